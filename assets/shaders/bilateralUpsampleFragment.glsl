@@ -0,0 +1,52 @@
+/* ---------------------------------------------------------------------------
+** bilateralUpsampleFragment
+** ---------------------------------------------------------------------------
+** Draws a small image on a bigger target. The 4 nearest texels are mixed
+** with their linear filter weights, divided by how much their depth differs
+** from the depth of the pixel, so an edge takes the color of its own side.
+** The depth of a texel is read at its center, on the full depth.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+in vec2 Texcoord;
+out vec4 outColor;
+
+uniform sampler2D colorTexture;		// The small image
+uniform sampler2D depthTexture;		// The depth of the scene
+
+// Keeps the weights finite where the depth is the same
+const float DEPTH_EPSILON = 0.0001;
+
+void main() 
+{
+	vec2  smallSize  = vec2(textureSize(colorTexture, 0));
+	vec2  depthSize  = vec2(textureSize(depthTexture, 0));
+	vec2  depthScale = depthSize / smallSize;
+	float depth      = texelFetch(depthTexture, ivec2(Texcoord * depthSize), 0).r;
+	
+	vec2 position = Texcoord * smallSize - 0.5;
+	vec2 first    = floor(position);
+	vec2 fraction = position - first;
+	
+	vec3  total       = vec3(0.0);
+	float totalWeight = 0.0;
+	
+	for (int y = 0; y < 2; y++)
+	{
+		for (int x = 0; x < 2; x++)
+		{
+			vec2  texel      = clamp(first + vec2(x, y), vec2(0.0), smallSize - 1.0);
+			float linear     = (x == 0 ? 1.0 - fraction.x : fraction.x) * (y == 0 ? 1.0 - fraction.y : fraction.y);
+			float texelDepth = texelFetch(depthTexture, ivec2((texel + 0.5) * depthScale), 0).r;
+			float weight     = linear / (DEPTH_EPSILON + abs(texelDepth - depth));
+			
+			total       += texelFetch(colorTexture, ivec2(texel), 0).rgb * weight;
+			totalWeight += weight;
+		}
+	}
+	
+	outColor = vec4(total / totalWeight, 1.0);
+}
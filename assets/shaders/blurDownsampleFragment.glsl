@@ -0,0 +1,29 @@
+/* ---------------------------------------------------------------------------
+** blurDownsampleFragment
+** ---------------------------------------------------------------------------
+** Dual Kawase downsample: the image is drawn at half its size, with the
+** center and the four corners of the pixel (each one a bilinear sample of
+** 4 texels).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+in vec2 Texcoord;
+out vec4 outColor;
+
+uniform sampler2D colorTexture;
+uniform vec2 halfTexel;		// Half a texel of colorTexture
+
+void main() 
+{
+	vec3 color = texture(colorTexture, Texcoord).rgb * 4.0;
+	
+	color += texture(colorTexture, Texcoord - halfTexel).rgb;
+	color += texture(colorTexture, Texcoord + halfTexel).rgb;
+	color += texture(colorTexture, Texcoord + vec2(halfTexel.x, -halfTexel.y)).rgb;
+	color += texture(colorTexture, Texcoord - vec2(halfTexel.x, -halfTexel.y)).rgb;
+	
+	outColor = vec4(color / 8.0, 1.0);
+}
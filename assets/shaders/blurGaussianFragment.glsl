@@ -0,0 +1,34 @@
+/* ---------------------------------------------------------------------------
+** blurGaussianFragment
+** ---------------------------------------------------------------------------
+** One direction (horizontal or vertical) of a separable Gaussian blur. Every
+** sample but the center one is read on both sides, and it is placed between
+** two texels so the bilinear filter reads both with their weights.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+in vec2 Texcoord;
+out vec4 outColor;
+
+uniform sampler2D colorTexture;
+
+uniform vec2  direction;		// One texel, on the row or on the column
+uniform int   tapCount;
+uniform float tapOffsets[8];	// In texels, the first one is the center
+uniform float tapWeights[8];
+
+void main() 
+{
+	vec3 color = texture(colorTexture, Texcoord).rgb * tapWeights[0];
+	
+	for (int i = 1; i < tapCount; i++)
+	{
+		vec2 offset = direction * tapOffsets[i];
+		color += (texture(colorTexture, Texcoord + offset).rgb + texture(colorTexture, Texcoord - offset).rgb) * tapWeights[i];
+	}
+	
+	outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,33 @@
+/* ---------------------------------------------------------------------------
+** blurUpsampleFragment
+** ---------------------------------------------------------------------------
+** Dual Kawase upsample: the image is drawn at twice its size, with a tent
+** of 8 samples around the pixel (the diagonal ones weigh double).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+in vec2 Texcoord;
+out vec4 outColor;
+
+uniform sampler2D colorTexture;
+uniform vec2 halfTexel;		// Half a texel of colorTexture
+
+void main() 
+{
+	vec3 color = vec3(0.0);
+	
+	color += texture(colorTexture, Texcoord + vec2(-halfTexel.x * 2.0, 0.0)).rgb;
+	color += texture(colorTexture, Texcoord + vec2( halfTexel.x * 2.0, 0.0)).rgb;
+	color += texture(colorTexture, Texcoord + vec2(0.0, -halfTexel.y * 2.0)).rgb;
+	color += texture(colorTexture, Texcoord + vec2(0.0,  halfTexel.y * 2.0)).rgb;
+	
+	color += texture(colorTexture, Texcoord + vec2(-halfTexel.x,  halfTexel.y)).rgb * 2.0;
+	color += texture(colorTexture, Texcoord + vec2( halfTexel.x,  halfTexel.y)).rgb * 2.0;
+	color += texture(colorTexture, Texcoord + vec2( halfTexel.x, -halfTexel.y)).rgb * 2.0;
+	color += texture(colorTexture, Texcoord + vec2(-halfTexel.x, -halfTexel.y)).rgb * 2.0;
+	
+	outColor = vec4(color / 12.0, 1.0);
+}
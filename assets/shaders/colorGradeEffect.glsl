@@ -0,0 +1,25 @@
+/* ---------------------------------------------------------------------------
+** colorGradeEffect
+** ---------------------------------------------------------------------------
+** Exposure and tint, contrast around the middle grey and saturation against
+** the luminance. It is not a shader by itself, the function is added to the
+** fused pass of the PostprocessChain.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+uniform float gradeExposure;
+uniform float gradeContrast;
+uniform float gradeSaturation;
+uniform vec3  gradeTint;
+
+vec3 ColorGrade(vec3 color, vec2 uv)
+{
+	color *= gradeExposure * gradeTint;
+	color  = (color - 0.5) * gradeContrast + 0.5;
+	
+	float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+	color = mix(vec3(luminance), color, gradeSaturation);
+	
+	return clamp(color, 0.0, 1.0);
+}
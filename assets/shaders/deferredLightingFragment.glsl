@@ -0,0 +1,118 @@
+/* ---------------------------------------------------------------------------
+** deferredLightingFragment
+** ---------------------------------------------------------------------------
+** The lighting pass of the deferred renderer. Every pixel of the screen is
+** lit once, whatever the number of surfaces that were drawn on it: the
+** position is rebuilt from the depth, and only the lights of its cluster
+** (see LightClusters) are applied. The lighting is the same as fragment.glsl.
+** It also outputs the speed, as the forward shader does, for the motion blur.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330 core
+
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec2 speedTexture;
+
+// G-buffer
+uniform sampler2D albedoTexture;		// rgb albedo, a shininess
+uniform sampler2D normalTexture;		// Octahedral view space normal
+uniform sampler2D velocityTexture;
+uniform sampler2D depthTexture;
+
+uniform mat4 inverseProjection;
+uniform mat4 viewMatrix;
+
+// Clustered lights (see LightManager and LightClusters)
+uniform samplerBuffer  lightData;		// 2 texels per light: world position + radius, color + intensity
+uniform usamplerBuffer lightIndices;	// Lights of every froxel, one after another
+uniform usamplerBuffer lightClusters;	// Offset and count of every froxel
+uniform ivec3 clusterGrid;
+uniform vec2  clusterScale;				// Froxels per pixel
+uniform vec2  clusterDepth;				// slice = log(depth) * x + y
+
+// The 2 coordinates of the octahedron to a unit vector
+vec3 DecodeNormal(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if(n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
+void main()
+{
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(depthTexture, pixel, 0).r;
+	
+	// Nothing was drawn here
+	if(depth == 1.0)
+	{
+		color        = vec4(0.0, 0.0, 0.0, 1.0);
+		speedTexture = vec2(0.0);
+		return;
+	}
+	
+	// Position from the depth
+	vec4 ndc             = vec4(gl_FragCoord.xy / vec2(textureSize(depthTexture, 0)) * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+	vec4 position        = inverseProjection * ndc;
+	vec3 fragPositionCam = position.xyz / position.w;
+	
+	//Material Colors
+	vec4 albedo                = texelFetch(albedoTexture, pixel, 0);
+	vec3 materialDiffuseColor  = albedo.rgb;
+	vec3 materialAmbientColor  = vec3(0.1,0.1,0.1) * materialDiffuseColor;
+	vec3 materialSpecularColor = vec3(0.3,0.3,0.3);
+	vec3 normal                = DecodeNormal(texelFetch(normalTexture, pixel, 0).rg);
+	
+	//Specular Init
+	float shininess        = albedo.a * 255.0;
+	vec3  normalizedEyeDir = normalize(-fragPositionCam);
+	
+	vec3 totalLighting = vec3(materialAmbientColor);
+	
+	// Our froxel
+	ivec3 cell    = ivec3(ivec2(gl_FragCoord.xy * clusterScale), int(log(-fragPositionCam.z) * clusterDepth.x + clusterDepth.y));
+	cell          = clamp(cell, ivec3(0), clusterGrid - 1);
+	int   cluster = (cell.z * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+	uvec2 range   = texelFetch(lightClusters, cluster).rg;
+	
+	for (uint i = 0u; i < range.y; i++) // for the light sources of the froxel
+	{
+		int  light      = int(texelFetch(lightIndices, int(range.x + i)).r);
+		vec4 lightPos   = texelFetch(lightData, light * 2    );		// xyz position, w radius
+		vec4 lightColor = texelFetch(lightData, light * 2 + 1);		// rgb color, w intensity
+		
+		// Lights
+		vec3  lightPosCam     = (viewMatrix * vec4(lightPos.xyz, 1.0)).xyz;
+		vec3  lightVector     = lightPosCam - fragPositionCam;
+		float distancePowered = dot      (lightVector, lightVector);
+		vec3  light_direction = lightVector * inversesqrt(distancePowered);
+		
+		// The light fades to 0 at its radius, so cutting it at the froxels doesn't show
+		float falloff         = clamp(1.0 - pow(distancePowered / (lightPos.w * lightPos.w), 2.0), 0.0, 1.0);
+		float attenuation     = falloff * falloff / distancePowered;
+		
+		//Diffuse
+		float diffPower       = clamp(dot(normal, light_direction), 0, 1);
+		
+		//Specular
+		vec3  reflectDirection = reflect  (-light_direction, normal);
+		float basicSpecPower   = max    (dot(normalizedEyeDir, reflectDirection), 0.0);
+		float specPower        = pow      (basicSpecPower, shininess);
+		
+		// Apply Lighting
+		vec3 specTotal = materialSpecularColor * lightColor.rgb * (lightColor.w / 100.0) * specPower * attenuation;	//Specular
+		vec3 diffTotal = materialDiffuseColor  * lightColor.rgb *  lightColor.w          * diffPower * attenuation;	//Diffuse
+		
+		totalLighting += diffTotal + specTotal;
+	}
+	
+    color = vec4(totalLighting, 0.3);
+	
+	// Motion Blur
+	speedTexture = texelFetch(velocityTexture, pixel, 0).rg;
+}
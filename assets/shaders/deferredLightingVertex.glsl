@@ -1,8 +1,8 @@
 /* ---------------------------------------------------------------------------
-** basicPostProcessVertex
+** deferredLightingVertex
 ** ---------------------------------------------------------------------------
-** A simple post process shader that does nothing. The Vertex passes the
-** position and coordinates to the Fragment.
+** The lighting pass of the deferred renderer. The Vertex only draws the
+** screen quad, the Fragment reads the G-buffer with the pixel coordinates.
 **
 ** Author: Fly - Ruben Negredo
 ** -------------------------------------------------------------------------*/
@@ -10,10 +10,8 @@
 #version 330
 
 in vec2 position;
-out vec2 Texcoord;
 
 void main() 
 {
-    Texcoord = (position / 2.0) + 0.5;
     gl_Position = vec4(position, 0.0, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,23 @@
+/* ---------------------------------------------------------------------------
+** dizzyEffect
+** ---------------------------------------------------------------------------
+** Doubles the screen: the image is read twice, moved with sin and cos in a
+** radius, and both colors are mixed. It is not a shader by itself, the
+** function is added to the fused pass of the PostprocessChain.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+uniform float dizzyTime;
+uniform float dizzyRadius;
+uniform int   dizzyViewHeight;
+
+vec3 Dizzy(sampler2D image, vec2 uv)
+{
+	float invViewSize = 1.0 / dizzyViewHeight;
+	
+	vec3 color1 = texture(image, uv + cos(dizzyTime * 10.0) * dizzyRadius * invViewSize).rgb;
+	vec3 color2 = texture(image, uv + sin(dizzyTime * 10.0) * dizzyRadius * invViewSize).rgb;
+	
+	return mix(color1, color2, 0.5);
+}
@@ -2,7 +2,9 @@
 ** Fragment
 ** ---------------------------------------------------------------------------
 ** A shader that draws a mesh with diffuse map, normal map, and specular map.
-** It has some lights and outputs data for a postprocess.
+** The lights are clustered: the fragment finds its froxel (screen tile and
+** depth slice) and only loops over the lights that touch it.
+** It outputs data for a postprocess too.
 **
 ** Author: Fly - Ruben Negredo
 ** -------------------------------------------------------------------------*/
@@ -10,61 +12,76 @@
 #version 330 core
 
 out vec4 color;
-out vec4 speedTexture;
+out vec2 speedTexture;	// Screen movement since the last frame (RG16F)
 
 
 //Varying
 in vec3 fragColor;
 in vec2 uv;
-in vec3 fragPosition;
-in vec3 fragNormal;
-in vec3 eyeDirectionTan;
-in vec3 lightDirectionTan[8];
+in vec3 fragPositionCam;
+in vec3 tangentCam;
+in vec3 bitangentCam;
+in vec3 normalCam;
 in vec4 oldScreenCoord;
 in vec4 newScreenCoord;
 
-uniform sampler2D diffuseSampler;
-uniform sampler2D specularSampler;
-uniform sampler2D normalSampler;
+// Texture arrays, and the layer this mesh uses on each one (diffuse, specular, normal)
+uniform sampler2DArray diffuseSampler;
+uniform sampler2DArray specularSampler;
+uniform sampler2DArray normalSampler;
+uniform int textureLayers[3];
 
 uniform mat4 viewMatrix;
-uniform mat4 modelMatrix;
 
-uniform vec3 lightPos[8];
-uniform vec3 lightColor[8];
-uniform float lightPower[8];
-uniform int numberOfLights;
+// Clustered lights (see LightManager and LightClusters)
+uniform samplerBuffer  lightData;		// 2 texels per light: world position + radius, color + intensity
+uniform usamplerBuffer lightIndices;	// Lights of every froxel, one after another
+uniform usamplerBuffer lightClusters;	// Offset and count of every froxel
+uniform ivec3 clusterGrid;
+uniform vec2  clusterScale;				// Froxels per pixel
+uniform vec2  clusterDepth;				// slice = log(depth) * x + y
 
 
 void main()
 {
-	const int MAX_NUMBER_OF_LIGHTS = 8;
-	int actualLightNumber = numberOfLights;
-	
-	if(actualLightNumber > MAX_NUMBER_OF_LIGHTS)
-	{
-		actualLightNumber = MAX_NUMBER_OF_LIGHTS;
-	}
-		
 	//Material Colors
-	vec3 materialDiffuseColor  = texture2D(diffuseSampler, uv).rgb;
+	vec3 materialDiffuseColor  = texture(diffuseSampler, vec3(uv, textureLayers[0])).rgb;
 	vec3 materialAmbientColor  = vec3(0.1,0.1,0.1) * materialDiffuseColor;
 	vec3 materialSpecularColor = vec3(0.3,0.3,0.3);
 	
-	vec3 normal = normalize(texture2D(normalSampler, uv).rgb * 2.0 - 1.0);
+	// The normal map only stores X and Y (BC5), Z is rebuilt from them
+	vec3 normalTan;
+	normalTan.xy = texture(normalSampler, vec3(uv, textureLayers[2])).rg * 2.0 - 1.0;
+	normalTan.z  = sqrt(clamp(1.0 - dot(normalTan.xy, normalTan.xy), 0.0, 1.0));
+	vec3 normal  = normalize(mat3(normalize(tangentCam), normalize(bitangentCam), normalize(normalCam)) * normalTan);
 	
 	//Specular Init
-	float shininess        = texture2D(specularSampler, uv).r * 255.0;
-	vec3  normalizedEyeDir = normalize(eyeDirectionTan);
+	float shininess        = texture(specularSampler, vec3(uv, textureLayers[1])).r * 255.0;
+	vec3  normalizedEyeDir = normalize(-fragPositionCam);
 	
 	vec3 totalLighting = vec3(materialAmbientColor);
 	
-    for (int i = 0; i < actualLightNumber; i++) // for all light sources
+	// Our froxel
+	ivec3 cell    = ivec3(ivec2(gl_FragCoord.xy * clusterScale), int(log(-fragPositionCam.z) * clusterDepth.x + clusterDepth.y));
+	cell          = clamp(cell, ivec3(0), clusterGrid - 1);
+	int   cluster = (cell.z * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+	uvec2 range   = texelFetch(lightClusters, cluster).rg;
+	
+	for (uint i = 0u; i < range.y; i++) // for the light sources of the froxel
 	{
+		int  light      = int(texelFetch(lightIndices, int(range.x + i)).r);
+		vec4 lightPos   = texelFetch(lightData, light * 2    );		// xyz position, w radius
+		vec4 lightColor = texelFetch(lightData, light * 2 + 1);		// rgb color, w intensity
+		
 		// Lights
-		float distanceToLight = length   (lightPos[i] - fragPosition);	
-		float distancePowered = distanceToLight * distanceToLight;
-		vec3  light_direction = normalize(lightDirectionTan[i]      );
+		vec3  lightPosCam     = (viewMatrix * vec4(lightPos.xyz, 1.0)).xyz;
+		vec3  lightVector     = lightPosCam - fragPositionCam;
+		float distancePowered = dot      (lightVector, lightVector);
+		vec3  light_direction = lightVector * inversesqrt(distancePowered);
+		
+		// The light fades to 0 at its radius, so cutting it at the froxels doesn't show
+		float falloff         = clamp(1.0 - pow(distancePowered / (lightPos.w * lightPos.w), 2.0), 0.0, 1.0);
+		float attenuation     = falloff * falloff / distancePowered;
 		
 		//Diffuse
 		float diffPower       = clamp(dot(normal, light_direction), 0, 1);
@@ -75,8 +92,8 @@ void main()
 		float specPower        = pow      (basicSpecPower, shininess);
 		
 		// Apply Lighting
-		vec3 specTotal = materialSpecularColor * lightColor[i] * (lightPower[i] / 100.0) * specPower / distancePowered;	//Specular
-		vec3 diffTotal = materialDiffuseColor  * lightColor[i] *  lightPower[i]          * diffPower / distancePowered;	//Diffuse
+		vec3 specTotal = materialSpecularColor * lightColor.rgb * (lightColor.w / 100.0) * specPower * attenuation;	//Specular
+		vec3 diffTotal = materialDiffuseColor  * lightColor.rgb *  lightColor.w          * diffPower * attenuation;	//Diffuse
 		
 		totalLighting += diffTotal + specTotal;
 	}
@@ -84,6 +101,5 @@ void main()
     color = vec4(totalLighting, 0.3);
 	
 	// Motion Blur
-	vec2 speed = (newScreenCoord.xy / newScreenCoord.w) - (oldScreenCoord.xy / oldScreenCoord.w);
-	speedTexture = vec4(0.5 + 0.5 *  speed, 0.0, 1.0);
-}
+	speedTexture = (newScreenCoord.xy / newScreenCoord.w) - (oldScreenCoord.xy / oldScreenCoord.w);
+}
\ No newline at end of file
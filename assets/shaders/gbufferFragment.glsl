@@ -0,0 +1,57 @@
+/* ---------------------------------------------------------------------------
+** gbufferFragment
+** ---------------------------------------------------------------------------
+** The geometry pass of the deferred renderer (used with vertex.glsl). No
+** lighting here, it only writes what the lighting pass needs: the albedo
+** with the shininess, the view space normal (octahedral, 2 channels) and
+** the speed for the motion blur. The depth gives the position.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330 core
+
+layout(location = 0) out vec4 albedoShininess;
+layout(location = 1) out vec2 packedNormal;
+layout(location = 2) out vec2 velocity;
+
+
+//Varying
+in vec3 fragColor;
+in vec2 uv;
+in vec3 fragPositionCam;
+in vec3 tangentCam;
+in vec3 bitangentCam;
+in vec3 normalCam;
+in vec4 oldScreenCoord;
+in vec4 newScreenCoord;
+
+// Texture arrays, and the layer this mesh uses on each one (diffuse, specular, normal)
+uniform sampler2DArray diffuseSampler;
+uniform sampler2DArray specularSampler;
+uniform sampler2DArray normalSampler;
+uniform int textureLayers[3];
+
+// A unit vector to the 2 coordinates of the octahedron
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : folded;
+}
+
+void main()
+{
+	// The normal map only stores X and Y (BC5), Z is rebuilt from them
+	vec3 normalTan;
+	normalTan.xy = texture(normalSampler, vec3(uv, textureLayers[2])).rg * 2.0 - 1.0;
+	normalTan.z  = sqrt(clamp(1.0 - dot(normalTan.xy, normalTan.xy), 0.0, 1.0));
+	vec3 normal  = normalize(mat3(normalize(tangentCam), normalize(bitangentCam), normalize(normalCam)) * normalTan);
+	
+	albedoShininess.rgb = texture(diffuseSampler,  vec3(uv, textureLayers[0])).rgb;
+	albedoShininess.a   = texture(specularSampler, vec3(uv, textureLayers[1])).r;
+	packedNormal        = EncodeNormal(normal);
+	
+	// Motion Blur
+	velocity = (newScreenCoord.xy / newScreenCoord.w) - (oldScreenCoord.xy / oldScreenCoord.w);
+}
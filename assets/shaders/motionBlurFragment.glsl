@@ -1,9 +1,12 @@
 /* ---------------------------------------------------------------------------
-** motionBlurVertex
+** motionBlurFragment
 ** ---------------------------------------------------------------------------
-** A shader that blurs the movement. This motion blur only affects the camera.
-** The Fragment takes the speedTexture, and depending on that value sets an
-** offset. The pixel will be blurred depending on that offset.
+** A shader that blurs the movement. The Fragment samples along the longest
+** speed around its tile (neighbour max), with a number of samples that
+** depends on how long it is. Every sample weighs more if its own speed (or
+** the one of the pixel) reaches the pixel, so the moving objects are smeared
+** over the background. If nothing moves around the tile, the pixel is just
+** copied.
 **
 ** Author: Fly - Ruben Negredo
 ** -------------------------------------------------------------------------*/
@@ -13,38 +16,58 @@
 in vec2 Texcoord;
 out vec4 outColor;
 
-uniform sampler2D speedTexture;
 uniform sampler2D colorTexture;
+uniform sampler2D speedTexture;
+uniform sampler2D neighbourMaxTexture;
 
 uniform float intensity;
-uniform int numberOfSamples;
+uniform int   maxSamples;
+uniform float velocityThreshold;	// In pixels
+uniform int   tileSize;
+
+// One sample every this many pixels of blur
+const float PIXELS_PER_SAMPLE = 2.0;
+
+// How much a blur of this length covers a pixel at this distance (both in pixels)
+float Cover(float distance, float blurLength)
+{
+	return clamp(1.0 - distance / max(0.5 * blurLength, 1.0), 0.0, 1.0);
+}
 
 void main() 
 {
-	//If the pixel in speedTexture is pure black, probably it is not a mesh, and anyway it is not moving. So paint it black
-	bool drawPixel = (texture2D(speedTexture, Texcoord).rgb != vec3(0.0, 0.0, 0.0));
+	vec2  pixels = vec2(textureSize(colorTexture, 0));
+	ivec2 tile   = ivec2(Texcoord * vec2(textureSize(speedTexture, 0))) / tileSize;
+	vec3  color  = texture(colorTexture, Texcoord).rgb;
+	
+	vec2  maxBlur   = intensity * texelFetch(neighbourMaxTexture, tile, 0).rg;
+	float maxLength = length(maxBlur * pixels);
 	
-	if(drawPixel)
+	// Nothing moves around here
+	if (maxLength < velocityThreshold)
 	{
-		//float intensity = 1.5;
-		
-		vec2 speed  = 2.0 * texture2D(speedTexture, Texcoord).rg - 1.0;
-		vec2 blur_direction = intensity * speed;
-		vec3 color  = vec3(0.0, 0.0, 0.0);
-		
-		//int numberOfSamples = 8;
-		
-		for (float i = 0.0; i < numberOfSamples; i++)
-		{
-			vec2 offset = blur_direction * (float(i) / float(numberOfSamples - 1) - 0.5);
-			color += texture2D(colorTexture, Texcoord + offset).rgb;
-		}
-		
-		color /= numberOfSamples;
 		outColor = vec4(color, 1.0);
+		return;
 	}
-	else
+	
+	float centerLength = length(intensity * texture(speedTexture, Texcoord).rg * pixels);
+	int   samples      = clamp(int(ceil(maxLength / PIXELS_PER_SAMPLE)), 2, maxSamples);
+	
+	vec3  total       = color;
+	float totalWeight = 1.0;
+	
+	for (int i = 0; i < samples; i++)
 	{
-		outColor = vec4(0.0, 0.0, 0.0, 1.0);
+		float t        = float(i) / float(samples - 1) - 0.5;
+		vec2  position = Texcoord + maxBlur * t;
+		float distance = abs(t) * maxLength;
+		
+		float sampleLength = length(intensity * texture(speedTexture, position).rg * pixels);
+		float weight       = max(Cover(distance, sampleLength), Cover(distance, centerLength));
+		
+		total       += texture(colorTexture, position).rgb * weight;
+		totalWeight += weight;
 	}
-}
\ No newline at end of file
+	
+	outColor = vec4(total / totalWeight, 1.0);
+}
@@ -0,0 +1,47 @@
+/* ---------------------------------------------------------------------------
+** motionBlurNeighbourMaxFragment
+** ---------------------------------------------------------------------------
+** Second reduction of the motion blur. Every tile keeps the longest speed of
+** itself and its 8 neighbours, so the blur of a moving object reaches the
+** tiles around it.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+in vec2 Texcoord;
+out vec2 outVelocity;
+
+uniform sampler2D velocityTexture;	// The tile max
+uniform sampler2D speedTexture;		// The speed of the scene, for its size
+
+void main() 
+{
+	ivec2 size = textureSize(velocityTexture, 0);
+	ivec2 tile = ivec2(gl_FragCoord.xy);
+	
+	// The lengths are compared in pixels of the scene, as the tile max does
+	vec2  pixels      = vec2(textureSize(speedTexture, 0));
+	vec2  maxVelocity = vec2(0.0);
+	float maxLength   = 0.0;
+	
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			ivec2 neighbour = clamp(tile + ivec2(x, y), ivec2(0), size - 1);
+			vec2  velocity  = texelFetch(velocityTexture, neighbour, 0).rg;
+			vec2  blur      = velocity * pixels;
+			float len       = dot(blur, blur);
+			
+			if (len > maxLength)
+			{
+				maxLength   = len;
+				maxVelocity = velocity;
+			}
+		}
+	}
+	
+	outVelocity = maxVelocity;
+}
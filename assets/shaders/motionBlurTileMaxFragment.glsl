@@ -0,0 +1,46 @@
+/* ---------------------------------------------------------------------------
+** motionBlurTileMaxFragment
+** ---------------------------------------------------------------------------
+** First reduction of the motion blur. Every pixel of the output is a tile of
+** the speed texture, and it keeps the longest speed of the tile.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+in vec2 Texcoord;
+out vec2 outVelocity;
+
+uniform sampler2D velocityTexture;
+uniform int tileSize;
+
+void main() 
+{
+	ivec2 size  = textureSize(velocityTexture, 0);
+	ivec2 first = ivec2(gl_FragCoord.xy) * tileSize;
+	ivec2 last  = min(first + tileSize, size);
+	
+	// The lengths are compared in pixels, the screen is not square
+	vec2  pixels      = vec2(size);
+	vec2  maxVelocity = vec2(0.0);
+	float maxLength   = 0.0;
+	
+	for (int y = first.y; y < last.y; y++)
+	{
+		for (int x = first.x; x < last.x; x++)
+		{
+			vec2  velocity = texelFetch(velocityTexture, ivec2(x, y), 0).rg;
+			vec2  blur     = velocity * pixels;
+			float len      = dot(blur, blur);
+			
+			if (len > maxLength)
+			{
+				maxLength   = len;
+				maxVelocity = velocity;
+			}
+		}
+	}
+	
+	outVelocity = maxVelocity;
+}
@@ -0,0 +1,24 @@
+/* ---------------------------------------------------------------------------
+** planarReflectionFragment
+** ---------------------------------------------------------------------------
+** Blends the reflection on the surface, already drawn by the scene. The
+** reflection was drawn with the same projection, so it is read at the pixel
+** (its target can be smaller than the scene).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+layout(location = 0) out vec4 outColor;
+
+uniform sampler2D reflectionTexture;
+uniform float     reflectivity;		// How much of the reflection is seen (0 to 1)
+uniform vec2      invSceneSize;		// 1 / the size of the scene, in pixels
+
+void main()
+{
+	vec2 texcoord = gl_FragCoord.xy * invSceneSize;
+
+	outColor = vec4(texture(reflectionTexture, texcoord).rgb, reflectivity);
+}
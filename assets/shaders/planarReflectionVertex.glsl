@@ -0,0 +1,19 @@
+/* ---------------------------------------------------------------------------
+** planarReflectionVertex
+** ---------------------------------------------------------------------------
+** Places the surface of a planar reflection on the screen, the fragment
+** shader only needs the pixel.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#version 330
+
+layout(location = 0) in vec3 vertexPosition_modelspace;
+
+uniform mat4 MVP;
+
+void main()
+{
+	gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
+}
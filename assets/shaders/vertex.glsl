@@ -2,7 +2,8 @@
 ** Vertex
 ** ---------------------------------------------------------------------------
 ** A shader that draws a mesh with diffuse map, normal map, and specular map.
-** It has some lights and outputs data for a postprocess.
+** It outputs the view space position and tangent frame, the lighting is done
+** in the fragment shader with the lights of its cluster.
 **
 ** Author: Fly - Ruben Negredo
 ** -------------------------------------------------------------------------*/
@@ -23,17 +24,15 @@ uniform mat4 MVP;
 uniform mat4 viewMatrix;
 uniform mat4 modelMatrix;
 uniform mat3 modelView3x3;
-uniform vec3 lightPos[8];
-uniform int numberOfLights;
 uniform mat4 oldMVP;	//For motion blur
 
 //Varying
 out vec3 fragColor;
 out vec2 uv;
-out vec3 fragPosition;
-out vec3 fragNormal;
-out vec3 lightDirectionTan[8];
-out vec3 eyeDirectionTan;
+out vec3 fragPositionCam;
+out vec3 tangentCam;		// Tangent frame, in view space
+out vec3 bitangentCam;
+out vec3 normalCam;
 out vec4 oldScreenCoord;	// For motion blur
 out vec4 newScreenCoord;
 
@@ -43,25 +42,12 @@ void main()
     gl_Position       = MVP * pos;
 	fragColor         = vertexColor_modelspace;
 	uv                = vertexUV_modelspace;
-	fragPosition      = (modelMatrix * pos).xyz;
-	fragNormal        = (viewMatrix * modelMatrix * vec4(vertexNormal_modelspace,0.0)).xyz;
+	fragPositionCam   = (viewMatrix * modelMatrix * pos).xyz;
 	
 	// For normal mapping
-	mat3 TBN = transpose(mat3
-	(
-		modelView3x3 * normalize(tangents  ),
-		modelView3x3 * normalize(bitangents),
-		modelView3x3 * normalize(vertexNormal_modelspace   )
-	));
-	
-	vec3 vertexPosCam = (viewMatrix * modelMatrix * pos).xyz;
-	vec3 eyeDirection = vec3(0,0,0) - vertexPosCam;
-	eyeDirectionTan   = TBN * eyeDirection;
-	for(int i = 0; i < numberOfLights; i++)
-	{
-		vec3 lightPosCam     = (viewMatrix * vec4(lightPos[i], 1.0)).xyz;
-		lightDirectionTan[i] = TBN * lightPosCam  + eyeDirection;
-	}
+	tangentCam        = modelView3x3 * normalize(tangents               );
+	bitangentCam      = modelView3x3 * normalize(bitangents             );
+	normalCam         = modelView3x3 * normalize(vertexNormal_modelspace);
 	
 	// For Motion Blur
 	oldScreenCoord = oldMVP * pos;
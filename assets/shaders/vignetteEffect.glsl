@@ -0,0 +1,19 @@
+/* ---------------------------------------------------------------------------
+** vignetteEffect
+** ---------------------------------------------------------------------------
+** Darkens the pixels far from the center of the screen. It is not a shader
+** by itself, the function is added to the fused pass of the PostprocessChain.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+uniform float vignetteStrength;
+uniform float vignetteRadius;
+
+vec3 Vignette(vec3 color, vec2 uv)
+{
+	// 1.0 on the corners
+	float distance = length(uv - 0.5) * 1.41421356;
+	
+	return color * (1.0 - vignetteStrength * smoothstep(vignetteRadius, 1.0, distance));
+}
@@ -28,6 +28,10 @@
 			glm::vec3 pos;
 			glm::vec3 rot;
 			glm::vec3 sc;
+
+            // Called whenever the position changes (lights upload it again)
+            virtual void OnMoved()
+            {}
             
         public:
 
@@ -79,6 +83,7 @@
 				pos.x = _x;
 				pos.y = _y;
 				pos.z = _z;
+                OnMoved();
 			}
 
             // Change the scale into the new one
@@ -111,6 +116,7 @@
 				pos.x = new_pos.x;
 				pos.y = new_pos.y;
 				pos.z = new_pos.z;
+                OnMoved();
 			}
 
             // Change the scale into the new one
@@ -145,6 +151,7 @@
 				pos.x += _x;
 				pos.y += _y;
 				pos.z += _z;
+                OnMoved();
 			}
 
             // Adds a rotation to the actual one
@@ -177,6 +184,7 @@
 				pos.x += pos_offset.x;
 				pos.y += pos_offset.y;
 				pos.z += pos_offset.z;
+                OnMoved();
 			}
 
             // Adds a rotation to the actual one
@@ -0,0 +1,833 @@
+/* ---------------------------------------------------------------------------
+** BenchmarkRunner.cpp
+** The cases of the benchmarks, how they are measured, and the comparison
+** with a baseline.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "BenchmarkRunner.hpp"
+#include "Actor.hpp"
+#include "Mesh.hpp"
+#include "ShaderManager.hpp"
+#include "Profiler.hpp"
+#include "View.hpp"
+#include "NullRenderDevice.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <SFML/System/Clock.hpp>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "tinyobjloader\tiny_obj_loader.h"
+#include "objindexer\objloader.hpp"
+#include "objindexer\vboindexer.hpp"
+#include "stb_image\stb_image.h"
+
+namespace flygl
+{
+    // A wavy grid of size x size quads, as the loaders give it: three
+    // vertices per triangle, without indices
+    struct SyntheticMesh
+    {
+    public:
+
+        int                    size;
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+
+        // Constructor
+        SyntheticMesh(const int& grid_size): size(grid_size)
+        {
+            static const int corners[6][2] = { {0, 0}, {0, 1}, {1, 1}, {0, 0}, {1, 1}, {1, 0} };
+
+            for(int z = 0; z < size; ++z)
+            {
+                for(int x = 0; x < size; ++x)
+                {
+                    for(int i = 0; i < 6; ++i)
+                    {
+                        const int gx = x + corners[i][0];
+                        const int gz = z + corners[i][1];
+
+                        vertices.push_back(GetPosition(gx, gz));
+                        uvs.     push_back(glm::vec2((float)gx / size, (float)gz / size));
+                        normals. push_back(GetNormal(gx, gz));
+                    }
+                }
+            }
+        }
+
+        // Writes it as an OBJ, with the vertices shared by the faces
+        bool Save(const std::string& path) const
+        {
+            FILE* file = fopen(path.c_str(), "w");
+            if(file == NULL)
+            {
+                return false;
+            }
+
+            for(int z = 0; z <= size; ++z)
+            {
+                for(int x = 0; x <= size; ++x)
+                {
+                    const glm::vec3 position = GetPosition(x, z);
+                    const glm::vec3 normal   = GetNormal  (x, z);
+                    fprintf(file, "v %f %f %f\nvt %f %f\nvn %f %f %f\n", position.x, position.y, position.z,
+                            (float)x / size, (float)z / size, normal.x, normal.y, normal.z);
+                }
+            }
+
+            for(int z = 0; z < size; ++z)
+            {
+                for(int x = 0; x < size; ++x)
+                {
+                    // OBJ indices start at 1
+                    const int a = z * (size + 1) + x + 1;
+                    const int b = a + size + 1;
+                    fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, b + 1, b + 1, b + 1);
+                    fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b + 1, b + 1, b + 1, a + 1, a + 1, a + 1);
+                }
+            }
+
+            fclose(file);
+            return true;
+        }
+
+        int GetTriangles() const
+        {
+            return size * size * 2;
+        }
+
+        std::string GetParameter() const
+        {
+            char parameter[64];
+            sprintf(parameter, "grid %d", size);
+            return parameter;
+        }
+
+    private:
+
+        glm::vec3 GetPosition(const int& x, const int& z) const
+        {
+            return glm::vec3((float)x, std::sin(x * 0.3f) * std::cos(z * 0.2f), (float)z);
+        }
+
+        glm::vec3 GetNormal(const int& x, const int& z) const
+        {
+            const float dx = 0.3f * std::cos(x * 0.3f) * std::cos(z * 0.2f);
+            const float dz = -0.2f * std::sin(x * 0.3f) * std::sin(z * 0.2f);
+            return glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+        }
+    };
+
+    // A case that reads a synthetic mesh from an OBJ file
+    class ObjFileCase: public BenchmarkCase
+    {
+    protected:
+
+        SyntheticMesh mesh;
+        std::string   path;
+
+    public:
+
+        // Constructor
+        ObjFileCase(const int& grid_size): mesh(grid_size)
+        {
+            char file_name[64];
+            sprintf(file_name, "benchmark_grid_%d.obj", grid_size);
+            path = file_name;
+        }
+
+        std::string GetParameter() const { return mesh.GetParameter(); }
+        double      GetItems    () const { return mesh.GetTriangles(); }
+
+        bool Prepare() { return mesh.Save(path); }
+        void Release() { remove(path.c_str());   }
+    };
+
+    // tinyobj::LoadObj, what Mesh::LoadMesh uses
+    class TinyObjCase: public ObjFileCase
+    {
+    public:
+
+        // Constructor
+        TinyObjCase(const int& grid_size): ObjFileCase(grid_size)
+        {}
+
+        std::string GetName() const { return "tinyobj::LoadObj"; }
+
+        void Run()
+        {
+            std::vector<tinyobj::shape_t> shapes;
+            tinyobj::LoadObj(shapes, path.c_str(), "");
+        }
+    };
+
+    // The simple OBJ loader of the indexer (it prints a line every time)
+    class LoadObjCase: public ObjFileCase
+    {
+    public:
+
+        // Constructor
+        LoadObjCase(const int& grid_size): ObjFileCase(grid_size)
+        {}
+
+        std::string GetName() const { return "loadOBJ"; }
+
+        void Run()
+        {
+            std::vector<glm::vec3> vertices, normals;
+            std::vector<glm::vec2> uvs;
+            loadOBJ(path.c_str(), vertices, uvs, normals);
+        }
+    };
+
+    // indexVBO or indexVBO_slow on a synthetic mesh
+    class IndexCase: public BenchmarkCase
+    {
+    private:
+
+        SyntheticMesh mesh;
+        bool          isSlow;
+
+        std::vector<unsigned short> indices;
+        std::vector<glm::vec3>      vertices, normals;
+        std::vector<glm::vec2>      uvs;
+
+    public:
+
+        // Constructor
+        IndexCase(const int& grid_size, const bool& slow): mesh(grid_size), isSlow(slow)
+        {}
+
+        std::string GetName     () const { return isSlow ? "indexVBO_slow" : "indexVBO"; }
+        std::string GetParameter() const { return mesh.GetParameter(); }
+        double      GetItems    () const { return (double)mesh.vertices.size(); }
+
+        void Run()
+        {
+            indices. clear();
+            vertices.clear();
+            uvs.     clear();
+            normals. clear();
+
+            if(isSlow)
+            {
+                indexVBO_slow(mesh.vertices, mesh.uvs, mesh.normals, indices, vertices, uvs, normals);
+            }
+            else
+            {
+                indexVBO(mesh.vertices, mesh.uvs, mesh.normals, indices, vertices, uvs, normals);
+            }
+        }
+    };
+
+    // indexVBO_TBN, with the tangents of the mesh
+    class IndexTangentsCase: public BenchmarkCase
+    {
+    private:
+
+        SyntheticMesh          mesh;
+        std::vector<glm::vec3> tangents, bitangents;
+
+        std::vector<unsigned short> indices;
+        std::vector<glm::vec3>      outVertices, outNormals, outTangents, outBitangents;
+        std::vector<glm::vec2>      outUvs;
+
+    public:
+
+        // Constructor
+        IndexTangentsCase(const int& grid_size): mesh(grid_size)
+        {}
+
+        std::string GetName     () const { return "indexVBO_TBN"; }
+        std::string GetParameter() const { return mesh.GetParameter(); }
+        double      GetItems    () const { return (double)mesh.vertices.size(); }
+
+        bool Prepare()
+        {
+            Mesh::ComputeTangents(mesh.vertices, mesh.uvs, mesh.normals, tangents, bitangents);
+            return true;
+        }
+
+        void Run()
+        {
+            indices.      clear();
+            outVertices.  clear();
+            outUvs.       clear();
+            outNormals.   clear();
+            outTangents.  clear();
+            outBitangents.clear();
+
+            indexVBO_TBN(mesh.vertices, mesh.uvs, mesh.normals, tangents, bitangents,
+                         indices, outVertices, outUvs, outNormals, outTangents, outBitangents);
+        }
+    };
+
+    // Mesh::ComputeTangents
+    class TangentsCase: public BenchmarkCase
+    {
+    private:
+
+        SyntheticMesh          mesh;
+        std::vector<glm::vec3> tangents, bitangents;
+
+    public:
+
+        // Constructor
+        TangentsCase(const int& grid_size): mesh(grid_size)
+        {}
+
+        std::string GetName     () const { return "Mesh::ComputeTangents"; }
+        std::string GetParameter() const { return mesh.GetParameter(); }
+        double      GetItems    () const { return (double)mesh.vertices.size(); }
+
+        void Run()
+        {
+            tangents.  clear();
+            bitangents.clear();
+            Mesh::ComputeTangents(mesh.vertices, mesh.uvs, mesh.normals, tangents, bitangents);
+        }
+    };
+
+    // stbi_load on a texture of the scene, to RGBA
+    class ImageLoadCase: public BenchmarkCase
+    {
+    private:
+
+        std::string path;
+        std::string fileName;
+        double      texels;
+
+    public:
+
+        // Constructor
+        ImageLoadCase(const std::string& file_name):
+            path("../../assets/textures/" + file_name), fileName(file_name), texels(0.0)
+        {}
+
+        std::string GetName     () const { return "stbi_load"; }
+        std::string GetParameter() const { return fileName; }
+        double      GetItems    () const { return texels; }
+
+        bool Prepare()
+        {
+            int width, height, channels;
+            const bool exists = stbi_info(path.c_str(), &width, &height, &channels) != 0;
+
+            texels = exists ? (double)width * height : 0.0;
+            return exists;
+        }
+
+        void Run()
+        {
+            int width, height, channels;
+            stbi_image_free(stbi_load(path.c_str(), &width, &height, &channels, 4));
+        }
+    };
+
+    // Actor::Update on many actors, every one with its own transformation
+    class ActorUpdateCase: public BenchmarkCase
+    {
+    private:
+
+        std::vector<Actor> actors;
+
+    public:
+
+        // Constructor
+        ActorUpdateCase(const int& count): actors(count)
+        {
+            for(int i = 0; i < count; ++i)
+            {
+                actors[i].SetPosition((float)i, i * 0.5f, -(float)i);
+                actors[i].SetRotation(i * 10.0f, i * 20.0f, i * 30.0f);
+                actors[i].SumScale(i * 0.001f);
+            }
+        }
+
+        std::string GetName() const { return "Actor::Update"; }
+
+        std::string GetParameter() const
+        {
+            char parameter[64];
+            sprintf(parameter, "%u actors", (unsigned int)actors.size());
+            return parameter;
+        }
+
+        double GetItems() const { return (double)actors.size(); }
+
+        void Run()
+        {
+            for(size_t i = 0; i < actors.size(); ++i)
+            {
+                actors[i].Update();
+            }
+        }
+    };
+
+    // ShaderManager reading a shader file
+    class ShaderLoadCase: public BenchmarkCase
+    {
+    private:
+
+        std::string   path;
+        std::string   fileName;
+        ShaderManager shaders;
+
+    public:
+
+        // Constructor
+        ShaderLoadCase(const std::string& file_name): path("../../assets/shaders/" + file_name), fileName(file_name)
+        {}
+
+        std::string GetName     () const { return "ShaderManager::LoadVertexShader"; }
+        std::string GetParameter() const { return fileName; }
+
+        bool Prepare()
+        {
+            FILE* file = fopen(path.c_str(), "r");
+            if(file != NULL)
+            {
+                fclose(file);
+            }
+            return file != NULL;
+        }
+
+        void Run()
+        {
+            shaders.LoadVertexShader(path);
+        }
+    };
+
+    // What a zone of the Profiler costs when the build has FLYGL_PROFILING
+    // (the class is used here, so it is measured in every build)
+    class ProfileZoneCase: public BenchmarkCase
+    {
+    private:
+
+        static const int ZONES = 1000;
+
+    public:
+
+        std::string GetName     () const { return "ProfileZone"; }
+        std::string GetParameter() const { return "1000 zones";  }
+
+        double GetItems() const { return ZONES; }
+
+        void Run()
+        {
+            for(int i = 0; i < ZONES; ++i)
+            {
+                ProfileZone zone("Benchmark");
+            }
+        }
+    };
+
+    // View::Update and View::Draw on the NullRenderDevice, without recording:
+    // the CPU side of a frame (culling, sorting, uniforms and the calls to
+    // the device) without the driver. The items are the draws of a frame,
+    // so the throughput is the draws a second.
+    class NullDrawCase: public BenchmarkCase
+    {
+    private:
+
+        static const int WIDTH  = 640;
+        static const int HEIGHT = 400;
+
+        std::string effects;
+        bool        isDeferred;
+
+        NullRenderDevice* device;
+        View*             view;
+        double            draws;
+
+    public:
+
+        // Constructor
+        //
+        // enabled_effects  The keys of the effects, as --effects of the headless run
+        // deferred         If the deferred renderer draws the scene
+        NullDrawCase(const std::string& enabled_effects, const bool& deferred):
+            effects(enabled_effects), isDeferred(deferred), device(NULL), view(NULL), draws(0.0)
+        {}
+
+        std::string GetName() const { return "View::Draw on NullRenderDevice"; }
+
+        std::string GetParameter() const
+        {
+            return std::string(isDeferred ? "deferred" : "forward") + (effects.empty() ? "" : ", effects " + effects);
+        }
+
+        double GetItems() const { return draws; }
+
+        bool Prepare()
+        {
+            FILE* file = fopen("../../assets/models/troll.obj", "r");
+            if(file == NULL)
+            {
+                return false;
+            }
+            fclose(file);
+
+            device = new NullRenderDevice();
+            device->SetRecording(false);
+            RenderDevice::SetCurrent(device);
+
+            view = new View(WIDTH, HEIGHT);
+            view->SetInputsEnabled    (false);
+            view->SetDynamicResolution(false);
+            view->SetWaitForTextures  (true);
+            view->SetDeferred         (isDeferred);
+
+            for(size_t i = 0; i < effects.size(); ++i)
+            {
+                view->SwitchEffect(effects[i] - '0');
+            }
+
+            // The first frame waits for the textures
+            Run();
+            device->Reset();
+            Run();
+
+            draws = (double)device->GetDrawCount();
+            return true;
+        }
+
+        void Release()
+        {
+            delete view;
+            view = NULL;
+
+            RenderDevice::SetCurrent(NULL);
+            delete device;
+            device = NULL;
+        }
+
+        void Run()
+        {
+            view->Update(1.0f / 60.0f);
+            view->Draw();
+        }
+    };
+
+    const int NullDrawCase::WIDTH;
+    const int NullDrawCase::HEIGHT;
+
+    // Destructor
+    BenchmarkRunner::~BenchmarkRunner()
+    {
+        for(size_t i = 0; i < cases.size(); ++i)
+        {
+            delete cases[i];
+        }
+    }
+
+    // Reads the options. Returns false if there is no --benchmark.
+    //
+    // argc     The arguments of main
+    // argv
+    bool BenchmarkRunner::ParseArguments(const int& argc, char* argv[])
+    {
+        bool is_benchmark = false;
+
+        for(int i = 1; i < argc; ++i)
+        {
+            const std::string option = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if(option == "--benchmark")
+            {
+                is_benchmark = true;
+            }
+            else if(has_value && option == "--filter")      { filter       = argv[++i];               }
+            else if(has_value && option == "--min-time")    { minTime      = (float)atof(argv[++i]);  }
+            else if(has_value && option == "--repetitions") { repetitions  = atoi(argv[++i]);         }
+            else if(has_value && option == "--output")      { outputPath   = argv[++i];               }
+            else if(has_value && option == "--baseline")    { baselinePath = argv[++i];               }
+            else if(has_value && option == "--threshold")   { threshold    = (float)atof(argv[++i]);  }
+            else
+            {
+                error = "Unknown option (or without value): " + option;
+            }
+        }
+
+        if(error.empty() && (minTime <= 0.0f || repetitions <= 0 || threshold < 0.0f))
+        {
+            error = "The time, the repetitions and the threshold must be positive";
+        }
+
+        return is_benchmark;
+    }
+
+    // Measures every case, writes the results and compares them with the
+    // baseline. Returns the exit code of the program.
+    int BenchmarkRunner::Run()
+    {
+        if(!error.empty())
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+
+        CreateCases();
+        results.clear();
+
+        for(size_t i = 0; i < cases.size(); ++i)
+        {
+            BenchmarkCase& benchmark_case = *cases[i];
+            const std::string key = GetKey(benchmark_case.GetName(), benchmark_case.GetParameter());
+
+            if(!filter.empty() && key.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            if(!benchmark_case.Prepare())
+            {
+                fprintf(stdout, "%-60s skipped\n", key.c_str());
+                benchmark_case.Release();
+                continue;
+            }
+
+            const BenchmarkResult result = Measure(benchmark_case);
+            benchmark_case.Release();
+
+            results.push_back(result);
+
+            fprintf(stdout, "%-60s %14.0f ns  (%ld iterations)\n", key.c_str(), result.medianTime, result.iterations);
+        }
+
+        const int exit_code = baselinePath.empty() ? EXIT_SUCCESS : Compare();
+
+        if(!outputPath.empty() && !WriteResults())
+        {
+            fprintf(stderr, "Can't write %s\n", outputPath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        return exit_code;
+    }
+
+    // The meshes grow 4 times every step. The indexers count the vertices
+    // with 16 bits, so the biggest has less than 65536 of them (without
+    // indices), and indexVBO_slow is quadratic so it only gets the small ones.
+    void BenchmarkRunner::CreateCases()
+    {
+        static const int grid_sizes[] = { 12, 24, 48, 96 };
+        static const int grid_count   = sizeof(grid_sizes) / sizeof(grid_sizes[0]);
+
+        for(int i = 0; i < grid_count; ++i) { cases.push_back(new TinyObjCase      (grid_sizes[i]));        }
+        for(int i = 0; i < grid_count; ++i) { cases.push_back(new LoadObjCase      (grid_sizes[i]));        }
+        for(int i = 0; i < grid_count; ++i) { cases.push_back(new IndexCase        (grid_sizes[i], false)); }
+        for(int i = 0; i < 2;          ++i) { cases.push_back(new IndexCase        (grid_sizes[i], true));  }
+        for(int i = 0; i < grid_count; ++i) { cases.push_back(new IndexTangentsCase(grid_sizes[i]));        }
+        for(int i = 0; i < grid_count; ++i) { cases.push_back(new TangentsCase     (grid_sizes[i]));        }
+
+        // The textures of View::MeshInitialization
+        static const char* textures[] =
+        {
+            "colors.jpg",   "specular.jpg", "normals.jpg",
+            "Suelo_D.tga",  "Suelo_S.tga",  "Suelo_NM.tga",
+            "Pared_D.tga",  "Pared_S.tga",  "Pared_NM.tga",
+            "Columna_D.tga", "Columna_S.tga", "Columna_NM.tga"
+        };
+        for(size_t i = 0; i < sizeof(textures) / sizeof(textures[0]); ++i)
+        {
+            cases.push_back(new ImageLoadCase(textures[i]));
+        }
+
+        cases.push_back(new ActorUpdateCase(100));
+        cases.push_back(new ActorUpdateCase(1000));
+        cases.push_back(new ActorUpdateCase(10000));
+
+        static const char* shaders[] =
+        {
+            "vertex.glsl", "fragment.glsl", "gbufferFragment.glsl", "deferredLightingFragment.glsl", "motionBlurFragment.glsl"
+        };
+        for(size_t i = 0; i < sizeof(shaders) / sizeof(shaders[0]); ++i)
+        {
+            cases.push_back(new ShaderLoadCase(shaders[i]));
+        }
+
+        cases.push_back(new ProfileZoneCase());
+
+        cases.push_back(new NullDrawCase("",      false));
+        cases.push_back(new NullDrawCase("",      true ));
+        cases.push_back(new NullDrawCase("12356", false));
+    }
+
+    // Runs a case once to warm it up and to know how many iterations fill
+    // a batch, and then the batches
+    BenchmarkResult BenchmarkRunner::Measure(BenchmarkCase& benchmark_case) const
+    {
+        sf::Clock clock;
+        benchmark_case.Run();
+
+        const double first_time = std::max(1.0, (double)clock.getElapsedTime().asMicroseconds());
+
+        BenchmarkResult result;
+        result.name         = benchmark_case.GetName();
+        result.parameter    = benchmark_case.GetParameter();
+        result.iterations   = std::max(1L, (long)(minTime * 1000000.0 / first_time));
+        result.items        = benchmark_case.GetItems();
+        result.baselineTime = 0.0;
+
+        std::vector<double> times;
+        for(int i = 0; i < repetitions; ++i)
+        {
+            clock.restart();
+
+            for(long j = 0; j < result.iterations; ++j)
+            {
+                benchmark_case.Run();
+            }
+
+            times.push_back(clock.getElapsedTime().asMicroseconds() * 1000.0 / result.iterations);
+        }
+
+        double total = 0.0;
+        for(size_t i = 0; i < times.size(); ++i)
+        {
+            total += times[i];
+        }
+
+        std::sort(times.begin(), times.end());
+
+        result.medianTime = times[times.size() / 2];
+        result.minTime    = times[0];
+        result.meanTime   = total / times.size();
+
+        return result;
+    }
+
+    // A line per case, so a baseline can be read back without a JSON parser
+    bool BenchmarkRunner::WriteResults() const
+    {
+        FILE* file = fopen(outputPath.c_str(), "w");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        fprintf(file, "{\n  \"min_time\": %.3f,\n  \"repetitions\": %d,\n  \"threshold\": %.3f,\n  \"benchmarks\": [\n",
+                minTime, repetitions, threshold);
+
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchmarkResult& result = results[i];
+
+            const double per_second = result.medianTime > 0.0 ? result.items * 1.0e9 / result.medianTime : 0.0;
+
+            fprintf(file, "    { \"name\": \"%s\", \"parameter\": \"%s\", \"iterations\": %ld, "
+                          "\"median_ns\": %.1f, \"min_ns\": %.1f, \"mean_ns\": %.1f, \"items\": %.0f, \"items_per_second\": %.1f",
+                    result.name.c_str(), result.parameter.c_str(), result.iterations,
+                    result.medianTime, result.minTime, result.meanTime, result.items, per_second);
+
+            if(result.baselineTime > 0.0)
+            {
+                fprintf(file, ", \"baseline_ns\": %.1f, \"change\": %.4f",
+                        result.baselineTime, result.medianTime / result.baselineTime - 1.0);
+            }
+
+            fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+
+        fclose(file);
+        return true;
+    }
+
+    // Reads the medians of a file written by WriteResults
+    //
+    // medians      Returns the median of every case, by its key
+    bool BenchmarkRunner::LoadBaseline(std::map<std::string, double>& medians) const
+    {
+        FILE* file = fopen(baselinePath.c_str(), "r");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        char line[2048];
+        while(fgets(line, sizeof(line), file) != NULL)
+        {
+            const char* name      = strstr(line, "\"name\": \"");
+            const char* parameter = strstr(line, "\"parameter\": \"");
+            const char* median    = strstr(line, "\"median_ns\": ");
+            if(name == NULL || parameter == NULL || median == NULL)
+            {
+                continue;
+            }
+
+            name      += strlen("\"name\": \"");
+            parameter += strlen("\"parameter\": \"");
+            median    += strlen("\"median_ns\": ");
+
+            const char* name_end      = strchr(name,      '"');
+            const char* parameter_end = strchr(parameter, '"');
+            if(name_end == NULL || parameter_end == NULL)
+            {
+                continue;
+            }
+
+            medians[GetKey(std::string(name, name_end), std::string(parameter, parameter_end))] = atof(median);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    // Prints how every case has changed since the baseline. Fails if any
+    // is slower than the threshold.
+    int BenchmarkRunner::Compare()
+    {
+        std::map<std::string, double> medians;
+        if(!LoadBaseline(medians))
+        {
+            fprintf(stderr, "Can't read the baseline %s\n", baselinePath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        int regressions = 0;
+
+        fprintf(stdout, "\nCompared with %s (threshold %.0f%%)\n", baselinePath.c_str(), threshold * 100.0f);
+
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            BenchmarkResult& result = results[i];
+            const std::string key = GetKey(result.name, result.parameter);
+
+            std::map<std::string, double>::const_iterator baseline = medians.find(key);
+            if(baseline == medians.end() || baseline->second <= 0.0)
+            {
+                fprintf(stdout, "%-60s new\n", key.c_str());
+                continue;
+            }
+
+            result.baselineTime = baseline->second;
+
+            const double change = result.medianTime / result.baselineTime - 1.0;
+            const bool   slower = change > threshold;
+            const bool   faster = change < -threshold;
+
+            regressions += slower ? 1 : 0;
+
+            fprintf(stdout, "%-60s %+7.1f%%%s\n", key.c_str(), change * 100.0,
+                    slower ? "  REGRESSION" : (faster ? "  faster" : ""));
+        }
+
+        fprintf(stdout, "%d regressions\n", regressions);
+
+        return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
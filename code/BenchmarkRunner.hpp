@@ -0,0 +1,128 @@
+/* ---------------------------------------------------------------------------
+** BenchmarkRunner.hpp
+** Measures the CPU side of loading and updating the scene, without a window
+** or a GL context: the OBJ loaders (tinyobj::LoadObj and loadOBJ), the
+** indexers (indexVBO, indexVBO_slow and indexVBO_TBN), Mesh::ComputeTangents,
+** stbi_load on the textures of the scene, Actor::Update, the loading of the
+** shader files, and View::Update and View::Draw on the NullRenderDevice (the
+** CPU side of a frame, per draw). The meshes are grids made here, of
+** growing size, so the results don't depend on the assets.
+** Every case is run in batches of at least --min-time seconds, and the time
+** of an iteration is the median of the batches. The results are written as
+** JSON, and compared with the ones of a previous run if --baseline is given:
+** a case slower than --threshold is a regression, and the program fails.
+**
+**   FlyEngine --benchmark [--filter indexVBO] [--min-time 0.1] [--repetitions 5]
+**             [--output benchmarks.json] [--baseline old.json] [--threshold 0.1]
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef BENCHMARKRUNNER_HEADER
+#define BENCHMARKRUNNER_HEADER
+
+#include <map>
+#include <string>
+#include <vector>
+
+    namespace flygl
+    {
+        // Something to measure, with one of its parameters
+        class BenchmarkCase
+        {
+        public:
+
+            // Destructor
+            virtual ~BenchmarkCase()
+            {}
+
+            virtual std::string GetName     () const = 0;
+            virtual std::string GetParameter() const = 0;
+
+            // What is done before and after the measure, not timed. Prepare
+            // returns false if the case can't be run (a missing file).
+            virtual bool Prepare()
+            {
+                return true;
+            }
+
+            virtual void Release()
+            {}
+
+            // An iteration, the part that is measured
+            virtual void Run() = 0;
+
+            // What an iteration processes (vertices, texels...), for the throughput
+            virtual double GetItems() const
+            {
+                return 0.0;
+            }
+        };
+
+        // The time of a case
+        struct BenchmarkResult
+        {
+        public:
+
+            std::string name;
+            std::string parameter;
+            long        iterations;     // Of every batch
+            double      medianTime;     // Nanoseconds per iteration
+            double      minTime;
+            double      meanTime;
+            double      items;          // Per iteration
+            double      baselineTime;   // Median of the baseline, 0 if it isn't there
+        };
+
+        class BenchmarkRunner
+        {
+        private:
+
+            std::string filter;         // Only the cases whose name has it
+            float       minTime;        // Seconds of every batch
+            int         repetitions;    // Batches
+            std::string outputPath;
+            std::string baselinePath;
+            float       threshold;      // Fraction a case can be slower than the baseline
+
+            std::string error;
+
+            std::vector<BenchmarkCase*>   cases;
+            std::vector<BenchmarkResult>  results;
+
+        public:
+
+            // Constructor
+            BenchmarkRunner():
+                minTime(0.1f), repetitions(5), outputPath("benchmarks.json"), threshold(0.1f)
+            {}
+
+            // Destructor
+            ~BenchmarkRunner();
+
+            bool ParseArguments(const int& argc, char* argv[]);
+            int  Run();
+
+            const std::vector<BenchmarkResult>& GetResults() const
+            {
+                return results;
+            }
+
+        private:
+
+            void CreateCases();
+
+            BenchmarkResult Measure(BenchmarkCase& benchmark_case) const;
+
+            bool WriteResults() const;
+            bool LoadBaseline(std::map<std::string, double>& medians) const;
+            int  Compare     ();
+
+            static std::string GetKey(const std::string& name, const std::string& parameter)
+            {
+                return name + "/" + parameter;
+            }
+        };
+    }
+
+#endif
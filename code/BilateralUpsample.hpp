@@ -0,0 +1,55 @@
+/* ---------------------------------------------------------------------------
+** BilateralUpsample.hpp
+** Draws an image drawn at a lower resolution on a bigger target. Every pixel
+** mixes the 4 nearest texels of the small image like a linear filter would,
+** but each texel weighs less the more its depth differs from the depth of
+** the pixel, so the edges of the meshes don't bleed into the background.
+** The PostprocessChain uses it for the effects with a resolution scale.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef BILATERALUPSAMPLE_HEADER
+#define BILATERALUPSAMPLE_HEADER
+
+#include "Postprocess.hpp"
+
+    namespace flygl
+    {
+        class BilateralUpsample : public Postprocess
+        {
+        protected:
+            GLuint depthTextureID;
+
+        public:
+
+			//Constructor
+			BilateralUpsample(): Postprocess()
+			{
+			}
+
+            virtual void Initialize(
+                const std::string& vertex_path, const std::string& fragment_path, 
+                RenderTargetPool& render_targets)
+            {
+                Postprocess::Initialize(vertex_path, fragment_path, render_targets);
+
+                depthTextureID = postProcessShader.SetUniform("depthTexture");
+            }
+
+        protected:
+
+            // The small image, and the depth of the scene (full resolution)
+            virtual void RenderTextures()
+            {
+                Postprocess::RenderTextures();
+
+                const GLint unit = 1;
+
+                RenderDevice::Get().BindTexture(unit, GL_TEXTURE_2D, renderTargets->GetDepthTexture());
+                RenderDevice::Get().SetUniform (depthTextureID, UNIFORM_INT, 1, &unit);
+            }
+        };
+    }
+
+#endif
@@ -0,0 +1,217 @@
+/* ---------------------------------------------------------------------------
+** BlurProcess.cpp
+** A Gaussian blur whose radius is a fraction of the screen height, so it
+** looks the same at any resolution. The image is first halved a few times
+** (dual Kawase downsampling, 5 taps) until the radius left is a few texels,
+** blurred there with a separable Gaussian (horizontal and vertical passes,
+** and two texels read with a single linear sample), and then upsampled back
+** (dual Kawase, 8 taps) to the output. A big radius costs the same as a
+** small one, most of the work is done on the small levels.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "BlurProcess.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace flygl
+{
+    // The image is halved until the sigma left (in texels) is not bigger than this
+    static const float MAX_LEVEL_SIGMA = 3.0f;
+
+    // Loads the three shaders of the blur
+    //
+    // vertex_path      The vertex shader of the screen quad
+    // gaussian_path    The separable Gaussian
+    // downsample_path  The dual Kawase downsample
+    // upsample_path    The dual Kawase upsample
+    // render_targets   The pool the targets are taken from every frame
+    void BlurProcess::Initialize(
+        const std::string& vertex_path,     const std::string& gaussian_path,
+        const std::string& downsample_path, const std::string& upsample_path,
+        RenderTargetPool& render_targets)
+    {
+        Postprocess::Initialize(vertex_path, gaussian_path, render_targets);
+
+        directionID  = postProcessShader.SetUniform("direction" );
+        tapCountID   = postProcessShader.SetUniform("tapCount"  );
+        tapOffsetsID = postProcessShader.SetUniform("tapOffsets");
+        tapWeightsID = postProcessShader.SetUniform("tapWeights");
+
+        downsampleShader.LoadVertexShader  (vertex_path    );
+        downsampleShader.LoadFragmentShader(downsample_path);
+        downsampleShader.CompileShaders();
+
+        downsampleTexelID   = downsampleShader.SetUniform("halfTexel"   );
+        downsampleTextureID = downsampleShader.SetUniform("colorTexture");
+
+        upsampleShader.LoadVertexShader  (vertex_path  );
+        upsampleShader.LoadFragmentShader(upsample_path);
+        upsampleShader.CompileShaders();
+
+        upsampleTexelID   = upsampleShader.SetUniform("halfTexel"   );
+        upsampleTextureID = upsampleShader.SetUniform("colorTexture");
+    }
+
+    // Blurs the input on the output: down the levels, Gaussian on the
+    // smallest one, and up again
+    //
+    // input    What the previous pass (or the scene) has drawn
+    // output   Where the effect is drawn, NULL for the screen
+    void BlurProcess::Draw(const RenderTarget* input, const SceneTargets&, RenderTarget* output)
+    {
+        const float sigma       = radius * input->height;
+        const int   level_count = GetLevelCount(sigma, input->width, input->height);
+        const float level_sigma = sigma / (1 << level_count);
+
+        if(level_sigma != tapSigma)
+        {
+            ComputeTaps(level_sigma, tapOffsets, tapWeights, tapCount);
+            tapSigma = level_sigma;
+        }
+
+        // Down
+        const RenderTarget* source = input;
+
+        for(int i = 1; i <= level_count; ++i)
+        {
+            RenderTarget* level = renderTargets->Acquire(
+                std::max(1, input->width >> i), std::max(1, input->height >> i), input->internalFormat);
+
+            Resample(downsampleShader, downsampleTexelID, downsampleTextureID, source, level);
+
+            levels.push_back(level);
+            source = level;
+        }
+
+        // Gaussian, the vertical pass goes back to the smallest level (or the output)
+        RenderTarget* horizontal = renderTargets->Acquire(source->width, source->height, input->internalFormat);
+
+        Gaussian(source,     horizontal, true);
+        Gaussian(horizontal, levels.empty() ? output : levels.back(), false);
+
+        renderTargets->Release(horizontal);
+
+        // Up, every level is drawn on the bigger one, and the last on the output
+        for(int i = level_count - 1; i >= 0; --i)
+        {
+            Resample(upsampleShader, upsampleTexelID, upsampleTextureID, levels[i], i > 0 ? levels[i - 1] : output);
+        }
+
+        for(size_t i = 0; i < levels.size(); ++i)
+        {
+            renderTargets->Release(levels[i]);
+        }
+        levels.clear();
+    }
+
+    // How many times the image has to be halved so the Gaussian left is
+    // small, without making it too small
+    //
+    // sigma    The sigma of the blur, in texels of the full image
+    // width    Width of the full image
+    // height   Height of the full image
+    int BlurProcess::GetLevelCount(const float& sigma, const int& width, const int& height)
+    {
+        int level_count = 0;
+
+        while(sigma / (1 << level_count) > MAX_LEVEL_SIGMA &&
+              level_count < MAX_LEVELS &&
+              (width  >> (level_count + 1)) >= MIN_LEVEL_SIZE &&
+              (height >> (level_count + 1)) >= MIN_LEVEL_SIZE)
+        {
+            level_count++;
+        }
+
+        return level_count;
+    }
+
+    // The linear samples of a Gaussian. Two neighbour texels are read with a
+    // single sample between them, placed where the bilinear filter gives each
+    // one its weight.
+    //
+    // sigma    The sigma, in texels
+    // offsets  Distance of every sample to the center (in texels), the first one is 0
+    // weights  Weight of every sample (the others are read on both sides)
+    // count    Number of samples written
+    void BlurProcess::ComputeTaps(const float& sigma, GLfloat* offsets, GLfloat* weights, GLint& count)
+    {
+        // Discrete weights, 3 sigmas on each side
+        const int radius_texels = std::min((int)std::ceil(3.0f * sigma), 2 * (MAX_TAPS - 1));
+
+        float discrete[2 * MAX_TAPS];
+        float total = 0.0f;
+
+        for(int i = 0; i <= radius_texels; ++i)
+        {
+            discrete[i] = sigma > 0.0f ? std::exp(-(float)(i * i) / (2.0f * sigma * sigma)) : (i == 0 ? 1.0f : 0.0f);
+            total      += i == 0 ? discrete[i] : 2.0f * discrete[i];
+        }
+
+        offsets[0] = 0.0f;
+        weights[0] = discrete[0] / total;
+        count      = 1;
+
+        for(int i = 1; i <= radius_texels; i += 2)
+        {
+            const float first  = discrete[i];
+            const float second = i + 1 <= radius_texels ? discrete[i + 1] : 0.0f;
+            const float weight = first + second;
+
+            offsets[count] = (i * first + (i + 1) * second) / weight;
+            weights[count] = weight / total;
+            count++;
+        }
+    }
+
+    // Draws the source on the destination with a dual Kawase shader
+    //
+    // shader       The downsample or upsample shader
+    // texel_id     Its half texel uniform
+    // texture_id   Its texture uniform
+    // source       What is read
+    // destination  Where it is drawn, NULL for the screen
+    void BlurProcess::Resample(ShaderManager& shader, const GLuint& texel_id, const GLuint& texture_id,
+                               const RenderTarget* source, RenderTarget* destination)
+    {
+        BindOutput(destination);
+        shader.UseThisShader();
+
+        const GLint   unit     = 0;
+        const GLfloat texel[2] = { 0.5f / source->width, 0.5f / source->height };
+
+        RenderDevice& device = RenderDevice::Get();
+        device.BindTexture(unit, GL_TEXTURE_2D, source->texture);
+        device.SetUniform (texture_id, UNIFORM_INT,  1, &unit    );
+        device.SetUniform (texel_id,   UNIFORM_VEC2, 1, texel);
+
+        DrawQuad();
+    }
+
+    // One direction of the separable Gaussian
+    //
+    // source       What is read
+    // destination  Where it is drawn, NULL for the screen
+    // horizontal   If the samples are on the same row (if not, on the same column)
+    void BlurProcess::Gaussian(const RenderTarget* source, RenderTarget* destination, const bool& horizontal)
+    {
+        BindOutput(destination);
+        postProcessShader.UseThisShader();
+
+        const GLint   unit         = 0;
+        const GLfloat direction[2] = { horizontal ? 1.0f / source->width : 0.0f, horizontal ? 0.0f : 1.0f / source->height };
+
+        RenderDevice& device = RenderDevice::Get();
+        device.BindTexture(unit, GL_TEXTURE_2D, source->texture);
+        device.SetUniform (colorTextureID, UNIFORM_INT, 1, &unit);
+
+        device.SetUniform(directionID,  UNIFORM_VEC2,  1,        direction   );
+        device.SetUniform(tapCountID,   UNIFORM_INT,   1,        &tapCount    );
+        device.SetUniform(tapOffsetsID, UNIFORM_FLOAT, tapCount, tapOffsets   );
+        device.SetUniform(tapWeightsID, UNIFORM_FLOAT, tapCount, tapWeights   );
+
+        DrawQuad();
+    }
+}
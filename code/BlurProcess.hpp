@@ -0,0 +1,104 @@
+/* ---------------------------------------------------------------------------
+** BlurProcess.hpp
+** A Gaussian blur whose radius is a fraction of the screen height, so it
+** looks the same at any resolution. The image is first halved a few times
+** (dual Kawase downsampling, 5 taps) until the radius left is a few texels,
+** blurred there with a separable Gaussian (horizontal and vertical passes,
+** and two texels read with a single linear sample), and then upsampled back
+** (dual Kawase, 8 taps) to the output. A big radius costs the same as a
+** small one, most of the work is done on the small levels.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef BLURPROCESS_HEADER
+#define BLURPROCESS_HEADER
+
+#include "Postprocess.hpp"
+
+    namespace flygl
+    {
+        class BlurProcess : public Postprocess
+        {
+        public:
+
+            // Linear samples of the Gaussian on each side (the first one is the center)
+            static const int MAX_TAPS = 8;
+
+            // Times the image can be halved
+            static const int MAX_LEVELS = 6;
+
+            // Levels are not made smaller than this
+            static const int MIN_LEVEL_SIZE = 8;
+
+        protected:
+
+            // The radius (sigma of the Gaussian) as a fraction of the screen height
+            GLfloat radius;
+
+            // Dual Kawase shaders (the Gaussian is the postProcessShader)
+            ShaderManager downsampleShader;
+            ShaderManager upsampleShader;
+
+            GLuint downsampleTexelID;
+            GLuint downsampleTextureID;
+            GLuint upsampleTexelID;
+            GLuint upsampleTextureID;
+
+            // Gaussian uniforms
+            GLuint directionID;
+            GLuint tapCountID;
+            GLuint tapOffsetsID;
+            GLuint tapWeightsID;
+
+            // The linear samples, computed for the sigma of the last draw
+            GLfloat tapOffsets[MAX_TAPS];
+            GLfloat tapWeights[MAX_TAPS];
+            GLint   tapCount;
+            GLfloat tapSigma;
+
+            // The halved images of this draw
+            std::vector<RenderTarget*> levels;
+
+        public:
+
+			//Constructor
+			BlurProcess(): Postprocess(), radius(0.012f), tapCount(0), tapSigma(0.0f)
+			{
+			}
+
+            void Initialize(
+                const std::string& vertex_path,     const std::string& gaussian_path,
+                const std::string& downsample_path, const std::string& upsample_path,
+                RenderTargetPool& render_targets);
+
+            virtual void Draw(const RenderTarget* input, const SceneTargets& scene, RenderTarget* output);
+
+            virtual const char* GetName() const
+            {
+                return "BlurProcess";
+            }
+
+            // The sigma of the Gaussian, as a fraction of the screen height
+            void SetRadius(const float& screen_fraction)
+            {
+                radius = screen_fraction;
+            }
+
+            float GetRadius() const
+            {
+                return radius;
+            }
+
+            static int  GetLevelCount(const float& sigma, const int& width, const int& height);
+            static void ComputeTaps  (const float& sigma, GLfloat* offsets, GLfloat* weights, GLint& count);
+
+        private:
+
+            void Resample(ShaderManager& shader, const GLuint& texel_id, const GLuint& texture_id,
+                          const RenderTarget* source, RenderTarget* destination);
+            void Gaussian(const RenderTarget* source, RenderTarget* destination, const bool& horizontal);
+        };
+    }
+
+#endif
@@ -67,6 +67,18 @@
                 return glm::perspective (fieldOfView, GLfloat(screenWidth) / screenHeight, nearPlane, farPlane);
             }
 
+            // Returns the actual Field of View (vertical, in degrees)
+            float GetFoV() const
+            {
+                return fieldOfView;
+            }
+
+            // Returns the height of the screen
+            int GetScreenHeight() const
+            {
+                return screenHeight;
+            }
+
             // Returns the actual value of the Near Plane
             float GetNear() const
             {
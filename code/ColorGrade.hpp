@@ -0,0 +1,65 @@
+/* ---------------------------------------------------------------------------
+** ColorGrade.hpp
+** Changes the exposure, contrast, saturation and tint of the screen. It is a
+** point function (colorGradeEffect.glsl), fused with the effects next to it.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef COLORGRADE_HEADER
+#define COLORGRADE_HEADER
+
+#include "FusedPass.hpp"
+#include <glm/glm.hpp>
+
+    namespace flygl
+    {
+        class ColorGrade : public FusableEffect
+        {
+        protected:
+            GLfloat   exposure;
+            GLfloat   contrast;
+            GLfloat   saturation;
+            glm::vec3 tint;
+
+        public:
+
+			//Constructor
+			ColorGrade(): FusableEffect("ColorGrade", POINT_OPERATION),
+                exposure(1.1f), contrast(1.15f), saturation(1.2f), tint(1.0f, 0.97f, 0.92f)
+			{
+			}
+
+            void SetExposure(const float& value)
+            {
+                exposure = value;
+            }
+
+            void SetContrast(const float& value)
+            {
+                contrast = value;
+            }
+
+            void SetSaturation(const float& value)
+            {
+                saturation = value;
+            }
+
+            void SetTint(const float& r, const float& g, const float& b)
+            {
+                tint = glm::vec3(r, g, b);
+            }
+
+            // Render the Uniforms
+            virtual void SetUniforms(FusedPass& pass)
+            {
+                RenderDevice& device = RenderDevice::Get();
+                device.SetUniform(pass.GetUniform("gradeExposure"  ), UNIFORM_FLOAT, 1, &exposure  );
+                device.SetUniform(pass.GetUniform("gradeContrast"  ), UNIFORM_FLOAT, 1, &contrast  );
+                device.SetUniform(pass.GetUniform("gradeSaturation"), UNIFORM_FLOAT, 1, &saturation);
+                device.SetUniform(pass.GetUniform("gradeTint"      ), UNIFORM_VEC3,  1, &tint[0]   );
+            }
+        };
+    }
+
+#endif
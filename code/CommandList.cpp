@@ -0,0 +1,352 @@
+/* ---------------------------------------------------------------------------
+** CommandList.cpp
+** The calls made to a render device, stored in an array of words, that can
+** be replayed on another device or printed.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "CommandList.hpp"
+
+#include <cstring>
+#include <map>
+
+namespace flygl
+{
+    // The header of a command: the type on the low byte, then the number of
+    // arguments (16 bits) and the number of data blocks
+    static const GLuint ARGUMENT_SHIFT = 8;
+    static const GLuint DATA_SHIFT     = 24;
+    static const GLuint BYTE_MASK      = 0xFF;
+    static const GLuint ARGUMENT_MASK  = 0xFFFF;
+
+    // Translates the names of the device that recorded a list to the ones
+    // of the device it is replayed on (the names that were not created in
+    // the list are kept)
+    template <typename T>
+    static T Translate(const std::map<T, T>& table, const T& recorded)
+    {
+        typename std::map<T, T>::const_iterator found = table.find(recorded);
+        return found != table.end() ? found->second : recorded;
+    }
+
+    template <typename T>
+    static void Remember(std::map<T, T>& table, const T& recorded, const T& created)
+    {
+        table[recorded] = created;
+    }
+
+    // Starts a new command
+    void CommandList::Begin(const RenderCommandType& type)
+    {
+        currentHeader = words.size();
+        words.push_back((GLuint)type);
+        commandCount++;
+    }
+
+    // Adds an argument to the command (before its data blocks)
+    void CommandList::AddArgument(const GLuint& argument)
+    {
+        words.push_back(argument);
+        words[currentHeader] += 1 << ARGUMENT_SHIFT;
+    }
+
+    // Adds a data block to the command (a copy of the bytes)
+    void CommandList::AddData(const void* data, const size_t& size)
+    {
+        const size_t data_words = (size + sizeof(GLuint) - 1) / sizeof(GLuint);
+        const size_t position   = words.size() + 1;
+
+        words.push_back((GLuint)size);
+        words.resize(position + data_words, 0);
+
+        if(size > 0 && data != NULL)
+        {
+            memcpy(&words[position], data, size);
+        }
+
+        words[currentHeader] += 1 << DATA_SHIFT;
+    }
+
+    // Forgets every command
+    void CommandList::Clear()
+    {
+        words.clear();
+        commandCount  = 0;
+        currentHeader = 0;
+    }
+
+    // Reads a command, and returns the position of the next one
+    //
+    // position     Where the command starts (0 for the first one)
+    // command      Where it is read
+    size_t CommandList::Read(const size_t& position, RenderCommand& command) const
+    {
+        const GLuint header = words[position];
+
+        command.type          = (RenderCommandType)(header & BYTE_MASK);
+        command.argumentCount = (header >> ARGUMENT_SHIFT) & ARGUMENT_MASK;
+        command.dataCount     = (header >> DATA_SHIFT) & BYTE_MASK;
+        command.arguments     = command.argumentCount > 0 ? &words[position + 1] : NULL;
+
+        size_t next = position + 1 + command.argumentCount;
+
+        for(int i = 0; i < command.dataCount && i < RenderCommand::MAX_DATA; ++i)
+        {
+            command.dataSize[i] = words[next];
+            command.data    [i] = command.dataSize[i] > 0 ? &words[next + 1] : NULL;
+
+            next += 1 + (command.dataSize[i] + sizeof(GLuint) - 1) / sizeof(GLuint);
+        }
+
+        return next;
+    }
+
+    // Makes every call again on the given device. The buffers, textures,
+    // programs, frame buffers and uniforms created by the list are created
+    // again, and their uses go to the new ones.
+    void CommandList::Replay(RenderDevice& device) const
+    {
+        std::map<GLuint, GLuint> names;
+        std::map<GLint,  GLint>  locations;
+
+        RenderCommand command;
+
+        size_t position = 0;
+        while(position < words.size())
+        {
+            position = Read(position, command);
+            const GLuint* a = command.arguments;
+
+            switch(command.type)
+            {
+                case COMMAND_CREATE_BUFFER:
+                    Remember(names, a[0], device.CreateBuffer(a[1], command.data[0], command.dataSize[0], a[2]));
+                    break;
+
+                case COMMAND_DELETE_BUFFER:
+                    device.DeleteBuffer(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_SET_BUFFER_DATA:
+                    device.SetBufferData(Translate(names, a[0]), a[1], command.data[0], command.dataSize[0], a[2]);
+                    break;
+
+                case COMMAND_UPDATE_BUFFER:
+                    device.UpdateBuffer(Translate(names, a[0]), a[1], a[2], command.data[0], command.dataSize[0]);
+                    break;
+
+                case COMMAND_CREATE_TEXTURE_2D:
+                    Remember(names, a[0], device.CreateTexture2D(a[1], a[2], a[3], a[4]));
+                    break;
+
+                case COMMAND_BIND_TEXTURE:
+                    device.BindTexture(a[0], a[1], Translate(names, a[2]));
+                    break;
+
+                case COMMAND_DELETE_TEXTURE:
+                    device.DeleteTexture(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_CREATE_TEXTURE_ARRAY:
+                    Remember(names, a[0], device.CreateTextureArray());
+                    break;
+
+                case COMMAND_SET_COMPRESSED_LEVEL:
+                    device.SetCompressedLevel(Translate(names, a[0]), a[1], a[2], a[3], a[4], a[5], command.data[0], command.dataSize[0]);
+                    break;
+
+                case COMMAND_CREATE_BUFFER_TEXTURE:
+                    Remember(names, a[0], device.CreateBufferTexture(Translate(names, a[1]), a[2]));
+                    break;
+
+                case COMMAND_CREATE_PROGRAM:
+                {
+                    const std::string vertex_code  ((const char*)command.data[0], command.dataSize[0]);
+                    const std::string fragment_code((const char*)command.data[1], command.dataSize[1]);
+                    Remember(names, a[0], device.CreateProgram(vertex_code, fragment_code));
+                    break;
+                }
+
+                case COMMAND_DELETE_PROGRAM:
+                    device.DeleteProgram(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_USE_PROGRAM:
+                    device.UseProgram(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_GET_UNIFORM_LOCATION:
+                {
+                    const std::string name((const char*)command.data[0], command.dataSize[0]);
+                    Remember(locations, (GLint)a[0], device.GetUniformLocation(Translate(names, a[1]), name));
+                    break;
+                }
+
+                case COMMAND_SET_UNIFORM:
+                    device.SetUniform(Translate(locations, (GLint)a[0]), (UniformType)a[1], a[2], command.data[0]);
+                    break;
+
+                case COMMAND_CREATE_FRAMEBUFFER:
+                {
+                    GLuint colors[8];
+                    const int count = a[2] < 8 ? a[2] : 8;
+                    for(int i = 0; i < count; ++i)
+                    {
+                        colors[i] = Translate(names, a[3 + i]);
+                    }
+                    Remember(names, a[0], device.CreateFramebuffer(colors, count, Translate(names, a[1])));
+                    break;
+                }
+
+                case COMMAND_DELETE_FRAMEBUFFER:
+                    device.DeleteFramebuffer(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_BIND_FRAMEBUFFER:
+                    device.BindFramebuffer(Translate(names, a[0]), a[1]);
+                    break;
+
+                case COMMAND_SET_VIEWPORT:
+                    device.SetViewport(a[0], a[1], a[2], a[3]);
+                    break;
+
+                case COMMAND_CLEAR:
+                    device.Clear(a[0]);
+                    break;
+
+                case COMMAND_SET_CLEAR_COLOR:
+                    device.SetClearColor(ToFloat(a[0]), ToFloat(a[1]), ToFloat(a[2]), ToFloat(a[3]));
+                    break;
+
+                case COMMAND_SET_CAPABILITY:
+                    device.SetCapability(a[0], a[1] != 0);
+                    break;
+
+                case COMMAND_SET_DEPTH_FUNCTION:
+                    device.SetDepthFunction(a[0]);
+                    break;
+
+                case COMMAND_SET_DEPTH_MASK:
+                    device.SetDepthMask(a[0] != 0);
+                    break;
+
+                case COMMAND_SET_FRONT_FACE:
+                    device.SetFrontFace(a[0]);
+                    break;
+
+                case COMMAND_SET_BLEND_FUNCTION:
+                    device.SetBlendFunction(a[0], a[1]);
+                    break;
+
+                case COMMAND_SET_POLYGON_OFFSET:
+                    device.SetPolygonOffset(ToFloat(a[0]), ToFloat(a[1]));
+                    break;
+
+                case COMMAND_SET_COLOR_MASK:
+                    device.SetColorMask(a[0], a[1] != 0);
+                    break;
+
+                case COMMAND_CREATE_VERTEX_ARRAY:
+                    Remember(names, a[0], device.CreateVertexArray());
+                    break;
+
+                case COMMAND_BIND_VERTEX_ARRAY:
+                    device.BindVertexArray(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_DELETE_VERTEX_ARRAY:
+                    device.DeleteVertexArray(Translate(names, a[0]));
+                    break;
+
+                case COMMAND_SET_VERTEX_ATTRIBUTE:
+                    device.SetVertexAttribute(a[0], Translate(names, a[1]), a[2], a[3]);
+                    break;
+
+                case COMMAND_ENABLE_ATTRIBUTES:
+                    device.EnableAttributes(a[0], a[1] != 0);
+                    break;
+
+                case COMMAND_DRAW_ARRAYS:
+                    device.DrawArrays(a[0], a[1], a[2]);
+                    break;
+
+                case COMMAND_DRAW_ELEMENTS:
+                    device.DrawElements(a[0], Translate(names, a[1]), a[2], a[3]);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Writes a line for every command: its name, its arguments and the size
+    // and a checksum of its data
+    void CommandList::Print(std::ostream& stream) const
+    {
+        RenderCommand command;
+
+        size_t position = 0;
+        while(position < words.size())
+        {
+            position = Read(position, command);
+
+            stream << GetName(command.type);
+
+            for(int i = 0; i < command.argumentCount; ++i)
+            {
+                stream << ' ' << (GLint)command.arguments[i];
+            }
+
+            for(int i = 0; i < command.dataCount && i < RenderCommand::MAX_DATA; ++i)
+            {
+                // FNV-1a, so different data is seen without printing it
+                const unsigned char* bytes = (const unsigned char*)command.data[i];
+                GLuint hash = 2166136261u;
+
+                for(size_t j = 0; j < command.dataSize[i]; ++j)
+                {
+                    hash = (hash ^ bytes[j]) * 16777619u;
+                }
+
+                stream << " [" << command.dataSize[i] << " bytes " << std::hex << hash << std::dec << ']';
+            }
+
+            stream << '\n';
+        }
+    }
+
+    // The name of the method of the device
+    const char* CommandList::GetName(const RenderCommandType& type)
+    {
+        static const char* NAMES[COMMAND_TYPE_COUNT] =
+        {
+            "CreateBuffer",      "DeleteBuffer",      "SetBufferData",   "UpdateBuffer",
+            "CreateTexture2D",   "BindTexture",       "DeleteTexture",
+            "CreateTextureArray", "SetCompressedLevel", "CreateBufferTexture",
+            "CreateProgram",     "DeleteProgram",     "UseProgram",     "GetUniformLocation", "SetUniform",
+            "CreateFramebuffer", "DeleteFramebuffer", "BindFramebuffer", "SetViewport",       "Clear",
+            "SetClearColor",     "SetCapability",     "SetDepthFunction", "SetDepthMask",     "SetFrontFace",
+            "SetBlendFunction",  "SetPolygonOffset",  "SetColorMask",
+            "CreateVertexArray", "BindVertexArray",   "DeleteVertexArray",
+            "SetVertexAttribute", "EnableAttributes", "DrawArrays",     "DrawElements"
+        };
+
+        return type < COMMAND_TYPE_COUNT ? NAMES[type] : "Unknown";
+    }
+
+    GLuint CommandList::ToWord(const GLfloat& value)
+    {
+        GLuint word;
+        memcpy(&word, &value, sizeof(word));
+        return word;
+    }
+
+    GLfloat CommandList::ToFloat(const GLuint& word)
+    {
+        GLfloat value;
+        memcpy(&value, &word, sizeof(value));
+        return value;
+    }
+}
@@ -0,0 +1,141 @@
+/* ---------------------------------------------------------------------------
+** CommandList.hpp
+** The calls made to a render device, stored one after another in an array
+** of words: a header (the command, its number of arguments and of data
+** blocks), the arguments, and every data block (its size in bytes and the
+** bytes, padded to words). The names of buffers, textures... are the ones
+** of the device that recorded them: replaying the list on another device
+** creates them again and translates every use to the new names.
+** Two lists are equal if they made the same calls with the same values, so
+** they can be compared (or printed and compared as text).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef COMMANDLIST_HEADER
+#define COMMANDLIST_HEADER
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+#include "RenderDevice.hpp"
+
+    namespace flygl
+    {
+        // One of the methods of a render device
+        enum RenderCommandType
+        {
+            COMMAND_CREATE_BUFFER,
+            COMMAND_DELETE_BUFFER,
+            COMMAND_SET_BUFFER_DATA,
+            COMMAND_UPDATE_BUFFER,
+            COMMAND_CREATE_TEXTURE_2D,
+            COMMAND_BIND_TEXTURE,
+            COMMAND_DELETE_TEXTURE,
+            COMMAND_CREATE_TEXTURE_ARRAY,
+            COMMAND_SET_COMPRESSED_LEVEL,
+            COMMAND_CREATE_BUFFER_TEXTURE,
+            COMMAND_CREATE_PROGRAM,
+            COMMAND_DELETE_PROGRAM,
+            COMMAND_USE_PROGRAM,
+            COMMAND_GET_UNIFORM_LOCATION,
+            COMMAND_SET_UNIFORM,
+            COMMAND_CREATE_FRAMEBUFFER,
+            COMMAND_DELETE_FRAMEBUFFER,
+            COMMAND_BIND_FRAMEBUFFER,
+            COMMAND_SET_VIEWPORT,
+            COMMAND_CLEAR,
+            COMMAND_SET_CLEAR_COLOR,
+            COMMAND_SET_CAPABILITY,
+            COMMAND_SET_DEPTH_FUNCTION,
+            COMMAND_SET_DEPTH_MASK,
+            COMMAND_SET_FRONT_FACE,
+            COMMAND_SET_BLEND_FUNCTION,
+            COMMAND_SET_POLYGON_OFFSET,
+            COMMAND_SET_COLOR_MASK,
+            COMMAND_CREATE_VERTEX_ARRAY,
+            COMMAND_BIND_VERTEX_ARRAY,
+            COMMAND_DELETE_VERTEX_ARRAY,
+            COMMAND_SET_VERTEX_ATTRIBUTE,
+            COMMAND_ENABLE_ATTRIBUTES,
+            COMMAND_DRAW_ARRAYS,
+            COMMAND_DRAW_ELEMENTS,
+            COMMAND_TYPE_COUNT
+        };
+
+        // A command read from a list (it points inside the list)
+        struct RenderCommand
+        {
+        public:
+
+            static const int MAX_DATA = 2;
+
+            RenderCommandType type;
+
+            const GLuint* arguments;
+            int           argumentCount;
+
+            const void* data    [MAX_DATA];
+            size_t      dataSize[MAX_DATA];
+            int         dataCount;
+        };
+
+        class CommandList
+        {
+        private:
+
+            std::vector<GLuint> words;
+            size_t              commandCount;
+
+            // Where the header of the command being written is
+            size_t currentHeader;
+
+        public:
+
+            // Constructor
+            CommandList(): commandCount(0), currentHeader(0)
+            {}
+
+            // Writing: Begin, the arguments, the data blocks
+            void Begin      (const RenderCommandType& type);
+            void AddArgument(const GLuint& argument);
+            void AddData    (const void* data, const size_t& size);
+
+            void Clear();
+
+            // Reads the command at a position, and returns the position of the next one
+            size_t Read(const size_t& position, RenderCommand& command) const;
+
+            void Replay(RenderDevice& device) const;
+            void Print (std::ostream& stream) const;
+
+            size_t GetCommandCount() const
+            {
+                return commandCount;
+            }
+
+            size_t GetSizeInBytes() const
+            {
+                return words.size() * sizeof(GLuint);
+            }
+
+            bool operator==(const CommandList& other) const
+            {
+                return words == other.words;
+            }
+
+            bool operator!=(const CommandList& other) const
+            {
+                return words != other.words;
+            }
+
+            static const char* GetName(const RenderCommandType& type);
+
+            // Float arguments are stored with their bits
+            static GLuint  ToWord (const GLfloat& value);
+            static GLfloat ToFloat(const GLuint&  word );
+        };
+    }
+
+#endif
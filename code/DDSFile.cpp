@@ -0,0 +1,197 @@
+/* ---------------------------------------------------------------------------
+** DDSFile.cpp
+** Reads and writes block compressed textures (with their mip chain) in a DDS
+** container, so they are compressed only once and then uploaded straight
+** away with glCompressedTexImage2D.
+** Supported blocks: DXT1 (BC1), DXT5 (BC3), ATI1 (BC4) and ATI2 (BC5).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "DDSFile.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace flygl
+{
+    // Size (in 32 bit words) of the DDS header, without the magic number
+    static const int DDS_HEADER_WORDS = 31;
+
+    // Some positions and flags of the header we need
+    static const int DDS_HEIGHT       = 2;
+    static const int DDS_WIDTH        = 3;
+    static const int DDS_LINEAR_SIZE  = 4;
+    static const int DDS_MIPMAP_COUNT = 6;
+    static const int DDS_PF_SIZE      = 18;
+    static const int DDS_PF_FLAGS     = 19;
+    static const int DDS_PF_FOURCC    = 20;
+    static const int DDS_CAPS         = 26;
+
+    static const unsigned int DDSD_DEFAULT    = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+    static const unsigned int DDPF_FOURCC     = 0x4;
+    static const unsigned int DDSCAPS_DEFAULT = 0x8 | 0x1000 | 0x400000;
+
+    // Reads the description of the image stored in a .dds file
+    //
+    // path     The path route of the file
+    // format   The block format
+    // width    Width of the first level
+    // height   Height of the first level
+    // levels   Number of levels stored
+    bool DDSFile::ReadHeader(const std::string& path, GLenum& format, int& width, int& height, int& levels)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        const bool success = ReadHeader(file, format, width, height, levels);
+
+        fclose(file);
+        return success;
+    }
+
+    // Loads a compressed image from a .dds file
+    //
+    // path         The path route of the file
+    // image        Where the levels are stored
+    // first_level  The first level to read, the bigger ones are skipped (used when streaming)
+    //
+    // Returns false if the file does not exist or has a format we don't know.
+    bool DDSFile::Load(const std::string& path, CompressedImage& image, const int& first_level)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        int width, height, count;
+        bool success = ReadHeader(file, image.format, width, height, count);
+
+        if(success)
+        {
+            const int first = std::min(std::max(0, first_level), count - 1);
+
+            image.levels.resize(count - first);
+
+            for(int i = 0; i < count && success; ++i)
+            {
+                const size_t level_size = TextureCompressor::GetLevelSize(image.format, width, height);
+
+                if(i < first)
+                {
+                    success = fseek(file, level_size, SEEK_CUR) == 0;
+                }
+                else
+                {
+                    CompressedImage::Level& level = image.levels[i - first];
+                    level.width  = width;
+                    level.height = height;
+                    level.data.resize(level_size);
+
+                    success = fread(&level.data[0], level.data.size(), 1, file) == 1;
+                }
+
+                width  = std::max(1, width  / 2);
+                height = std::max(1, height / 2);
+            }
+        }
+
+        fclose(file);
+        return success;
+    }
+
+    // Saves a compressed image into a .dds file
+    //
+    // path     The path route of the file
+    // image    The levels to save
+    bool DDSFile::Save(const std::string& path, const CompressedImage& image)
+    {
+        if(image.levels.empty())
+        {
+            return false;
+        }
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        unsigned int magic = FourCC('D', 'D', 'S', ' ');
+        unsigned int header[DDS_HEADER_WORDS];
+        memset(header, 0, sizeof(header));
+
+        header[0]                = DDS_HEADER_WORDS * 4;
+        header[1]                = DDSD_DEFAULT;
+        header[DDS_HEIGHT]       = image.levels[0].height;
+        header[DDS_WIDTH]        = image.levels[0].width;
+        header[DDS_LINEAR_SIZE]  = image.levels[0].data.size();
+        header[DDS_MIPMAP_COUNT] = image.levels.size();
+        header[DDS_PF_SIZE]      = 32;
+        header[DDS_PF_FLAGS]     = DDPF_FOURCC;
+        header[DDS_PF_FOURCC]    = FormatToFourCC(image.format);
+        header[DDS_CAPS]         = DDSCAPS_DEFAULT;
+
+        bool success = fwrite(&magic, sizeof(magic),  1, file) == 1 &&
+                       fwrite(header, sizeof(header), 1, file) == 1;
+
+        for(size_t i = 0; i < image.levels.size() && success; ++i)
+        {
+            success = fwrite(&image.levels[i].data[0], image.levels[i].data.size(), 1, file) == 1;
+        }
+
+        fclose(file);
+        return success;
+    }
+
+    // Reads the header of an opened file, leaving it just before the first level
+    bool DDSFile::ReadHeader(FILE* file, GLenum& format, int& width, int& height, int& levels)
+    {
+        unsigned int magic;
+        unsigned int header[DDS_HEADER_WORDS];
+
+        bool success = fread(&magic,  sizeof(magic),  1, file) == 1 &&
+                       fread(header,  sizeof(header), 1, file) == 1 &&
+                       magic  == FourCC('D', 'D', 'S', ' ') &&
+                       header[0] == DDS_HEADER_WORDS * 4 &&
+                       (header[DDS_PF_FLAGS] & DDPF_FOURCC) != 0;
+
+        if(success)
+        {
+            format  = FourCCToFormat(header[DDS_PF_FOURCC]);
+            width   = header[DDS_WIDTH ];
+            height  = header[DDS_HEIGHT];
+            levels  = std::max(1u, header[DDS_MIPMAP_COUNT]);
+            success = format != GL_NONE && width > 0 && height > 0;
+        }
+
+        return success;
+    }
+
+    unsigned int DDSFile::FormatToFourCC(const GLenum& format)
+    {
+        switch(format)
+        {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:  return FourCC('D', 'X', 'T', '1');
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return FourCC('D', 'X', 'T', '5');
+            case GL_COMPRESSED_RED_RGTC1:          return FourCC('A', 'T', 'I', '1');
+            case GL_COMPRESSED_RG_RGTC2:           return FourCC('A', 'T', 'I', '2');
+            default:                               return 0;
+        }
+    }
+
+    GLenum DDSFile::FourCCToFormat(const unsigned int& four_cc)
+    {
+        if(four_cc == FourCC('D', 'X', 'T', '1')) return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        if(four_cc == FourCC('D', 'X', 'T', '5')) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        if(four_cc == FourCC('A', 'T', 'I', '1')) return GL_COMPRESSED_RED_RGTC1;
+        if(four_cc == FourCC('B', 'C', '4', 'U')) return GL_COMPRESSED_RED_RGTC1;
+        if(four_cc == FourCC('A', 'T', 'I', '2')) return GL_COMPRESSED_RG_RGTC2;
+        if(four_cc == FourCC('B', 'C', '5', 'U')) return GL_COMPRESSED_RG_RGTC2;
+        return GL_NONE;
+    }
+}
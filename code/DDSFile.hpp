@@ -0,0 +1,45 @@
+/* ---------------------------------------------------------------------------
+** DDSFile.hpp
+** Reads and writes block compressed textures (with their mip chain) in a DDS
+** container, so they are compressed only once and then uploaded straight
+** away with glCompressedTexImage2D.
+** Supported blocks: DXT1 (BC1), DXT5 (BC3), ATI1 (BC4) and ATI2 (BC5).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef DDSFILE_HEADER
+#define DDSFILE_HEADER
+
+#include <string>
+#include <cstdio>
+
+#include "TextureCompressor.hpp"
+
+    namespace flygl
+    {
+        class DDSFile
+        {
+        public:
+
+            static bool Load(const std::string& path, CompressedImage& image, const int& first_level = 0);
+            static bool Save(const std::string& path, const CompressedImage& image);
+
+            static bool ReadHeader(const std::string& path, GLenum& format, int& width, int& height, int& levels);
+
+        private:
+
+            static bool ReadHeader(FILE* file, GLenum& format, int& width, int& height, int& levels);
+
+            static unsigned int FourCC(const char& a, const char& b, const char& c, const char& d)
+            {
+                return (unsigned int)(unsigned char)a       | (unsigned int)(unsigned char)b <<  8 |
+                       (unsigned int)(unsigned char)c << 16 | (unsigned int)(unsigned char)d << 24;
+            }
+
+            static unsigned int FormatToFourCC(const GLenum& format);
+            static GLenum       FourCCToFormat(const unsigned int& four_cc);
+        };
+    }
+
+#endif
@@ -0,0 +1,144 @@
+/* ---------------------------------------------------------------------------
+** DeferredRenderer.cpp
+** A deferred path, an alternative to drawing the meshes with their forward
+** shaders. The meshes are drawn first to a compact G-buffer (albedo with
+** shininess, octahedral normal, velocity and depth) with a shader shared by
+** all of them, and then a single screen pass lights every pixel with the
+** lights of its cluster (see LightClusters). This way the lighting costs the
+** same whatever the number of surfaces drawn on every pixel.
+** The lighting pass writes the color and the speed, as the forward shaders
+** do, so it can be drawn on the frame buffer of any post process. The
+** G-buffer is taken from the RenderTargetPool for the frame, and given back
+** once it is lit.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "DeferredRenderer.hpp"
+#include "Profiler.hpp"
+
+namespace flygl
+{
+    // Initializes the G-buffer and the lighting pass
+    //
+    // vertex_path      The vertex shader of the lighting pass
+    // fragment_path    The fragment shader of the lighting pass
+    // render_targets   The pool the G-buffer is taken from every frame
+    void DeferredRenderer::Initialize(
+        const std::string& vertex_path, const std::string& fragment_path,
+        RenderTargetPool& render_targets)
+    {
+        Postprocess::Initialize(vertex_path, fragment_path, render_targets);
+
+        depthTextureID      = postProcessShader.SetUniform("depthTexture"     );
+        inverseProjectionID = postProcessShader.SetUniform("inverseProjection");
+        viewMatrixID        = postProcessShader.SetUniform("viewMatrix"       );
+        clusterGridID       = postProcessShader.SetUniform("clusterGrid"      );
+        clusterScaleID      = postProcessShader.SetUniform("clusterScale"     );
+        clusterDepthID      = postProcessShader.SetUniform("clusterDepth"     );
+
+        postProcessShader.UseThisShader();
+        LightClusters::SetSamplers(postProcessShader.GetProgram());
+    }
+
+    // Loads the shader that draws the meshes to the G-buffer. The textures
+    // are on the units of their usage (see Mesh::DrawGeometry).
+    //
+    // vertex_path      The vertex shader of the meshes
+    // fragment_path    The fragment shader that writes the G-buffer
+    void DeferredRenderer::InitializeGeometry(const std::string& vertex_path, const std::string& fragment_path)
+    {
+        geometryShader.LoadVertexShader  (vertex_path  );
+        geometryShader.LoadFragmentShader(fragment_path);
+        geometryShader.CompileShaders();
+        geometryShader.UseThisShader ();
+
+        const GLint units[3] = { DIFFUSE_TEXTURE, SPECULAR_TEXTURE, NORMAL_TEXTURE };
+
+        RenderDevice& device = RenderDevice::Get();
+        device.SetUniform(geometryShader.SetUniform("diffuseSampler" ), UNIFORM_INT, 1, &units[0]);
+        device.SetUniform(geometryShader.SetUniform("specularSampler"), UNIFORM_INT, 1, &units[1]);
+        device.SetUniform(geometryShader.SetUniform("normalSampler"  ), UNIFORM_INT, 1, &units[2]);
+
+        geometryUniforms.textureLayersID = geometryShader.SetUniform("textureLayers");
+        geometryUniforms.matrixID        = geometryShader.SetUniform("MVP"          );
+        geometryUniforms.viewMatrixID    = geometryShader.SetUniform("viewMatrix"   );
+        geometryUniforms.modelMatrixID   = geometryShader.SetUniform("modelMatrix"  );
+        geometryUniforms.modelView3x3ID  = geometryShader.SetUniform("modelView3x3" );
+        geometryUniforms.oldMVP_ID       = geometryShader.SetUniform("oldMVP"       );
+    }
+
+    // Draws the meshes to the G-buffer (and the shared depth)
+    void DeferredRenderer::DrawGeometry(const std::vector<Mesh*>& meshes, const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
+    {
+        FLYGL_PROFILE_ZONE("DeferredRenderer::DrawGeometry");
+
+        PreProcess();
+        RenderDevice::Get().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        geometryShader.UseThisShader();
+
+        for(size_t i = 0; i < meshes.size(); ++i)
+        {
+            meshes[i]->DrawGeometry(projection_matrix, view_matrix, geometryUniforms);
+        }
+    }
+
+    // Lights the G-buffer on the frame buffer that is bound (the screen, or
+    // the one of a post process, without the depth that is being read) and
+    // gives the G-buffer back to the pool
+    //
+    // projection_matrix    The projection the G-buffer was drawn with
+    // view_matrix          The camera the G-buffer was drawn with
+    // clusters             The lights of every cluster, already bound
+    void DeferredRenderer::DrawLighting(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightClusters& clusters)
+    {
+        FLYGL_PROFILE_ZONE("DeferredRenderer::DrawLighting");
+
+        inverseProjection = glm::inverse(projection_matrix);
+        viewMatrix        = view_matrix;
+        lightClusters     = &clusters;
+
+        RenderDevice::Get().SetCapability(GL_DEPTH_TEST, false);
+        RenderQuad();
+        RenderDevice::Get().SetCapability(GL_DEPTH_TEST, true);
+
+        ReleaseTargets();
+    }
+
+    // The G-buffer targets: albedo + shininess, normal and velocity
+    void DeferredRenderer::InitializeTargetsSection()
+    {
+        AddTarget(GL_RGBA8, "albedoTexture"  );
+        AddTarget(GL_RG16F, "normalTexture"  );
+        AddTarget(GL_RG16F, "velocityTexture");
+    }
+
+    // Every target of the G-buffer, and the depth after them
+    void DeferredRenderer::RenderTextures()
+    {
+        Postprocess::RenderTextures();
+
+        const GLint depth_unit = targets.size();
+
+        RenderDevice& device = RenderDevice::Get();
+        device.BindTexture(depth_unit, GL_TEXTURE_2D, renderTargets->GetDepthTexture());
+        device.SetUniform (depthTextureID, UNIFORM_INT, 1, &depth_unit);
+    }
+
+    // The camera and the clusters
+    void DeferredRenderer::RenderUniforms()
+    {
+        Postprocess::RenderUniforms();
+
+        const GLint grid[3] = { LightClusters::GRID_X, LightClusters::GRID_Y, LightClusters::GRID_Z };
+
+        RenderDevice& device = RenderDevice::Get();
+        device.SetUniform(inverseProjectionID, UNIFORM_MAT4,  1, &inverseProjection[0][0]);
+        device.SetUniform(viewMatrixID,        UNIFORM_MAT4,  1, &viewMatrix[0][0]       );
+
+        device.SetUniform(clusterGridID,  UNIFORM_IVEC3, 1, grid                                   );
+        device.SetUniform(clusterScaleID, UNIFORM_VEC2,  1, &lightClusters->GetScale()[0]          );
+        device.SetUniform(clusterDepthID, UNIFORM_VEC2,  1, &lightClusters->GetDepthParameters()[0]);
+    }
+}
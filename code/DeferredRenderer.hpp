@@ -0,0 +1,74 @@
+/* ---------------------------------------------------------------------------
+** DeferredRenderer.hpp
+** A deferred path, an alternative to drawing the meshes with their forward
+** shaders. The meshes are drawn first to a compact G-buffer (albedo with
+** shininess, octahedral normal, velocity and depth) with a shader shared by
+** all of them, and then a single screen pass lights every pixel with the
+** lights of its cluster (see LightClusters). This way the lighting costs the
+** same whatever the number of surfaces drawn on every pixel.
+** The lighting pass writes the color and the speed, as the forward shaders
+** do, so it can be drawn on the frame buffer of any post process. The
+** G-buffer is taken from the RenderTargetPool for the frame, and given back
+** once it is lit.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef DEFERREDRENDERER_HEADER
+#define DEFERREDRENDERER_HEADER
+
+#include "Postprocess.hpp"
+#include "Mesh.hpp"
+#include "LightClusters.hpp"
+
+    namespace flygl
+    {
+        class DeferredRenderer : public Postprocess
+        {
+        protected:
+
+            // The G-buffer are the targets (albedo with the shininess, normal
+            // and velocity) and the shared depth of the pool
+            GLuint depthTextureID;
+
+            // Geometry pass
+            ShaderManager    geometryShader;
+            GeometryUniforms geometryUniforms;
+
+            // Lighting pass uniforms
+            GLuint inverseProjectionID;
+            GLuint viewMatrixID;
+            GLuint clusterGridID;
+            GLuint clusterScaleID;
+            GLuint clusterDepthID;
+
+            // What the lighting pass needs of this frame
+            glm::mat4            inverseProjection;
+            glm::mat4            viewMatrix;
+            const LightClusters* lightClusters;
+
+        public:
+
+			//Constructor
+			DeferredRenderer(): Postprocess(), lightClusters(NULL)
+			{
+			}
+
+            virtual void Initialize(
+                const std::string& vertex_path, const std::string& fragment_path, 
+                RenderTargetPool& render_targets);
+
+            void InitializeGeometry(const std::string& vertex_path, const std::string& fragment_path);
+
+            void DrawGeometry(const std::vector<Mesh*>& meshes, const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
+            void DrawLighting(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightClusters& clusters);
+
+        protected:
+
+            virtual void InitializeTargetsSection();
+            virtual void RenderTextures          ();
+            virtual void RenderUniforms          ();
+        };
+    }
+
+#endif
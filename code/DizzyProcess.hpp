@@ -1,6 +1,8 @@
 /* ---------------------------------------------------------------------------
 ** DizzyProcess.hpp
 ** Doubles the screen and mixes it in a radius.
+** It is a sampling function (dizzyEffect.glsl), so the point effects after
+** it are drawn in the same pass.
 **
 ** Author: Fly - Ruben Negredo
 ** -------------------------------------------------------------------------*/
@@ -8,70 +10,37 @@
 #ifndef DIZZYPROCESS_HEADER
 #define DIZZYPROCESS_HEADER
 
-#include "Postprocess.hpp"
+#include "FusedPass.hpp"
 
     namespace flygl
     {
-        class DizzyProcess : public Postprocess
+        class DizzyProcess : public FusableEffect
         {
         protected:
-            GLuint deltaTimeID;
-            GLuint radiusID;
-            GLuint viewHeightID;
-
             GLfloat deltaTime;
             GLfloat radius;
-            GLuint viewHeight;
 
         public:
 
 			//Constructor
-			DizzyProcess(): Postprocess()
+			DizzyProcess(): FusableEffect("Dizzy", SAMPLING_OPERATION), deltaTime(0.0f), radius(10.0f)
 			{
 			}
 
-            ~DizzyProcess()
-            {
-                Postprocess::~Postprocess();
-            }
-
             void Update(const float& delta_time)
             {
                 deltaTime += delta_time;
             }
 
-            virtual void Initialize(
-                const std::string& vertex_path, const std::string& fragment_path, 
-                const int& screenWidth,         const int& screenHeight)
-            {
-                Postprocess::Initialize(vertex_path, fragment_path, screenWidth, screenHeight);
-                
-                deltaTime = 0.0f;
-                radius    = 10.0f;
-                viewHeight = screenHeight;
-
-                deltaTimeID  = postProcessShader.SetUniform("deltaTime");
-                radiusID     = postProcessShader.SetUniform("radius");
-                viewHeightID = postProcessShader.SetUniform("viewHeight");
-            }
-
-            // Get the new height value
-            virtual void Resize(const int& screenWidth, const int& screenHeight)
-            {
-                Postprocess::Resize(screenWidth, screenHeight);
-                viewHeight = screenHeight;
-            }
-
-        protected:
-
             // Render the Uniforms
-            virtual void RenderUniforms()
+            virtual void SetUniforms(FusedPass& pass)
             {
-                Postprocess::RenderUniforms();
+                const GLint view_height = renderTargets->GetScreenHeight();
 
-                glUniform1f(deltaTimeID, deltaTime);
-                glUniform1f(radiusID, radius);
-                glUniform1i(viewHeightID, viewHeight);
+                RenderDevice& device = RenderDevice::Get();
+                device.SetUniform(pass.GetUniform("dizzyTime"      ), UNIFORM_FLOAT, 1, &deltaTime  );
+                device.SetUniform(pass.GetUniform("dizzyRadius"    ), UNIFORM_FLOAT, 1, &radius     );
+                device.SetUniform(pass.GetUniform("dizzyViewHeight"), UNIFORM_INT,   1, &view_height);
             }
         };
     }
@@ -0,0 +1,79 @@
+/* ---------------------------------------------------------------------------
+** FusableEffect.hpp
+** An effect that doesn't have its own shader, only a GLSL function (read
+** from a file) that the PostprocessChain puts together with the functions of
+** the effects next to it in a single generated pass (see FusedPass). Point
+** effects get the color of their pixel and return the new one:
+**      vec3 Name(vec3 color, vec2 uv)
+** and sampling effects read the image wherever they want, so they can only
+** be the first of a fused pass:
+**      vec3 Name(sampler2D image, vec2 uv)
+** The uniforms of the function must have names no other effect uses.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef FUSABLEEFFECT_HEADER
+#define FUSABLEEFFECT_HEADER
+
+#include "Postprocess.hpp"
+#include <fstream>
+#include <iterator>
+
+    namespace flygl
+    {
+        class FusedPass;
+
+        class FusableEffect : public Postprocess
+        {
+        protected:
+
+            PostprocessOperation operation;
+
+            // The GLSL function
+            std::string functionName;
+            std::string functionCode;
+
+        public:
+
+			//Constructor
+			FusableEffect(const std::string& function_name, const PostprocessOperation& effect_operation):
+                Postprocess(), operation(effect_operation), functionName(function_name)
+			{
+			}
+
+            // Reads the function. There is nothing to compile, the chain
+            // does it when the effect is fused with the others
+            //
+            // function_path    The file with the GLSL function
+            // render_targets   The pool of the chain
+            void Initialize(const std::string& function_path, RenderTargetPool& render_targets)
+            {
+                renderTargets = &render_targets;
+
+                std::ifstream infile(function_path.c_str());
+                functionCode.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+            }
+
+            virtual PostprocessOperation GetOperation() const
+            {
+                return operation;
+            }
+
+            const std::string& GetFunctionName() const
+            {
+                return functionName;
+            }
+
+            const std::string& GetFunctionCode() const
+            {
+                return functionCode;
+            }
+
+            // Sets the uniforms of the function on the fused pass that draws it
+            virtual void SetUniforms(FusedPass&)
+            {}
+        };
+    }
+
+#endif
@@ -0,0 +1,90 @@
+/* ---------------------------------------------------------------------------
+** FusedPass.cpp
+** A pass generated by the PostprocessChain for some consecutive effects
+** that only have a GLSL function (see FusableEffect). Its fragment shader
+** calls every function in order, so N effects cost a single read and write
+** of the screen instead of N. The chain keeps every generated pass, they are
+** only compiled the first time that group of effects is enabled.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "FusedPass.hpp"
+
+namespace flygl
+{
+    // Generates the shader of the effects and compiles it
+    //
+    // fused_effects    The effects, in order (only the first one can be a sampling one)
+    // vertex_path      The vertex shader of the screen quad
+    // render_targets   The pool the targets are taken from every frame
+    void FusedPass::Initialize(
+        const std::vector<FusableEffect*>& fused_effects, const std::string& vertex_path,
+        RenderTargetPool& render_targets)
+    {
+        effects = fused_effects;
+
+        postProcessShader.LoadVertexShader     (vertex_path);
+        postProcessShader.SetFragmentShaderCode(GenerateFragmentCode(effects));
+
+        InitializeProgram(render_targets);
+    }
+
+    // Returns the ID of a uniform of the effects (it is only asked to GL once)
+    GLuint FusedPass::GetUniform(const std::string& name)
+    {
+        std::map<std::string, GLuint>::const_iterator found = uniforms.find(name);
+
+        if(found != uniforms.end())
+        {
+            return found->second;
+        }
+
+        const GLuint id = postProcessShader.SetUniform(name);
+        uniforms[name]  = id;
+        return id;
+    }
+
+    // The fragment shader: the functions of the effects and a main that
+    // reads the pixel (or lets the first effect read it) and calls them in order
+    std::string FusedPass::GenerateFragmentCode(const std::vector<FusableEffect*>& fused_effects)
+    {
+        std::string code =
+            "#version 330\n"
+            "\n"
+            "in vec2 Texcoord;\n"
+            "out vec4 outColor;\n"
+            "\n"
+            "uniform sampler2D colorTexture;\n"
+            "\n";
+
+        for(size_t i = 0; i < fused_effects.size(); ++i)
+        {
+            code += fused_effects[i]->GetFunctionCode();
+            code += "\n\n";
+        }
+
+        code += "void main()\n{\n";
+
+        size_t first_point = 0;
+
+        if(!fused_effects.empty() && fused_effects[0]->GetOperation() == SAMPLING_OPERATION)
+        {
+            code += "    vec3 color = " + fused_effects[0]->GetFunctionName() + "(colorTexture, Texcoord);\n";
+            first_point = 1;
+        }
+        else
+        {
+            code += "    vec3 color = texture(colorTexture, Texcoord).rgb;\n";
+        }
+
+        for(size_t i = first_point; i < fused_effects.size(); ++i)
+        {
+            code += "    color = " + fused_effects[i]->GetFunctionName() + "(color, Texcoord);\n";
+        }
+
+        code += "    outColor = vec4(color, 1.0);\n}\n";
+
+        return code;
+    }
+}
@@ -0,0 +1,69 @@
+/* ---------------------------------------------------------------------------
+** FusedPass.hpp
+** A pass generated by the PostprocessChain for some consecutive effects
+** that only have a GLSL function (see FusableEffect). Its fragment shader
+** calls every function in order, so N effects cost a single read and write
+** of the screen instead of N. The chain keeps every generated pass, they are
+** only compiled the first time that group of effects is enabled.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef FUSEDPASS_HEADER
+#define FUSEDPASS_HEADER
+
+#include "FusableEffect.hpp"
+#include <map>
+
+    namespace flygl
+    {
+        class FusedPass : public Postprocess
+        {
+        protected:
+
+            // The effects, in order
+            std::vector<FusableEffect*> effects;
+
+            // The uniforms of the effects, by name
+            std::map<std::string, GLuint> uniforms;
+
+        public:
+
+			//Constructor
+			FusedPass(): Postprocess()
+			{
+			}
+
+            void Initialize(
+                const std::vector<FusableEffect*>& fused_effects, const std::string& vertex_path,
+                RenderTargetPool& render_targets);
+
+            GLuint GetUniform(const std::string& name);
+
+            // The effects it draws
+            const std::vector<FusableEffect*>& GetEffects() const
+            {
+                return effects;
+            }
+
+            virtual const char* GetName() const
+            {
+                return "FusedPass";
+            }
+
+            static std::string GenerateFragmentCode(const std::vector<FusableEffect*>& fused_effects);
+
+        protected:
+
+            // Every effect sets its own uniforms
+            virtual void RenderUniforms()
+            {
+                for(size_t i = 0; i < effects.size(); ++i)
+                {
+                    effects[i]->SetUniforms(*this);
+                }
+            }
+        };
+    }
+
+#endif
@@ -0,0 +1,491 @@
+/* ---------------------------------------------------------------------------
+** GLRenderDevice.cpp
+** The render device that calls OpenGL.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "GLRenderDevice.hpp"
+
+#include <cassert>
+#include <iostream>
+
+#ifdef _MSC_VER
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+
+namespace flygl
+{
+    // Creates a buffer with the given data
+    //
+    // target   GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER...
+    // data     What it has, NULL to leave it undefined
+    // size     Bytes of the data
+    // usage    GL_STATIC_DRAW, GL_DYNAMIC_DRAW...
+    GLuint GLRenderDevice::CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferData(target, size, data, usage);
+
+        return buffer;
+    }
+
+    void GLRenderDevice::DeleteBuffer(const GLuint& buffer)
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+
+    // Gives the buffer a new size (and data)
+    //
+    // buffer   The buffer
+    // target   Where it is bound to do it
+    // data     What it has, NULL to leave it undefined
+    // size     Bytes of the data
+    // usage    GL_STATIC_DRAW, GL_DYNAMIC_DRAW...
+    void GLRenderDevice::SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        glBindBuffer(target, buffer);
+        glBufferData(target, size, data, usage);
+    }
+
+    // Writes a part of the buffer
+    //
+    // buffer   The buffer
+    // target   Where it is bound to do it
+    // offset   First byte written
+    // data     What is written
+    // size     Bytes of the data
+    void GLRenderDevice::UpdateBuffer(const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size)
+    {
+        glBindBuffer   (target, buffer);
+        glBufferSubData(target, offset, size, data);
+    }
+
+    // Creates a 2D texture without data (a render target), clamped to its edges
+    //
+    // internal_format  Sized format (GL_RGB8, GL_RG16F, GL_DEPTH24_STENCIL8...)
+    // width            Size in pixels
+    // height
+    // filter           GL_LINEAR or GL_NEAREST
+    GLuint GLRenderDevice::CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter)
+    {
+        GLenum format, type;
+        GetFormat(internal_format, format, type);
+
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D (GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, NULL);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter          );
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter          );
+
+        return texture;
+    }
+
+    // Binds a texture to a unit (0, 1, 2...)
+    void GLRenderDevice::BindTexture(const GLuint& unit, const GLenum& target, const GLuint& texture)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture  (target, texture);
+    }
+
+    void GLRenderDevice::DeleteTexture(const GLuint& texture)
+    {
+        glDeleteTextures(1, &texture);
+    }
+
+    // Creates an empty texture array, repeated and with trilinear filtering.
+    // It is left bound on the active unit, so it can be filled directly.
+    GLuint GLRenderDevice::CreateTextureArray()
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S,     GL_REPEAT              );
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T,     GL_REPEAT              );
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR              );
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+        return texture;
+    }
+
+    // Uploads a block compressed level of a texture array. The levels are
+    // given from the biggest one, the last one given is the smallest used.
+    //
+    // texture          The texture array
+    // level            The level (0 is the biggest one)
+    // internal_format  GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RED_RGTC1...
+    // width            Size of the level in pixels
+    // height
+    // layers           Number of layers
+    // data             Every layer of the level, one after another
+    // size             Bytes of the data
+    void GLRenderDevice::SetCompressedLevel(const GLuint& texture, const int& level, const GLenum& internal_format,
+                                            const int& width, const int& height, const int& layers,
+                                            const void* data, const size_t& size)
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internal_format, width, height, layers, 0, size, data);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL,  level);
+    }
+
+    // Creates a texture that reads a buffer
+    //
+    // buffer           The buffer
+    // internal_format  How its texels are read (GL_RGBA32F, GL_R32UI...)
+    GLuint GLRenderDevice::CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer  (GL_TEXTURE_BUFFER, internal_format, buffer);
+
+        return texture;
+    }
+
+    // Compiles and links the shaders, checking for errors
+    //
+    // vertex_code      The code of the vertex shader
+    // fragment_code    The code of the fragment shader
+    GLuint GLRenderDevice::CreateProgram(const std::string& vertex_code, const std::string& fragment_code)
+    {
+        GLuint   vertex_shader_id = CompileShader(GL_VERTEX_SHADER,   vertex_code  );
+        GLuint fragment_shader_id = CompileShader(GL_FRAGMENT_SHADER, fragment_code);
+
+        // Create the program and link the shaders
+        GLuint program_id = glCreateProgram();
+
+        glAttachShader(program_id,   vertex_shader_id);
+        glAttachShader(program_id, fragment_shader_id);
+        glLinkProgram (program_id);
+
+        GLint succeeded = GL_FALSE;
+        glGetProgramiv(program_id, GL_LINK_STATUS, &succeeded);
+        if (!succeeded)
+        {
+            ShowLinkageError(program_id);
+        }
+
+        // Free the shaders
+        glDeleteShader(  vertex_shader_id);
+        glDeleteShader(fragment_shader_id);
+
+        return program_id;
+    }
+
+    void GLRenderDevice::DeleteProgram(const GLuint& program)
+    {
+        glDeleteProgram(program);
+    }
+
+    void GLRenderDevice::UseProgram(const GLuint& program)
+    {
+        glUseProgram(program);
+    }
+
+    GLint GLRenderDevice::GetUniformLocation(const GLuint& program, const std::string& name)
+    {
+        return glGetUniformLocation(program, name.c_str());
+    }
+
+    // Sets a uniform of the program in use
+    //
+    // location The uniform
+    // type     What every value is
+    // count    How many values there are (an array)
+    // values   The values, GLint or GLfloat
+    void GLRenderDevice::SetUniform(const GLint& location, const UniformType& type, const int& count, const void* values)
+    {
+        const GLint*   ints   = (const GLint*  )values;
+        const GLfloat* floats = (const GLfloat*)values;
+
+        switch(type)
+        {
+            case UNIFORM_INT:   glUniform1iv      (location, count, ints);             break;
+            case UNIFORM_IVEC3: glUniform3iv      (location, count, ints);             break;
+            case UNIFORM_FLOAT: glUniform1fv      (location, count, floats);           break;
+            case UNIFORM_VEC2:  glUniform2fv      (location, count, floats);           break;
+            case UNIFORM_VEC3:  glUniform3fv      (location, count, floats);           break;
+            case UNIFORM_VEC4:  glUniform4fv      (location, count, floats);           break;
+            case UNIFORM_MAT3:  glUniformMatrix3fv(location, count, GL_FALSE, floats); break;
+            case UNIFORM_MAT4:  glUniformMatrix4fv(location, count, GL_FALSE, floats); break;
+        }
+    }
+
+    // Creates a frame buffer with the given textures attached (on
+    // GL_COLOR_ATTACHMENT0, 1... and the depth and stencil)
+    //
+    // color_textures   The color textures
+    // count            Number of color textures
+    // depth_texture    A GL_DEPTH24_STENCIL8 texture, 0 for none
+    GLuint GLRenderDevice::CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture)
+    {
+        GLuint framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+        for(int i = 0; i < count; ++i)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, color_textures[i], 0);
+        }
+
+        if(depth_texture != 0)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth_texture, 0);
+        }
+
+        return framebuffer;
+    }
+
+    void GLRenderDevice::DeleteFramebuffer(const GLuint& framebuffer)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+
+    // Binds a frame buffer (0 for the screen)
+    //
+    // framebuffer  The frame buffer
+    // draw_buffers Its first attachments that are drawn (ignored for the screen)
+    void GLRenderDevice::BindFramebuffer(const GLuint& framebuffer, const int& draw_buffers)
+    {
+        static const GLenum DRAWING_BUFFERS[] =
+        {
+            GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3,
+            GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7
+        };
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+        if(framebuffer != 0)
+        {
+            glDrawBuffers(draw_buffers, DRAWING_BUFFERS);
+        }
+    }
+
+    void GLRenderDevice::SetViewport(const int& x, const int& y, const int& width, const int& height)
+    {
+        glViewport(x, y, width, height);
+    }
+
+    void GLRenderDevice::Clear(const GLbitfield& mask)
+    {
+        glClear(mask);
+    }
+
+    void GLRenderDevice::SetClearColor(const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha)
+    {
+        glClearColor(red, green, blue, alpha);
+    }
+
+    void GLRenderDevice::SetCapability(const GLenum& capability, const bool& enabled)
+    {
+        if(enabled)
+        {
+            glEnable(capability);
+        }
+        else
+        {
+            glDisable(capability);
+        }
+    }
+
+    void GLRenderDevice::SetDepthFunction(const GLenum& function)
+    {
+        glDepthFunc(function);
+    }
+
+    void GLRenderDevice::SetDepthMask(const bool& write)
+    {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void GLRenderDevice::SetFrontFace(const GLenum& mode)
+    {
+        glFrontFace(mode);
+    }
+
+    void GLRenderDevice::SetBlendFunction(const GLenum& source, const GLenum& destination)
+    {
+        glBlendFunc(source, destination);
+    }
+
+    void GLRenderDevice::SetPolygonOffset(const GLfloat& factor, const GLfloat& units)
+    {
+        glPolygonOffset(factor, units);
+    }
+
+    // Lets the draws write on a color attachment or not
+    void GLRenderDevice::SetColorMask(const GLuint& attachment, const bool& write)
+    {
+        const GLboolean mask = write ? GL_TRUE : GL_FALSE;
+        glColorMaski(attachment, mask, mask, mask, mask);
+    }
+
+    GLuint GLRenderDevice::CreateVertexArray()
+    {
+        GLuint vertex_array;
+        glGenVertexArrays(1, &vertex_array);
+        return vertex_array;
+    }
+
+    void GLRenderDevice::BindVertexArray(const GLuint& vertex_array)
+    {
+        glBindVertexArray(vertex_array);
+    }
+
+    void GLRenderDevice::DeleteVertexArray(const GLuint& vertex_array)
+    {
+        glDeleteVertexArrays(1, &vertex_array);
+    }
+
+    // The attribute is read from the buffer, tightly packed
+    //
+    // index        The attribute (its layout location)
+    // buffer       The buffer it is read from
+    // components   Values of every vertex (1 to 4)
+    // type         GL_FLOAT...
+    void GLRenderDevice::SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type)
+    {
+        glBindBuffer         (GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(index, components, type, GL_FALSE, 0, (void*)0);
+    }
+
+    // Enables or disables the first attributes
+    void GLRenderDevice::EnableAttributes(const GLuint& count, const bool& enabled)
+    {
+        for(GLuint i = 0; i < count; ++i)
+        {
+            if(enabled)
+            {
+                glEnableVertexAttribArray(i);
+            }
+            else
+            {
+                glDisableVertexAttribArray(i);
+            }
+        }
+    }
+
+    void GLRenderDevice::DrawArrays(const GLenum& mode, const int& first, const int& count)
+    {
+        glDrawArrays(mode, first, count);
+    }
+
+    // Draws with the indices of a buffer
+    //
+    // mode         GL_TRIANGLES...
+    // index_buffer The buffer with the indices
+    // count        Number of indices
+    // type         GL_UNSIGNED_SHORT, GL_UNSIGNED_INT
+    void GLRenderDevice::DrawElements(const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type)
+    {
+        glBindBuffer  (GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+        glDrawElements(mode, count, type, (void*)0);
+    }
+
+    // Reads the screen as RGB bytes, from its bottom row
+    //
+    // width    Size of the screen in pixels
+    // height
+    // pixels   Where they are written (width * height * 3 bytes)
+    void GLRenderDevice::ReadScreen(const int& width, const int& height, unsigned char* pixels)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glPixelStorei    (GL_PACK_ALIGNMENT, 1);
+        glReadPixels     (0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    // The pixel format and type that go with a sized format (the textures
+    // are created without data, but GL wants a valid pair)
+    void GLRenderDevice::GetFormat(const GLenum& internal_format, GLenum& format, GLenum& type)
+    {
+        switch(internal_format)
+        {
+            case GL_R8:                 format = GL_RED;  type = GL_UNSIGNED_BYTE; break;
+            case GL_RG8:                format = GL_RG;   type = GL_UNSIGNED_BYTE; break;
+            case GL_RGB8:               format = GL_RGB;  type = GL_UNSIGNED_BYTE; break;
+            case GL_R16F:
+            case GL_R32F:               format = GL_RED;  type = GL_FLOAT;         break;
+            case GL_RG16F:
+            case GL_RG32F:              format = GL_RG;   type = GL_FLOAT;         break;
+            case GL_R11F_G11F_B10F:     format = GL_RGB;  type = GL_FLOAT;         break;
+            case GL_RGBA16F:
+            case GL_RGBA32F:            format = GL_RGBA; type = GL_FLOAT;         break;
+            case GL_DEPTH24_STENCIL8:   format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; break;
+            default:                    format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+        }
+    }
+
+    // Creates and compiles a shader, showing its errors
+    GLuint GLRenderDevice::CompileShader(const GLenum& shader_type, const std::string& code)
+    {
+        GLuint shader_id = glCreateShader(shader_type);
+
+        const char* shader_code[] = { code.c_str() };
+        const GLint shader_size[] = { (GLint)code.size() };
+
+        glShaderSource (shader_id, 1, shader_code, shader_size);
+        glCompileShader(shader_id);
+
+        GLint succeeded = GL_FALSE;
+        glGetShaderiv(shader_id, GL_COMPILE_STATUS, &succeeded);
+        if (!succeeded)
+        {
+            ShowCompilationError(shader_id);
+        }
+
+        return shader_id;
+    }
+
+    //Shows an error log
+    void GLRenderDevice::ShowCompilationError(const GLuint& shader_id)
+    {
+        std::string info_log;
+        GLint  info_log_length;
+
+        glGetShaderiv (shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
+
+        info_log.resize (info_log_length);
+
+        glGetShaderInfoLog (shader_id, info_log_length, NULL, &info_log.front ());
+
+        std::cerr << info_log.c_str () << std::endl;
+
+        #ifdef _MSC_VER
+            OutputDebugStringA (info_log.c_str ());
+        #endif
+
+        assert(false);
+    }
+
+    //Shows an error log
+    void GLRenderDevice::ShowLinkageError(const GLuint& program_id)
+    {
+        std::string info_log;
+        GLint  info_log_length;
+
+        glGetProgramiv (program_id, GL_INFO_LOG_LENGTH, &info_log_length);
+
+        info_log.resize (info_log_length);
+
+        glGetProgramInfoLog (program_id, info_log_length, NULL, &info_log.front ());
+
+        std::cerr << info_log.c_str () << std::endl;
+
+        #ifdef _MSC_VER
+            OutputDebugStringA (info_log.c_str ());
+        #endif
+
+        assert(false);
+    }
+}
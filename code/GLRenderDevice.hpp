@@ -0,0 +1,77 @@
+/* ---------------------------------------------------------------------------
+** GLRenderDevice.hpp
+** The render device that calls OpenGL, what the engine did directly before.
+** The names it returns are the GL names.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef GLRENDERDEVICE_HEADER
+#define GLRENDERDEVICE_HEADER
+
+#include "RenderDevice.hpp"
+
+    namespace flygl
+    {
+        class GLRenderDevice: public RenderDevice
+        {
+        public:
+
+            GLuint CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   DeleteBuffer(const GLuint& buffer);
+            void   SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   UpdateBuffer (const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size);
+
+            GLuint CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter);
+            void   BindTexture    (const GLuint& unit, const GLenum& target, const GLuint& texture);
+            void   DeleteTexture  (const GLuint& texture);
+
+            GLuint CreateTextureArray ();
+            void   SetCompressedLevel (const GLuint& texture, const int& level, const GLenum& internal_format,
+                                       const int& width, const int& height, const int& layers,
+                                       const void* data, const size_t& size);
+            GLuint CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format);
+
+            GLuint CreateProgram     (const std::string& vertex_code, const std::string& fragment_code);
+            void   DeleteProgram     (const GLuint& program);
+            void   UseProgram        (const GLuint& program);
+            GLint  GetUniformLocation(const GLuint& program, const std::string& name);
+            void   SetUniform        (const GLint& location, const UniformType& type, const int& count, const void* values);
+
+            GLuint CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture);
+            void   DeleteFramebuffer(const GLuint& framebuffer);
+            void   BindFramebuffer  (const GLuint& framebuffer, const int& draw_buffers);
+            void   SetViewport      (const int& x, const int& y, const int& width, const int& height);
+            void   Clear            (const GLbitfield& mask);
+            void   SetClearColor    (const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha);
+
+            void SetCapability    (const GLenum& capability, const bool& enabled);
+            void SetDepthFunction (const GLenum& function);
+            void SetDepthMask     (const bool& write);
+            void SetFrontFace     (const GLenum& mode);
+            void SetBlendFunction (const GLenum& source, const GLenum& destination);
+            void SetPolygonOffset (const GLfloat& factor, const GLfloat& units);
+            void SetColorMask     (const GLuint& attachment, const bool& write);
+
+            GLuint CreateVertexArray();
+            void   BindVertexArray  (const GLuint& vertex_array);
+            void   DeleteVertexArray(const GLuint& vertex_array);
+
+            void SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type);
+            void EnableAttributes  (const GLuint& count, const bool& enabled);
+            void DrawArrays        (const GLenum& mode, const int& first, const int& count);
+            void DrawElements      (const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type);
+
+            void ReadScreen(const int& width, const int& height, unsigned char* pixels);
+
+            static void GetFormat(const GLenum& internal_format, GLenum& format, GLenum& type);
+
+        private:
+
+            static GLuint CompileShader       (const GLenum& shader_type, const std::string& code);
+            static void   ShowCompilationError(const GLuint& shader_id );
+            static void   ShowLinkageError    (const GLuint& program_id);
+        };
+    }
+
+#endif
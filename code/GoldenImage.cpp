@@ -0,0 +1,198 @@
+/* ---------------------------------------------------------------------------
+** GoldenImage.cpp
+** Reads, saves and compares the images of the golden tests.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "GoldenImage.hpp"
+#include "RenderDevice.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+namespace flygl
+{
+    // The screen is read from the bottom, the image starts at the top
+    //
+    // screen_width     Size of the screen in pixels
+    // screen_height
+    void GoldenImage::ReadScreen(const int& screen_width, const int& screen_height)
+    {
+        width  = screen_width;
+        height = screen_height;
+
+        std::vector<unsigned char> screen(width * height * 3);
+        RenderDevice::Get().ReadScreen(width, height, &screen[0]);
+
+        pixels.resize(screen.size());
+        for(int y = 0; y < height; ++y)
+        {
+            std::copy(screen.begin() + (height - 1 - y) * width * 3, screen.begin() + (height - y) * width * 3,
+                      pixels.begin() + y * width * 3);
+        }
+    }
+
+    // Reads a binary PPM with 8 bits per channel
+    bool GoldenImage::Load(const std::string& path)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        int max_value = 0;
+        const bool is_valid = fscanf(file, "P6 %d %d %d", &width, &height, &max_value) == 3 &&
+                              width > 0 && height > 0 && max_value == 255 && fgetc(file) != EOF;
+
+        if(is_valid)
+        {
+            pixels.resize(width * height * 3);
+        }
+
+        const bool success = is_valid && fread(&pixels[0], 1, pixels.size(), file) == pixels.size();
+        fclose(file);
+
+        if(!success)
+        {
+            width  = 0;
+            height = 0;
+            pixels.clear();
+        }
+
+        return success;
+    }
+
+    // Saves the image as a binary PPM
+    bool GoldenImage::Save(const std::string& path) const
+    {
+        FILE* file = fopen(path.c_str(), "wb");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        fprintf(file, "P6\n%d %d\n255\n", width, height);
+        const bool success = pixels.empty() || fwrite(&pixels[0], 1, pixels.size(), file) == pixels.size();
+
+        fclose(file);
+        return success;
+    }
+
+    // Compares this frame with its golden image
+    //
+    // golden       The image the frame should look like
+    // tolerance    How different they can be
+    ImageDifference GoldenImage::Compare(const GoldenImage& golden, const ImageTolerance& tolerance) const
+    {
+        ImageDifference difference;
+        difference.meanDeltaE   = 0.0f;
+        difference.maxDeltaE    = 0.0f;
+        difference.failedPixels = 0;
+        difference.isSameSize   = width == golden.width && height == golden.height;
+        difference.passed       = false;
+
+        if(!difference.isSameSize || pixels.empty())
+        {
+            return difference;
+        }
+
+        std::vector<float> lab, golden_lab;
+        GetLab(lab);
+        golden.GetLab(golden_lab);
+
+        const float max_squared = tolerance.maxDeltaE * tolerance.maxDeltaE;
+        float       worst       = 0.0f;     // Squared, of every pixel (failed or not)
+        double      total       = 0.0;
+
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                const float* color = &lab[(y * width + x) * 3];
+
+                float best = -1.0f;
+                for(int dy = -tolerance.searchRadius; dy <= tolerance.searchRadius; ++dy)
+                {
+                    for(int dx = -tolerance.searchRadius; dx <= tolerance.searchRadius; ++dx)
+                    {
+                        const int gx = x + dx;
+                        const int gy = y + dy;
+                        if(gx < 0 || gy < 0 || gx >= width || gy >= height)
+                        {
+                            continue;
+                        }
+
+                        const float* other = &golden_lab[(gy * width + gx) * 3];
+                        const float  dl    = color[0] - other[0];
+                        const float  da    = color[1] - other[1];
+                        const float  db    = color[2] - other[2];
+                        const float  delta = dl * dl + da * da + db * db;
+
+                        if(dx == 0 && dy == 0)
+                        {
+                            total += std::sqrt(delta);
+                        }
+
+                        if(best < 0.0f || delta < best)
+                        {
+                            best = delta;
+                        }
+                    }
+                }
+
+                worst = std::max(worst, best);
+
+                if(best > max_squared)
+                {
+                    difference.failedPixels++;
+                }
+            }
+        }
+
+        difference.maxDeltaE  = std::sqrt(worst);
+        difference.meanDeltaE = (float)(total / (width * height));
+        difference.passed     = difference.failedPixels <= tolerance.maxFailedPixels * width * height;
+
+        return difference;
+    }
+
+    // sRGB (D65) to CIELAB, 3 floats per pixel
+    void GoldenImage::GetLab(std::vector<float>& lab) const
+    {
+        float linear[256];
+        for(int i = 0; i < 256; ++i)
+        {
+            const float value = i / 255.0f;
+            linear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        lab.resize(pixels.size());
+
+        for(size_t i = 0; i < pixels.size(); i += 3)
+        {
+            const float r = linear[pixels[i    ]];
+            const float g = linear[pixels[i + 1]];
+            const float b = linear[pixels[i + 2]];
+
+            // XYZ over the white point
+            float xyz[3] =
+            {
+                (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f,
+                (0.2126f * r + 0.7152f * g + 0.0722f * b),
+                (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f
+            };
+
+            for(int j = 0; j < 3; ++j)
+            {
+                xyz[j] = xyz[j] > 0.008856f ? std::pow(xyz[j], 1.0f / 3.0f) : 7.787f * xyz[j] + 16.0f / 116.0f;
+            }
+
+            lab[i    ] = 116.0f * xyz[1] - 16.0f;
+            lab[i + 1] = 500.0f * (xyz[0] - xyz[1]);
+            lab[i + 2] = 200.0f * (xyz[1] - xyz[2]);
+        }
+    }
+}
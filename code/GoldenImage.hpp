@@ -0,0 +1,87 @@
+/* ---------------------------------------------------------------------------
+** GoldenImage.hpp
+** An RGB image (the first row is the top one) that can be read from the
+** screen and saved or loaded as a binary PPM, and the comparison of a frame
+** with its golden image. The comparison is perceptual: the colours are
+** compared in CIELAB (Delta E 1976, 2.3 is the smallest difference that can
+** be seen), and a pixel only fails if no pixel around it in the golden image
+** is close enough, so the edges that move less than a pixel are forgiven.
+** The image fails if too many pixels do.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef GOLDENIMAGE_HEADER
+#define GOLDENIMAGE_HEADER
+
+#include <string>
+#include <vector>
+
+    namespace flygl
+    {
+        // How different a frame can be from its golden image
+        struct ImageTolerance
+        {
+        public:
+
+            float maxDeltaE;        // A pixel fails if it differs more than this
+            float maxFailedPixels;  // Fraction of the pixels that can fail
+            int   searchRadius;     // Pixels around it where the golden colour is looked for
+
+            // Constructor
+            ImageTolerance(): maxDeltaE(5.0f), maxFailedPixels(0.001f), searchRadius(1)
+            {}
+        };
+
+        // The result of a comparison
+        struct ImageDifference
+        {
+        public:
+
+            float meanDeltaE;       // Of every pixel, without the search
+            float maxDeltaE;        // Of every pixel, after the search
+            int   failedPixels;
+            bool  isSameSize;
+            bool  passed;
+        };
+
+        class GoldenImage
+        {
+        private:
+
+            int                        width;
+            int                        height;
+            std::vector<unsigned char> pixels;
+
+        public:
+
+            // Constructor
+            GoldenImage(): width(0), height(0)
+            {}
+
+            // Reads what has been drawn on the screen of the RenderDevice
+            void ReadScreen(const int& screen_width, const int& screen_height);
+
+            bool Load(const std::string& path);
+            bool Save(const std::string& path) const;
+
+            ImageDifference Compare(const GoldenImage& golden, const ImageTolerance& tolerance) const;
+
+            int GetWidth() const
+            {
+                return width;
+            }
+
+            int GetHeight() const
+            {
+                return height;
+            }
+
+        private:
+
+            // The CIELAB colour of every pixel
+            void GetLab(std::vector<float>& lab) const;
+        };
+    }
+
+#endif
@@ -0,0 +1,447 @@
+/* ---------------------------------------------------------------------------
+** GoldenTest.cpp
+** Draws the cases of the golden tests, compares them with their images and
+** writes the report.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "GoldenTest.hpp"
+#include "View.hpp"
+
+#include <cstdio>
+#include <algorithm>
+
+// glew
+#include <GL/glew.h>
+
+namespace flygl
+{
+    const int GoldenTest::FRAMES_PER_CASE;
+    const int GoldenTest::CHECK_EVERY;
+
+    // A text as a JSON string, without the quotes: the quotes, the
+    // backslashes (Windows paths) and the control characters are escaped
+    static std::string EscapeJson(const std::string& text)
+    {
+        std::string escaped;
+        for(size_t i = 0; i < text.size(); ++i)
+        {
+            const unsigned char character = text[i];
+
+            if(character == '"' || character == '\\')
+            {
+                escaped += '\\';
+                escaped += character;
+            }
+            else if(character < 0x20)
+            {
+                char code[8];
+                sprintf(code, "\\u%04x", character);
+                escaped += code;
+            }
+            else
+            {
+                escaped += character;
+            }
+        }
+        return escaped;
+    }
+
+    // Constructor
+    //
+    // width        Size of the frames in pixels
+    // height
+    // delta_time   Seconds every Update is given
+    // golden_dir   Directory with the golden images
+    GoldenTest::GoldenTest(const int& width, const int& height, const float& delta_time, const std::string& golden_dir):
+        width(width), height(height), deltaTime(delta_time), directory(golden_dir), updateGolden(false), timingTolerance(0.0f)
+    {
+        CreateCases();
+    }
+
+    // The cases, every effect with the camera moving in a way it can be seen.
+    // The paths start where the View puts the camera.
+    void GoldenTest::CreateCases()
+    {
+        const glm::vec3 position(-60.0f, -160.0f, -230.0f);
+        const glm::vec3 rotation( 20.0f,  -10.0f,    0.0f);
+        const float     duration = FRAMES_PER_CASE * deltaTime;
+
+        std::vector<CameraKey> still(1);
+        still[0].time     = 0.0f;
+        still[0].position = position;
+        still[0].rotation = rotation;
+
+        // Turns to the right and back
+        std::vector<CameraKey> pan(3, still[0]);
+        pan[1].time     = duration * 0.5f;
+        pan[1].rotation = rotation + glm::vec3(0.0f, 15.0f, 0.0f);
+        pan[2].time     = duration;
+        pan[2].rotation = rotation + glm::vec3(5.0f, -10.0f, 0.0f);
+
+        // Goes in fast, for the motion blur
+        std::vector<CameraKey> dolly(2, still[0]);
+        dolly[1].time     = duration;
+        dolly[1].position = position + glm::vec3(20.0f, 10.0f, 60.0f);
+        dolly[1].rotation = rotation + glm::vec3(-5.0f, 5.0f, 0.0f);
+
+        const struct
+        {
+            const char*                   name;
+            const char*                   effects;
+            bool                          isDeferred;
+            const std::vector<CameraKey>* path;
+        }
+        definitions[] =
+        {
+            { "forward",     "",   false, &pan   },
+            { "deferred",    "",   true,  &pan   },
+            { "motion_blur", "1",  false, &dolly },
+            { "reflection",  "2",  false, &pan   },
+            { "blur",        "3",  false, &still },
+            { "dizzy",       "4",  false, &still },
+            { "color_grade", "56", false, &dolly }
+        };
+
+        for(size_t i = 0; i < sizeof(definitions) / sizeof(definitions[0]); ++i)
+        {
+            TestCase test_case;
+            test_case.name       = definitions[i].name;
+            test_case.effects    = definitions[i].effects;
+            test_case.isDeferred = definitions[i].isDeferred;
+            test_case.path       = *definitions[i].path;
+            cases.push_back(test_case);
+        }
+    }
+
+    // Draws the chosen cases, and compares their frames or saves them.
+    // Returns true if every case has passed.
+    //
+    // report_path      The JSON report, empty for none
+    bool GoldenTest::Run(const std::string& report_path)
+    {
+        if(!updateGolden && timingTolerance > 0.0f && !LoadBaselineTimes())
+        {
+            fprintf(stdout, "No golden times in %s, the times are not checked\n", directory.c_str());
+        }
+
+        std::vector<std::string> names;
+        std::vector<CaseResult>  results;
+        bool                     passed = true;
+
+        for(size_t i = 0; i < cases.size(); ++i)
+        {
+            if(!IsSelected(cases[i].name))
+            {
+                continue;
+            }
+
+            const CaseResult result = RunCase(cases[i]);
+            names.  push_back(cases[i].name);
+            results.push_back(result);
+
+            passed = passed && result.passed;
+
+            fprintf(stdout, "%-12s %s  cpu %7.3f ms  gpu %7.3f ms%s\n", cases[i].name.c_str(),
+                    updateGolden ? "saved " : (result.passed ? "passed" : "FAILED"),
+                    result.cpuMedian, result.gpuMedian, result.isSlower ? "  (slower)" : "");
+
+            for(size_t j = 0; j < result.checks.size() && !updateGolden; ++j)
+            {
+                const FrameCheck& check = result.checks[j];
+                if(!check.hasGolden)
+                {
+                    fprintf(stdout, "    frame %d: no golden image %s\n", check.frame, check.image.c_str());
+                }
+                else if(!check.difference.passed)
+                {
+                    fprintf(stdout, "    frame %d: %d pixels differ (max Delta E %.2f, mean %.3f)\n", check.frame,
+                            check.difference.failedPixels, check.difference.maxDeltaE, check.difference.meanDeltaE);
+                }
+            }
+        }
+
+        if(names.empty())
+        {
+            fprintf(stderr, "No case is called %s\n", selectedCases.c_str());
+            return false;
+        }
+
+        if(updateGolden && !SaveBaselineTimes(names, results))
+        {
+            fprintf(stderr, "Can't save the golden times in %s\n", directory.c_str());
+            passed = false;
+        }
+
+        if(!report_path.empty() && !WriteReport(report_path, names, results))
+        {
+            fprintf(stderr, "Can't write %s\n", report_path.c_str());
+            passed = false;
+        }
+
+        return passed;
+    }
+
+    bool GoldenTest::IsSelected(const std::string& name) const
+    {
+        if(selectedCases.empty())
+        {
+            return true;
+        }
+
+        return ("," + selectedCases + ",").find("," + name + ",") != std::string::npos;
+    }
+
+    // Draws a case in a new View, so nothing is left from the previous one
+    GoldenTest::CaseResult GoldenTest::RunCase(const TestCase& test_case) const
+    {
+        CaseResult result;
+        result.passed = true;
+
+        View view(width, height);
+        view.SetInputsEnabled    (false);
+        view.SetDynamicResolution(false);
+        view.SetWaitForTextures  (true);
+        view.SetDeferred         (test_case.isDeferred);
+
+        for(size_t i = 0; i < test_case.effects.size(); ++i)
+        {
+            view.SwitchEffect(test_case.effects[i] - '0');
+        }
+
+        for(int frame = 0; frame < FRAMES_PER_CASE; ++frame)
+        {
+            glm::vec3 position, rotation;
+            GetCamera(test_case.path, frame * deltaTime, position, rotation);
+            view.SetCamera(position, rotation);
+
+            result.timings.push_back(HeadlessRunner::DrawFrame(view, deltaTime));
+
+            if((frame + 1) % CHECK_EVERY != 0)
+            {
+                continue;
+            }
+
+            FrameCheck check;
+            check.frame     = frame;
+            check.image     = GetImagePath(test_case.name, frame);
+            check.hasGolden = false;
+
+            GoldenImage image;
+            image.ReadScreen(width, height);
+
+            if(updateGolden)
+            {
+                check.hasGolden = image.Save(check.image);
+                result.passed   = result.passed && check.hasGolden;
+            }
+            else
+            {
+                GoldenImage golden;
+                check.hasGolden  = golden.Load(check.image);
+                check.difference = image.Compare(golden, tolerance);
+
+                // What was drawn instead is kept next to the golden image
+                if(!check.difference.passed)
+                {
+                    image.Save(check.image.substr(0, check.image.size() - 4) + ".failed.ppm");
+                    result.passed = false;
+                }
+            }
+
+            result.checks.push_back(check);
+        }
+
+        std::vector<float> cpu, gpu;
+        for(size_t i = 0; i < result.timings.size(); ++i)
+        {
+            cpu.push_back(result.timings[i].cpuTime);
+            gpu.push_back(result.timings[i].gpuTime);
+        }
+
+        result.cpuMedian   = Percentile(cpu, 50);
+        result.gpuMedian   = Percentile(gpu, 50);
+        result.baselineCpu = 0.0f;
+        result.baselineGpu = 0.0f;
+        result.isSlower    = false;
+
+        std::map<std::string, std::pair<float, float> >::const_iterator baseline = baselineTimes.find(test_case.name);
+        if(baseline != baselineTimes.end())
+        {
+            result.baselineCpu = baseline->second.first;
+            result.baselineGpu = baseline->second.second;
+
+            // A GPU time of 0 is unknown (no timer queries)
+            result.isSlower = result.cpuMedian > result.baselineCpu * (1.0f + timingTolerance) ||
+                              (result.baselineGpu > 0.0f && result.gpuMedian > result.baselineGpu * (1.0f + timingTolerance));
+
+            result.passed = result.passed && !result.isSlower;
+        }
+
+        return result;
+    }
+
+    // Where the camera of a path is at a time
+    //
+    // path         Keys sorted by time
+    // time         Seconds since the case started
+    // position     Returns the position and the rotation
+    // rotation
+    void GoldenTest::GetCamera(const std::vector<CameraKey>& path, const float& time, glm::vec3& position, glm::vec3& rotation) const
+    {
+        size_t next = 0;
+        while(next < path.size() && path[next].time <= time)
+        {
+            next++;
+        }
+
+        if(next == 0 || next == path.size())
+        {
+            const CameraKey& key = path[next == 0 ? 0 : path.size() - 1];
+            position = key.position;
+            rotation = key.rotation;
+            return;
+        }
+
+        const CameraKey& from   = path[next - 1];
+        const CameraKey& to     = path[next];
+        const float      amount = (time - from.time) / (to.time - from.time);
+
+        position = glm::mix(from.position, to.position, amount);
+        rotation = glm::mix(from.rotation, to.rotation, amount);
+    }
+
+    std::string GoldenTest::GetImagePath(const std::string& name, const int& frame) const
+    {
+        char file_name[256];
+        sprintf(file_name, "/%.200s_%05d.ppm", name.c_str(), frame);
+        return directory + file_name;
+    }
+
+    // Reads the median times the golden run had: "name cpu_ms gpu_ms" per line
+    bool GoldenTest::LoadBaselineTimes()
+    {
+        FILE* file = fopen((directory + "/timings.txt").c_str(), "r");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        char  name[256];
+        float cpu, gpu;
+        while(fscanf(file, "%255s %f %f", name, &cpu, &gpu) == 3)
+        {
+            baselineTimes[name] = std::make_pair(cpu, gpu);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    bool GoldenTest::SaveBaselineTimes(const std::vector<std::string>& names, const std::vector<CaseResult>& results) const
+    {
+        FILE* file = fopen((directory + "/timings.txt").c_str(), "w");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        for(size_t i = 0; i < names.size(); ++i)
+        {
+            fprintf(file, "%s %.4f %.4f\n", names[i].c_str(), results[i].cpuMedian, results[i].gpuMedian);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    // Writes the result of every case: its checks and the times of its frames
+    bool GoldenTest::WriteReport(const std::string& path, const std::vector<std::string>& names, const std::vector<CaseResult>& results) const
+    {
+        FILE* file = fopen(path.c_str(), "w");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        bool passed = true;
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            passed = passed && results[i].passed;
+        }
+
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+
+        fprintf(file, "{\n");
+        fprintf(file, "  \"renderer\": \"%s\",\n", EscapeJson(renderer != NULL ? renderer : "").c_str());
+        fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n  \"delta_time\": %.6f,\n", width, height, deltaTime);
+        fprintf(file, "  \"golden\": \"%s\",\n  \"updated\": %s,\n", EscapeJson(directory).c_str(), updateGolden ? "true" : "false");
+        fprintf(file, "  \"tolerance\": { \"delta_e\": %.3f, \"failed_pixels\": %.6f, \"search_radius\": %d, \"timing\": %.3f },\n",
+                tolerance.maxDeltaE, tolerance.maxFailedPixels, tolerance.searchRadius, timingTolerance);
+        fprintf(file, "  \"passed\": %s,\n", passed ? "true" : "false");
+        fprintf(file, "  \"cases\": [\n");
+
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            const CaseResult& result = results[i];
+
+            std::vector<float> cpu, gpu, wall;
+            for(size_t j = 0; j < result.timings.size(); ++j)
+            {
+                cpu. push_back(result.timings[j].cpuTime );
+                gpu. push_back(result.timings[j].gpuTime );
+                wall.push_back(result.timings[j].wallTime);
+            }
+
+            fprintf(file, "    {\n      \"name\": \"%s\",\n      \"passed\": %s,\n      \"slower\": %s,\n", EscapeJson(names[i]).c_str(),
+                    result.passed ? "true" : "false", result.isSlower ? "true" : "false");
+
+            fprintf(file, "      \"cpu_ms\":  { \"median\": %.4f, \"p95\": %.4f, \"baseline\": %.4f },\n",
+                    result.cpuMedian, Percentile(cpu, 95), result.baselineCpu);
+            fprintf(file, "      \"gpu_ms\":  { \"median\": %.4f, \"p95\": %.4f, \"baseline\": %.4f },\n",
+                    result.gpuMedian, Percentile(gpu, 95), result.baselineGpu);
+            fprintf(file, "      \"wall_ms\": { \"median\": %.4f, \"p95\": %.4f },\n",
+                    Percentile(wall, 50), Percentile(wall, 95));
+
+            fprintf(file, "      \"checks\": [\n");
+            for(size_t j = 0; j < result.checks.size(); ++j)
+            {
+                const FrameCheck& check = result.checks[j];
+                fprintf(file, "        { \"frame\": %d, \"golden\": %s, \"passed\": %s, \"mean_delta_e\": %.4f, "
+                              "\"max_delta_e\": %.4f, \"failed_pixels\": %d }%s\n",
+                        check.frame, check.hasGolden ? "true" : "false", (updateGolden || check.difference.passed) ? "true" : "false",
+                        check.difference.meanDeltaE, check.difference.maxDeltaE, check.difference.failedPixels,
+                        j + 1 < result.checks.size() ? "," : "");
+            }
+            fprintf(file, "      ],\n");
+
+            fprintf(file, "      \"frames\": [\n");
+            for(size_t j = 0; j < result.timings.size(); ++j)
+            {
+                fprintf(file, "        { \"frame\": %u, \"cpu_ms\": %.4f, \"gpu_ms\": %.4f, \"wall_ms\": %.4f }%s\n",
+                        (unsigned int)j, result.timings[j].cpuTime, result.timings[j].gpuTime, result.timings[j].wallTime,
+                        j + 1 < result.timings.size() ? "," : "");
+            }
+            fprintf(file, "      ]\n    }%s\n", i + 1 < results.size() ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+
+        fclose(file);
+        return true;
+    }
+
+    // values   Times, copied to be sorted
+    // percent  0 to 100
+    float GoldenTest::Percentile(std::vector<float> values, const int& percent)
+    {
+        if(values.empty())
+        {
+            return 0.0f;
+        }
+
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, (values.size() * percent) / 100)];
+    }
+}
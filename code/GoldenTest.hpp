@@ -0,0 +1,158 @@
+/* ---------------------------------------------------------------------------
+** GoldenTest.hpp
+** The regression tests of the drawing. Every case draws the View with some
+** effects (none, deferred, motion blur, reflection, blur, dizzy, colour
+** grading and vignette) while the camera follows a scripted path, with a
+** fixed time step and at a fixed resolution, and compares some of its
+** frames with the golden images saved before (GoldenImage, with a
+** perceptual tolerance). The time of every frame is measured too, and all
+** of it is written to a JSON report. If the golden directory has the times
+** of the cases, the ones that have become slower fail as well.
+** With --update-golden the frames and the times are saved as the new
+** golden ones instead.
+**
+**   FlyEngine --headless --golden golden [--update-golden] [--report report.json]
+**             [--tolerance 5] [--max-failed 0.001] [--timing-tolerance 0.5]
+**             [--cases forward,blur] [--software]
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef GOLDENTEST_HEADER
+#define GOLDENTEST_HEADER
+
+#include <map>
+#include <string>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "GoldenImage.hpp"
+#include "HeadlessRunner.hpp"
+
+    namespace flygl
+    {
+        class GoldenTest
+        {
+        public:
+
+            static const int FRAMES_PER_CASE = 30;
+            static const int CHECK_EVERY     = 10;  // Frames between the ones compared
+
+        private:
+
+            // Where the camera is at a time, the path goes in straight lines between them
+            struct CameraKey
+            {
+            public:
+
+                float     time;
+                glm::vec3 position;
+                glm::vec3 rotation;
+            };
+
+            struct TestCase
+            {
+            public:
+
+                std::string            name;
+                std::string            effects;     // Keys of the effects, as in the View
+                bool                   isDeferred;
+                std::vector<CameraKey> path;
+            };
+
+            // A frame compared with its golden image
+            struct FrameCheck
+            {
+            public:
+
+                int             frame;
+                std::string     image;
+                bool            hasGolden;
+                ImageDifference difference;
+            };
+
+            struct CaseResult
+            {
+            public:
+
+                std::vector<FrameTiming> timings;
+                std::vector<FrameCheck>  checks;
+                float                    cpuMedian;
+                float                    gpuMedian;
+                float                    baselineCpu;   // Golden times, 0 if there are none
+                float                    baselineGpu;
+                bool                     isSlower;
+                bool                     passed;
+            };
+
+            int         width;
+            int         height;
+            float       deltaTime;
+            std::string directory;
+            bool        updateGolden;
+
+            ImageTolerance tolerance;
+            float          timingTolerance;    // Fraction a median can grow, 0 to not check the times
+            std::string    selectedCases;      // Names separated by commas, empty for all
+
+            std::vector<TestCase> cases;
+
+            // Median times of the golden run, CPU and GPU
+            std::map<std::string, std::pair<float, float> > baselineTimes;
+
+        public:
+
+            // width        Size of the frames in pixels
+            // height
+            // delta_time   Seconds every Update is given
+            // golden_dir   Directory with the golden images
+            GoldenTest(const int& width, const int& height, const float& delta_time, const std::string& golden_dir);
+
+            // Saves the frames as the golden ones instead of comparing them
+            void SetUpdate(const bool& update)
+            {
+                updateGolden = update;
+            }
+
+            void SetTolerance(const ImageTolerance& image_tolerance)
+            {
+                tolerance = image_tolerance;
+            }
+
+            void SetTimingTolerance(const float& fraction)
+            {
+                timingTolerance = fraction;
+            }
+
+            void SetCases(const std::string& names)
+            {
+                selectedCases = names;
+            }
+
+            // Returns true if every case has passed
+            bool Run(const std::string& report_path);
+
+        private:
+
+            void CreateCases();
+
+            bool IsSelected(const std::string& name) const;
+
+            CaseResult RunCase(const TestCase& test_case) const;
+
+            void GetCamera(const std::vector<CameraKey>& path, const float& time, glm::vec3& position, glm::vec3& rotation) const;
+
+            std::string GetImagePath(const std::string& name, const int& frame) const;
+
+            bool LoadBaselineTimes();
+            bool SaveBaselineTimes(const std::vector<std::string>& names, const std::vector<CaseResult>& results) const;
+
+            bool WriteReport(const std::string& path, const std::vector<std::string>& names, const std::vector<CaseResult>& results) const;
+
+            static float Percentile(std::vector<float> values, const int& percent);
+        };
+    }
+
+#endif
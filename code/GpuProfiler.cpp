@@ -0,0 +1,264 @@
+/* ---------------------------------------------------------------------------
+** GpuProfiler.cpp
+** The timestamp queries of the frames, and how they are read.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "GpuProfiler.hpp"
+#include "Profiler.hpp"
+
+#include <cstring>
+
+namespace flygl
+{
+    const int GpuProfiler::FRAMES;
+    const int GpuProfiler::MAX_ZONES;
+
+    // How much a new frame moves the averages
+    static const float AVERAGE_WEIGHT = 0.1f;
+
+    #ifdef FLYGL_PROFILING
+        // The row of the GPU in the trace, shared by every profiler (there is
+        // only one GL context, and it is only used from the main thread)
+        static ProfileThread* GetTrack()
+        {
+            static ProfileThread* track = Profiler::CreateTrack("GPU");
+            return track;
+        }
+    #endif
+
+    // Destructor
+    GpuProfiler::~GpuProfiler()
+    {
+        if(isSupported)
+        {
+            for(int i = 0; i < FRAMES; ++i)
+            {
+                glDeleteQueries(MAX_ZONES * 2, &frames[i].queries[0][0]);
+            }
+        }
+    }
+
+    // Finds if the driver has timestamps, and creates the queries of every frame
+    void GpuProfiler::Initialize()
+    {
+        if(isInitialized)
+        {
+            return;
+        }
+        isInitialized = true;
+
+        GLint bits = 0;
+        if(glQueryCounter != NULL && glGetQueryiv != NULL)
+        {
+            // The errors of somebody else first, an old driver doesn't know the target
+            while(glGetError() != GL_NO_ERROR)
+            {}
+
+            glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+
+            if(glGetError() != GL_NO_ERROR)
+            {
+                bits = 0;
+            }
+        }
+
+        isSupported = bits > 0;
+
+        if(isSupported)
+        {
+            for(int i = 0; i < FRAMES; ++i)
+            {
+                glGenQueries(MAX_ZONES * 2, &frames[i].queries[0][0]);
+                frames[i].zoneCount = 0;
+            }
+        }
+    }
+
+    // Reads the frames that are ready, and starts the queries of a new one.
+    // If every set of queries is waiting, the oldest frame is lost.
+    void GpuProfiler::BeginFrame()
+    {
+        if(!isSupported)
+        {
+            return;
+        }
+
+        while(readFrames < issuedFrames)
+        {
+            if(!ReadFrame(frames[readFrames % FRAMES]) && issuedFrames - readFrames < FRAMES)
+            {
+                break;
+            }
+            readFrames++;
+        }
+
+        frames[issuedFrames % FRAMES].zoneCount = 0;
+        isInFrame = true;
+
+        BeginZone("Frame");
+    }
+
+    void GpuProfiler::EndFrame()
+    {
+        if(!isInFrame)
+        {
+            return;
+        }
+
+        EndZone(0);
+
+        isInFrame = false;
+        issuedFrames++;
+    }
+
+    // Issues the timestamp at the begin of a zone
+    //
+    // name     A literal, only the pointer is kept
+    int GpuProfiler::BeginZone(const char* name)
+    {
+        Frame& frame = frames[issuedFrames % FRAMES];
+
+        if(!isInFrame || frame.zoneCount >= MAX_ZONES)
+        {
+            return -1;
+        }
+
+        const int zone = frame.zoneCount++;
+
+        frame.names  [zone] = name;
+        frame.isEnded[zone] = false;
+        glQueryCounter(frame.queries[zone][0], GL_TIMESTAMP);
+
+        return zone;
+    }
+
+    // Issues the timestamp at the end of a zone
+    //
+    // zone     What BeginZone returned
+    void GpuProfiler::EndZone(const int& zone)
+    {
+        if(zone < 0 || !isInFrame)
+        {
+            return;
+        }
+
+        Frame& frame = frames[issuedFrames % FRAMES];
+
+        frame.isEnded[zone] = true;
+        glQueryCounter(frame.queries[zone][1], GL_TIMESTAMP);
+    }
+
+    float GpuProfiler::GetAverageTime(const char* name) const
+    {
+        for(size_t i = 0; i < passTimes.size(); ++i)
+        {
+            if(strcmp(passTimes[i].name, name) == 0)
+            {
+                return passTimes[i].averageTime;
+            }
+        }
+        return 0.0f;
+    }
+
+    // Reads the times of a frame, if the GPU has finished it (its end is
+    // the last timestamp issued, so the rest are ready too). Returns false
+    // if it is not ready.
+    bool GpuProfiler::ReadFrame(Frame& frame)
+    {
+        GLuint available = 0;
+        glGetQueryObjectuiv(frame.queries[0][1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if(!available)
+        {
+            return false;
+        }
+
+        GLuint64 times[MAX_ZONES][2];
+        for(int i = 0; i < frame.zoneCount; ++i)
+        {
+            if(frame.isEnded[i])
+            {
+                glGetQueryObjectui64v(frame.queries[i][0], GL_QUERY_RESULT, &times[i][0]);
+                glGetQueryObjectui64v(frame.queries[i][1], GL_QUERY_RESULT, &times[i][1]);
+            }
+        }
+
+        frameTime = (times[0][1] - times[0][0]) / 1000000.0f;
+
+        // The zones with the same name are added
+        std::vector<bool> is_drawn(passTimes.size(), false);
+        for(size_t i = 0; i < passTimes.size(); ++i)
+        {
+            passTimes[i].lastTime = 0.0f;
+        }
+
+        for(int i = 1; i < frame.zoneCount; ++i)
+        {
+            if(frame.isEnded[i])
+            {
+                const size_t pass = GetPassIndex(frame.names[i]);
+                passTimes[pass].lastTime += (times[i][1] - times[i][0]) / 1000000.0f;
+
+                is_drawn.resize(passTimes.size(), false);
+                is_drawn[pass] = true;
+            }
+        }
+
+        for(size_t i = 0; i < passTimes.size(); ++i)
+        {
+            GpuPassTime& pass = passTimes[i];
+
+            if(is_drawn[i])
+            {
+                pass.averageTime = pass.samples == 0 ? pass.lastTime : pass.averageTime + (pass.lastTime - pass.averageTime) * AVERAGE_WEIGHT;
+                pass.samples++;
+            }
+        }
+
+        #ifdef FLYGL_PROFILING
+            // The GPU clock is taken to the one of the Profiler with the time
+            // both have now
+            GLint64 gpu_now = 0;
+            glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+
+            const double cpu_now      = (double)Profiler::GetTicks();
+            const double ticks_per_ns = Profiler::GetTicksPerMicrosecond() / 1000.0;
+
+            for(int i = 0; i < frame.zoneCount; ++i)
+            {
+                if(frame.isEnded[i])
+                {
+                    const double start = cpu_now - (double)(gpu_now - (GLint64)times[i][0]) * ticks_per_ns;
+                    const double end   = cpu_now - (double)(gpu_now - (GLint64)times[i][1]) * ticks_per_ns;
+
+                    Profiler::Record(GetTrack(), frame.names[i], (unsigned long long)start, (unsigned long long)end);
+                }
+            }
+        #endif
+
+        return true;
+    }
+
+    // The time of a zone, added the first time it is seen
+    size_t GpuProfiler::GetPassIndex(const char* name)
+    {
+        for(size_t i = 0; i < passTimes.size(); ++i)
+        {
+            if(strcmp(passTimes[i].name, name) == 0)
+            {
+                return i;
+            }
+        }
+
+        GpuPassTime pass;
+        pass.name        = name;
+        pass.lastTime    = 0.0f;
+        pass.averageTime = 0.0f;
+        pass.samples     = 0;
+
+        passTimes.push_back(pass);
+        return passTimes.size() - 1;
+    }
+}
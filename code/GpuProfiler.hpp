@@ -0,0 +1,150 @@
+/* ---------------------------------------------------------------------------
+** GpuProfiler.hpp
+** Measures where the time of the GPU goes: the frame and zones inside it
+** (the passes), with two timestamp queries each. The queries of a frame
+** are read on the next frames, as soon as they are ready, and there are
+** FRAMES sets of them, so the CPU never waits for the GPU (a frame whose
+** queries are still not ready when its set is needed again is lost).
+** Every zone keeps its last time and a rolling average, by name (zones with
+** the same name on a frame are added). With FLYGL_PROFILING the zones also
+** go to the Profiler, on a "GPU" row of the trace.
+** Without timer queries (the driver has no GL_TIMESTAMP bits) nothing is
+** measured and every time is 0.
+**
+**   gpuProfiler.BeginFrame();
+**   {
+**       GpuZone zone(&gpuProfiler, "Scene");
+**       ...
+**   }
+**   gpuProfiler.EndFrame();
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef GPUPROFILER_HEADER
+#define GPUPROFILER_HEADER
+
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+    namespace flygl
+    {
+        // The time of a zone, in milliseconds
+        struct GpuPassTime
+        {
+        public:
+
+            const char* name;
+            float       lastTime;       // Of the last frame read (0 if it was not drawn)
+            float       averageTime;    // Rolling average of the frames it was drawn on
+            int         samples;
+        };
+
+        class GpuProfiler
+        {
+        public:
+
+            // Frames whose queries can be waiting for the GPU
+            static const int FRAMES = 4;
+
+            // Zones of a frame (the frame itself is the first one)
+            static const int MAX_ZONES = 64;
+
+        private:
+
+            struct Frame
+            {
+            public:
+
+                GLuint      queries[MAX_ZONES][2];  // Timestamps at the begin and the end
+                const char* names  [MAX_ZONES];
+                bool        isEnded[MAX_ZONES];
+                int         zoneCount;
+            };
+
+            Frame frames[FRAMES];
+            long  issuedFrames;     // Frames whose queries were issued
+            long  readFrames;       // Frames that were read (or lost)
+            bool  isInFrame;
+
+            bool isSupported;
+            bool isInitialized;
+
+            float                    frameTime;
+            std::vector<GpuPassTime> passTimes;
+
+        public:
+
+            // Constructor
+            GpuProfiler(): issuedFrames(0), readFrames(0), isInFrame(false), isSupported(false), isInitialized(false), frameTime(0.0f)
+            {}
+
+            // Destructor
+            ~GpuProfiler();
+
+            // Creates the queries (it needs the GL context)
+            void Initialize();
+
+            void BeginFrame();
+            void EndFrame  ();
+
+            // Returns the zone to end, -1 if it is not measured
+            int  BeginZone(const char* name);
+            void EndZone  (const int& zone);
+
+            bool IsSupported() const
+            {
+                return isSupported;
+            }
+
+            // Milliseconds of the last frame read (0 until it is known)
+            float GetFrameTime() const
+            {
+                return frameTime;
+            }
+
+            // Every zone that has been drawn, in the order they were first seen
+            const std::vector<GpuPassTime>& GetPassTimes() const
+            {
+                return passTimes;
+            }
+
+            // Average milliseconds of a zone, 0 if it has never been read
+            float GetAverageTime(const char* name) const;
+
+        private:
+
+            bool ReadFrame(Frame& frame);
+
+            size_t GetPassIndex(const char* name);
+        };
+
+        // Measures its scope on the GPU, if there is a profiler
+        class GpuZone
+        {
+        private:
+
+            GpuProfiler* profiler;
+            int          zone;
+
+        public:
+
+            // Constructor
+            GpuZone(GpuProfiler* gpu_profiler, const char* name):
+                profiler(gpu_profiler), zone(gpu_profiler != NULL ? gpu_profiler->BeginZone(name) : -1)
+            {}
+
+            // Destructor
+            ~GpuZone()
+            {
+                if(profiler != NULL)
+                {
+                    profiler->EndZone(zone);
+                }
+            }
+        };
+    }
+
+#endif
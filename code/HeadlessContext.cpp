@@ -0,0 +1,160 @@
+/* ---------------------------------------------------------------------------
+** HeadlessContext.cpp
+** An OpenGL 3.3 core context without a window or a display, on an EGL
+** pbuffer of the given size. Only built with FLYGL_HEADLESS defined.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "HeadlessContext.hpp"
+
+#ifdef FLYGL_HEADLESS
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+
+    // Older headers don't have the surfaceless platform of Mesa
+    #ifndef EGL_PLATFORM_SURFACELESS_MESA
+        #define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+    #endif
+#endif
+
+namespace flygl
+{
+    // If the context can be created in this build
+    bool HeadlessContext::IsAvailable()
+    {
+#ifdef FLYGL_HEADLESS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Creates the context and makes it current
+    //
+    // width    Size of the frame buffer, in pixels
+    // height
+    bool HeadlessContext::Create(const int& width, const int& height)
+    {
+        Destroy();
+
+#ifdef FLYGL_HEADLESS
+        EGLDisplay egl_display = EGL_NO_DISPLAY;
+
+        // The surfaceless platform needs no display server at all
+        PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+        if(get_platform_display != NULL)
+        {
+            egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        }
+        if(egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, NULL, NULL))
+        {
+            egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+            if(egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, NULL, NULL))
+            {
+                error = "No EGL display";
+                return false;
+            }
+        }
+        display = egl_display;
+
+        if(!eglBindAPI(EGL_OPENGL_API))
+        {
+            error = "EGL can't create OpenGL contexts";
+            Destroy();
+            return false;
+        }
+
+        // The same buffers the window asks for
+        const EGLint config_attributes[] =
+        {
+            EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE,     8,
+            EGL_GREEN_SIZE,   8,
+            EGL_BLUE_SIZE,    8,
+            EGL_DEPTH_SIZE,   24,
+            EGL_STENCIL_SIZE, 8,
+            EGL_NONE
+        };
+
+        EGLConfig config;
+        EGLint    config_count = 0;
+
+        if(!eglChooseConfig(egl_display, config_attributes, &config, 1, &config_count) || config_count == 0)
+        {
+            error = "No EGL config with a pbuffer";
+            Destroy();
+            return false;
+        }
+
+        const EGLint surface_attributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+
+        surface = eglCreatePbufferSurface(egl_display, config, surface_attributes);
+        if(surface == EGL_NO_SURFACE)
+        {
+            error = "Can't create the pbuffer";
+            Destroy();
+            return false;
+        }
+
+        const EGLint context_attributes[] =
+        {
+            EGL_CONTEXT_MAJOR_VERSION_KHR,       3,
+            EGL_CONTEXT_MINOR_VERSION_KHR,       3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+            EGL_NONE
+        };
+
+        context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, context_attributes);
+        if(context == EGL_NO_CONTEXT)
+        {
+            error = "Can't create an OpenGL 3.3 core context";
+            Destroy();
+            return false;
+        }
+
+        if(!eglMakeCurrent(egl_display, (EGLSurface)surface, (EGLSurface)surface, (EGLContext)context))
+        {
+            error = "Can't make the context current";
+            Destroy();
+            return false;
+        }
+
+        return true;
+#else
+        (void)width;
+        (void)height;
+
+        error = "Built without FLYGL_HEADLESS";
+        return false;
+#endif
+    }
+
+    // Destroys the context and its pbuffer
+    void HeadlessContext::Destroy()
+    {
+#ifdef FLYGL_HEADLESS
+        if(display != NULL)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+            if(context != NULL)
+            {
+                eglDestroyContext(display, context);
+            }
+            if(surface != NULL)
+            {
+                eglDestroySurface(display, surface);
+            }
+            eglTerminate(display);
+        }
+#endif
+        display = NULL;
+        surface = NULL;
+        context = NULL;
+    }
+}
@@ -0,0 +1,55 @@
+/* ---------------------------------------------------------------------------
+** HeadlessContext.hpp
+** An OpenGL 3.3 core context without a window or a display, on an EGL
+** pbuffer of the given size (its frame buffer is the "screen"). It uses the
+** surfaceless platform of Mesa if there is one, so it works on machines
+** without a GPU or an X server (llvmpipe). It needs EGL, so it is only built
+** with FLYGL_HEADLESS defined (if not, Create always fails).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef HEADLESSCONTEXT_HEADER
+#define HEADLESSCONTEXT_HEADER
+
+#include <string>
+
+    namespace flygl
+    {
+        class HeadlessContext
+        {
+        private:
+
+            // The EGL display, surface and context (kept out of the header)
+            void* display;
+            void* surface;
+            void* context;
+
+            // Why Create failed
+            std::string error;
+
+        public:
+
+            // Constructor
+            HeadlessContext(): display(NULL), surface(NULL), context(NULL)
+            {}
+
+            // Destructor
+            ~HeadlessContext()
+            {
+                Destroy();
+            }
+
+            bool Create (const int& width, const int& height);
+            void Destroy();
+
+            const std::string& GetError() const
+            {
+                return error;
+            }
+
+            static bool IsAvailable();
+        };
+    }
+
+#endif
@@ -0,0 +1,380 @@
+/* ---------------------------------------------------------------------------
+** HeadlessRunner.cpp
+** Runs the View without a window, for a fixed number of frames, and dumps
+** the frames and their times.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "HeadlessRunner.hpp"
+#include "HeadlessContext.hpp"
+#include "GoldenTest.hpp"
+#include "SoftwareRenderDevice.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "MemoryTracker.hpp"
+#include "View.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <SFML/System/Clock.hpp>
+
+namespace flygl
+{
+    // Reads the options. Returns false if there is no --headless (the
+    // window is opened as always).
+    //
+    // argc     The arguments of main
+    // argv
+    bool HeadlessRunner::ParseArguments(const int& argc, char* argv[])
+    {
+        bool is_headless = false;
+
+        for(int i = 1; i < argc; ++i)
+        {
+            const std::string option = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if(option == "--headless")
+            {
+                is_headless = true;
+            }
+            else if(option == "--deferred")
+            {
+                useDeferred = true;
+            }
+            else if(option == "--fixed-resolution")
+            {
+                useDynamicResolution = false;
+            }
+            else if(option == "--software")
+            {
+                useSoftware = true;
+            }
+            else if(option == "--update-golden")
+            {
+                updateGolden = true;
+            }
+            else if(option == "--memory")
+            {
+                showMemory = true;
+            }
+            else if(has_value && option == "--width")      { width        = atoi(argv[++i]);         }
+            else if(has_value && option == "--height")     { height       = atoi(argv[++i]);         }
+            else if(has_value && option == "--frames")     { frames       = atoi(argv[++i]);         }
+            else if(has_value && option == "--warmup")     { warmupFrames = atoi(argv[++i]);         }
+            else if(has_value && option == "--delta")      { deltaTime    = (float)atof(argv[++i]);  }
+            else if(has_value && option == "--effects")    { effects      = argv[++i];               }
+            else if(has_value && option == "--dump")       { dumpPath     = argv[++i];               }
+            else if(has_value && option == "--dump-every") { dumpEvery    = atoi(argv[++i]);         }
+            else if(has_value && option == "--timings")    { timingsPath  = argv[++i];               }
+            else if(has_value && option == "--threads")    { threads      = atoi(argv[++i]);         }
+            else if(has_value && option == "--trace")      { tracePath    = argv[++i];               }
+            else if(has_value && option == "--stats")      { statsPath    = argv[++i];               }
+            else if(has_value && option == "--memory-every") { memoryEvery = atoi(argv[++i]);         }
+            else if(has_value && option == "--cpu-budget")   { cpuBudget   = (float)atof(argv[++i]);  }
+            else if(has_value && option == "--gpu-budget")   { gpuBudget   = (float)atof(argv[++i]);  }
+            else if(has_value && option == "--golden")     { goldenPath   = argv[++i];               }
+            else if(has_value && option == "--report")     { reportPath   = argv[++i];               }
+            else if(has_value && option == "--cases")      { goldenCases  = argv[++i];               }
+            else if(has_value && option == "--tolerance")        { tolerance.maxDeltaE       = (float)atof(argv[++i]); }
+            else if(has_value && option == "--max-failed")       { tolerance.maxFailedPixels = (float)atof(argv[++i]); }
+            else if(has_value && option == "--timing-tolerance") { timingTolerance           = (float)atof(argv[++i]); }
+            else
+            {
+                error = "Unknown option (or without value): " + option;
+            }
+        }
+
+        if(error.empty() && (width <= 0 || height <= 0 || frames <= 0 || warmupFrames < 0 || dumpEvery < 0 || threads < 0 ||
+                             tolerance.maxDeltaE < 0.0f || tolerance.maxFailedPixels < 0.0f || timingTolerance < 0.0f ||
+                             memoryEvery < 0 || cpuBudget < 0.0f || gpuBudget < 0.0f))
+        {
+            error = "The size, the frames, the warmup, the threads, the tolerances and the budgets can't be negative";
+        }
+
+        // A period or a budget shows the report too
+        showMemory = showMemory || memoryEvery > 0 || cpuBudget > 0.0f || gpuBudget > 0.0f;
+
+        if(!goldenPath.empty() && reportPath.empty())
+        {
+            reportPath = goldenPath + "/report.json";
+        }
+
+        // Without a period, only the last frame is dumped
+        if(!dumpPath.empty() && dumpEvery == 0)
+        {
+            dumpEvery = frames;
+        }
+
+        return is_headless;
+    }
+
+    // Creates the context and the View, and draws the frames. Returns the
+    // exit code of the program.
+    int HeadlessRunner::Run()
+    {
+        if(!error.empty())
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+
+        HeadlessContext context;
+        if(!context.Create(width, height))
+        {
+            fprintf(stderr, "Headless context: %s\n", context.GetError().c_str());
+            return EXIT_FAILURE;
+        }
+
+        // GLEW built only for GLX may fail its GLX part without a display,
+        // after the GL functions are already loaded
+        glewExperimental = true;
+        if(glewInit() != GLEW_OK && glGenVertexArrays == NULL)
+        {
+            fprintf(stderr, "Headless context: GLEW can't load the GL functions\n");
+            return EXIT_FAILURE;
+        }
+
+        fprintf(stdout, "%s, %s, %dx%d\n", glGetString(GL_RENDERER), glGetString(GL_VERSION), width, height);
+
+        // The GL context is still used for the queries and the vertex arrays
+        SoftwareRenderDevice* software_device = NULL;
+        if(useSoftware)
+        {
+            software_device = new SoftwareRenderDevice(width, height, threads);
+            RenderDevice::SetCurrent(software_device);
+
+            fprintf(stdout, "Software device, %d threads\n", software_device->GetThreadCount());
+        }
+
+        // The window gets its vertex array from the loading screen
+        GLuint vertex_array;
+        glGenVertexArrays(1, &vertex_array);
+        glBindVertexArray(vertex_array);
+
+        const int result = goldenPath.empty() ? DrawFrames() : RunGolden();
+
+        RenderDevice::SetCurrent(NULL);
+        delete software_device;
+
+        glDeleteVertexArrays(1, &vertex_array);
+
+        return result;
+    }
+
+    // Draws the frames with the effects chosen, and dumps them
+    int HeadlessRunner::DrawFrames()
+    {
+        timings.clear();
+
+        if(!statsPath.empty() && !RenderStats::Get().OpenStream(statsPath))
+        {
+            fprintf(stderr, "Can't write %s\n", statsPath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        const float MEGABYTE = 1024.0f * 1024.0f;
+        MemoryTracker::SetTotalBudgets((size_t)(cpuBudget * MEGABYTE), (size_t)(gpuBudget * MEGABYTE));
+
+        {
+            View view(width, height);
+            view.SetInputsEnabled    (false);
+            view.SetDeferred         (useDeferred);
+            view.SetDynamicResolution(useDynamicResolution);
+
+            for(size_t i = 0; i < effects.size(); ++i)
+            {
+                if(effects[i] >= '0' && effects[i] <= '6')
+                {
+                    view.SwitchEffect(effects[i] - '0');
+                }
+            }
+
+            for(int frame = -warmupFrames; frame < frames; ++frame)
+            {
+                const FrameTiming timing = DrawFrame(view, deltaTime);
+
+                if(frame < 0)
+                {
+                    continue;
+                }
+
+                timings.push_back(timing);
+
+                if(dumpEvery > 0 && (frame + 1) % dumpEvery == 0 && !DumpFrame(frame))
+                {
+                    fprintf(stderr, "Can't dump the frame %d\n", frame);
+                }
+
+                // The last frame is reported after the summary
+                if(memoryEvery > 0 && (frame + 1) % memoryEvery == 0 && frame + 1 < frames)
+                {
+                    fprintf(stdout, "Frame %d\n", frame);
+                    MemoryTracker::WriteReport(stdout);
+                }
+            }
+
+            gpuPasses = view.GetGpuProfiler().GetPassTimes();
+
+            PrintSummary();
+
+            // With the scene still loaded
+            if(showMemory)
+            {
+                MemoryTracker::WriteReport(stdout);
+            }
+        }
+
+        RenderStats::Get().CloseStream();
+
+        if(!timingsPath.empty() && !WriteTimings())
+        {
+            fprintf(stderr, "Can't write %s\n", timingsPath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        if(!tracePath.empty())
+        {
+            #ifdef FLYGL_PROFILING
+                if(!Profiler::WriteChromeTrace(tracePath, frames))
+                {
+                    fprintf(stderr, "Can't write %s\n", tracePath.c_str());
+                    return EXIT_FAILURE;
+                }
+            #else
+                fprintf(stderr, "No trace, the build has no FLYGL_PROFILING\n");
+            #endif
+        }
+
+        if(MemoryTracker::IsOverBudget())
+        {
+            fprintf(stderr, "The memory went over its budget\n");
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    // Runs the golden tests, fails if any of them does
+    int HeadlessRunner::RunGolden() const
+    {
+        GoldenTest test(width, height, deltaTime, goldenPath);
+        test.SetUpdate         (updateGolden);
+        test.SetTolerance      (tolerance);
+        test.SetTimingTolerance(timingTolerance);
+        test.SetCases          (goldenCases);
+
+        return test.Run(reportPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Updates and draws a frame, and waits for the GPU
+    //
+    // view         What is drawn
+    // delta_time   Seconds the Update is given
+    FrameTiming HeadlessRunner::DrawFrame(View& view, const float& delta_time)
+    {
+        sf::Clock clock;
+
+        RenderDevice::Get().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        view.Update(delta_time);
+        view.Draw();
+
+        FrameTiming timing;
+        timing.cpuTime = clock.getElapsedTime().asMicroseconds() / 1000.0f;
+
+        // There is no swap to wait for, so the GPU is waited for here
+        {
+            FLYGL_PROFILE_ZONE("glFinish");
+            glFinish();
+        }
+        FLYGL_PROFILE_FRAME();
+
+        timing.gpuTime     = view.GetGpuFrameTime();
+        timing.wallTime    = clock.getElapsedTime().asMicroseconds() / 1000.0f;
+        timing.renderScale = view.GetRenderScale();
+
+        return timing;
+    }
+
+    // Saves what is on the screen as a binary PPM (prefix + frame number)
+    bool HeadlessRunner::DumpFrame(const int& frame) const
+    {
+        char path[1024];
+        sprintf(path, "%.1000s%05d.ppm", dumpPath.c_str(), frame);
+
+        GoldenImage image;
+        image.ReadScreen(width, height);
+
+        return image.Save(path);
+    }
+
+    // Writes a line with the times of every measured frame
+    bool HeadlessRunner::WriteTimings() const
+    {
+        FILE* file = fopen(timingsPath.c_str(), "w");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        fprintf(file, "frame,cpu_ms,gpu_ms,wall_ms,render_scale\n");
+        for(size_t i = 0; i < timings.size(); ++i)
+        {
+            fprintf(file, "%u,%.4f,%.4f,%.4f,%.2f\n", (unsigned int)i,
+                    timings[i].cpuTime, timings[i].gpuTime, timings[i].wallTime, timings[i].renderScale);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    // Prints the average, the median and the 95th percentile of the times
+    void HeadlessRunner::PrintSummary() const
+    {
+        if(timings.empty())
+        {
+            return;
+        }
+
+        std::vector<float> cpu, gpu, wall;
+        for(size_t i = 0; i < timings.size(); ++i)
+        {
+            cpu. push_back(timings[i].cpuTime );
+            gpu. push_back(timings[i].gpuTime );
+            wall.push_back(timings[i].wallTime);
+        }
+
+        std::vector<float>* times[3] = { &cpu, &gpu, &wall };
+        const char*         names[3] = { "cpu ", "gpu ", "wall" };
+
+        fprintf(stdout, "%u frames (ms)  average  median  95%%\n", (unsigned int)timings.size());
+
+        for(int i = 0; i < 3; ++i)
+        {
+            std::vector<float>& values = *times[i];
+
+            float total = 0.0f;
+            for(size_t j = 0; j < values.size(); ++j)
+            {
+                total += values[j];
+            }
+
+            std::sort(values.begin(), values.end());
+
+            fprintf(stdout, "%s           %7.3f  %6.3f  %6.3f\n", names[i],
+                    total / values.size(), values[values.size() / 2], values[(values.size() * 95) / 100]);
+        }
+
+        fprintf(stdout, "Last frame: %s\n", RenderStats::Get().GetSummary().c_str());
+
+        // The rolling averages of the GPU profiler, not of every frame
+        for(size_t i = 0; i < gpuPasses.size(); ++i)
+        {
+            fprintf(stdout, "  gpu %-20s %7.3f\n", gpuPasses[i].name, gpuPasses[i].averageTime);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/* ---------------------------------------------------------------------------
+** HeadlessRunner.hpp
+** Runs the View without a window, on a HeadlessContext: a fixed number of
+** frames at a chosen resolution, with a fixed time step and the effects
+** chosen on the command line (the keyboard is not read). It can dump the
+** frames as images and the time of every frame as CSV, and prints a summary
+** of the times. It is what the build machines without a GPU run.
+** With --software the frames are drawn by the SoftwareRenderDevice (on
+** --threads threads, 0 for every core): the reference images the GPU is
+** compared with. References should use --fixed-resolution, so both draw
+** at the same size.
+** With --golden it runs the GoldenTest instead, whose options are there.
+** With --trace the zones of the Profiler are saved as a Chrome trace (the
+** build needs FLYGL_PROFILING, see Profiler), and with --stats the counts
+** of every frame (see RenderStats) as CSV, or JSON lines for a .json file.
+** With --memory the MemoryTracker report is printed at the end (and every
+** --memory-every frames), and the run fails if the peak of the heap or of
+** the video memory goes over --cpu-budget or --gpu-budget (megabytes).
+**
+**   FlyEngine --headless [--width 640] [--height 400] [--frames 300]
+**             [--warmup 10] [--delta 0.016667] [--effects 136] [--deferred]
+**             [--fixed-resolution] [--software] [--threads 0]
+**             [--dump frames/frame] [--dump-every 60] [--timings timings.csv]
+**             [--trace trace.json] [--stats stats.csv] [--memory]
+**             [--memory-every 60] [--cpu-budget 64] [--gpu-budget 256]
+**             [--golden golden ...]
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef HEADLESSRUNNER_HEADER
+#define HEADLESSRUNNER_HEADER
+
+#include <string>
+#include <vector>
+
+#include "GoldenImage.hpp"
+#include "GpuProfiler.hpp"
+
+    namespace flygl
+    {
+        class View;
+
+        // The times of a frame, in milliseconds
+        struct FrameTiming
+        {
+        public:
+
+            float cpuTime;      // Update and Draw, without waiting for the GPU
+            float gpuTime;      // The query of the View (a frame late, 0 until it is known)
+            float wallTime;     // Update and Draw until the GPU has finished
+            float renderScale;  // The scale the scene was drawn at
+        };
+
+        class HeadlessRunner
+        {
+        private:
+
+            int         width;
+            int         height;
+            int         frames;
+            int         warmupFrames;   // Drawn before the measured ones, not in the summary
+            float       deltaTime;      // Seconds every Update is given
+            std::string effects;        // Keys of the effects (1 to 6)
+            bool        useDeferred;
+            bool        useDynamicResolution;
+            bool        useSoftware;    // Draw with the SoftwareRenderDevice
+            int         threads;        // Its threads, 0 for one per core
+
+            std::string dumpPath;       // Prefix of the dumped frames, empty for none
+            int         dumpEvery;
+            std::string timingsPath;    // CSV with every frame, empty for none
+            std::string tracePath;      // Chrome trace of the measured frames, empty for none
+            std::string statsPath;      // Render stats of every frame, empty for none
+
+            // The memory report
+            bool        showMemory;
+            int         memoryEvery;    // Frames between reports, 0 for only the last one
+            float       cpuBudget;      // Megabytes of the peak, 0 for no budget
+            float       gpuBudget;
+
+            // The golden tests
+            std::string    goldenPath;      // Directory of the golden images, empty to not run them
+            bool           updateGolden;
+            std::string    reportPath;      // JSON report
+            std::string    goldenCases;
+            ImageTolerance tolerance;
+            float          timingTolerance;
+
+            // Why the arguments are wrong, if they are
+            std::string error;
+
+            std::vector<FrameTiming> timings;
+            std::vector<GpuPassTime> gpuPasses;     // At the end of the frames
+
+        public:
+
+            // Constructor
+            HeadlessRunner():
+                width(640), height(400), frames(300), warmupFrames(10), deltaTime(1.0f / 60.0f),
+                useDeferred(false), useDynamicResolution(true), useSoftware(false), threads(0), dumpEvery(0),
+                showMemory(false), memoryEvery(0), cpuBudget(0.0f), gpuBudget(0.0f),
+                updateGolden(false), timingTolerance(0.0f)
+            {}
+
+            bool ParseArguments(const int& argc, char* argv[]);
+            int  Run();
+
+            const std::vector<FrameTiming>& GetTimings() const
+            {
+                return timings;
+            }
+
+            // Updates and draws a frame, and waits for the GPU
+            static FrameTiming DrawFrame(View& view, const float& delta_time);
+
+        private:
+
+            int  DrawFrames   ();
+            int  RunGolden    () const;
+
+            bool DumpFrame    (const int& frame) const;
+            bool WriteTimings () const;
+            void PrintSummary () const;
+        };
+    }
+
+#endif
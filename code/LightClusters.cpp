@@ -0,0 +1,287 @@
+/* ---------------------------------------------------------------------------
+** LightClusters.cpp
+** Clustered forward lighting. The view frustum is split in a grid of froxels
+** (tiles on screen, exponential slices in depth), and every frame the point
+** lights are assigned to the froxels their sphere of influence touches (a
+** SIMD sphere vs box test, 4 froxels at a time). The indices of the lights
+** of each froxel (in the buffer of the LightManager) and the range of every
+** froxel are uploaded to texture buffers, so the fragment shader only loops
+** over the lights of its own froxel. There is no limit on the number of lights.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "LightClusters.hpp"
+#include "RenderDevice.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+// SSE for the sphere vs box tests
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+    #include <xmmintrin.h>
+    #define FLYGL_CLUSTERS_SSE
+#endif
+
+namespace flygl
+{
+    const GLuint LightClusters::LIGHT_INDICES_UNIT;
+    const GLuint LightClusters::CLUSTERS_UNIT;
+
+    // Froxels in a slice
+    static const int SLICE_SIZE = LightClusters::GRID_X * LightClusters::GRID_Y;
+
+    // Creates the buffers. Call it once there is a GL context.
+    void LightClusters::Initialize()
+    {
+        CreateBufferTexture(lightIndicesBuffer, lightIndicesTexture, GL_R32UI  );
+        CreateBufferTexture(clustersBuffer,     clustersTexture,     GL_RG32UI );
+
+        clusterRanges.resize(CLUSTER_COUNT * 2);
+        clusterCounts.resize(CLUSTER_COUNT);
+    }
+
+    // Assigns the lights to the froxels and uploads everything
+    //
+    // lights               The uploaded lights of the scene
+    // view_matrix          The camera
+    // projection_matrix    The projection of the camera (the froxels are rebuilt if it changes)
+    // near_plane           Near plane of the projection
+    // far_plane            Far plane of the projection
+    // width                Width of the render target, in pixels
+    // height               Height of the render target, in pixels
+    void LightClusters::Update(
+        const LightManager& lights, const glm::mat4& view_matrix, const glm::mat4& projection_matrix,
+        const float& near_plane, const float& far_plane, const int& width, const int& height)
+    {
+        if(minX.empty() || projection_matrix != projection || near_plane != nearPlane || far_plane != farPlane)
+        {
+            BuildBoxes(projection_matrix, near_plane, far_plane);
+        }
+
+        clusterScale = glm::vec2(float(GRID_X) / width, float(GRID_Y) / height);
+
+        hits.clear();
+        std::fill(clusterCounts.begin(), clusterCounts.end(), 0);
+
+        visibleLights = 0;
+
+        const std::vector<GLfloat>& light_data = lights.GetLightData();
+
+        for(GLuint light = 0; light < lights.GetLightCount(); ++light)
+        {
+            const GLfloat*  data   = &light_data[light * LightManager::LIGHT_SIZE];
+            const glm::vec3 center = glm::vec3(view_matrix * glm::vec4(data[0], data[1], data[2], 1.0f));
+            const float     radius = data[3];
+
+            // Completely behind the camera or beyond the far plane
+            if(-center.z + radius < nearPlane || -center.z - radius > farPlane)
+            {
+                continue;
+            }
+
+            const size_t before = hits.size();
+
+            AssignLight(light, center, radius);
+
+            if(hits.size() != before)
+            {
+                visibleLights++;
+            }
+        }
+
+        // Ranges of every froxel, and the lights sorted by froxel
+        GLuint offset = 0;
+        for(int i = 0; i < CLUSTER_COUNT; ++i)
+        {
+            clusterRanges[i * 2    ] = offset;
+            clusterRanges[i * 2 + 1] = 0;
+            offset += clusterCounts[i];
+        }
+
+        lightIndices.resize(offset);
+        for(size_t i = 0; i < hits.size(); i += 2)
+        {
+            GLuint* range = &clusterRanges[hits[i] * 2];
+            lightIndices[range[0] + range[1]++] = hits[i + 1];
+        }
+
+        Upload();
+    }
+
+    // Binds the buffers on their units
+    void LightClusters::Bind() const
+    {
+        RenderDevice& device = RenderDevice::Get();
+
+        device.BindTexture(LIGHT_INDICES_UNIT, GL_TEXTURE_BUFFER, lightIndicesTexture);
+        device.BindTexture(CLUSTERS_UNIT,      GL_TEXTURE_BUFFER, clustersTexture    );
+    }
+
+    // Computes the view space box of every froxel. The corners of a froxel
+    // are on the rays through its tile, at the depths of its slice.
+    void LightClusters::BuildBoxes(const glm::mat4& projection_matrix, const float& near_plane, const float& far_plane)
+    {
+        projection = projection_matrix;
+        nearPlane  = near_plane;
+        farPlane   = far_plane;
+
+        // Exponential slices: slice = log(depth / near) / log(far / near) * GRID_Z
+        const float depth_scale = GRID_Z / std::log(farPlane / nearPlane);
+        clusterDepth = glm::vec2(depth_scale, -std::log(nearPlane) * depth_scale);
+
+        minX.resize(CLUSTER_COUNT); minY.resize(CLUSTER_COUNT); minZ.resize(CLUSTER_COUNT);
+        maxX.resize(CLUSTER_COUNT); maxY.resize(CLUSTER_COUNT); maxZ.resize(CLUSTER_COUNT);
+
+        // From NDC to view space at depth 1
+        const float x_scale = 1.0f / projection[0][0];
+        const float y_scale = 1.0f / projection[1][1];
+
+        for(int z = 0; z < GRID_Z; ++z)
+        {
+            const float slice_near = nearPlane * std::pow(farPlane / nearPlane, float(z    ) / GRID_Z);
+            const float slice_far  = nearPlane * std::pow(farPlane / nearPlane, float(z + 1) / GRID_Z);
+
+            for(int y = 0; y < GRID_Y; ++y)
+            {
+                const float y0 = (-1.0f + 2.0f *  y      / GRID_Y) * y_scale;
+                const float y1 = (-1.0f + 2.0f * (y + 1) / GRID_Y) * y_scale;
+
+                for(int x = 0; x < GRID_X; ++x)
+                {
+                    const float x0 = (-1.0f + 2.0f *  x      / GRID_X) * x_scale;
+                    const float x1 = (-1.0f + 2.0f * (x + 1) / GRID_X) * x_scale;
+
+                    const int i = (z * GRID_Y + y) * GRID_X + x;
+
+                    // The sides are linear in depth, the extremes are on the near or far side
+                    minX[i] = std::min(x0 * slice_near, x0 * slice_far);
+                    maxX[i] = std::max(x1 * slice_near, x1 * slice_far);
+                    minY[i] = std::min(y0 * slice_near, y0 * slice_far);
+                    maxY[i] = std::max(y1 * slice_near, y1 * slice_far);
+                    minZ[i] = -slice_far;
+                    maxZ[i] = -slice_near;
+                }
+            }
+        }
+    }
+
+    // Tests the sphere against the froxels of the slices it spans, and
+    // stores the ones it touches
+    //
+    // light    Index of the light in the buffer of the LightManager
+    // center   View space center of the sphere
+    // radius   Radius of the sphere
+    void LightClusters::AssignLight(const GLuint& light, const glm::vec3& center, const float& radius)
+    {
+        const int first_slice = GetSlice(-center.z - radius);
+        const int last_slice  = GetSlice(-center.z + radius);
+        const float radius_squared = radius * radius;
+
+#ifdef FLYGL_CLUSTERS_SSE
+        const __m128 center_x = _mm_set1_ps(center.x);
+        const __m128 center_y = _mm_set1_ps(center.y);
+        const __m128 center_z = _mm_set1_ps(center.z);
+        const __m128 radius2  = _mm_set1_ps(radius_squared);
+        const __m128 zero     = _mm_setzero_ps();
+#endif
+
+        for(int slice = first_slice; slice <= last_slice; ++slice)
+        {
+            const int start = slice * SLICE_SIZE;
+
+            for(int i = start; i < start + SLICE_SIZE; i += 4)
+            {
+                int mask;
+
+#ifdef FLYGL_CLUSTERS_SSE
+                // Distance from the center to the box, on every axis (0 if inside)
+                const __m128 dx = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minX[i]), center_x), _mm_sub_ps(center_x, _mm_loadu_ps(&maxX[i]))));
+                const __m128 dy = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minY[i]), center_y), _mm_sub_ps(center_y, _mm_loadu_ps(&maxY[i]))));
+                const __m128 dz = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&minZ[i]), center_z), _mm_sub_ps(center_z, _mm_loadu_ps(&maxZ[i]))));
+
+                const __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                mask = _mm_movemask_ps(_mm_cmple_ps(distance2, radius2));
+#else
+                mask = 0;
+                for(int j = 0; j < 4; ++j)
+                {
+                    const float dx = std::max(0.0f, std::max(minX[i + j] - center.x, center.x - maxX[i + j]));
+                    const float dy = std::max(0.0f, std::max(minY[i + j] - center.y, center.y - maxY[i + j]));
+                    const float dz = std::max(0.0f, std::max(minZ[i + j] - center.z, center.z - maxZ[i + j]));
+                    if(dx * dx + dy * dy + dz * dz <= radius_squared)
+                    {
+                        mask |= 1 << j;
+                    }
+                }
+#endif
+
+                for(int j = 0; mask != 0; ++j, mask >>= 1)
+                {
+                    if(mask & 1)
+                    {
+                        hits.push_back(i + j);
+                        hits.push_back(light);
+                        clusterCounts[i + j]++;
+                    }
+                }
+            }
+        }
+    }
+
+    // The slice of a view depth (positive), clamped to the grid
+    int LightClusters::GetSlice(const float& depth) const
+    {
+        if(depth <= nearPlane)
+        {
+            return 0;
+        }
+
+        const int slice = int(std::log(depth) * clusterDepth.x + clusterDepth.y);
+        return std::min(GRID_Z - 1, std::max(0, slice));
+    }
+
+    // Sets the sampler uniforms of a shader that uses the clusters (it must be in use)
+    void LightClusters::SetSamplers(const GLuint& program)
+    {
+        static const char* NAMES[] = { "lightData", "lightIndices", "lightClusters" };
+        const GLint        UNITS[] = { LightManager::LIGHT_DATA_UNIT, LIGHT_INDICES_UNIT, CLUSTERS_UNIT };
+
+        RenderDevice& device = RenderDevice::Get();
+
+        for(int i = 0; i < 3; ++i)
+        {
+            device.SetUniform(device.GetUniformLocation(program, NAMES[i]), UNIFORM_INT, 1, &UNITS[i]);
+        }
+    }
+
+    // Sends the CPU copies to the buffers
+    void LightClusters::Upload()
+    {
+        UploadBuffer(lightIndicesBuffer, lightIndices.size()  * sizeof(GLuint),  lightIndices.empty() ? NULL : &lightIndices[0]);
+        UploadBuffer(clustersBuffer,     clusterRanges.size() * sizeof(GLuint),  &clusterRanges[0]);
+    }
+
+    // A buffer with a texture over it, so shaders can texelFetch it
+    void LightClusters::CreateBufferTexture(GLuint& buffer, GLuint& texture, const GLenum& format)
+    {
+        RenderDevice& device = RenderDevice::Get();
+
+        buffer  = device.CreateBuffer       (GL_TEXTURE_BUFFER, NULL, 16, GL_STREAM_DRAW);
+        texture = device.CreateBufferTexture(buffer, format);
+    }
+
+    // Replaces the contents of a buffer. The old storage is orphaned, so we
+    // don't wait for the frames that are still using it.
+    void LightClusters::UploadBuffer(const GLuint& buffer, const size_t& size, const void* data)
+    {
+        RenderDevice& device = RenderDevice::Get();
+
+        device.SetBufferData(buffer, GL_TEXTURE_BUFFER, NULL, std::max(size, (size_t)16), GL_STREAM_DRAW);
+
+        if(size > 0)
+        {
+            device.UpdateBuffer(buffer, GL_TEXTURE_BUFFER, 0, data, size);
+        }
+    }
+}
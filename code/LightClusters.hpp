@@ -0,0 +1,138 @@
+/* ---------------------------------------------------------------------------
+** LightClusters.hpp
+** Clustered forward lighting. The view frustum is split in a grid of froxels
+** (tiles on screen, exponential slices in depth), and every frame the point
+** lights are assigned to the froxels their sphere of influence touches (a
+** SIMD sphere vs box test, 4 froxels at a time). The indices of the lights
+** of each froxel (in the buffer of the LightManager) and the range of every
+** froxel are uploaded to texture buffers, so the fragment shader only loops
+** over the lights of its own froxel. There is no limit on the number of lights.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef LIGHTCLUSTERS_HEADER
+#define LIGHTCLUSTERS_HEADER
+
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "LightManager.hpp"
+
+    namespace flygl
+    {
+        class LightClusters
+        {
+        public:
+
+            // Froxels of the grid
+            static const int GRID_X = 16;
+            static const int GRID_Y = 9;
+            static const int GRID_Z = 24;
+            static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+            // Texture units of the buffers (the lights are on LightManager::LIGHT_DATA_UNIT)
+            static const GLuint LIGHT_INDICES_UNIT = 9;
+            static const GLuint CLUSTERS_UNIT      = 10;
+
+        private:
+
+            // Boxes of the froxels in view space, one array per coordinate
+            // (so 4 of them can be tested at once). A slice is GRID_X * GRID_Y
+            // froxels, a multiple of 4.
+            std::vector<float> minX, minY, minZ;
+            std::vector<float> maxX, maxY, maxZ;
+
+            // The projection the boxes were built for
+            glm::mat4 projection;
+            float     nearPlane;
+            float     farPlane;
+
+            // CPU copies of what goes to the GPU
+            std::vector<GLuint>  lightIndices;
+            std::vector<GLuint>  clusterRanges;      // Offset + count per froxel
+            std::vector<GLuint>  clusterCounts;
+            std::vector<GLuint>  hits;               // Froxel and light of every assignment
+
+            // Buffers and the texture views over them
+            GLuint lightIndicesBuffer, lightIndicesTexture;
+            GLuint clustersBuffer,     clustersTexture;
+
+            // Uniforms the shader needs to find its froxel
+            glm::vec2 clusterScale;     // Froxels per pixel
+            glm::vec2 clusterDepth;     // slice = log(depth) * x + y
+
+            int visibleLights;
+
+        public:
+
+            // Constructor
+            LightClusters(): nearPlane(0.0f), farPlane(0.0f),
+                lightIndicesBuffer(0), lightIndicesTexture(0),
+                clustersBuffer(0),     clustersTexture(0),
+                visibleLights(0)
+            {}
+
+            // Destructor
+            ~LightClusters()
+            {
+                RenderDevice& device = RenderDevice::Get();
+                device.DeleteTexture(lightIndicesTexture);
+                device.DeleteTexture(clustersTexture    );
+                device.DeleteBuffer (lightIndicesBuffer );
+                device.DeleteBuffer (clustersBuffer     );
+            }
+
+            void Initialize();
+
+            void Update(
+                const LightManager& lights, const glm::mat4& view_matrix, const glm::mat4& projection_matrix,
+                const float& near_plane, const float& far_plane, const int& width, const int& height);
+
+            void Bind() const;
+
+            // Sets the sampler uniforms of a shader that uses the clusters (it must be in use)
+            static void SetSamplers(const GLuint& program);
+
+            // Froxels per pixel, on X and Y
+            const glm::vec2& GetScale() const
+            {
+                return clusterScale;
+            }
+
+            // To compute the slice from the view depth: log(depth) * x + y
+            const glm::vec2& GetDepthParameters() const
+            {
+                return clusterDepth;
+            }
+
+            // Lights that touch some froxel this frame
+            int GetVisibleLightCount() const
+            {
+                return visibleLights;
+            }
+
+            // Light and froxel pairs of this frame
+            size_t GetAssignmentCount() const
+            {
+                return lightIndices.size();
+            }
+
+        private:
+
+            void BuildBoxes    (const glm::mat4& projection_matrix, const float& near_plane, const float& far_plane);
+            void AssignLight   (const GLuint& light, const glm::vec3& center, const float& radius);
+            int  GetSlice      (const float& depth) const;
+            void Upload        ();
+
+            static void CreateBufferTexture(GLuint& buffer, GLuint& texture, const GLenum& format);
+            static void UploadBuffer       (const GLuint& buffer, const size_t& size, const void* data);
+        };
+    }
+
+#endif
@@ -0,0 +1,222 @@
+/* ---------------------------------------------------------------------------
+** LightManager.cpp
+** The registry of the point lights of the scene. Lights register and
+** unregister themselves at any time, and tell the manager when they change.
+** Only the lights that light something (enabled, with some intensity and
+** color) are packed in a persistent GPU buffer, and every frame only the
+** ones that changed are written again.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "LightManager.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace flygl
+{
+    const float LightManager::LIGHT_CUTOFF = 1.0f / 255.0f;
+
+    const GLuint LightManager::LIGHT_DATA_UNIT;
+
+    // Lights the buffer has room for at the beginning
+    static const size_t INITIAL_CAPACITY = 64;
+
+    // Creates the buffer. Call it once there is a GL context.
+    void LightManager::Initialize()
+    {
+        capacity = INITIAL_CAPACITY;
+
+        RenderDevice& device = RenderDevice::Get();
+
+        lightBuffer  = device.CreateBuffer       (GL_TEXTURE_BUFFER, NULL, capacity * LIGHT_SIZE * sizeof(GLfloat), GL_DYNAMIC_DRAW);
+        lightTexture = device.CreateBufferTexture(lightBuffer, GL_RGBA32F);
+    }
+
+    // Adds a light to the scene. It is uploaded on the next update.
+    void LightManager::Register(PointLight* light)
+    {
+        if(light->changedLights != NULL)
+        {
+            return;
+        }
+
+        light->registryIndex = lights.size();
+        light->changedLights = &changedLights;
+        lights.push_back(light);
+
+        light->isDirty = false;
+        light->MarkDirty();
+    }
+
+    // Removes a light from the scene
+    void LightManager::Unregister(PointLight* light)
+    {
+        if(light->changedLights != &changedLights)
+        {
+            return;
+        }
+
+        if(light->packedIndex >= 0)
+        {
+            Unpack(light);
+        }
+
+        if(light->isDirty)
+        {
+            changedLights.erase(std::find(changedLights.begin(), changedLights.end(), light));
+        }
+
+        // The last one takes its place
+        PointLight* last = lights.back();
+        lights[light->registryIndex] = last;
+        last->registryIndex = light->registryIndex;
+        lights.pop_back();
+
+        light->changedLights = NULL;
+        light->registryIndex = -1;
+        light->isDirty       = false;
+    }
+
+    // Packs the lights that changed, and uploads the slots that are different
+    void LightManager::Update()
+    {
+        lastChangedCount = changedLights.size();
+
+        for(size_t i = 0; i < changedLights.size(); ++i)
+        {
+            PointLight* light = changedLights[i];
+            light->isDirty = false;
+
+            if(light->IsLighting())
+            {
+                if(light->packedIndex < 0)
+                {
+                    Pack(light);
+                }
+                else
+                {
+                    WriteSlot(light->packedIndex);
+                }
+            }
+            else if(light->packedIndex >= 0)
+            {
+                Unpack(light);
+            }
+        }
+
+        changedLights.clear();
+
+        Upload();
+    }
+
+    // Adds a light at the end of the uploaded ones
+    void LightManager::Pack(PointLight* light)
+    {
+        light->packedIndex = packedLights.size();
+        packedLights.push_back(light);
+        packedData.resize(packedLights.size() * LIGHT_SIZE);
+
+        WriteSlot(light->packedIndex);
+    }
+
+    // Removes a light from the uploaded ones. The last one takes its place.
+    void LightManager::Unpack(PointLight* light)
+    {
+        const GLuint slot = light->packedIndex;
+        PointLight*  last = packedLights.back();
+
+        packedLights[slot] = last;
+        last->packedIndex  = slot;
+        light->packedIndex = -1;
+
+        packedLights.pop_back();
+
+        if(last != light)
+        {
+            WriteSlot(slot);
+        }
+
+        packedData.resize(packedLights.size() * LIGHT_SIZE);
+    }
+
+    // Writes the CPU copy of a slot with the data of its light
+    void LightManager::WriteSlot(const GLuint& slot)
+    {
+        const PointLight* light     = packedLights[slot];
+        const glm::vec3   position  = light->GetPosition();
+        const glm::vec3   color     = light->GetColor();
+        const float       intensity = light->GetIntensity();
+
+        // Where the light adds less than the cutoff (1 / d^2 attenuation)
+        const float brightness = intensity * std::max(color.x, std::max(color.y, color.z));
+        const float radius     = std::sqrt(brightness / LIGHT_CUTOFF);
+
+        GLfloat* data = &packedData[slot * LIGHT_SIZE];
+        data[0] = position.x;
+        data[1] = position.y;
+        data[2] = position.z;
+        data[3] = radius;
+        data[4] = color.x;
+        data[5] = color.y;
+        data[6] = color.z;
+        data[7] = intensity;
+
+        dirtySlots.push_back(slot);
+    }
+
+    // Sends the dirty slots to the GPU, joining the consecutive ones. If the
+    // buffer is too small it is grown, and everything is sent.
+    void LightManager::Upload()
+    {
+        if(dirtySlots.empty())
+        {
+            return;
+        }
+
+        RenderDevice& device = RenderDevice::Get();
+
+        if(packedLights.size() > capacity)
+        {
+            while(capacity < packedLights.size())
+            {
+                capacity *= 2;
+            }
+
+            device.SetBufferData(lightBuffer, GL_TEXTURE_BUFFER, NULL, capacity * LIGHT_SIZE * sizeof(GLfloat), GL_DYNAMIC_DRAW);
+            device.UpdateBuffer (lightBuffer, GL_TEXTURE_BUFFER, 0, &packedData[0], packedData.size() * sizeof(GLfloat));
+
+            dirtySlots.clear();
+            return;
+        }
+
+        std::sort(dirtySlots.begin(), dirtySlots.end());
+
+        const size_t slot_bytes = LIGHT_SIZE * sizeof(GLfloat);
+
+        for(size_t i = 0; i < dirtySlots.size(); )
+        {
+            // A removed light may have left a slot beyond the end
+            if(dirtySlots[i] >= packedLights.size())
+            {
+                break;
+            }
+
+            size_t end = i + 1;
+            while(end < dirtySlots.size() && dirtySlots[end] <= dirtySlots[end - 1] + 1 && dirtySlots[end] < packedLights.size())
+            {
+                end++;
+            }
+
+            const GLuint first = dirtySlots[i];
+            const GLuint last  = dirtySlots[end - 1];
+
+            device.UpdateBuffer(lightBuffer, GL_TEXTURE_BUFFER, first * slot_bytes, &packedData[first * LIGHT_SIZE], (last - first + 1) * slot_bytes);
+
+            i = end;
+        }
+
+        dirtySlots.clear();
+    }
+}
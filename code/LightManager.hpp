@@ -0,0 +1,121 @@
+/* ---------------------------------------------------------------------------
+** LightManager.hpp
+** The registry of the point lights of the scene. Lights register and
+** unregister themselves at any time, and tell the manager when they change.
+** Only the lights that light something (enabled, with some intensity and
+** color) are packed in a persistent GPU buffer, and every frame only the
+** ones that changed are written again.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef LIGHTMANAGER_HEADER
+#define LIGHTMANAGER_HEADER
+
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+#include "PointLight.hpp"
+#include "RenderDevice.hpp"
+
+    namespace flygl
+    {
+        class LightManager
+        {
+        public:
+
+            // Texture unit of the buffer (the materials use the first ones)
+            static const GLuint LIGHT_DATA_UNIT = 8;
+
+            // Floats per light: world position + radius, color + intensity
+            static const int LIGHT_SIZE = 8;
+
+            // A light stops at the distance where it adds less than this
+            static const float LIGHT_CUTOFF;
+
+        private:
+
+            // Every registered light, and the ones that changed since the last update
+            std::vector<PointLight*> lights;
+            std::vector<PointLight*> changedLights;
+
+            // The uploaded lights, and a CPU copy of the buffer
+            std::vector<PointLight*> packedLights;
+            std::vector<GLfloat>     packedData;
+
+            // Slots of the buffer that have to be written again
+            std::vector<GLuint> dirtySlots;
+
+            GLuint lightBuffer;
+            GLuint lightTexture;
+            size_t capacity;            // Lights that fit in the buffer
+
+            size_t lastChangedCount;
+
+        public:
+
+            // Constructor
+            LightManager(): lightBuffer(0), lightTexture(0), capacity(0), lastChangedCount(0)
+            {}
+
+            // Destructor
+            ~LightManager()
+            {
+                while(!lights.empty())
+                {
+                    Unregister(lights.back());
+                }
+
+                RenderDevice::Get().DeleteTexture(lightTexture);
+                RenderDevice::Get().DeleteBuffer (lightBuffer );
+            }
+
+            void Initialize();
+
+            void Register  (PointLight* light);
+            void Unregister(PointLight* light);
+
+            void Update();
+
+            // Binds the buffer on its unit
+            void Bind() const
+            {
+                RenderDevice::Get().BindTexture(LIGHT_DATA_UNIT, GL_TEXTURE_BUFFER, lightTexture);
+            }
+
+            // Number of uploaded lights
+            size_t GetLightCount() const
+            {
+                return packedLights.size();
+            }
+
+            // LIGHT_SIZE floats per uploaded light, in the same order as the GPU buffer
+            const std::vector<GLfloat>& GetLightData() const
+            {
+                return packedData;
+            }
+
+            // Number of registered lights (uploaded or not)
+            size_t GetRegisteredCount() const
+            {
+                return lights.size();
+            }
+
+            // Lights that changed on the last update
+            size_t GetChangedCount() const
+            {
+                return lastChangedCount;
+            }
+
+        private:
+
+            void Pack  (PointLight* light);
+            void Unpack(PointLight* light);
+            void WriteSlot(const GLuint& slot);
+            void Upload();
+        };
+    }
+
+#endif
@@ -0,0 +1,124 @@
+/* ---------------------------------------------------------------------------
+** MappedFile.cpp
+** A read only file mapped in memory, so decoders can read it directly
+** without copying it to a buffer first.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace flygl
+{
+    // Maps the whole file. Empty files can't be mapped.
+    //
+    // path     The path route of the file
+    bool MappedFile::Open(const std::string& path)
+    {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if(file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        fileHandle = file;
+
+        LARGE_INTEGER file_size;
+        if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        {
+            Close();
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(mapping == NULL)
+        {
+            Close();
+            return false;
+        }
+        mappingHandle = mapping;
+
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = (size_t)file_size.QuadPart;
+#else
+        fileDescriptor = open(path.c_str(), O_RDONLY);
+        if(fileDescriptor < 0)
+        {
+            return false;
+        }
+
+        struct stat file_stat;
+        if(fstat(fileDescriptor, &file_stat) != 0 || file_stat.st_size == 0)
+        {
+            Close();
+            return false;
+        }
+
+        void* view = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if(view != MAP_FAILED)
+        {
+            data = (const unsigned char*)view;
+            size = (size_t)file_stat.st_size;
+
+            // It is read once, from the beginning to the end
+            madvise(view, size, MADV_SEQUENTIAL);
+        }
+#endif
+
+        if(data == NULL)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Unmaps the file
+    void MappedFile::Close()
+    {
+#ifdef _WIN32
+        if(data != NULL)
+        {
+            UnmapViewOfFile(data);
+        }
+        if(mappingHandle != NULL)
+        {
+            CloseHandle((HANDLE)mappingHandle);
+        }
+        if(fileHandle != NULL)
+        {
+            CloseHandle((HANDLE)fileHandle);
+        }
+#else
+        if(data != NULL)
+        {
+            munmap((void*)data, size);
+        }
+        if(fileDescriptor >= 0)
+        {
+            close(fileDescriptor);
+        }
+#endif
+
+        data           = NULL;
+        size           = 0;
+        fileHandle     = NULL;
+        mappingHandle  = NULL;
+        fileDescriptor = -1;
+    }
+}
@@ -0,0 +1,64 @@
+/* ---------------------------------------------------------------------------
+** MappedFile.hpp
+** A read only file mapped in memory, so decoders can read it directly
+** without copying it to a buffer first.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef MAPPEDFILE_HEADER
+#define MAPPEDFILE_HEADER
+
+#include <string>
+#include <cstddef>
+
+    namespace flygl
+    {
+        class MappedFile
+        {
+        private:
+
+            const unsigned char* data;
+            size_t               size;
+
+            // Handles of the file and the mapping (Windows), or the descriptor
+            void* fileHandle;
+            void* mappingHandle;
+            int   fileDescriptor;
+
+        public:
+
+            // Constructor
+            MappedFile(): data(NULL), size(0), fileHandle(NULL), mappingHandle(NULL), fileDescriptor(-1)
+            {}
+
+            // Destructor
+            ~MappedFile()
+            {
+                Close();
+            }
+
+            bool Open (const std::string& path);
+            void Close();
+
+            // The contents of the file (NULL if it is not open)
+            const unsigned char* GetData() const
+            {
+                return data;
+            }
+
+            // Bytes of the file
+            size_t GetSize() const
+            {
+                return size;
+            }
+
+        private:
+
+            // Not copyable, it owns the mapping
+            MappedFile(const MappedFile&);
+            MappedFile& operator=(const MappedFile&);
+        };
+    }
+
+#endif
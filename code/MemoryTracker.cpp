@@ -0,0 +1,426 @@
+/* ---------------------------------------------------------------------------
+** MemoryTracker.cpp
+** The counters of every tag and kind of resource, the report, and the
+** operators new and delete that count the heap (with FLYGL_MEMORY_TRACKING).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "MemoryTracker.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// The same as the one of the Profiler, without its includes
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #ifndef FLYGL_THREAD_LOCAL
+        #define FLYGL_THREAD_LOCAL __declspec(thread)
+    #endif
+#else
+    #ifndef FLYGL_THREAD_LOCAL
+        #define FLYGL_THREAD_LOCAL __thread
+    #endif
+#endif
+
+namespace flygl
+{
+    // Bytes alive, their peak and the allocations alive. They are only
+    // plain integers, so they are ready before the first new (the
+    // constructors of other statics allocate too).
+    struct MemoryCounter
+    {
+    public:
+
+        volatile long long liveBytes;
+        volatile long long peakBytes;
+        volatile long long liveCount;
+        size_t             budget;
+    };
+
+    static MemoryCounter heapCounters[MEMORY_TAG_COUNT];
+    static MemoryCounter gpuCounters [GPU_RESOURCE_COUNT];
+    static MemoryCounter heapTotal;
+    static MemoryCounter gpuTotal;
+
+    static FLYGL_THREAD_LOCAL int currentTag = MEMORY_OTHER;
+
+    static const char* TAG_NAMES[MEMORY_TAG_COUNT] =
+    {
+        "other", "loading", "meshes", "textures", "shaders", "postprocess"
+    };
+
+    static const char* RESOURCE_NAMES[GPU_RESOURCE_COUNT] =
+    {
+        "buffers", "textures", "render targets", "programs"
+    };
+
+    // Returns the value there was
+    static long long CompareExchange(volatile long long& value, const long long& new_value, const long long& expected)
+    {
+        #if defined(_MSC_VER)
+            return _InterlockedCompareExchange64(&value, new_value, expected);
+        #else
+            return __sync_val_compare_and_swap(&value, expected, new_value);
+        #endif
+    }
+
+    // Returns the new value
+    static long long AtomicAdd(volatile long long& value, const long long& amount)
+    {
+        #if defined(_MSC_VER)
+            long long old_value = value;
+            long long seen;
+            while((seen = CompareExchange(value, old_value + amount, old_value)) != old_value)
+            {
+                old_value = seen;
+            }
+            return old_value + amount;
+        #else
+            return __sync_add_and_fetch(&value, amount);
+        #endif
+    }
+
+    // Raises the peak to the value, if it is higher (other threads may be raising it too)
+    static void AtomicMax(volatile long long& peak, const long long& value)
+    {
+        long long old_peak = peak;
+        while(value > old_peak)
+        {
+            const long long seen = CompareExchange(peak, value, old_peak);
+            if(seen == old_peak)
+            {
+                break;
+            }
+            old_peak = seen;
+        }
+    }
+
+    // bytes    Negative when it is freed
+    static void Count(MemoryCounter& counter, const long long& bytes, const long long& count)
+    {
+        const long long live = AtomicAdd(counter.liveBytes, bytes);
+        AtomicAdd(counter.liveCount, count);
+
+        if(bytes > 0)
+        {
+            AtomicMax(counter.peakBytes, live);
+        }
+    }
+
+    static MemoryUsage GetUsage(const MemoryCounter& counter)
+    {
+        MemoryUsage usage;
+        usage.liveBytes = counter.liveBytes > 0 ? (size_t)counter.liveBytes : 0;
+        usage.peakBytes = (size_t)counter.peakBytes;
+        usage.liveCount = counter.liveCount > 0 ? (size_t)counter.liveCount : 0;
+        usage.budget    = counter.budget;
+
+        return usage;
+    }
+
+    static bool IsOver(const MemoryCounter& counter)
+    {
+        return counter.budget > 0 && (size_t)counter.peakBytes > counter.budget;
+    }
+
+    static void WriteLine(FILE* file, const char* kind, const char* name, const MemoryCounter& counter)
+    {
+        const float MEGABYTE = 1024.0f * 1024.0f;
+
+        const MemoryUsage usage = GetUsage(counter);
+
+        fprintf(file, "  %-4s %-15s %10.2f %10.2f %8u", kind, name,
+                usage.liveBytes / MEGABYTE, usage.peakBytes / MEGABYTE, (unsigned int)usage.liveCount);
+
+        if(usage.budget > 0)
+        {
+            fprintf(file, " %10.2f%s", usage.budget / MEGABYTE, IsOver(counter) ? "  over budget" : "");
+        }
+        fprintf(file, "\n");
+    }
+
+    bool MemoryTracker::IsHeapTracked()
+    {
+        #ifdef FLYGL_MEMORY_TRACKING
+            return true;
+        #else
+            return false;
+        #endif
+    }
+
+    MemoryTag MemoryTracker::GetTag()
+    {
+        return (MemoryTag)currentTag;
+    }
+
+    void MemoryTracker::SetTag(const MemoryTag& tag)
+    {
+        currentTag = tag;
+    }
+
+    // tag      What the memory is used for
+    // bytes    Size of the block
+    void MemoryTracker::AddAllocation(const MemoryTag& tag, const size_t& bytes)
+    {
+        Count(heapCounters[tag], (long long)bytes, 1);
+        Count(heapTotal,         (long long)bytes, 1);
+    }
+
+    // tag      The one it was added with
+    // bytes    Size of the block
+    void MemoryTracker::RemoveAllocation(const MemoryTag& tag, const size_t& bytes)
+    {
+        Count(heapCounters[tag], -(long long)bytes, -1);
+        Count(heapTotal,         -(long long)bytes, -1);
+    }
+
+    void MemoryTracker::AddGpuResource(const GpuResource& resource, const size_t& bytes)
+    {
+        Count(gpuCounters[resource], (long long)bytes, 1);
+        Count(gpuTotal,              (long long)bytes, 1);
+    }
+
+    void MemoryTracker::RemoveGpuResource(const GpuResource& resource, const size_t& bytes)
+    {
+        Count(gpuCounters[resource], -(long long)bytes, -1);
+        Count(gpuTotal,              -(long long)bytes, -1);
+    }
+
+    // The data of a resource that already exists is redefined
+    void MemoryTracker::ResizeGpuResource(const GpuResource& resource, const size_t& old_bytes, const size_t& new_bytes)
+    {
+        const long long bytes = (long long)new_bytes - (long long)old_bytes;
+
+        Count(gpuCounters[resource], bytes, 0);
+        Count(gpuTotal,              bytes, 0);
+    }
+
+    // The budgets and the peaks are kept
+    void MemoryTracker::ResetGpu()
+    {
+        for(int i = 0; i < GPU_RESOURCE_COUNT; ++i)
+        {
+            gpuCounters[i].liveBytes = 0;
+            gpuCounters[i].liveCount = 0;
+        }
+
+        gpuTotal.liveBytes = 0;
+        gpuTotal.liveCount = 0;
+    }
+
+    MemoryUsage MemoryTracker::GetHeapUsage(const MemoryTag& tag)
+    {
+        return GetUsage(heapCounters[tag]);
+    }
+
+    MemoryUsage MemoryTracker::GetGpuUsage(const GpuResource& resource)
+    {
+        return GetUsage(gpuCounters[resource]);
+    }
+
+    MemoryUsage MemoryTracker::GetHeapTotal()
+    {
+        return GetUsage(heapTotal);
+    }
+
+    MemoryUsage MemoryTracker::GetGpuTotal()
+    {
+        return GetUsage(gpuTotal);
+    }
+
+    void MemoryTracker::SetHeapBudget(const MemoryTag& tag, const size_t& bytes)
+    {
+        heapCounters[tag].budget = bytes;
+    }
+
+    void MemoryTracker::SetGpuBudget(const GpuResource& resource, const size_t& bytes)
+    {
+        gpuCounters[resource].budget = bytes;
+    }
+
+    // Of every tag and of every kind of resource together
+    void MemoryTracker::SetTotalBudgets(const size_t& heap_bytes, const size_t& gpu_bytes)
+    {
+        heapTotal.budget = heap_bytes;
+        gpuTotal .budget = gpu_bytes;
+    }
+
+    bool MemoryTracker::IsOverBudget()
+    {
+        bool is_over = IsOver(heapTotal) || IsOver(gpuTotal);
+
+        for(int i = 0; i < MEMORY_TAG_COUNT; ++i)
+        {
+            is_over = is_over || IsOver(heapCounters[i]);
+        }
+
+        for(int i = 0; i < GPU_RESOURCE_COUNT; ++i)
+        {
+            is_over = is_over || IsOver(gpuCounters[i]);
+        }
+
+        return is_over;
+    }
+
+    const char* MemoryTracker::GetTagName(const MemoryTag& tag)
+    {
+        return TAG_NAMES[tag];
+    }
+
+    const char* MemoryTracker::GetResourceName(const GpuResource& resource)
+    {
+        return RESOURCE_NAMES[resource];
+    }
+
+    // Live and peak megabytes, the allocations (or resources) alive, and
+    // the budget if there is one
+    //
+    // file     Where it is written (stdout)
+    void MemoryTracker::WriteReport(FILE* file)
+    {
+        fprintf(file, "Memory (MB)               live       peak    count     budget\n");
+
+        if(IsHeapTracked())
+        {
+            for(int i = 0; i < MEMORY_TAG_COUNT; ++i)
+            {
+                WriteLine(file, "cpu", TAG_NAMES[i], heapCounters[i]);
+            }
+            WriteLine(file, "cpu", "total", heapTotal);
+        }
+        else
+        {
+            fprintf(file, "  cpu  not counted, the build has no FLYGL_MEMORY_TRACKING\n");
+        }
+
+        for(int i = 0; i < GPU_RESOURCE_COUNT; ++i)
+        {
+            WriteLine(file, "gpu", RESOURCE_NAMES[i], gpuCounters[i]);
+        }
+        WriteLine(file, "gpu", "total", gpuTotal);
+
+        fflush(file);
+    }
+}
+
+#ifdef FLYGL_MEMORY_TRACKING
+
+    #if defined(_MSC_VER) || __cplusplus < 201103L
+        #define FLYGL_NO_THROW throw()
+    #else
+        #define FLYGL_NO_THROW noexcept
+    #endif
+
+    #if defined(_MSC_VER) || __cplusplus >= 201103L
+        #define FLYGL_THROW_BAD_ALLOC
+    #else
+        #define FLYGL_THROW_BAD_ALLOC throw(std::bad_alloc)
+    #endif
+
+    // Before every block, keeps the alignment of malloc
+    static const size_t ALLOCATION_HEADER_SIZE = 16;
+
+    struct AllocationHeader
+    {
+    public:
+
+        size_t size;
+        int    tag;
+    };
+
+    // Counts the block on the tag of the thread, NULL if there is no memory
+    static void* TrackedAllocate(const size_t& size)
+    {
+        char* block = (char*)malloc(size + ALLOCATION_HEADER_SIZE);
+        if(block == NULL)
+        {
+            return NULL;
+        }
+
+        AllocationHeader* header = (AllocationHeader*)block;
+        header->size = size;
+        header->tag  = flygl::MemoryTracker::GetTag();
+
+        flygl::MemoryTracker::AddAllocation((flygl::MemoryTag)header->tag, size);
+
+        return block + ALLOCATION_HEADER_SIZE;
+    }
+
+    static void TrackedFree(void* pointer)
+    {
+        if(pointer == NULL)
+        {
+            return;
+        }
+
+        char*             block  = (char*)pointer - ALLOCATION_HEADER_SIZE;
+        AllocationHeader* header = (AllocationHeader*)block;
+
+        flygl::MemoryTracker::RemoveAllocation((flygl::MemoryTag)header->tag, header->size);
+
+        free(block);
+    }
+
+    void* operator new(std::size_t size) FLYGL_THROW_BAD_ALLOC
+    {
+        void* pointer = TrackedAllocate(size);
+        if(pointer == NULL)
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void* operator new[](std::size_t size) FLYGL_THROW_BAD_ALLOC
+    {
+        void* pointer = TrackedAllocate(size);
+        if(pointer == NULL)
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void* operator new(std::size_t size, const std::nothrow_t&) FLYGL_NO_THROW
+    {
+        return TrackedAllocate(size);
+    }
+
+    void* operator new[](std::size_t size, const std::nothrow_t&) FLYGL_NO_THROW
+    {
+        return TrackedAllocate(size);
+    }
+
+    void operator delete(void* pointer) FLYGL_NO_THROW
+    {
+        TrackedFree(pointer);
+    }
+
+    void operator delete[](void* pointer) FLYGL_NO_THROW
+    {
+        TrackedFree(pointer);
+    }
+
+    // The sized forms (C++14) ignore the size, the header already has it
+    void operator delete(void* pointer, std::size_t) FLYGL_NO_THROW
+    {
+        operator delete(pointer);
+    }
+
+    void operator delete[](void* pointer, std::size_t) FLYGL_NO_THROW
+    {
+        operator delete[](pointer);
+    }
+
+    void operator delete(void* pointer, const std::nothrow_t&) FLYGL_NO_THROW
+    {
+        TrackedFree(pointer);
+    }
+
+    void operator delete[](void* pointer, const std::nothrow_t&) FLYGL_NO_THROW
+    {
+        TrackedFree(pointer);
+    }
+
+#endif
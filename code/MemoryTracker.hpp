@@ -0,0 +1,135 @@
+/* ---------------------------------------------------------------------------
+** MemoryTracker.hpp
+** Where the memory goes, by subsystem. The CPU heap is counted by tag
+** (loading, meshes, textures, shaders, post processes and the rest): a
+** MemoryScope sets the tag of its thread until the end of its scope, and
+** every new made meanwhile is counted on it, and taken out of it when it
+** is deleted (wherever that happens). The video memory is estimated by
+** kind of resource (buffers, texture arrays, render targets and programs)
+** from what is created on the StatsRenderDevice.
+** Every tag and kind keeps the live bytes, the peak and the live count,
+** and can have a budget: the report marks the ones whose peak is over it.
+** The heap is only counted when the build defines FLYGL_MEMORY_TRACKING,
+** that replaces the global operator new and delete (a header of 16 bytes
+** on every block). Without it the scopes only set the tag, and only the
+** video memory is known. What is allocated with malloc (stb_image) is not
+** counted.
+**
+**   {
+**       MemoryScope scope(MEMORY_MESHES);
+**       ...
+**   }
+**   MemoryTracker::WriteReport(stdout);
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef MEMORYTRACKER_HEADER
+#define MEMORYTRACKER_HEADER
+
+#include <cstdio>
+#include <cstddef>
+
+    namespace flygl
+    {
+        // What the heap is used for
+        enum MemoryTag
+        {
+            MEMORY_OTHER,
+            MEMORY_LOADING,     // The scene while it loads, and files being read
+            MEMORY_MESHES,
+            MEMORY_TEXTURES,
+            MEMORY_SHADERS,
+            MEMORY_POSTPROCESS,
+            MEMORY_TAG_COUNT
+        };
+
+        // What the video memory is used for
+        enum GpuResource
+        {
+            GPU_BUFFERS,
+            GPU_TEXTURES,       // Texture arrays, with every level uploaded
+            GPU_RENDER_TARGETS, // The 2D textures that are drawn on (color and depth)
+            GPU_PROGRAMS,       // Their code, the size the driver uses is not known
+            GPU_RESOURCE_COUNT
+        };
+
+        struct MemoryUsage
+        {
+        public:
+
+            size_t liveBytes;
+            size_t peakBytes;
+            size_t liveCount;   // Allocations or resources alive
+            size_t budget;      // Bytes, 0 for none
+        };
+
+        class MemoryTracker
+        {
+        public:
+
+            // If the heap is counted (the build has FLYGL_MEMORY_TRACKING)
+            static bool IsHeapTracked();
+
+            // The tag of the thread that calls it
+            static MemoryTag GetTag();
+            static void      SetTag(const MemoryTag& tag);
+
+            // Called by the operators, and by whoever allocates in other ways
+            static void AddAllocation   (const MemoryTag& tag, const size_t& bytes);
+            static void RemoveAllocation(const MemoryTag& tag, const size_t& bytes);
+
+            // Called by the StatsRenderDevice
+            static void AddGpuResource   (const GpuResource& resource, const size_t& bytes);
+            static void RemoveGpuResource(const GpuResource& resource, const size_t& bytes);
+            static void ResizeGpuResource(const GpuResource& resource, const size_t& old_bytes, const size_t& new_bytes);
+
+            // Forgets the video memory (the resources of another device)
+            static void ResetGpu();
+
+            static MemoryUsage GetHeapUsage(const MemoryTag&   tag);
+            static MemoryUsage GetGpuUsage (const GpuResource& resource);
+
+            // Of every tag or kind
+            static MemoryUsage GetHeapTotal();
+            static MemoryUsage GetGpuTotal ();
+
+            // bytes    0 for none
+            static void SetHeapBudget(const MemoryTag&   tag,      const size_t& bytes);
+            static void SetGpuBudget (const GpuResource& resource, const size_t& bytes);
+            static void SetTotalBudgets(const size_t& heap_bytes, const size_t& gpu_bytes);
+
+            // If the peak of any tag, kind or total is over its budget
+            static bool IsOverBudget();
+
+            static const char* GetTagName     (const MemoryTag&   tag);
+            static const char* GetResourceName(const GpuResource& resource);
+
+            // A table with every tag and kind
+            static void WriteReport(FILE* file);
+        };
+
+        // Sets the tag of its thread, and the previous one back when it ends
+        class MemoryScope
+        {
+        private:
+
+            MemoryTag previousTag;
+
+        public:
+
+            // Constructor
+            MemoryScope(const MemoryTag& tag): previousTag(MemoryTracker::GetTag())
+            {
+                MemoryTracker::SetTag(tag);
+            }
+
+            // Destructor
+            ~MemoryScope()
+            {
+                MemoryTracker::SetTag(previousTag);
+            }
+        };
+    }
+
+#endif
@@ -7,6 +7,9 @@
 ** -------------------------------------------------------------------------*/
 
 #include "Mesh.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "MemoryTracker.hpp"
 
 // The OBJ Loader
 #include "tinyobjloader\tiny_obj_loader.h"
@@ -16,25 +19,37 @@
 
 namespace flygl
 {
+    const GLuint Mesh::ATTRIBUTE_COUNTER;
+
     // Loads the mesh from an .obj File
     //
     // path     The path route of the file
     void Mesh::LoadMesh(const std::string& path)
     {
+        FLYGL_PROFILE_ZONE("Mesh::LoadMesh");
+        MemoryScope memory_scope(MEMORY_MESHES);
+
         std::vector< glm::vec3 > _vertices;
         std::vector< glm::vec2 > _uvs;
         std::vector< glm::vec3 > _normals;
         std::vector< glm::vec3 > _tangents;
         std::vector< glm::vec3 > _bitangents;
 
-        LoadMeshFromFile(path, _vertices, _uvs, _normals);                
-        ComputeTangents (_vertices, _uvs, _normals, _tangents, _bitangents);
+        // The data before it is indexed is only needed while loading
+        {
+            MemoryScope loading_scope(MEMORY_LOADING);
+
+            LoadMeshFromFile(path, _vertices, _uvs, _normals);                
+            ComputeTangents (_vertices, _uvs, _normals, _tangents, _bitangents);
+        }
         
         // Index every data (vertices, uvs, normals, tangents and bitangents)
         indexVBO_TBN    (_vertices, _uvs, _normals, _tangents, _bitangents, 
                  indices, vertices,  uvs,  normals,  tangents,  bitangents);
 
+        ComputeBounds      ();
         InitializeGLBuffers();
+        ReleaseBufferData  ();
     }
 
     // Loads the shaders and Compile them.
@@ -51,73 +66,143 @@ namespace flygl
     //
     // texture_path     The path route of the texture
     // uniform_name     The name of the uniform that has the texture on the shader
-    void Mesh::SetTexture(const std::string& texture_path, const std::string& uniform_name)
+    // usage            Diffuse, specular or normal. It decides how the texture is compressed
+    void Mesh::SetTexture(const std::string& texture_path, const std::string& uniform_name, const TextureUsage& usage)
+    {
+        FLYGL_PROFILE_ZONE("Mesh::SetTexture");
+        MemoryScope memory_scope(MEMORY_TEXTURES);
+
+        Texture* texture = new Texture();
+        texture->Load(texture_path, usage);
+
+        // The sampler always reads from the same unit, we only need to set it once
+        shaders.UseThisShader();
+        const GLint unit = textures.size();
+        RenderDevice::Get().SetUniform(shaders.SetUniform(uniform_name), UNIFORM_INT, 1, &unit);
+
+        // Push the texture and the layer it uses
+           textures.push_back(texture);
+        textureLayers.push_back(0);
+    }
+
+    // Changes one of the textures for a layer of another one (usually an
+    // array of textures with the same size and format)
+    //
+    // slot     The position of the texture (in the order they were set)
+    // texture  The new texture
+    // layer    The layer of the texture this mesh will use
+    void Mesh::SetTextureLayer(const size_t& slot, Texture* texture, const GLint& layer)
     {
-        int img_width, img_height, comp_num;
-        unsigned char *data = stbi_load(texture_path.c_str(), &img_width, &img_height, &comp_num, 0);
-
-        // Create one OpenGL texture
-	    GLuint textureID;
-	    glGenTextures(1, &textureID);
-	
-	    glBindTexture(GL_TEXTURE_2D, textureID);
-
-        glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, 
-                        img_width, img_height, 
-                        0, GL_RGB, GL_UNSIGNED_BYTE, 
-                        data);
-
-        // Free the data, we already have it stored
-        stbi_image_free(data);
-
-        // Set texture Parameters
-        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT              );
-	    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT              );
-	    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR              );
-	    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); 
-	    glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Push the texture ID and its Uniform ID to the array
-          textures.push_back(textureID);
-        textureIDs.push_back(shaders.SetUniform(uniform_name));
+        texture->AddReference();
+        textures[slot]->Release();
+
+             textures[slot] = texture;
+        textureLayers[slot] = layer;
     }
 
     // Initialize the required shader uniforms and store their IDs
     void Mesh::SetBasicUniforms()
     {
+        // Layers of the texture arrays
+        textureLayersID = shaders.SetUniform("textureLayers");
+
         // Matrix Uniforms
         matrixID       = shaders.SetUniform("MVP"        );
         viewMatrixID   = shaders.SetUniform("viewMatrix" );
         modelMatrixID  = shaders.SetUniform("modelMatrix");
                                
-        // Light Uniforms
-        lightPosID     = shaders.SetUniform("lightPos"      );
-        lightColorID   = shaders.SetUniform("lightColor"    );
-        lightPowerID   = shaders.SetUniform("lightPower"    );
-        lightNumberID  = shaders.SetUniform("numberOfLights");
-        modelView3x3ID = shaders.SetUniform("modelView3x3"  );
+        modelView3x3ID = shaders.SetUniform("modelView3x3");
+
+        // Clustered Light Uniforms, the buffers are always on the same units
+        clusterGridID  = shaders.SetUniform("clusterGrid" );
+        clusterScaleID = shaders.SetUniform("clusterScale");
+        clusterDepthID = shaders.SetUniform("clusterDepth");
+
+        shaders.UseThisShader();
+        LightClusters::SetSamplers(shaders.GetProgram());
         
         // Motion Blur
         oldMVP_ID = shaders.SetUniform("oldMVP");
     }
 
     // Draws the mesh into the draw buffer
-    void Mesh::Draw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightingBuffer& lights)
+    void Mesh::Draw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightClusters& lights)
     {
+        FLYGL_PROFILE_ZONE("Mesh::Draw");
+        RenderStats::Get().AddDrawnObject();
+
         shaders.UseThisShader();
 
         // Matrices
         MVP = projection_matrix * view_matrix * model_matrix;
         
-        DrawUniforms(projection_matrix, view_matrix, lights);
+        DrawUniforms(view_matrix, lights);
         DrawTextures();
+        DrawElements();
+    }
+
+    // Draws the mesh from another point of view than the camera (a reflection).
+    // The matrices of the camera are kept, so its motion blur is not broken.
+    //
+    // projection_matrix    The projection of the point of view
+    // view_matrix          The point of view
+    // lights               The light clusters of that point of view
+    void Mesh::DrawFromView(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightClusters& lights)
+    {
+        const glm::mat4 camera_MVP    = MVP;
+        const glm::mat4 camera_oldMVP = oldMVP;
+
+        Draw(projection_matrix, view_matrix, lights);
+
+        MVP    = camera_MVP;
+        oldMVP = camera_oldMVP;
+    }
+
+    // Draws the mesh with a shader shared by every mesh (it must be in use),
+    // like the G-buffer one. Every texture goes to the unit of its usage
+    // (diffuse 0, specular 1, normal 2), whatever order it was set in.
+    //
+    // projection_matrix    The projection of the camera
+    // view_matrix          The camera
+    // uniforms             The uniform IDs of the shader in use
+    void Mesh::DrawGeometry(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const GeometryUniforms& uniforms)
+    {
+        FLYGL_PROFILE_ZONE("Mesh::DrawGeometry");
+        RenderStats::Get().AddDrawnObject();
 
+        MVP = projection_matrix * view_matrix * model_matrix;
+
+        glm::mat3 ModelView3x3Matrix = glm::mat3(view_matrix * model_matrix);
+
+        RenderDevice& device = RenderDevice::Get();
+
+        device.SetUniform(uniforms.matrixID,       UNIFORM_MAT4, 1, &MVP[0][0]               );
+        device.SetUniform(uniforms.viewMatrixID,   UNIFORM_MAT4, 1, &view_matrix[0][0]       );
+        device.SetUniform(uniforms.modelMatrixID,  UNIFORM_MAT4, 1, &model_matrix[0][0]      );
+        device.SetUniform(uniforms.oldMVP_ID,      UNIFORM_MAT4, 1, &oldMVP[0][0]            );
+        device.SetUniform(uniforms.modelView3x3ID, UNIFORM_MAT3, 1, &ModelView3x3Matrix[0][0]);
+
+        GLint layers[3] = { 0, 0, 0 };
+        for(size_t i = 0; i < textures.size(); ++i)
+        {
+            const TextureUsage usage = textures[i]->GetUsage();
+
+            textures[i]->Bind(usage);
+            layers[usage] = textureLayers[i];
+        }
+        device.SetUniform(uniforms.textureLayersID, UNIFORM_INT, 3, layers);
+
+        DrawElements();
+    }
+
+    // Draws the triangles with the attributes of the mesh
+    void Mesh::DrawElements()
+    {
         EnableAttributes();
         DrawAttributes();
         
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
-        //             |Mode         |Count         |Type             |Array buff offset
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, (void*)0);
+        //                             |Mode         |Index buffer  |Count         |Type
+        RenderDevice::Get().DrawElements(GL_TRIANGLES, elementBuffer, indices.size(), GL_UNSIGNED_SHORT);
 
         DisableAttributes();
 
@@ -233,96 +318,126 @@ namespace flygl
         }
     }
 
+    // Calculates the bounding sphere and the density of the texture
+    // coordinates (how many uvs there are in a world unit). Both of them are
+    // used to know which mip levels of the textures are needed.
+    void Mesh::ComputeBounds()
+    {
+        glm::vec3 min_corner = vertices.empty() ? glm::vec3(0.0f) : vertices[0];
+        glm::vec3 max_corner = min_corner;
+
+        for(size_t i = 1; i < vertices.size(); ++i)
+        {
+            min_corner = glm::min(min_corner, vertices[i]);
+            max_corner = glm::max(max_corner, vertices[i]);
+        }
+
+        boundsCenter = (min_corner + max_corner) * 0.5f;
+        boundsRadius = 0.0f;
+
+        for(size_t i = 0; i < vertices.size(); ++i)
+        {
+            boundsRadius = glm::max(boundsRadius, glm::length(vertices[i] - boundsCenter));
+        }
+
+        float world_area = 0.0f;
+        float uv_area    = 0.0f;
+
+        for(size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const glm::vec3& v0 = vertices[indices[i + 0]];
+            const glm::vec3& v1 = vertices[indices[i + 1]];
+            const glm::vec3& v2 = vertices[indices[i + 2]];
+
+            const glm::vec2 uv1 = uvs[indices[i + 1]] - uvs[indices[i]];
+            const glm::vec2 uv2 = uvs[indices[i + 2]] - uvs[indices[i]];
+
+            world_area += glm::length(glm::cross(v1 - v0, v2 - v0)) * 0.5f;
+            uv_area    += glm::abs(uv1.x * uv2.y - uv1.y * uv2.x)  * 0.5f;
+        }
+
+        uvDensity = world_area > 0.0f ? glm::sqrt(uv_area / world_area) : 0.0f;
+    }
+
     // Once we have loaded from the .obj file, done every calculation, 
     // and indexed the data, we initialize the GL buffers with that data.
     void Mesh::InitializeGLBuffers()
     {
-        glGenBuffers(1,              &vertexBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
-                
-        glGenBuffers(1,               &colorBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER,  colorBuffer);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
-                
-        glGenBuffers(1,               &uvBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER,  uvBuffer);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(glm::vec2), &uvs[0], GL_STATIC_DRAW);
-        
-        glGenBuffers(1,               &normalBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER,  normalBuffer);
-        glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(glm::vec3), &normals[0], GL_STATIC_DRAW);
+        RenderDevice& device = RenderDevice::Get();
 
-        glGenBuffers(1, &tangentBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, tangentBuffer);
-        glBufferData(GL_ARRAY_BUFFER, tangents.size() * sizeof(glm::vec3), &tangents[0], GL_STATIC_DRAW);
- 
-        glGenBuffers(1, &bitangentBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, bitangentBuffer);
-        glBufferData(GL_ARRAY_BUFFER, bitangents.size() * sizeof(glm::vec3), &bitangents[0], GL_STATIC_DRAW);
-        
-        glGenBuffers(1, &elementBuffer);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+        vertexBuffer    = device.CreateBuffer(GL_ARRAY_BUFFER, &vertices[0],   vertices.size()   * sizeof(glm::vec3), GL_STATIC_DRAW);
+        colorBuffer     = device.CreateBuffer(GL_ARRAY_BUFFER, &vertices[0],   vertices.size()   * sizeof(glm::vec3), GL_STATIC_DRAW);
+        uvBuffer        = device.CreateBuffer(GL_ARRAY_BUFFER, &uvs[0],        uvs.size()        * sizeof(glm::vec2), GL_STATIC_DRAW);
+        normalBuffer    = device.CreateBuffer(GL_ARRAY_BUFFER, &normals[0],    normals.size()    * sizeof(glm::vec3), GL_STATIC_DRAW);
+        tangentBuffer   = device.CreateBuffer(GL_ARRAY_BUFFER, &tangents[0],   tangents.size()   * sizeof(glm::vec3), GL_STATIC_DRAW);
+        bitangentBuffer = device.CreateBuffer(GL_ARRAY_BUFFER, &bitangents[0], bitangents.size() * sizeof(glm::vec3), GL_STATIC_DRAW);
+
+        elementBuffer   = device.CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, &indices[0], indices.size() * sizeof(unsigned short), GL_STATIC_DRAW);
+    }
+
+    // The GL buffers have a copy of the data, and the bounds are computed:
+    // the vertices and their attributes are not read again. The indices
+    // stay, they are what tells how many elements are drawn.
+    void Mesh::ReleaseBufferData()
+    {
+        std::vector<glm::vec3>().swap(vertices);
+        std::vector<glm::vec2>().swap(uvs);
+        std::vector<glm::vec3>().swap(normals);
+        std::vector<glm::vec3>().swap(tangents);
+        std::vector<glm::vec3>().swap(bitangents);
     }
 
     // Pass every data to the shader.
-    void Mesh::DrawUniforms(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightingBuffer& lights)
+    void Mesh::DrawUniforms(const glm::mat4& view_matrix, const LightClusters& lights)
     {       
         glm::mat3 ModelView3x3Matrix = glm::mat3(view_matrix * model_matrix);
 
+        RenderDevice& device = RenderDevice::Get();
+
         // Lights
-        glUniform3fv(lightPosID,    lights.numberOfLights, &lights.positionBuffer [0]);
-        glUniform3fv(lightColorID,  lights.numberOfLights, &lights.colorBuffer    [0]);
-        glUniform1fv(lightPowerID,  lights.numberOfLights, &lights.intensityBuffer[0]);
-        glUniform1i (lightNumberID, lights.numberOfLights);
+        static const GLint CLUSTER_GRID[3] = { LightClusters::GRID_X, LightClusters::GRID_Y, LightClusters::GRID_Z };
+
+        device.SetUniform(clusterGridID,  UNIFORM_IVEC3, 1, CLUSTER_GRID                    );
+        device.SetUniform(clusterScaleID, UNIFORM_VEC2,  1, &lights.GetScale()[0]           );
+        device.SetUniform(clusterDepthID, UNIFORM_VEC2,  1, &lights.GetDepthParameters()[0] );
         
         //Set Basic Uniforms
-        glUniformMatrix4fv(matrixID,       1, GL_FALSE, &MVP[0][0]               );
-        glUniformMatrix4fv(viewMatrixID,   1, GL_FALSE, &view_matrix[0][0]       );
-        glUniformMatrix4fv(modelMatrixID,  1, GL_FALSE, &model_matrix[0][0]      );
-        glUniformMatrix4fv(oldMVP_ID,      1, GL_FALSE, &oldMVP[0][0]            );
-        glUniformMatrix3fv(modelView3x3ID, 1, GL_FALSE, &ModelView3x3Matrix[0][0]);
+        device.SetUniform(matrixID,       UNIFORM_MAT4, 1, &MVP[0][0]               );
+        device.SetUniform(viewMatrixID,   UNIFORM_MAT4, 1, &view_matrix[0][0]       );
+        device.SetUniform(modelMatrixID,  UNIFORM_MAT4, 1, &model_matrix[0][0]      );
+        device.SetUniform(oldMVP_ID,      UNIFORM_MAT4, 1, &oldMVP[0][0]            );
+        device.SetUniform(modelView3x3ID, UNIFORM_MAT3, 1, &ModelView3x3Matrix[0][0]);
     }
 
-    // Pass the textures to the shader.
+    // Pass the textures to the shader. The ones that are already bound
+    // (shared with the last mesh drawn) are skipped. Every texture stays on
+    // the unit of its sampler, but its layer goes where the shader reads the
+    // one of its usage (diffuse 0, specular 1, normal 2), whatever order it
+    // was set in.
     void Mesh::DrawTextures()
     {
-        GLenum textCount = GL_TEXTURE0;
+        GLint layers[3] = { 0, 0, 0 };
         for(size_t i = 0; i < textures.size(); ++i)
         {
-		    glActiveTexture(textCount);
-		    glBindTexture  (GL_TEXTURE_2D, textures[i]);
-		    glUniform1i    (textureIDs[i], i);
-
-            textCount++;
+            textures[i]->Bind(i);
+            layers[textures[i]->GetUsage()] = textureLayers[i];
         }
+
+        RenderDevice::Get().SetUniform(textureLayersID, UNIFORM_INT, 3, layers);
     }
 
     // Pass the attribute data to the shaders
     void Mesh::DrawAttributes()
     {
-        // Example:
-        //                       |Attnum | Size |Type     |Normalized? |Stride |Array buff offset
-        // glVertexAttribPointer(0,       3,    GL_FLOAT, GL_FALSE,    0,      (void*)0          );
-
-        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-                                                               
-        glBindBuffer(GL_ARRAY_BUFFER, colorBuffer);        
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-                                                               
-        glBindBuffer(GL_ARRAY_BUFFER, uvBuffer);           
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-                                                               
-        glBindBuffer(GL_ARRAY_BUFFER, normalBuffer);       
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-                                                               
-        glBindBuffer(GL_ARRAY_BUFFER, tangentBuffer);      
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-                                                               
-        glBindBuffer(GL_ARRAY_BUFFER, bitangentBuffer);    
-        glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        RenderDevice& device = RenderDevice::Get();
+
+        //                        |Attnum |Buffer          |Size |Type
+        device.SetVertexAttribute(0,       vertexBuffer,    3,    GL_FLOAT);
+        device.SetVertexAttribute(1,       colorBuffer,     3,    GL_FLOAT);
+        device.SetVertexAttribute(2,       uvBuffer,        2,    GL_FLOAT);
+        device.SetVertexAttribute(3,       normalBuffer,    3,    GL_FLOAT);
+        device.SetVertexAttribute(4,       tangentBuffer,   3,    GL_FLOAT);
+        device.SetVertexAttribute(5,       bitangentBuffer, 3,    GL_FLOAT);
     }
 
 }
\ No newline at end of file
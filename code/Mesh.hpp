@@ -18,18 +18,35 @@
 #include "stb_image\stb_image.h" 
 
 #include "ShaderManager.hpp"
-#include "PointLight.hpp"
+#include "RenderDevice.hpp"
+#include "Texture.hpp"
+#include "LightClusters.hpp"
 #include "Camera.hpp"
 
     namespace flygl
     {
+        // Uniforms of a shader shared by every mesh (the G-buffer one of the
+        // DeferredRenderer), so the meshes don't need their own IDs for it
+        struct GeometryUniforms
+        {
+        public:
+
+            GLuint textureLayersID;
+            GLuint matrixID;
+            GLuint viewMatrixID;
+            GLuint modelMatrixID;
+            GLuint modelView3x3ID;
+            GLuint oldMVP_ID;
+        };
+
         class Mesh: public Actor
         {
         protected:
             
             static const GLuint ATTRIBUTE_COUNTER = 6;
 
-            // Buffer data
+            // Buffer data. Only the indices are kept after the GL buffers are
+            // created (their count is drawn), the rest is freed.
             std::vector< glm::vec3 >    vertices;
             std::vector< glm::vec2 >    uvs;
             std::vector< glm::vec3 >    normals;
@@ -51,21 +68,21 @@
 
             ShaderManager shaders;
 
-            // Textures
-            std::vector<GLuint> textures;
-            std::vector<GLuint> textureIDs;
+            // Textures (arrays), and the layer of each one this mesh uses
+            std::vector<Texture*> textures;
+            std::vector<GLint>    textureLayers;
 
             // Basic uniforms
+            GLuint textureLayersID;
             GLuint matrixID;
             GLuint viewMatrixID;
             GLuint modelMatrixID;
             GLuint modelView3x3ID;
 
-            // Light uniforms
-            GLuint lightPosID;
-            GLuint lightColorID;
-            GLuint lightPowerID;
-            GLuint lightNumberID;
+            // Clustered light uniforms
+            GLuint clusterGridID;
+            GLuint clusterScaleID;
+            GLuint clusterDepthID;
 
             // Cam Uniforms
             GLuint nearID;
@@ -74,23 +91,34 @@
             // Motion Blur Uniform
             GLuint oldMVP_ID;
 
+            // Bounding sphere (model space) and texture coordinates per
+            // world unit, used to know how big the textures are on screen
+            glm::vec3 boundsCenter;
+            float     boundsRadius;
+            float     uvDensity;
+
             
             
         public:
 
 			//Constructor
-			Mesh():Actor(), textures(0), textureIDs(0), oldMVP(0){}
+			Mesh():Actor(), oldMVP(0), textures(0), textureLayers(0), boundsRadius(0.0f), uvDensity(0.0f){}
             
             ~Mesh()
             {
-                glDeleteTextures(textures.size(), &textures[0]);
+                for(size_t i = 0; i < textures.size(); ++i)
+                {
+                    textures[i]->Release();
+                }
                 
-                glDeleteBuffers(1, &vertexBuffer   );
-                glDeleteBuffers(1, &colorBuffer    );
-                glDeleteBuffers(1, &uvBuffer       );
-                glDeleteBuffers(1, &normalBuffer   );
-                glDeleteBuffers(1, &tangentBuffer  );
-                glDeleteBuffers(1, &bitangentBuffer);
+                RenderDevice& device = RenderDevice::Get();
+                device.DeleteBuffer(vertexBuffer   );
+                device.DeleteBuffer(colorBuffer    );
+                device.DeleteBuffer(uvBuffer       );
+                device.DeleteBuffer(normalBuffer   );
+                device.DeleteBuffer(tangentBuffer  );
+                device.DeleteBuffer(bitangentBuffer);
+                device.DeleteBuffer(elementBuffer  );
             }
 
 			//Sets the transformation buffer
@@ -102,46 +130,98 @@
             void SetBasicUniforms();
             void LoadMesh        (const std::string& path);
             void LoadShaders     (const std::string& vertex_path,  const std::string& fragment_path);
-            void SetTexture      (const std::string& texture_path, const std::string& uniform_name );
-            void Draw            (const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightingBuffer& lights);
+            void SetTexture      (const std::string& texture_path, const std::string& uniform_name, const TextureUsage& usage = DIFFUSE_TEXTURE);
+            void Draw            (const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightClusters& lights);
+            void DrawFromView    (const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightClusters& lights);
+            void DrawGeometry    (const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const GeometryUniforms& uniforms);
 
-        private:
+            void SetTextureLayer (const size_t& slot, Texture* texture, const GLint& layer);
 
-            // Loading Methods
+            // Returns the textures of the mesh
+            const std::vector<Texture*>& GetTextures() const
+            {
+                return textures;
+            }
 
-            void LoadMeshFromFile(const std::string path, std::vector<glm::vec3>& _vertices, std::vector<glm::vec2>& _uvs, std::vector<glm::vec3>& _normals);
-            
-            void ComputeTangents(
+            // Uses only its arguments, the benchmarks call it without a mesh
+            static void ComputeTangents(
                 const std::vector<glm::vec3>& _vertices, 
                 const std::vector<glm::vec2>& _uvs, 
                 const std::vector<glm::vec3>& _normals,
                       std::vector<glm::vec3>& _tangents, 
                       std::vector<glm::vec3>& _bitangents);
 
+            // Draw order that keeps together the meshes that share textures
+            // and shaders, so there is less to bind between them
+            // (by the names of the textures, not their addresses, so it is
+            // the same on every run)
+            static bool SortByMaterial(const Mesh* a, const Mesh* b)
+            {
+                for(size_t i = 0; i < a->textures.size() && i < b->textures.size(); ++i)
+                {
+                    if(a->textures[i]->GetID() != b->textures[i]->GetID())
+                    {
+                        return a->textures[i]->GetID() < b->textures[i]->GetID();
+                    }
+                }
+                if(a->textures.size() != b->textures.size())
+                {
+                    return a->textures.size() < b->textures.size();
+                }
+                return a->shaders.GetProgram() < b->shaders.GetProgram();
+            }
+
+            // Returns the center of the bounding sphere in world space
+            glm::vec3 GetBoundsCenter() const
+            {
+                return glm::vec3(model_matrix * glm::vec4(boundsCenter, 1.0f));
+            }
+
+            // Returns the radius of the bounding sphere in world space
+            float GetBoundsRadius() const
+            {
+                return boundsRadius * GetMaxScale();
+            }
+
+            // Returns the texture coordinates per world unit
+            float GetUVDensity() const
+            {
+                return uvDensity / GetMaxScale();
+            }
+
+        private:
+
+            // Loading Methods
+
+            void LoadMeshFromFile(const std::string path, std::vector<glm::vec3>& _vertices, std::vector<glm::vec2>& _uvs, std::vector<glm::vec3>& _normals);
+
             void InitializeGLBuffers();
+            void ComputeBounds      ();
+            void ReleaseBufferData  ();
+
+            // The biggest scale of the three axes
+            float GetMaxScale() const
+            {
+                return glm::max(glm::abs(sc.x), glm::max(glm::abs(sc.y), glm::abs(sc.z)));
+            }
 
             // Drawing Methods
 
-            void DrawUniforms(const glm::mat4& projection_matrix, const glm::mat4& view_matrix, const LightingBuffer& lights);
+            void DrawUniforms(const glm::mat4& view_matrix, const LightClusters& lights);
             void DrawTextures();
             void DrawAttributes();
+            void DrawElements  ();
             
             // Enable the attributes for passing them to the shader
             void EnableAttributes()
             {
-                for(GLuint i = 0; i < ATTRIBUTE_COUNTER; ++i)
-                {
-                    glEnableVertexAttribArray(i);
-                }
+                RenderDevice::Get().EnableAttributes(ATTRIBUTE_COUNTER, true);
             }
 
             // When we already used this attributes, disable them
             void DisableAttributes()
             {
-                for(GLuint i = 0; i < ATTRIBUTE_COUNTER; ++i)
-                {
-                    glDisableVertexAttribArray(i);
-                }
+                RenderDevice::Get().EnableAttributes(ATTRIBUTE_COUNTER, false);
             }
 
         };
@@ -0,0 +1,110 @@
+/* ---------------------------------------------------------------------------
+** MotionBlur.cpp
+** Adds the Motion Blur Post-Processing effect.
+** The speed of the scene is reduced to the biggest one of every tile (tile
+** max) and of every tile with its neighbours (neighbour max), so the blur
+** knows how far it has to sample, and the tiles where nothing moves only
+** read their own pixel.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "MotionBlur.hpp"
+
+namespace flygl
+{
+    const int    MotionBlur::TILE_SIZE;
+    const GLenum MotionBlur::TILE_FORMAT;
+
+    // Loads the blur and the two reductions of the speed
+    //
+    // vertex_path          The vertex shader of the screen quad
+    // fragment_path        The blur
+    // tile_max_path        The reduction of the speed to tiles
+    // neighbour_max_path   The reduction of the tiles to their neighbourhood
+    // render_targets       The pool the targets are taken from every frame
+    void MotionBlur::Initialize(
+        const std::string& vertex_path,   const std::string& fragment_path,
+        const std::string& tile_max_path, const std::string& neighbour_max_path,
+        RenderTargetPool& render_targets)
+    {
+        Postprocess::Initialize(vertex_path, fragment_path, render_targets);
+
+        intensityID           = postProcessShader.SetUniform("intensity");
+        maxSamplesID          = postProcessShader.SetUniform("maxSamples");
+        velocityThresholdID   = postProcessShader.SetUniform("velocityThreshold");
+        tileSizeID            = postProcessShader.SetUniform("tileSize");
+        speedTextureID        = postProcessShader.SetUniform("speedTexture");
+        neighbourMaxTextureID = postProcessShader.SetUniform("neighbourMaxTexture");
+
+        tileMaxShader.LoadVertexShader  (vertex_path  );
+        tileMaxShader.LoadFragmentShader(tile_max_path);
+        tileMaxShader.CompileShaders();
+
+        tileMaxVelocityID = tileMaxShader.SetUniform("velocityTexture");
+
+        // The size of the tiles never changes
+        tileMaxShader.UseThisShader();
+        const GLint tile_size = TILE_SIZE;
+        RenderDevice::Get().SetUniform(tileMaxShader.SetUniform("tileSize"), UNIFORM_INT, 1, &tile_size);
+
+        neighbourMaxShader.LoadVertexShader  (vertex_path       );
+        neighbourMaxShader.LoadFragmentShader(neighbour_max_path);
+        neighbourMaxShader.CompileShaders();
+
+        neighbourMaxVelocityID = neighbourMaxShader.SetUniform("velocityTexture");
+        neighbourMaxSpeedID    = neighbourMaxShader.SetUniform("speedTexture"   );
+    }
+
+    // Reduces the speed to the tiles and blurs the input on the output
+    //
+    // input    What the previous pass (or the scene) has drawn
+    // scene    The targets of the scene, the speed is read
+    // output   Where the effect is drawn, NULL for the screen
+    void MotionBlur::Draw(const RenderTarget* input, const SceneTargets& scene, RenderTarget* output)
+    {
+        const int tiles_width  = (scene.speed->width  + TILE_SIZE - 1) / TILE_SIZE;
+        const int tiles_height = (scene.speed->height + TILE_SIZE - 1) / TILE_SIZE;
+
+        RenderTarget* tile_max = renderTargets->Acquire(tiles_width, tiles_height, TILE_FORMAT);
+        neighbourMax           = renderTargets->Acquire(tiles_width, tiles_height, TILE_FORMAT);
+
+        Reduce(tileMaxShader, tileMaxVelocityID, scene.speed, tile_max);
+
+        // The neighbour max compares the lengths in pixels of the speed, as the tile max
+        const GLint speed_unit = 1;
+
+        neighbourMaxShader.UseThisShader();
+        RenderDevice::Get().BindTexture(speed_unit, GL_TEXTURE_2D, scene.speed->texture);
+        RenderDevice::Get().SetUniform (neighbourMaxSpeedID, UNIFORM_INT, 1, &speed_unit);
+
+        Reduce(neighbourMaxShader, neighbourMaxVelocityID, tile_max, neighbourMax);
+
+        renderTargets->Release(tile_max);
+
+        Postprocess::Draw(input, scene, output);
+
+        renderTargets->Release(neighbourMax);
+        neighbourMax = NULL;
+    }
+
+    // Draws a reduction of the source velocity on the destination
+    //
+    // shader       The tile max or neighbour max shader
+    // velocity_id  Its velocity uniform
+    // source       The velocity that is reduced
+    // destination  One texel for every tile
+    void MotionBlur::Reduce(ShaderManager& shader, const GLuint& velocity_id,
+                            const RenderTarget* source, RenderTarget* destination)
+    {
+        BindOutput(destination);
+        shader.UseThisShader();
+
+        const GLint unit = 0;
+
+        RenderDevice::Get().BindTexture(unit, GL_TEXTURE_2D, source->texture);
+        RenderDevice::Get().SetUniform (velocity_id, UNIFORM_INT, 1, &unit);
+
+        DrawQuad();
+    }
+}
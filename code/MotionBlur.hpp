@@ -1,13 +1,14 @@
 /* ---------------------------------------------------------------------------
 ** MotionBlur.hpp
 ** Adds the Motion Blur Post-Processing effect.
-** This is a Motion Blur Camera Only (it is not independent for each object).
 ** The technique used is the Speed Buffer which is calculated on models
-** shaders (actual MVP - previous MVP). This is passed to the Post processing
-** shader as a texture, then we simply itearate a number of times to draw each
-** pixel. The longer the distance (or higher the speed), more difference will
-** be from the previous position to the actual one, so the iterations will draw
-** wider, giving a blurry effect.
+** shaders (actual MVP - previous MVP), drawn on a RG16F target. Before the
+** blur, the speed is reduced to the biggest one of every tile of 16x16
+** pixels (tile max), and then to the biggest one of every tile and its 8
+** neighbours (neighbour max). The blur samples along the neighbour max, so
+** the moving objects are also smeared over the background around them, and
+** the number of samples depends on how long it is. The tiles where nothing
+** moves (most of the screen) only read their own pixel.
 **
 ** Author: Fly - Ruben Negredo
 ** -------------------------------------------------------------------------*/
@@ -21,80 +22,113 @@
     {
         class MotionBlur : public Postprocess
         {
+        public:
+
+            // Pixels on each side of a tile
+            static const int TILE_SIZE = 16;
+
+            // What the tiles are reduced on
+            static const GLenum TILE_FORMAT = GL_RG16F;
+
         protected:
-            GLuint speedTexture;
             GLuint speedTextureID;
-            
+            GLuint neighbourMaxTextureID;
             GLuint intensityID;
-            GLuint samplesNumID;
+            GLuint maxSamplesID;
+            GLuint velocityThresholdID;
+            GLuint tileSizeID;
 
-            GLuint numberOfSamples;
+            GLuint  maxSamples;
             GLfloat intensity;
+            GLfloat velocityThreshold;
+
+            // The reductions of the speed
+            ShaderManager tileMaxShader;
+            ShaderManager neighbourMaxShader;
+
+            GLuint tileMaxVelocityID;
+            GLuint neighbourMaxVelocityID;
+            GLuint neighbourMaxSpeedID;
+
+            // The neighbour max of this draw
+            RenderTarget* neighbourMax;
 
         public:
 
 			//Constructor
-			MotionBlur(): Postprocess()
+			MotionBlur(): Postprocess(), maxSamples(16), intensity(0.7f), velocityThreshold(0.5f), neighbourMax(NULL)
 			{
 			}
 
-            virtual void Initialize(
-                const std::string& vertex_path, const std::string& fragment_path, 
-                const int& screenWidth,         const int& screenHeight)
-            {
-                Postprocess::Initialize(vertex_path, fragment_path, screenWidth, screenHeight);
-                
-                numberOfSamples = 8;    //The higher the value, the cleaner (and more expensive)
-                intensity = 0.7f;        //Raise for fun! :D
+            void Initialize(
+                const std::string& vertex_path,           const std::string& fragment_path,
+                const std::string& tile_max_path,         const std::string& neighbour_max_path,
+                RenderTargetPool& render_targets);
 
-                intensityID = postProcessShader.SetUniform("intensity");
-                samplesNumID = postProcessShader.SetUniform("numberOfSamples");
-            }
+            virtual void Draw(const RenderTarget* input, const SceneTargets& scene, RenderTarget* output);
 
-            ~MotionBlur()
+            // The scene must be drawn with its speed
+            virtual bool UsesSpeed() const
             {
-                Postprocess::~Postprocess();
-                glDeleteTextures(1, &speedTexture);
+                return true;
             }
 
-            // Resize this new texture also!!
-            virtual void Resize(const int& screenWidth, const int& screenHeight)
+            virtual const char* GetName() const
             {
-                Postprocess::Resize(screenWidth, screenHeight);
+                return "MotionBlur";
+            }
 
-                glBindTexture(GL_TEXTURE_2D, speedTexture);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, screenWidth, screenHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+            // Samples of the longest blur (the higher the value, the cleaner and more expensive)
+            void SetMaxSamples(const GLuint& samples)
+            {
+                maxSamples = samples;
             }
 
-        protected:
-            
-            virtual void InitializeTexturesSection(const int& screenWidth, const int& screenHeight)
+            // The tiles whose blur is shorter than this (in pixels) are not blurred
+            void SetVelocityThreshold(const float& pixels)
             {
-                Postprocess::InitializeTexturesSection(screenWidth, screenHeight);
-                InitializeTexture(speedTextureID, speedTexture, 
-                    GL_COLOR_ATTACHMENT1, "speedTexture", screenWidth, screenHeight);
+                velocityThreshold = pixels;
             }
 
+        protected:
+
             // Render the Uniforms
             virtual void RenderUniforms()
             {
                 Postprocess::RenderUniforms();
 
-                glUniform1i(samplesNumID, numberOfSamples);
-                glUniform1f(intensityID, intensity);
+                const GLint max_samples = maxSamples;
+                const GLint tile_size   = TILE_SIZE;
+
+                RenderDevice& device = RenderDevice::Get();
+                device.SetUniform(maxSamplesID,        UNIFORM_INT,   1, &max_samples      );
+                device.SetUniform(intensityID,         UNIFORM_FLOAT, 1, &intensity        );
+                device.SetUniform(velocityThresholdID, UNIFORM_FLOAT, 1, &velocityThreshold);
+                device.SetUniform(tileSizeID,          UNIFORM_INT,   1, &tile_size        );
             }
 
-            // Hey, we have one more texture, so we draw one more texture!!
+            // Hey, we have more textures, so we draw more textures!!
             virtual void RenderTextures()
             {
                 //Draws the color texture
                 Postprocess::RenderTextures();
 
-                //Here, the speed texture!
-                glActiveTexture(GL_TEXTURE1);
-                glBindTexture  (GL_TEXTURE_2D, speedTexture);
-                glUniform1i    (speedTextureID, 1);
+                const GLint units[2] = { 1, 2 };
+                RenderDevice& device = RenderDevice::Get();
+
+                //Here, the speed texture of the scene!
+                device.BindTexture(units[0], GL_TEXTURE_2D, sceneTargets->speed->texture);
+                device.SetUniform (speedTextureID, UNIFORM_INT, 1, &units[0]);
+
+                //And the biggest speed around every tile
+                device.BindTexture(units[1], GL_TEXTURE_2D, neighbourMax->texture);
+                device.SetUniform (neighbourMaxTextureID, UNIFORM_INT, 1, &units[1]);
             }
+
+        private:
+
+            void Reduce(ShaderManager& shader, const GLuint& velocity_id,
+                        const RenderTarget* source, RenderTarget* destination);
         };
     }
 
@@ -0,0 +1,373 @@
+/* ---------------------------------------------------------------------------
+** NullRenderDevice.cpp
+** A render device that draws nothing, and records the calls.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "NullRenderDevice.hpp"
+
+#include <cstring>
+
+namespace flygl
+{
+    GLuint NullRenderDevice::CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        const GLuint buffer = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_BUFFER, 3, buffer, target, usage);
+            commands.AddData(data, size);
+        }
+        return buffer;
+    }
+
+    void NullRenderDevice::DeleteBuffer(const GLuint& buffer)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_DELETE_BUFFER, 1, buffer);
+        }
+    }
+
+    void NullRenderDevice::SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_BUFFER_DATA, 3, buffer, target, usage);
+            commands.AddData(data, size);
+        }
+    }
+
+    void NullRenderDevice::UpdateBuffer(const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_UPDATE_BUFFER, 3, buffer, target, offset);
+            commands.AddData(data, size);
+        }
+    }
+
+    GLuint NullRenderDevice::CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter)
+    {
+        const GLuint texture = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_TEXTURE_2D, 4, texture, internal_format, width, height);
+            commands.AddArgument(filter);
+        }
+        return texture;
+    }
+
+    void NullRenderDevice::BindTexture(const GLuint& unit, const GLenum& target, const GLuint& texture)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_BIND_TEXTURE, 3, unit, target, texture);
+        }
+    }
+
+    void NullRenderDevice::DeleteTexture(const GLuint& texture)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_DELETE_TEXTURE, 1, texture);
+        }
+    }
+
+    GLuint NullRenderDevice::CreateTextureArray()
+    {
+        const GLuint texture = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_TEXTURE_ARRAY, 1, texture);
+        }
+        return texture;
+    }
+
+    void NullRenderDevice::SetCompressedLevel(const GLuint& texture, const int& level, const GLenum& internal_format,
+                                              const int& width, const int& height, const int& layers,
+                                              const void* data, const size_t& size)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_COMPRESSED_LEVEL, 4, texture, level, internal_format, width);
+            commands.AddArgument(height);
+            commands.AddArgument(layers);
+            commands.AddData(data, size);
+        }
+    }
+
+    GLuint NullRenderDevice::CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format)
+    {
+        const GLuint texture = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_BUFFER_TEXTURE, 3, texture, buffer, internal_format);
+        }
+        return texture;
+    }
+
+    // The code is stored, so the list can create the program on another device
+    GLuint NullRenderDevice::CreateProgram(const std::string& vertex_code, const std::string& fragment_code)
+    {
+        const GLuint program = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_PROGRAM, 1, program);
+            commands.AddData(vertex_code.c_str(),   vertex_code.size()  );
+            commands.AddData(fragment_code.c_str(), fragment_code.size());
+        }
+        return program;
+    }
+
+    void NullRenderDevice::DeleteProgram(const GLuint& program)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_DELETE_PROGRAM, 1, program);
+        }
+    }
+
+    void NullRenderDevice::UseProgram(const GLuint& program)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_USE_PROGRAM, 1, program);
+        }
+    }
+
+    // Every name of every program has its own location. It is only recorded
+    // the first time, the replay needs it to know the real one.
+    GLint NullRenderDevice::GetUniformLocation(const GLuint& program, const std::string& name)
+    {
+        const std::pair<GLuint, std::string> key(program, name);
+
+        std::map<std::pair<GLuint, std::string>, GLint>::const_iterator found = locations.find(key);
+        if(found != locations.end())
+        {
+            return found->second;
+        }
+
+        const GLint location = nextLocation++;
+        locations[key] = location;
+
+        if(isRecording)
+        {
+            Record(COMMAND_GET_UNIFORM_LOCATION, 2, location, program);
+            commands.AddData(name.c_str(), name.size());
+        }
+        return location;
+    }
+
+    void NullRenderDevice::SetUniform(const GLint& location, const UniformType& type, const int& count, const void* values)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_UNIFORM, 3, location, type, count);
+            commands.AddData(values, GetUniformSize(type, count));
+        }
+    }
+
+    GLuint NullRenderDevice::CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture)
+    {
+        const GLuint framebuffer = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_FRAMEBUFFER, 3, framebuffer, depth_texture, count);
+            for(int i = 0; i < count; ++i)
+            {
+                commands.AddArgument(color_textures[i]);
+            }
+        }
+        return framebuffer;
+    }
+
+    void NullRenderDevice::DeleteFramebuffer(const GLuint& framebuffer)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_DELETE_FRAMEBUFFER, 1, framebuffer);
+        }
+    }
+
+    void NullRenderDevice::BindFramebuffer(const GLuint& framebuffer, const int& draw_buffers)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_BIND_FRAMEBUFFER, 2, framebuffer, draw_buffers);
+        }
+    }
+
+    void NullRenderDevice::SetViewport(const int& x, const int& y, const int& width, const int& height)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_VIEWPORT, 4, x, y, width, height);
+        }
+    }
+
+    void NullRenderDevice::Clear(const GLbitfield& mask)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_CLEAR, 1, mask);
+        }
+    }
+
+    void NullRenderDevice::SetClearColor(const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_CLEAR_COLOR, 4, CommandList::ToWord(red), CommandList::ToWord(green),
+                                               CommandList::ToWord(blue), CommandList::ToWord(alpha));
+        }
+    }
+
+    void NullRenderDevice::SetCapability(const GLenum& capability, const bool& enabled)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_CAPABILITY, 2, capability, enabled ? 1 : 0);
+        }
+    }
+
+    void NullRenderDevice::SetDepthFunction(const GLenum& function)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_DEPTH_FUNCTION, 1, function);
+        }
+    }
+
+    void NullRenderDevice::SetDepthMask(const bool& write)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_DEPTH_MASK, 1, write ? 1 : 0);
+        }
+    }
+
+    void NullRenderDevice::SetFrontFace(const GLenum& mode)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_FRONT_FACE, 1, mode);
+        }
+    }
+
+    void NullRenderDevice::SetBlendFunction(const GLenum& source, const GLenum& destination)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_BLEND_FUNCTION, 2, source, destination);
+        }
+    }
+
+    void NullRenderDevice::SetPolygonOffset(const GLfloat& factor, const GLfloat& units)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_POLYGON_OFFSET, 2, CommandList::ToWord(factor), CommandList::ToWord(units));
+        }
+    }
+
+    void NullRenderDevice::SetColorMask(const GLuint& attachment, const bool& write)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_COLOR_MASK, 2, attachment, write ? 1 : 0);
+        }
+    }
+
+    GLuint NullRenderDevice::CreateVertexArray()
+    {
+        const GLuint vertex_array = nextName++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_CREATE_VERTEX_ARRAY, 1, vertex_array);
+        }
+        return vertex_array;
+    }
+
+    void NullRenderDevice::BindVertexArray(const GLuint& vertex_array)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_BIND_VERTEX_ARRAY, 1, vertex_array);
+        }
+    }
+
+    void NullRenderDevice::DeleteVertexArray(const GLuint& vertex_array)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_DELETE_VERTEX_ARRAY, 1, vertex_array);
+        }
+    }
+
+    void NullRenderDevice::SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_SET_VERTEX_ATTRIBUTE, 4, index, buffer, components, type);
+        }
+    }
+
+    void NullRenderDevice::EnableAttributes(const GLuint& count, const bool& enabled)
+    {
+        if(isRecording)
+        {
+            Record(COMMAND_ENABLE_ATTRIBUTES, 2, count, enabled ? 1 : 0);
+        }
+    }
+
+    void NullRenderDevice::DrawArrays(const GLenum& mode, const int& first, const int& count)
+    {
+        drawCount++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_DRAW_ARRAYS, 3, mode, first, count);
+        }
+    }
+
+    void NullRenderDevice::DrawElements(const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type)
+    {
+        drawCount++;
+
+        if(isRecording)
+        {
+            Record(COMMAND_DRAW_ELEMENTS, 4, mode, index_buffer, count, type);
+        }
+    }
+
+    // There is nothing drawn, the screen is black
+    void NullRenderDevice::ReadScreen(const int& width, const int& height, unsigned char* pixels)
+    {
+        memset(pixels, 0, width * height * 3);
+    }
+
+    // Starts a command with its first arguments
+    //
+    // type     The command
+    // count    How many of a0..a3 are its arguments
+    void NullRenderDevice::Record(const RenderCommandType& type, const int& count,
+                                  const GLuint& a0, const GLuint& a1, const GLuint& a2, const GLuint& a3)
+    {
+        const GLuint arguments[4] = { a0, a1, a2, a3 };
+
+        commands.Begin(type);
+        for(int i = 0; i < count; ++i)
+        {
+            commands.AddArgument(arguments[i]);
+        }
+    }
+}
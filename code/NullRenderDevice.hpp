@@ -0,0 +1,124 @@
+/* ---------------------------------------------------------------------------
+** NullRenderDevice.hpp
+** A render device that draws nothing and needs no GPU. It gives names to
+** what is created (counting from 1) and, while it is recording, stores every
+** call in a CommandList, which can be replayed on another device or compared
+** with another list. It is what the CPU side of the draws (culling, sorting,
+** setting uniforms) is measured with, without the cost of the driver.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef NULLRENDERDEVICE_HEADER
+#define NULLRENDERDEVICE_HEADER
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "RenderDevice.hpp"
+#include "CommandList.hpp"
+
+    namespace flygl
+    {
+        class NullRenderDevice: public RenderDevice
+        {
+        private:
+
+            CommandList commands;
+            bool        isRecording;
+
+            GLuint nextName;
+            GLint  nextLocation;
+
+            // Every uniform asked for gets its own location
+            std::map<std::pair<GLuint, std::string>, GLint> locations;
+
+            // Draw calls since the last Reset
+            size_t drawCount;
+
+        public:
+
+            // Constructor
+            NullRenderDevice(): isRecording(true), nextName(1), nextLocation(1), drawCount(0)
+            {}
+
+            GLuint CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   DeleteBuffer(const GLuint& buffer);
+            void   SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   UpdateBuffer (const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size);
+
+            GLuint CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter);
+            void   BindTexture    (const GLuint& unit, const GLenum& target, const GLuint& texture);
+            void   DeleteTexture  (const GLuint& texture);
+
+            GLuint CreateTextureArray ();
+            void   SetCompressedLevel (const GLuint& texture, const int& level, const GLenum& internal_format,
+                                       const int& width, const int& height, const int& layers,
+                                       const void* data, const size_t& size);
+            GLuint CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format);
+
+            GLuint CreateProgram     (const std::string& vertex_code, const std::string& fragment_code);
+            void   DeleteProgram     (const GLuint& program);
+            void   UseProgram        (const GLuint& program);
+            GLint  GetUniformLocation(const GLuint& program, const std::string& name);
+            void   SetUniform        (const GLint& location, const UniformType& type, const int& count, const void* values);
+
+            GLuint CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture);
+            void   DeleteFramebuffer(const GLuint& framebuffer);
+            void   BindFramebuffer  (const GLuint& framebuffer, const int& draw_buffers);
+            void   SetViewport      (const int& x, const int& y, const int& width, const int& height);
+            void   Clear            (const GLbitfield& mask);
+            void   SetClearColor    (const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha);
+
+            void SetCapability    (const GLenum& capability, const bool& enabled);
+            void SetDepthFunction (const GLenum& function);
+            void SetDepthMask     (const bool& write);
+            void SetFrontFace     (const GLenum& mode);
+            void SetBlendFunction (const GLenum& source, const GLenum& destination);
+            void SetPolygonOffset (const GLfloat& factor, const GLfloat& units);
+            void SetColorMask     (const GLuint& attachment, const bool& write);
+
+            GLuint CreateVertexArray();
+            void   BindVertexArray  (const GLuint& vertex_array);
+            void   DeleteVertexArray(const GLuint& vertex_array);
+
+            void SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type);
+            void EnableAttributes  (const GLuint& count, const bool& enabled);
+            void DrawArrays        (const GLenum& mode, const int& first, const int& count);
+            void DrawElements      (const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type);
+
+            void ReadScreen(const int& width, const int& height, unsigned char* pixels);
+
+            // Without recording, the calls only cost what the engine does to make them
+            void SetRecording(const bool& recording)
+            {
+                isRecording = recording;
+            }
+
+            const CommandList& GetCommands() const
+            {
+                return commands;
+            }
+
+            size_t GetDrawCount() const
+            {
+                return drawCount;
+            }
+
+            // Forgets the recorded commands and the draws (the names are kept)
+            void Reset()
+            {
+                commands.Clear();
+                drawCount = 0;
+            }
+
+        private:
+
+            // Starts recording a command with up to 4 arguments
+            void Record(const RenderCommandType& type, const int& count,
+                        const GLuint& a0 = 0, const GLuint& a1 = 0, const GLuint& a2 = 0, const GLuint& a3 = 0);
+        };
+    }
+
+#endif
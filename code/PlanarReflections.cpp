@@ -0,0 +1,344 @@
+/* ---------------------------------------------------------------------------
+** PlanarReflections.cpp
+** Reflections on flat surfaces. Every reflection is drawn before the scene
+** from the camera reflected on its plane, on a pooled target smaller than
+** the scene, with an oblique projection (its near plane is the plane of the
+** reflection) and its own culling. After the scene, the surfaces blend the
+** reflection on top of themselves.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "PlanarReflections.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace flygl
+{
+    const GLenum PlanarReflections::COLOR_FORMAT;
+    const GLenum PlanarReflections::DEPTH_FORMAT;
+    const GLuint PlanarReflections::REFLECTION_UNIT;
+
+    // Deletes the lights and the zone name of every reflection
+    PlanarReflections::~PlanarReflections()
+    {
+        for(size_t i = 0; i < reflections.size(); ++i)
+        {
+            delete reflections[i].lights;
+            delete reflections[i].zoneName;
+        }
+    }
+
+    // Loads the shader of the surfaces
+    //
+    // vertex_path      The vertex shader of the surfaces
+    // fragment_path    The fragment shader, it blends the reflection
+    // render_targets   The pool the targets are taken from every frame
+    void PlanarReflections::Initialize(const std::string& vertex_path, const std::string& fragment_path, RenderTargetPool& render_targets)
+    {
+        renderTargets = &render_targets;
+
+        surfaceShader.LoadVertexShader  (vertex_path  );
+        surfaceShader.LoadFragmentShader(fragment_path);
+        surfaceShader.CompileShaders();
+
+        surfaceUniforms.textureLayersID = surfaceShader.SetUniform("textureLayers");
+        surfaceUniforms.matrixID        = surfaceShader.SetUniform("MVP"          );
+        surfaceUniforms.viewMatrixID    = surfaceShader.SetUniform("viewMatrix"   );
+        surfaceUniforms.modelMatrixID   = surfaceShader.SetUniform("modelMatrix"  );
+        surfaceUniforms.modelView3x3ID  = surfaceShader.SetUniform("modelView3x3" );
+        surfaceUniforms.oldMVP_ID       = surfaceShader.SetUniform("oldMVP"       );
+
+        reflectionTextureID = surfaceShader.SetUniform("reflectionTexture");
+        reflectivityID      = surfaceShader.SetUniform("reflectivity"     );
+        invSceneSizeID      = surfaceShader.SetUniform("invSceneSize"     );
+    }
+
+    // Adds a reflection, and returns its index
+    //
+    // point        A point of the plane, in world space
+    // normal       The normal of the plane, towards the side that is reflected
+    // surface      The mesh the reflection is drawn on (it is drawn normally too)
+    // reflectivity How much of the reflection is blended on the surface (0 to 1)
+    int PlanarReflections::Add(const glm::vec3& point, const glm::vec3& normal, Mesh* surface, const float& reflectivity)
+    {
+        const glm::vec3 unit_normal = glm::normalize(normal);
+
+        Reflection reflection;
+        reflection.plane        = glm::vec4(unit_normal, -glm::dot(unit_normal, point));
+        reflection.surface      = surface;
+        reflection.reflectivity = reflectivity;
+        reflection.lights       = new LightClusters();
+        reflection.color        = NULL;
+        reflection.depth        = NULL;
+
+        reflection.lights->Initialize();
+
+        std::ostringstream zone_name;
+        zone_name << "Reflection " << reflections.size();
+        reflection.zoneName = new std::string(zone_name.str());
+
+        reflection.cost.isVisible    = false;
+        reflection.cost.drawnMeshes  = 0;
+        reflection.cost.culledMeshes = 0;
+        reflection.cost.width        = 0;
+        reflection.cost.height       = 0;
+        reflection.cost.cpuTime      = 0.0f;
+        reflection.cost.gpuTime      = 0.0f;
+
+        reflections.push_back(reflection);
+        return reflections.size() - 1;
+    }
+
+    // The mesh is reflected on the given reflection
+    void PlanarReflections::AddMesh(const int& reflection, Mesh* mesh)
+    {
+        reflections[reflection].meshes.push_back(mesh);
+    }
+
+    // Draws every reflection whose surface is on screen on its own target.
+    // Call it before the scene, it changes the bound frame buffer and light
+    // clusters.
+    //
+    // lights               The lights of the scene
+    // camera               The camera (for its near and far planes)
+    // projection_matrix    The projection of the camera
+    // view_matrix          The camera
+    void PlanarReflections::Draw(
+        const LightManager& lights, const Camera& camera,
+        const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
+    {
+        FLYGL_PROFILE_ZONE("PlanarReflections::Draw");
+
+        glm::vec4 camera_frustum[6];
+        glm::vec4 reflected_frustum[6];
+
+        GetFrustumPlanes(projection_matrix * view_matrix, camera_frustum);
+
+        const glm::vec3 camera_position = glm::vec3(glm::inverse(view_matrix)[3]);
+
+        const int width  = std::max(1, (int)(renderTargets->GetWidth()  * resolutionScale + 0.5f));
+        const int height = std::max(1, (int)(renderTargets->GetHeight() * resolutionScale + 0.5f));
+
+        // The reflection turns the triangles around
+        RenderDevice& device = RenderDevice::Get();
+
+        device.SetCapability(GL_DEPTH_TEST, true);
+        device.SetFrontFace (GL_CW);
+
+        for(size_t i = 0; i < reflections.size(); ++i)
+        {
+            Reflection& reflection = reflections[i];
+            sf::Clock   clock;
+
+            if(gpuProfiler != NULL)
+            {
+                reflection.cost.gpuTime = gpuProfiler->GetAverageTime(reflection.zoneName->c_str());
+            }
+
+            reflection.cost.isVisible    = false;
+            reflection.cost.drawnMeshes  = 0;
+            reflection.cost.culledMeshes = 0;
+            reflection.cost.width        = width;
+            reflection.cost.height       = height;
+            reflection.cost.cpuTime      = 0.0f;
+
+            // Nothing to draw if the camera is behind the plane, or the surface is not on screen
+            const Mesh* surface = reflection.surface;
+
+            if(glm::dot(glm::vec3(reflection.plane), camera_position) + reflection.plane.w <= 0.0f ||
+               !IsSphereVisible(camera_frustum, surface->GetBoundsCenter(), surface->GetBoundsRadius()))
+            {
+                RenderStats::Get().AddCulledObjects(reflection.meshes.size());
+                continue;
+            }
+
+            reflection.cost.isVisible = true;
+            GpuZone gpu_zone(gpuProfiler, reflection.zoneName->c_str());
+
+            // The camera reflected on the plane, and the plane seen from it
+            const glm::mat4 reflected_view = view_matrix * GetReflectionMatrix(reflection.plane);
+            const glm::vec4 view_plane     = glm::transpose(glm::inverse(reflected_view)) * reflection.plane;
+            const glm::mat4 projection     = GetObliqueProjection(projection_matrix, view_plane);
+
+            // The clusters only need the X and Y of the projection, they are the same
+            reflection.lights->Update(lights, reflected_view, projection_matrix, camera.GetNear(), camera.GetFar(), width, height);
+            reflection.lights->Bind();
+
+            reflection.color = renderTargets->Acquire(width, height, COLOR_FORMAT);
+            reflection.depth = renderTargets->Acquire(width, height, DEPTH_FORMAT);
+
+            renderTargets->Bind(&reflection.color, 1, reflection.depth);
+            device.Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            GetFrustumPlanes(projection * reflected_view, reflected_frustum);
+
+            for(size_t m = 0; m < reflection.meshes.size(); ++m)
+            {
+                Mesh* mesh = reflection.meshes[m];
+
+                if(IsSphereVisible(reflected_frustum, mesh->GetBoundsCenter(), mesh->GetBoundsRadius()))
+                {
+                    mesh->DrawFromView(projection, reflected_view, *reflection.lights);
+                    reflection.cost.drawnMeshes++;
+                }
+                else
+                {
+                    reflection.cost.culledMeshes++;
+                    RenderStats::Get().AddCulledObjects(1);
+                }
+            }
+
+            reflection.cost.cpuTime = clock.getElapsedTime().asMicroseconds() / 1000.0f;
+        }
+
+        device.SetFrontFace(GL_CCW);
+    }
+
+    // Draws the surfaces again on top of the scene, blending their
+    // reflection, and gives the targets back to the pool. Call it after the
+    // scene, on the same frame buffer.
+    //
+    // projection_matrix    The projection of the camera
+    // view_matrix          The camera
+    void PlanarReflections::DrawSurfaces(const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
+    {
+        FLYGL_PROFILE_ZONE("PlanarReflections::DrawSurfaces");
+
+        RenderDevice& device = RenderDevice::Get();
+
+        const glm::vec2 inv_scene_size = 1.0f / glm::vec2(renderTargets->GetWidth(), renderTargets->GetHeight());
+        const GLint     unit           = REFLECTION_UNIT;
+
+        surfaceShader.UseThisShader();
+        device.SetUniform(invSceneSizeID, UNIFORM_VEC2, 1, &inv_scene_size[0]);
+
+        // On the surfaces already drawn, without touching their depth or their speed
+        device.SetCapability   (GL_BLEND, true);
+        device.SetBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        device.SetDepthFunction(GL_LEQUAL);
+        device.SetDepthMask    (false);
+        device.SetCapability   (GL_POLYGON_OFFSET_FILL, true);
+        device.SetPolygonOffset(-1.0f, -1.0f);
+        device.SetColorMask    (1, false);
+
+        for(size_t i = 0; i < reflections.size(); ++i)
+        {
+            Reflection& reflection = reflections[i];
+
+            if(reflection.color == NULL)
+            {
+                continue;
+            }
+
+            device.BindTexture(unit, GL_TEXTURE_2D, reflection.color->texture);
+            device.SetUniform (reflectionTextureID, UNIFORM_INT,   1, &unit                   );
+            device.SetUniform (reflectivityID,      UNIFORM_FLOAT, 1, &reflection.reflectivity);
+
+            reflection.surface->DrawGeometry(projection_matrix, view_matrix, surfaceUniforms);
+
+            renderTargets->Release(reflection.color);
+            renderTargets->Release(reflection.depth);
+            reflection.color = NULL;
+            reflection.depth = NULL;
+        }
+
+        device.SetColorMask    (1, true);
+        device.SetCapability   (GL_POLYGON_OFFSET_FILL, false);
+        device.SetDepthMask    (true);
+        device.SetDepthFunction(GL_LESS);
+        device.SetCapability   (GL_BLEND, false);
+    }
+
+    // The matrix that reflects the world on a plane
+    //
+    // plane    Normal (unit length) and distance
+    glm::mat4 PlanarReflections::GetReflectionMatrix(const glm::vec4& plane)
+    {
+        const glm::vec3 n(plane);
+        glm::mat4 reflection(1.0f);
+
+        for(int column = 0; column < 3; ++column)
+        {
+            for(int row = 0; row < 3; ++row)
+            {
+                reflection[column][row] -= 2.0f * n[row] * n[column];
+            }
+        }
+
+        reflection[3] = glm::vec4(-2.0f * plane.w * n, 1.0f);
+
+        return reflection;
+    }
+
+    // The projection with its near plane moved to the given plane (Lengyel's
+    // oblique frustum). The X and Y of every point are the same, only the
+    // depth changes.
+    //
+    // projection_matrix    A perspective projection
+    // view_plane           The plane in view space, the camera on its negative side
+    glm::mat4 PlanarReflections::GetObliqueProjection(const glm::mat4& projection_matrix, const glm::vec4& view_plane)
+    {
+        glm::mat4 projection = projection_matrix;
+
+        // The corner of the frustum opposite to the plane
+        glm::vec4 corner;
+        corner.x = ((view_plane.x > 0.0f ? 1.0f : (view_plane.x < 0.0f ? -1.0f : 0.0f)) + projection[2][0]) / projection[0][0];
+        corner.y = ((view_plane.y > 0.0f ? 1.0f : (view_plane.y < 0.0f ? -1.0f : 0.0f)) + projection[2][1]) / projection[1][1];
+        corner.z = -1.0f;
+        corner.w = (1.0f + projection[2][2]) / projection[3][2];
+
+        const glm::vec4 scaled = view_plane * (2.0f / glm::dot(view_plane, corner));
+
+        // Third row
+        projection[0][2] = scaled.x - projection[0][3];
+        projection[1][2] = scaled.y - projection[1][3];
+        projection[2][2] = scaled.z - projection[2][3];
+        projection[3][2] = scaled.w - projection[3][3];
+
+        return projection;
+    }
+
+    // The 6 planes of a frustum (left, right, bottom, top, near, far), with
+    // their normals inside
+    //
+    // view_projection  The projection times the view
+    // planes           Where the planes are written
+    void PlanarReflections::GetFrustumPlanes(const glm::mat4& view_projection, glm::vec4* planes)
+    {
+        const glm::vec4 row_x(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+        const glm::vec4 row_y(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+        const glm::vec4 row_z(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+        const glm::vec4 row_w(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+        planes[0] = row_w + row_x;
+        planes[1] = row_w - row_x;
+        planes[2] = row_w + row_y;
+        planes[3] = row_w - row_y;
+        planes[4] = row_w + row_z;
+        planes[5] = row_w - row_z;
+
+        for(int i = 0; i < 6; ++i)
+        {
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+        }
+    }
+
+    // If a sphere touches the inside of the frustum
+    bool PlanarReflections::IsSphereVisible(const glm::vec4* planes, const glm::vec3& center, const float& radius)
+    {
+        for(int i = 0; i < 6; ++i)
+        {
+            if(glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
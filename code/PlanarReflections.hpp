@@ -0,0 +1,151 @@
+/* ---------------------------------------------------------------------------
+** PlanarReflections.hpp
+** Reflections on flat surfaces (mirrors, polished floors...). Every
+** reflection has a plane, the mesh of its surface and the meshes that are
+** reflected on it. Before the scene, each one is drawn from the camera
+** reflected on its plane, on a pooled target smaller than the scene, with
+** an oblique projection whose near plane is the plane itself (so nothing
+** behind the mirror gets in) and its own culling of the meshes and the
+** lights. After the scene, the surfaces are drawn again on top, blending the
+** reflection read at the pixel. A reflection whose surface is not on screen
+** costs nothing, and the cost of every one is measured (CPU time, meshes
+** drawn, and GPU time with a zone of the GpuProfiler, if it is given one).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef PLANARREFLECTIONS_HEADER
+#define PLANARREFLECTIONS_HEADER
+
+#include <string>
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "GpuProfiler.hpp"
+#include "Mesh.hpp"
+#include "RenderTargetPool.hpp"
+
+    namespace flygl
+    {
+        // What a reflection cost on the last frame
+        struct ReflectionCost
+        {
+        public:
+
+            bool  isVisible;        // If its surface was on screen (if not, nothing was drawn)
+            int   drawnMeshes;
+            int   culledMeshes;
+            int   width;            // Size of its target
+            int   height;
+            float cpuTime;          // Milliseconds
+            float gpuTime;          // Milliseconds, average of the GpuProfiler (0 until it is known, or without it)
+        };
+
+        class PlanarReflections
+        {
+        public:
+
+            // Where the reflections are drawn
+            static const GLenum COLOR_FORMAT = GL_RGB8;
+            static const GLenum DEPTH_FORMAT = GL_DEPTH24_STENCIL8;
+
+            // Texture unit of the reflection when the surfaces are drawn
+            static const GLuint REFLECTION_UNIT = 11;
+
+        private:
+
+            struct Reflection
+            {
+            public:
+
+                // Normal and distance in world space (the reflected side is the positive one)
+                glm::vec4 plane;
+
+                Mesh*              surface;
+                float              reflectivity;
+                std::vector<Mesh*> meshes;
+
+                // The lights seen from the reflected camera
+                LightClusters* lights;
+
+                // The targets of this frame, between Draw and DrawSurfaces
+                RenderTarget* color;
+                RenderTarget* depth;
+
+                // Of its zone on the GpuProfiler, that keeps the pointer
+                std::string* zoneName;
+
+                ReflectionCost cost;
+            };
+
+            std::vector<Reflection> reflections;
+
+            RenderTargetPool* renderTargets;
+
+            // Size of the targets, as a fraction of the scene
+            float resolutionScale;
+
+            GpuProfiler* gpuProfiler;
+
+            // The shader that draws the surfaces with their reflection
+            ShaderManager    surfaceShader;
+            GeometryUniforms surfaceUniforms;
+            GLuint           reflectionTextureID;
+            GLuint           reflectivityID;
+            GLuint           invSceneSizeID;
+
+        public:
+
+            // Constructor
+            PlanarReflections(): renderTargets(NULL), resolutionScale(0.5f), gpuProfiler(NULL)
+            {}
+
+            ~PlanarReflections();
+
+            void Initialize(const std::string& vertex_path, const std::string& fragment_path, RenderTargetPool& render_targets);
+
+            int  Add    (const glm::vec3& point, const glm::vec3& normal, Mesh* surface, const float& reflectivity);
+            void AddMesh(const int& reflection, Mesh* mesh);
+
+            void Draw(
+                const LightManager& lights, const Camera& camera,
+                const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
+
+            void DrawSurfaces(const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
+
+            // Size of the targets, as a fraction of the scene size
+            void SetResolutionScale(const float& scale)
+            {
+                resolutionScale = scale;
+            }
+
+            // Every reflection is measured on its own zone (NULL for none)
+            void SetGpuProfiler(GpuProfiler* profiler)
+            {
+                gpuProfiler = profiler;
+            }
+
+            size_t GetCount() const
+            {
+                return reflections.size();
+            }
+
+            // What the reflection cost on the last frame
+            const ReflectionCost& GetCost(const size_t& reflection) const
+            {
+                return reflections[reflection].cost;
+            }
+
+            static glm::mat4 GetReflectionMatrix (const glm::vec4& plane);
+            static glm::mat4 GetObliqueProjection(const glm::mat4& projection_matrix, const glm::vec4& view_plane);
+            static void      GetFrustumPlanes    (const glm::mat4& view_projection, glm::vec4* planes);
+            static bool      IsSphereVisible     (const glm::vec4* planes, const glm::vec3& center, const float& radius);
+        };
+    }
+
+#endif
@@ -14,22 +14,6 @@
 
     namespace flygl
     {
-        // This is a struct to handle multiple lights on the scene.
-        // Used in the View class, but since it is really Light related
-        // I create it here xD
-        struct LightingBuffer
-        {
-        public:
-
-            static const short MAX_LIGHT_NUMBER = 8;
-
-            GLsizei numberOfLights;
-            
-            std::vector<GLfloat> positionBuffer;
-            std::vector<GLfloat> colorBuffer;
-            std::vector<GLfloat> intensityBuffer;
-        };
-
         class PointLight: public Actor
         {
         protected:
@@ -39,11 +23,20 @@
             float     prevIntensity;
             bool      isEnabled;
 
+            // Registry data (see LightManager). When something changes, the
+            // light adds itself to the changed ones of the manager.
+            std::vector<PointLight*>* changedLights;
+            int                       registryIndex;
+            int                       packedIndex;      // Index in the GPU buffer, -1 if not uploaded
+            bool                      isDirty;
+
+            friend class LightManager;
 
         public:
 
 			// Constructor
-			PointLight():Actor(), color(0.0f, 0.0f, 0.0f)
+			PointLight():Actor(), color(0.0f, 0.0f, 0.0f),
+                changedLights(NULL), registryIndex(-1), packedIndex(-1), isDirty(false)
             {
                 intensity = 60.0f;
                 isEnabled = true;
@@ -59,15 +52,14 @@
             // Changes the color of the light 
             void SetColor(const float& r, const float& g, const float& b)
             {
-                color.x = r;
-                color.y = g;
-                color.z = b;
+                SetColor(glm::vec3(r, g, b));
             }
 
             // Changes the color of the light
             void SetColor(const glm::vec3& _color)
             {
                 color = _color;
+                MarkDirty();
             }
 
             // Returns the color of the light
@@ -84,6 +76,7 @@
                 if(isEnabled)
                 {
                     intensity = w;
+                    MarkDirty();
                 }
             }
 
@@ -98,6 +91,7 @@
             {
                 intensity = prevIntensity;
                 isEnabled = true;
+                MarkDirty();
             }
 
             // Switches the light off
@@ -105,6 +99,7 @@
             {
                 intensity = 0.0f;
                 isEnabled = false;
+                MarkDirty();
             }
 
             // If on, turns it on, and viceversa
@@ -125,6 +120,32 @@
             {
                 return isEnabled;
             }
+
+            // If it lights something (disabled or black lights are not uploaded)
+            bool IsLighting() const
+            {
+                return isEnabled && intensity > 0.0f && (color.x > 0.0f || color.y > 0.0f || color.z > 0.0f);
+            }
+
+        protected:
+
+            // Every way of moving it goes through here, also from an Actor&
+            virtual void OnMoved()
+            {
+                MarkDirty();
+            }
+
+        private:
+
+            // Tells the manager (if any) this light has to be uploaded again
+            void MarkDirty()
+            {
+                if(changedLights != NULL && !isDirty)
+                {
+                    isDirty = true;
+                    changedLights->push_back(this);
+                }
+            }
         };
     }
 
@@ -13,59 +13,118 @@
 namespace flygl
 {
     // Initialize the necessary data to start the Postprocessing
+    //
+    // vertex_path      The vertex shader of the effect
+    // fragment_path    The fragment shader of the effect
+    // render_targets   The pool the targets are taken from every frame
     void Postprocess::Initialize(
         const std::string& vertex_path, const std::string& fragment_path,
-        const int& screenWidth, const int& screenHeight)
+        RenderTargetPool& render_targets)
+    {
+        postProcessShader.LoadVertexShader  ( vertex_path   );
+        postProcessShader.LoadFragmentShader( fragment_path );
+
+        InitializeProgram(render_targets);
+    }
+
+    // Compiles the shader code already loaded, and initializes everything
+    // else (the code of generated shaders is not read from a file)
+    //
+    // render_targets   The pool the targets are taken from every frame
+    void Postprocess::InitializeProgram(RenderTargetPool& render_targets)
     {
         attributeCounter = 0;
+        renderTargets    = &render_targets;
 
         //Screen quad
         InitializeRenderQuad();
-        InitializeShaders   (vertex_path, fragment_path);
+
+        postProcessShader.CompileShaders();
+        postProcessShader.UseThisShader();
+
         InitializeAttributes();
 
-        //Create Frame buffer
-        glGenFramebuffers(1, &frameBuffer);
-        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-        
-        InitializeTexturesSection(screenWidth, screenHeight);
-        CreateRenderBuffer       (screenWidth, screenHeight);
+        colorTextureID = postProcessShader.SetUniform("colorTexture");
+
+        InitializeTargetsSection();
     }
 
     // Applies the Postprocessing
-    void Postprocess::Draw()
+    //
+    // input    What the previous pass (or the scene) has drawn
+    // scene    The targets of the scene (speed...)
+    // output   Where the effect is drawn, NULL for the screen
+    void Postprocess::Draw(const RenderTarget* input, const SceneTargets& scene, RenderTarget* output)
     {
         // Bind the final render buffer
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        BindOutput(output);
+
+        inputTarget  = input;
+        sceneTargets = &scene;
+
+        RenderQuad();
+
+        inputTarget  = NULL;
+        sceneTargets = NULL;
+    }
+
+    // Takes a screen sized target for every attachment
+    void Postprocess::AcquireTargets()
+    {
+        ReleaseTargets();
+
+        for(size_t i = 0; i < targetFormats.size(); ++i)
+        {
+            targets.push_back(renderTargets->Acquire(targetFormats[i]));
+        }
+    }
+
+    // Gives the targets back to the pool, somebody else can draw on them
+    void Postprocess::ReleaseTargets()
+    {
+        for(size_t i = 0; i < targets.size(); ++i)
+        {
+            renderTargets->Release(targets[i]);
+        }
+        targets.clear();
+    }
+
+    // Draws the screen quad with the effect on the bound frame buffer
+    void Postprocess::RenderQuad()
+    {
         postProcessShader.UseThisShader();
         
         RenderTextures();
         RenderUniforms();
-        
+
+        DrawQuad();
+    }
+
+    // Draws the screen quad with the shader that is being used
+    void Postprocess::DrawQuad()
+    {
+        RenderDevice& device = RenderDevice::Get();
+
         // Enable attributes
-        for(GLuint i = 0; i < attributeCounter; ++i)
-        {
-            glEnableVertexAttribArray(i);
-        }
+        device.EnableAttributes(attributeCounter, true);
         
         DrawAttributes();
 
         // Draw the Quad that will be on the screen
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
+        device.DrawArrays(GL_TRIANGLE_STRIP, 0, 6);
  
         // Disable attributes
-        for(GLuint i = 0; i < attributeCounter; ++i)
-        {
-            glDisableVertexAttribArray(i);
-        }
+        device.EnableAttributes(attributeCounter, false);
     }
 
     // Initializes the Quad that will be on the screen and that will have
     // the texture for postprocessing
     void Postprocess::InitializeRenderQuad()
     {
-        glGenVertexArrays(1, &vaoQuad);
-        glBindVertexArray(vaoQuad);
+        RenderDevice& device = RenderDevice::Get();
+
+        vaoQuad = device.CreateVertexArray();
+        device.BindVertexArray(vaoQuad);
         
         // An array of 3 vectors which represents 3 vertices
         static const GLfloat g_vertex_buffer_data[] = 
@@ -79,41 +138,18 @@ namespace flygl
              1.0f,-1.0f, 0.0f,
         };
         // Generate 1 buffer, put the resulting identifier in vertexbuffer
-        glGenBuffers(1, &vboQuad);
-        glBindBuffer(GL_ARRAY_BUFFER, vboQuad);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
+        vboQuad = device.CreateBuffer(GL_ARRAY_BUFFER, g_vertex_buffer_data, sizeof(g_vertex_buffer_data), GL_STATIC_DRAW);
     }
 
-    // Initializes a texture with the given parameters
+    // Declares a target of the effect. It will be on the next attachment
+    // (GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, etc...) and on the texture
+    // unit with the same number
     //
-    // texture_id   The uniform ID
-    // texture      The texture itself
-    // attachment   GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, etc...
-    // uniform_name The name that the uniform has on the shader
-    // screenWidth  The width size of the viewport
-    // screenHeight The height size of the viewport
-    void Postprocess::InitializeTexture(
-        GLuint& texture_id, GLuint& texture, 
-        const GLenum& attachment, const std::string& uniform_name, 
-        const int& screenWidth, const int& screenHeight)
+    // internal_format  What the texture stores (GL_RGB8, GL_RG16F...)
+    // uniform_name     The name that the uniform has on the shader
+    void Postprocess::AddTarget(const GLenum& internal_format, const std::string& uniform_name)
     {
-        texture_id = postProcessShader.SetUniform(uniform_name);
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-
-        glTexImage2D
-        (
-            GL_TEXTURE_2D, 0, GL_RGB, screenWidth, screenHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glFramebufferTexture2D
-        (
-            GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0
-        );
-        drawingBuffers.push_back(attachment);
+        targetFormats .push_back(internal_format);
+        targetUniforms.push_back(postProcessShader.SetUniform(uniform_name));
     }
 }
\ No newline at end of file
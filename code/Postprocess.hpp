@@ -11,138 +11,209 @@
 #define POSTPROCESS_HEADER
 
 #include "ShaderManager.hpp"
+#include "RenderTargetPool.hpp"
+#include "RenderDevice.hpp"
 #include <GL\glew.h>
 #include <string>
 #include <vector>
 
     namespace flygl
     {
+        // How an effect reads the image it is applied to
+        enum PostprocessOperation
+        {
+            NEIGHBOURHOOD_OPERATION = 0,    // With its own shader, it is always a pass by itself
+            SAMPLING_OPERATION      = 1,    // A GLSL function that reads the image where it wants, it can start a fused pass
+            POINT_OPERATION         = 2     // A GLSL function of the color of its own pixel, it is fused with the ones before
+        };
+
+        // What the scene has been drawn on, some effects read more than the
+        // color (the depth is the shared one of the pool)
+        struct SceneTargets
+        {
+        public:
+
+            RenderTarget* color;
+            RenderTarget* speed;
+        };
+
         class Postprocess
         {
         protected:
-            //Scene Buffers
-            GLuint frameBuffer;
-            GLuint renderDepthStencilBuffer;
+            // Where the targets come from
+            RenderTargetPool* renderTargets;
+
+            // What is being drawn: the output of the previous pass (or the
+            // scene) and the targets of the scene
+            const RenderTarget* inputTarget;
+            const SceneTargets* sceneTargets;
+            GLuint              colorTextureID;
+
+            // Disabled effects are skipped by the chain
+            bool isEnabled;
+
+            // The chain draws the effect at this fraction of the resolution
+            GLfloat resolutionScale;
 
-            //The color texture
-            GLuint textureColor;
-            GLuint postProcessTextureID;
+            // What the scene is drawn on: a format and a uniform for each
+            // attachment, and the targets acquired for this frame
+            std::vector<GLenum>        targetFormats;
+            std::vector<GLuint>        targetUniforms;
+            std::vector<RenderTarget*> targets;
 
             // The mesh that will serve as the new screen!!
             GLuint vaoQuad;
             GLuint vboQuad;
             
-            // The attribute Position
-            GLuint attPosition;
-            
             // The shaders
             ShaderManager postProcessShader;
 
-            // An array of drawing buffers, if we have more than one texture target
-            std::vector<GLenum> drawingBuffers;
-
             GLuint attributeCounter;
 
         public:
 
 			// Constructor
-			Postprocess()
+			Postprocess(): renderTargets(NULL), inputTarget(NULL), sceneTargets(NULL), isEnabled(false), resolutionScale(1.0f), vaoQuad(0), vboQuad(0)
 			{
 			}
 
             // Destructor
-            ~Postprocess()
+            virtual ~Postprocess()
             {
-                glDeleteFramebuffers (1, &frameBuffer             );
-                glDeleteRenderbuffers(1, &renderDepthStencilBuffer);
-                glDeleteTextures     (1, &textureColor            );
+                ReleaseTargets();
+                RenderDevice::Get().DeleteBuffer     (vboQuad);
+                RenderDevice::Get().DeleteVertexArray(vaoQuad);
             }
 
             virtual void Initialize(
                 const std::string& vertex_path, const std::string& fragment_path, 
-                const int& screenWidth,         const int& screenHeight);
+                RenderTargetPool& render_targets);
+
+            virtual void Draw(const RenderTarget* input, const SceneTargets& scene, RenderTarget* output);
+
+            // Call this before drawing anything, so we switch the frame Buffer.
+            // The targets it declares are taken from the pool until they are released.
+            //
+            // with_depth   If the shared depth is attached (not if the scene is already drawn on it)
+            void PreProcess(const bool& with_depth = true)
+            {
+                AcquireTargets();
+                renderTargets->Bind(&targets[0], targets.size(), with_depth);
+                RenderDevice::Get().SetCapability(GL_DEPTH_TEST, true);
+            }
+
+            // How the effect reads the image (effects with their own shader read the neighbourhood)
+            virtual PostprocessOperation GetOperation() const
+            {
+                return NEIGHBOURHOOD_OPERATION;
+            }
+
+            // If the effect reads the speed of the scene (not only its color)
+            virtual bool UsesSpeed() const
+            {
+                return false;
+            }
 
-            virtual void Draw();
+            // The name of its zones in the profilers (a literal)
+            virtual const char* GetName() const
+            {
+                return "Postprocess";
+            }
 
-            // Call this before drawing anything, so we switch the frame Buffer
-            void PreProcess()
+            void SetEnabled(const bool& enabled)
             {
-                glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-                glDrawBuffers(2, &drawingBuffers[0]);
-                glEnable(GL_DEPTH_TEST);
+                isEnabled = enabled;
             }
 
-            // If the screen changes its size, we must change the size of the texture and the buffer
-            virtual void Resize(const int& screenWidth, const int& screenHeight)
+            bool IsEnabled() const
             {
-                glBindTexture(GL_TEXTURE_2D, textureColor);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, screenWidth, screenHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-                glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, screenWidth, screenHeight);
+                return isEnabled;
+            }
+
+            // Below 1, the chain draws the effect on smaller targets and
+            // upsamples it with the depth (only for effects with their own shader)
+            void SetResolutionScale(const float& scale)
+            {
+                resolutionScale = scale;
+            }
+
+            float GetResolutionScale() const
+            {
+                return resolutionScale;
             }
 
         protected:
 
-            // Initialize the attributes that will be passed to the shader
+            // Initialize the attributes that will be passed to the shader. The
+            // position is its only one (location 0), it is set on the device when
+            // the quad is drawn (see DrawAttributes)
             virtual void InitializeAttributes()
             {
-                attPosition = glGetAttribLocation(postProcessShader.GetProgram(), "position");
-                glEnableVertexAttribArray(attPosition);
-                glVertexAttribPointer(attPosition, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
                 attributeCounter++;
             }
 
-            // Called to initialize every texture
-            virtual void InitializeTexturesSection(const int& screenWidth, const int& screenHeight)
-            {
-                InitializeTexture(postProcessTextureID, textureColor, 
-                    GL_COLOR_ATTACHMENT0, "colorTexture", screenWidth, screenHeight);
-            }
+            // Called to declare the targets it draws the scene on. The effects
+            // of a chain don't need any (they are given an input and an output)
+            virtual void InitializeTargetsSection()
+            {}
 
             // If Uniforms are required, render them here
             virtual void RenderUniforms()
             {}
 
-            // Render the texture. If more textures are needed to render, override this method
+            // Render the textures: the input on the unit 0, or every target on
+            // the unit of its attachment. If more textures are needed to render,
+            // override this method
             virtual void RenderTextures()
             {
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, textureColor);
-                glUniform1i    (postProcessTextureID, 0);
+                RenderDevice& device = RenderDevice::Get();
+
+                if(inputTarget != NULL)
+                {
+                    const GLint unit = 0;
+                    device.BindTexture(unit, GL_TEXTURE_2D, inputTarget->texture);
+                    device.SetUniform (colorTextureID, UNIFORM_INT, 1, &unit);
+                    return;
+                }
+
+                for(size_t i = 0; i < targets.size(); ++i)
+                {
+                    const GLint unit = i;
+                    device.BindTexture(unit, GL_TEXTURE_2D, targets[i]->texture);
+                    device.SetUniform (targetUniforms[i], UNIFORM_INT, 1, &unit);
+                }
             }
 
             // Pass the attributes to the shader. If more attributes are needed, then override this method
             virtual void DrawAttributes()
             {
-                glBindBuffer(GL_ARRAY_BUFFER, vboQuad);
-                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+                RenderDevice::Get().SetVertexAttribute(0, vboQuad, 3, GL_FLOAT);
             }
 
-            void InitializeTexture(
-                GLuint& texture_id,       GLuint& texture, 
-                const GLenum& attachment, const std::string& uniform_name, 
-                const int& screenWidth,   const int& screenHeight);
+            void InitializeProgram(RenderTargetPool& render_targets);
+            void AddTarget        (const GLenum& internal_format, const std::string& uniform_name);
 
-        private:
-
-            void InitializeRenderQuad();
+            void AcquireTargets();
+            void ReleaseTargets();
+            void RenderQuad    ();
+            void DrawQuad      ();
 
-            // Create Renderbuffer Object to hold depth and stencil buffers
-            void CreateRenderBuffer(const int& screenWidth, const int& screenHeight)
+            // Binds the target to draw on, the screen if it is NULL
+            void BindOutput(RenderTarget* output)
             {
-                glGenRenderbuffers       (1, &renderDepthStencilBuffer);
-                glBindRenderbuffer       (GL_RENDERBUFFER, renderDepthStencilBuffer);
-                glRenderbufferStorage    (GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, screenWidth, screenHeight);
-                glFramebufferRenderbuffer(GL_FRAMEBUFFER,  GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderDepthStencilBuffer);
+                if(output != NULL)
+                {
+                    renderTargets->Bind(output);
+                }
+                else
+                {
+                    renderTargets->BindScreen();
+                }
             }
 
-            // Initialize the shaders that have the Postprocess effect
-            void InitializeShaders(const std::string& vertex_path, const std::string& fragment_path)
-            {
-                postProcessShader.LoadVertexShader  ( vertex_path   );
-                postProcessShader.LoadFragmentShader( fragment_path );
-                postProcessShader.CompileShaders();
-                postProcessShader.UseThisShader();
-            }
+        private:
+
+            void InitializeRenderQuad();
         };
     }
 
@@ -0,0 +1,253 @@
+/* ---------------------------------------------------------------------------
+** PostprocessChain.cpp
+** The post processes that are applied to the scene, in the order they were
+** added. Every pass reads what the previous one has drawn: the scene is drawn
+** on a pooled target, the passes go back and forth between two targets of
+** the pool, and only the last one draws on the screen. The passes that are
+** disabled are skipped (if none is enabled the scene goes straight to the
+** screen), and the speed of the scene is only drawn if an enabled pass
+** reads it.
+** Consecutive effects that are only a GLSL function (see FusableEffect) are
+** drawn in one pass, generated for that group and kept for the next frames.
+** An effect with a resolution scale is drawn on smaller targets (its input
+** is downsampled) and then upsampled with the depth (see BilateralUpsample).
+** If the scene is drawn smaller than the screen (render scale of the pool),
+** the last pass draws it on the screen, a copy if there are no effects.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "PostprocessChain.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
+
+namespace flygl
+{
+    const GLenum PostprocessChain::COLOR_FORMAT;
+    const GLenum PostprocessChain::SPEED_FORMAT;
+
+    // The targets are taken from this pool
+    //
+    // render_targets       The pool
+    // fused_vertex_path    The vertex shader of the generated passes (and of the resampling)
+    // copy_path            The shader that copies an image on a target of another size
+    // upsample_path        The shader that draws the output of a scaled effect back with the depth
+    void PostprocessChain::Initialize(
+        RenderTargetPool& render_targets, const std::string& fused_vertex_path,
+        const std::string& copy_path, const std::string& upsample_path)
+    {
+        renderTargets   = &render_targets;
+        fusedVertexPath = fused_vertex_path;
+
+        copy    .Initialize(fused_vertex_path, copy_path,     render_targets);
+        upsample.Initialize(fused_vertex_path, upsample_path, render_targets);
+    }
+
+    // Call this before drawing the scene, it binds where it has to be drawn
+    //
+    // with_depth   If the shared depth is attached (not if the scene is already drawn on it)
+    void PostprocessChain::Begin(const bool& with_depth)
+    {
+        FLYGL_PROFILE_ZONE("PostprocessChain::Begin");
+        MemoryScope memory_scope(MEMORY_POSTPROCESS);
+
+        // Straight to the screen, unless it has to be scaled up
+        if(GetEnabledCount() == 0 && !renderTargets->IsScaled())
+        {
+            renderTargets->BindScreen();
+            RenderDevice::Get().SetCapability(GL_DEPTH_TEST, true);
+            return;
+        }
+
+        RenderTarget* scene[2];
+        int           scene_count = 0;
+
+        sceneTargets.color   = renderTargets->Acquire(COLOR_FORMAT);
+        scene[scene_count++] = sceneTargets.color;
+
+        if(IsSpeedUsed())
+        {
+            sceneTargets.speed   = renderTargets->Acquire(SPEED_FORMAT);
+            scene[scene_count++] = sceneTargets.speed;
+        }
+
+        renderTargets->Bind(scene, scene_count, with_depth);
+        RenderDevice::Get().SetCapability(GL_DEPTH_TEST, true);
+    }
+
+    // Applies every enabled pass. Each one takes a target for its output and
+    // gives back its input, so the next one draws on it.
+    void PostprocessChain::End()
+    {
+        FLYGL_PROFILE_ZONE("PostprocessChain::End");
+
+        if(sceneTargets.color == NULL)
+        {
+            drawPasses.clear();
+            return;
+        }
+
+        BuildDrawPasses();
+
+        // Nothing enabled, the scene is only scaled up
+        if(drawPasses.empty())
+        {
+            drawPasses.push_back(&copy);
+        }
+
+        RenderTarget* input = sceneTargets.color;
+
+        RenderDevice::Get().SetCapability(GL_DEPTH_TEST, false);
+
+        for(size_t i = 0; i < drawPasses.size(); ++i)
+        {
+            FLYGL_PROFILE_ZONE(drawPasses[i]->GetName());
+            GpuZone         gpu_zone  (gpuProfiler, drawPasses[i]->GetName());
+            RenderStatsPass stats_pass(drawPasses[i]->GetName());
+
+            // The last one draws on the screen
+            RenderTarget* output = i + 1 < drawPasses.size() ?
+                renderTargets->Acquire(input->width, input->height, COLOR_FORMAT) : NULL;
+
+            if(drawPasses[i]->GetResolutionScale() < 1.0f)
+            {
+                DrawScaled(drawPasses[i], input, output);
+            }
+            else
+            {
+                drawPasses[i]->Draw(input, sceneTargets, output);
+            }
+
+            renderTargets->Release(input);
+            input = output;
+        }
+
+        RenderDevice::Get().SetCapability(GL_DEPTH_TEST, true);
+
+        renderTargets->Release(sceneTargets.speed);
+        sceneTargets.color = NULL;
+        sceneTargets.speed = NULL;
+    }
+
+    // Number of passes that will be applied
+    int PostprocessChain::GetEnabledCount() const
+    {
+        int count = 0;
+        for(size_t i = 0; i < passes.size(); ++i)
+        {
+            if(passes[i]->IsEnabled())
+            {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // If an enabled pass reads the speed of the scene
+    bool PostprocessChain::IsSpeedUsed() const
+    {
+        for(size_t i = 0; i < passes.size(); ++i)
+        {
+            if(passes[i]->IsEnabled() && passes[i]->UsesSpeed())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Draws a pass on targets of its resolution scale: the input is copied on
+    // a smaller one (the linear filter averages its texels), the pass draws on
+    // another one, and that one is upsampled with the depth on the output
+    //
+    // pass     The effect, its scale is below 1
+    // input    What the previous pass (or the scene) has drawn
+    // output   Where the effect is drawn, NULL for the screen
+    void PostprocessChain::DrawScaled(Postprocess* pass, const RenderTarget* input, RenderTarget* output)
+    {
+        const float scale  = pass->GetResolutionScale();
+        const int   width  = std::max(1, (int)(input->width  * scale + 0.5f));
+        const int   height = std::max(1, (int)(input->height * scale + 0.5f));
+
+        RenderTarget* small_input  = renderTargets->Acquire(width, height, COLOR_FORMAT);
+        RenderTarget* small_output = renderTargets->Acquire(width, height, COLOR_FORMAT);
+
+        copy. Draw(input, sceneTargets, small_input);
+        pass->Draw(small_input, sceneTargets, small_output);
+
+        renderTargets->Release(small_input);
+
+        upsample.Draw(small_output, sceneTargets, output);
+
+        renderTargets->Release(small_output);
+    }
+
+    // The passes to draw: the enabled effects with their own shader, and a
+    // fused pass for every group of consecutive function effects (a sampling
+    // effect starts a new group, it reads the image instead of a color)
+    void PostprocessChain::BuildDrawPasses()
+    {
+        drawPasses.clear();
+        fusedRun  .clear();
+
+        for(size_t i = 0; i < passes.size(); ++i)
+        {
+            if(!passes[i]->IsEnabled())
+            {
+                continue;
+            }
+
+            const PostprocessOperation operation = passes[i]->GetOperation();
+
+            if(operation == NEIGHBOURHOOD_OPERATION)
+            {
+                EndFusedRun();
+                drawPasses.push_back(passes[i]);
+            }
+            else
+            {
+                if(operation == SAMPLING_OPERATION)
+                {
+                    EndFusedRun();
+                }
+
+                // Only the fusable effects have other operations
+                fusedRun.push_back(static_cast<FusableEffect*>(passes[i]));
+            }
+        }
+
+        EndFusedRun();
+    }
+
+    // The group of function effects being built is drawn with its fused pass
+    void PostprocessChain::EndFusedRun()
+    {
+        if(!fusedRun.empty())
+        {
+            drawPasses.push_back(GetFusedPass(fusedRun));
+            fusedRun.clear();
+        }
+    }
+
+    // Returns the pass generated for these effects, it is generated and
+    // compiled if they have never been drawn together
+    FusedPass* PostprocessChain::GetFusedPass(const std::vector<FusableEffect*>& effects)
+    {
+        for(size_t i = 0; i < fusedPasses.size(); ++i)
+        {
+            if(fusedPasses[i]->GetEffects() == effects)
+            {
+                return fusedPasses[i];
+            }
+        }
+
+        FusedPass* pass = new FusedPass();
+        pass->Initialize(effects, fusedVertexPath, *renderTargets);
+
+        fusedPasses.push_back(pass);
+        return pass;
+    }
+}
@@ -0,0 +1,118 @@
+/* ---------------------------------------------------------------------------
+** PostprocessChain.hpp
+** The post processes that are applied to the scene, in the order they were
+** added. Every pass reads what the previous one has drawn: the scene is drawn
+** on a pooled target, the passes go back and forth between two targets of
+** the pool, and only the last one draws on the screen. The passes that are
+** disabled are skipped (if none is enabled the scene goes straight to the
+** screen), and the speed of the scene is only drawn if an enabled pass
+** reads it.
+** Consecutive effects that are only a GLSL function (see FusableEffect) are
+** drawn in one pass, generated for that group and kept for the next frames.
+** An effect with a resolution scale is drawn on smaller targets (its input
+** is downsampled) and then upsampled with the depth (see BilateralUpsample).
+** If the scene is drawn smaller than the screen (render scale of the pool),
+** the last pass draws it on the screen, a copy if there are no effects.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef POSTPROCESSCHAIN_HEADER
+#define POSTPROCESSCHAIN_HEADER
+
+#include "FusedPass.hpp"
+#include "BilateralUpsample.hpp"
+#include "GpuProfiler.hpp"
+
+    namespace flygl
+    {
+        class PostprocessChain
+        {
+        public:
+
+            // What the scene and the passes draw on
+            static const GLenum COLOR_FORMAT = GL_RGB8;
+            static const GLenum SPEED_FORMAT = GL_RG16F;
+
+        private:
+
+            RenderTargetPool*         renderTargets;
+            std::vector<Postprocess*> passes;
+
+            // The generated passes, and the vertex shader they use
+            std::vector<FusedPass*> fusedPasses;
+            std::string             fusedVertexPath;
+
+            // Copies on targets of other sizes, and the upsample of the
+            // effects drawn at a lower resolution
+            Postprocess       copy;
+            BilateralUpsample upsample;
+
+            // What is drawn this frame (fused passes instead of their effects)
+            std::vector<Postprocess*>   drawPasses;
+            std::vector<FusableEffect*> fusedRun;
+
+            // What the scene is being drawn on, between Begin and End
+            SceneTargets sceneTargets;
+
+            // Every pass is measured on it, if there is one
+            GpuProfiler* gpuProfiler;
+
+        public:
+
+            // Constructor
+            PostprocessChain(): renderTargets(NULL), gpuProfiler(NULL)
+            {
+                sceneTargets.color = NULL;
+                sceneTargets.speed = NULL;
+            }
+
+            // Destructor
+            ~PostprocessChain()
+            {
+                for(size_t i = 0; i < fusedPasses.size(); ++i)
+                {
+                    delete fusedPasses[i];
+                }
+            }
+
+            void Initialize(
+                RenderTargetPool& render_targets, const std::string& fused_vertex_path,
+                const std::string& copy_path, const std::string& upsample_path);
+
+            // Adds a pass after the ones already added (it must be initialized).
+            // An effect can't be added twice.
+            void Add(Postprocess* pass)
+            {
+                passes.push_back(pass);
+            }
+
+            void Begin(const bool& with_depth);
+            void End  ();
+
+            void SetGpuProfiler(GpuProfiler* profiler)
+            {
+                gpuProfiler = profiler;
+            }
+
+            int GetEnabledCount() const;
+
+            // Passes drawn on the last frame (after fusing the effects)
+            int GetDrawnCount() const
+            {
+                return drawPasses.size();
+            }
+
+        private:
+
+            bool IsSpeedUsed() const;
+
+            void DrawScaled(Postprocess* pass, const RenderTarget* input, RenderTarget* output);
+
+            void       BuildDrawPasses();
+            void       EndFusedRun    ();
+            FusedPass* GetFusedPass   (const std::vector<FusableEffect*>& effects);
+        };
+    }
+
+#endif
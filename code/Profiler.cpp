@@ -0,0 +1,186 @@
+/* ---------------------------------------------------------------------------
+** Profiler.cpp
+** The threads of the profiler, the frames, and the Chrome trace.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "Profiler.hpp"
+
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+namespace flygl
+{
+    FLYGL_THREAD_LOCAL ProfileThread* Profiler::currentThread = NULL;
+
+    const int ProfileThread::RING_SIZE;
+    const int Profiler::FRAME_RING_SIZE;
+
+    // Every thread that has written a zone, they are never deleted as the
+    // events of a thread that has ended can still be saved
+    static sf::Mutex                    threadsMutex;
+    static std::vector<ProfileThread*>  threads;
+
+    // The start of the last frames, written by the main thread
+    static unsigned long long frameStarts[Profiler::FRAME_RING_SIZE];
+    static long               frameCount = 0;
+
+    // To convert the ticks to microseconds
+    static const unsigned long long startTicks = Profiler::GetTicks();
+    static sf::Clock                startClock;
+
+    // A trace event, with the thread it belongs to
+    struct TraceEvent
+    {
+    public:
+
+        int          thread;
+        ProfileEvent event;
+
+        bool operator<(const TraceEvent& other) const
+        {
+            if(thread != other.thread)
+            {
+                return thread < other.thread;
+            }
+            return event.start < other.event.start;
+        }
+    };
+
+    // Creates the ring of the thread that calls it
+    ProfileThread* Profiler::RegisterThread()
+    {
+        sf::Lock lock(threadsMutex);
+
+        currentThread = new ProfileThread(threads.size() + 1);
+        threads.push_back(currentThread);
+
+        return currentThread;
+    }
+
+    // Creates a ring that no thread writes by itself
+    //
+    // name     Its row in the trace
+    ProfileThread* Profiler::CreateTrack(const std::string& name)
+    {
+        sf::Lock lock(threadsMutex);
+
+        ProfileThread* track = new ProfileThread(threads.size() + 1);
+        track->name = name;
+        threads.push_back(track);
+
+        return track;
+    }
+
+    // The name the thread that calls it has in the trace
+    void Profiler::SetThreadName(const std::string& name)
+    {
+        ProfileThread* thread = currentThread != NULL ? currentThread : RegisterThread();
+
+        sf::Lock lock(threadsMutex);
+        thread->name = name;
+    }
+
+    void Profiler::MarkFrame()
+    {
+        const unsigned long long now = GetTicks();
+
+        if(frameCount > 0)
+        {
+            Record("Frame", frameStarts[(frameCount - 1) % FRAME_RING_SIZE], now);
+        }
+
+        frameStarts[frameCount % FRAME_RING_SIZE] = now;
+        frameCount++;
+    }
+
+    double Profiler::GetTicksPerMicrosecond()
+    {
+        const double microseconds = (double)startClock.getElapsedTime().asMicroseconds();
+        const double ticks        = (double)(GetTicks() - startTicks);
+
+        return microseconds > 0.0 && ticks > 0.0 ? ticks / microseconds : 1.0;
+    }
+
+    // The events of every thread are copied first (the ones the threads may
+    // be writing over are skipped) and written sorted, with the names of the
+    // threads as metadata
+    //
+    // path         The JSON file
+    // last_frames  Only the events of the last frames, 0 for every one
+    bool Profiler::WriteChromeTrace(const std::string& path, const int& last_frames)
+    {
+        unsigned long long since = 0;
+        if(last_frames > 0 && frameCount > 0)
+        {
+            const long frames = std::min((long)std::min(last_frames, FRAME_RING_SIZE), frameCount);
+            since = frameStarts[(frameCount - frames) % FRAME_RING_SIZE];
+        }
+
+        std::vector<TraceEvent>  events;
+        std::vector<std::string> names;
+        {
+            sf::Lock lock(threadsMutex);
+
+            for(size_t i = 0; i < threads.size(); ++i)
+            {
+                const ProfileThread& thread = *threads[i];
+                const long           count  = thread.count;
+                const long           first  = std::max(0L, count - ProfileThread::RING_SIZE + ProfileThread::RING_SIZE / 16);
+
+                names.push_back(thread.name);
+
+                for(long j = first; j < count; ++j)
+                {
+                    TraceEvent trace_event;
+                    trace_event.thread = thread.id;
+                    trace_event.event  = thread.events[j & (ProfileThread::RING_SIZE - 1)];
+
+                    if(trace_event.event.end >= since)
+                    {
+                        events.push_back(trace_event);
+                    }
+                }
+            }
+        }
+
+        std::sort(events.begin(), events.end());
+
+        FILE* file = fopen(path.c_str(), "w");
+        if(file == NULL)
+        {
+            return false;
+        }
+
+        const double ticks_per_microsecond = GetTicksPerMicrosecond();
+
+        fprintf(file, "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [\n");
+        fprintf(file, "    { \"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": { \"name\": \"FlyEngine\" } }");
+
+        for(size_t i = 0; i < names.size(); ++i)
+        {
+            char name[64];
+            sprintf(name, "Thread %u", (unsigned int)i + 1);
+
+            fprintf(file, ",\n    { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": { \"name\": \"%s\" } }",
+                    (unsigned int)i + 1, names[i].empty() ? name : names[i].c_str());
+        }
+
+        for(size_t i = 0; i < events.size(); ++i)
+        {
+            const ProfileEvent& event = events[i].event;
+
+            fprintf(file, ",\n    { \"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f }",
+                    event.name, events[i].thread,
+                    (event.start - startTicks) / ticks_per_microsecond,
+                    (event.end - event.start) / ticks_per_microsecond);
+        }
+
+        fprintf(file, "\n  ]\n}\n");
+
+        fclose(file);
+        return true;
+    }
+}
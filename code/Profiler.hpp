@@ -0,0 +1,192 @@
+/* ---------------------------------------------------------------------------
+** Profiler.hpp
+** Measures where the time of the CPU goes, with zones: a zone is timed from
+** where it is declared to the end of its scope, and written when it ends
+** in a ring of the thread that ran it (only that thread writes there, so
+** no locks are needed). The rings keep the last events, and can be saved
+** as a Chrome trace (chrome://tracing or ui.perfetto.dev), all of them or
+** only the last frames.
+** The zones are declared with the macros, that are empty unless the build
+** defines FLYGL_PROFILING: without it they cost nothing. With it a zone
+** reads the time stamp counter twice and writes an event (some tens of
+** nanoseconds, see the benchmarks).
+**
+**   FLYGL_PROFILE_ZONE("View::Draw");
+**   FLYGL_PROFILE_FRAME();             // Once per frame, on the main thread
+**   FLYGL_PROFILE_THREAD("Worker");    // Name of the thread in the trace
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef PROFILER_HEADER
+#define PROFILER_HEADER
+
+#include <string>
+
+// SFML
+#include <SFML/System.hpp>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #define FLYGL_THREAD_LOCAL      __declspec(thread)
+    #define FLYGL_PROFILER_BARRIER() _ReadWriteBarrier()
+    #define FLYGL_PROFILER_TSC
+#else
+    #define FLYGL_THREAD_LOCAL      __thread
+    #define FLYGL_PROFILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+    #if defined(__i386__) || defined(__x86_64__)
+        #include <x86intrin.h>
+        #define FLYGL_PROFILER_TSC
+    #else
+        #include <time.h>
+    #endif
+#endif
+
+    namespace flygl
+    {
+        // A zone that has ended, in ticks of the profiler
+        struct ProfileEvent
+        {
+        public:
+
+            const char*        name;    // Not copied, it must live as long as the program (a literal)
+            unsigned long long start;
+            unsigned long long end;
+        };
+
+        // The events of a thread
+        struct ProfileThread
+        {
+        public:
+
+            // Events kept, a power of two
+            static const int RING_SIZE = 1 << 16;
+
+            int           id;
+            std::string   name;
+            ProfileEvent* events;
+            volatile long count;        // Events written, the last RING_SIZE are in the ring
+
+            // Constructor
+            ProfileThread(const int& thread_id): id(thread_id), events(new ProfileEvent[RING_SIZE]), count(0)
+            {}
+
+            // Destructor
+            ~ProfileThread()
+            {
+                delete[] events;
+            }
+
+        private:
+
+            // Not copied, it owns the ring
+            ProfileThread(const ProfileThread& other);
+            ProfileThread& operator=(const ProfileThread& other);
+        };
+
+        class Profiler
+        {
+        public:
+
+            // Frames whose start is remembered, for the trace of the last frames
+            static const int FRAME_RING_SIZE = 1024;
+
+        private:
+
+            static FLYGL_THREAD_LOCAL ProfileThread* currentThread;
+
+            static ProfileThread* RegisterThread();
+
+        public:
+
+            // The time stamp counter where there is one (the fastest to read)
+            static unsigned long long GetTicks()
+            {
+                #if defined(FLYGL_PROFILER_TSC)
+                    return __rdtsc();
+                #else
+                    timespec time;
+                    clock_gettime(CLOCK_MONOTONIC, &time);
+                    return (unsigned long long)time.tv_sec * 1000000000ULL + time.tv_nsec;
+                #endif
+            }
+
+            // Writes an event in the ring of the thread that calls it
+            //
+            // name     A literal, only the pointer is kept
+            // start    Ticks of GetTicks
+            // end
+            static void Record(const char* name, const unsigned long long& start, const unsigned long long& end)
+            {
+                Record(currentThread != NULL ? currentThread : RegisterThread(), name, start, end);
+            }
+
+            // Writes an event in a track (see CreateTrack), or the ring of a thread
+            static void Record(ProfileThread* track, const char* name, const unsigned long long& start, const unsigned long long& end)
+            {
+                ProfileEvent& event = track->events[track->count & (ProfileThread::RING_SIZE - 1)];
+                event.name  = name;
+                event.start = start;
+                event.end   = end;
+
+                // The event is complete before the count says it is there (the
+                // stores are not reordered on x86, the compiler mustn't either)
+                FLYGL_PROFILER_BARRIER();
+                track->count = track->count + 1;
+            }
+
+            static void SetThreadName(const std::string& name);
+
+            // A row of the trace that is not a thread, for times measured
+            // elsewhere (the GPU). Only one thread must write on it.
+            static ProfileThread* CreateTrack(const std::string& name);
+
+            // Ends a frame and starts the next one (one "Frame" zone each)
+            static void MarkFrame();
+
+            // Ticks in a microsecond, measured since the program started
+            static double GetTicksPerMicrosecond();
+
+            // Saves the events as a Chrome trace
+            //
+            // path         The JSON file
+            // last_frames  Only the events of the last frames, 0 for every one
+            static bool WriteChromeTrace(const std::string& path, const int& last_frames);
+        };
+
+        // Times its scope (see FLYGL_PROFILE_ZONE)
+        class ProfileZone
+        {
+        private:
+
+            const char*        name;
+            unsigned long long start;
+
+        public:
+
+            // Constructor
+            ProfileZone(const char* zone_name): name(zone_name), start(Profiler::GetTicks())
+            {}
+
+            // Destructor
+            ~ProfileZone()
+            {
+                Profiler::Record(name, start, Profiler::GetTicks());
+            }
+        };
+    }
+
+#define FLYGL_PROFILE_JOIN2(a, b) a##b
+#define FLYGL_PROFILE_JOIN(a, b)  FLYGL_PROFILE_JOIN2(a, b)
+
+#ifdef FLYGL_PROFILING
+    #define FLYGL_PROFILE_ZONE(name)   flygl::ProfileZone FLYGL_PROFILE_JOIN(profileZone, __LINE__)(name)
+    #define FLYGL_PROFILE_FRAME()      flygl::Profiler::MarkFrame()
+    #define FLYGL_PROFILE_THREAD(name) flygl::Profiler::SetThreadName(name)
+#else
+    #define FLYGL_PROFILE_ZONE(name)
+    #define FLYGL_PROFILE_FRAME()
+    #define FLYGL_PROFILE_THREAD(name)
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+/* ---------------------------------------------------------------------------
+** RenderDevice.cpp
+** The current device. It starts being the GL one, and it is always behind
+** the StatsRenderDevice, that counts its calls.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "RenderDevice.hpp"
+#include "GLRenderDevice.hpp"
+#include "StatsRenderDevice.hpp"
+
+namespace flygl
+{
+    // The GL device is always there, it doesn't touch GL until it is used
+    static GLRenderDevice glDevice;
+
+    static StatsRenderDevice statsDevice(&glDevice);
+
+    RenderDevice* RenderDevice::current = &statsDevice;
+
+    // Every draw goes to the given device from now on
+    //
+    // device   The new device, NULL goes back to the GL one
+    void RenderDevice::SetCurrent(RenderDevice* device)
+    {
+        statsDevice.SetDevice(device != NULL ? device : &glDevice);
+    }
+
+    // Bytes of the values of a uniform
+    //
+    // type     What every value is
+    // count    How many values there are (an array)
+    size_t RenderDevice::GetUniformSize(const UniformType& type, const int& count)
+    {
+        size_t components = 1;
+
+        switch(type)
+        {
+            case UNIFORM_INT:   components = 1;  break;
+            case UNIFORM_IVEC3: components = 3;  break;
+            case UNIFORM_FLOAT: components = 1;  break;
+            case UNIFORM_VEC2:  components = 2;  break;
+            case UNIFORM_VEC3:  components = 3;  break;
+            case UNIFORM_VEC4:  components = 4;  break;
+            case UNIFORM_MAT3:  components = 9;  break;
+            case UNIFORM_MAT4:  components = 16; break;
+        }
+
+        // GLint and GLfloat have the same size
+        return components * count * sizeof(GLfloat);
+    }
+}
@@ -0,0 +1,125 @@
+/* ---------------------------------------------------------------------------
+** RenderDevice.hpp
+** What the engine asks the GPU to do: buffers, textures, programs, frame
+** buffers, vertex arrays and draws. The meshes, the shaders, the texture
+** bindings, the render targets and the screen quad go through the current
+** device instead of calling GL, so another device can take its place:
+** GLRenderDevice is the real one (the default), NullRenderDevice draws nothing and can record the
+** commands to replay them later, SoftwareRenderDevice draws on the CPU.
+** Every call goes through the StatsRenderDevice first (see RenderStats).
+** The names it returns (buffers, textures...) are only valid on the device
+** that created them.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef RENDERDEVICE_HEADER
+#define RENDERDEVICE_HEADER
+
+#include <string>
+#include <cstddef>
+
+// glew
+#include <GL/glew.h>
+
+    namespace flygl
+    {
+        // What a uniform is (the values are given as an array of them)
+        enum UniformType
+        {
+            UNIFORM_INT,
+            UNIFORM_IVEC3,
+            UNIFORM_FLOAT,
+            UNIFORM_VEC2,
+            UNIFORM_VEC3,
+            UNIFORM_VEC4,
+            UNIFORM_MAT3,
+            UNIFORM_MAT4
+        };
+
+        class RenderDevice
+        {
+        private:
+
+            // The device every draw goes to
+            static RenderDevice* current;
+
+        public:
+
+            // Destructor
+            virtual ~RenderDevice()
+            {}
+
+            // Buffers (GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER...)
+            virtual GLuint CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage) = 0;
+            virtual void   DeleteBuffer(const GLuint& buffer) = 0;
+            virtual void   SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage) = 0;
+            virtual void   UpdateBuffer (const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size) = 0;
+
+            // Textures: 2D ones without data (render targets), and the binding of any texture
+            virtual GLuint CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter) = 0;
+            virtual void   BindTexture    (const GLuint& unit, const GLenum& target, const GLuint& texture) = 0;
+            virtual void   DeleteTexture  (const GLuint& texture) = 0;
+
+            // Texture arrays (repeated, trilinear) filled with block compressed levels,
+            // from the biggest one. The last level given is the smallest one used
+            virtual GLuint CreateTextureArray ()  = 0;
+            virtual void   SetCompressedLevel (const GLuint& texture, const int& level, const GLenum& internal_format,
+                                               const int& width, const int& height, const int& layers,
+                                               const void* data, const size_t& size) = 0;
+
+            // A texture that reads a buffer (GL_TEXTURE_BUFFER) with the given format
+            virtual GLuint CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format) = 0;
+
+            // Programs, with their shaders code. A program that doesn't compile is 0
+            virtual GLuint CreateProgram     (const std::string& vertex_code, const std::string& fragment_code) = 0;
+            virtual void   DeleteProgram     (const GLuint& program) = 0;
+            virtual void   UseProgram        (const GLuint& program) = 0;
+            virtual GLint  GetUniformLocation(const GLuint& program, const std::string& name) = 0;
+            virtual void   SetUniform        (const GLint& location, const UniformType& type, const int& count, const void* values) = 0;
+
+            // Frame buffers (0 is the screen). Binding one draws on its first draw_buffers attachments
+            virtual GLuint CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture) = 0;
+            virtual void   DeleteFramebuffer(const GLuint& framebuffer) = 0;
+            virtual void   BindFramebuffer  (const GLuint& framebuffer, const int& draw_buffers) = 0;
+            virtual void   SetViewport      (const int& x, const int& y, const int& width, const int& height) = 0;
+            virtual void   Clear            (const GLbitfield& mask) = 0;
+            virtual void   SetClearColor    (const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha) = 0;
+
+            // Fixed function state: GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_POLYGON_OFFSET_FILL
+            virtual void SetCapability    (const GLenum& capability, const bool& enabled) = 0;
+            virtual void SetDepthFunction (const GLenum& function) = 0;
+            virtual void SetDepthMask     (const bool& write) = 0;
+            virtual void SetFrontFace     (const GLenum& mode) = 0;
+            virtual void SetBlendFunction (const GLenum& source, const GLenum& destination) = 0;
+            virtual void SetPolygonOffset (const GLfloat& factor, const GLfloat& units) = 0;
+            virtual void SetColorMask     (const GLuint& attachment, const bool& write) = 0;
+
+            // Vertex arrays, the attributes set are kept on the one bound
+            virtual GLuint CreateVertexArray() = 0;
+            virtual void   BindVertexArray  (const GLuint& vertex_array) = 0;
+            virtual void   DeleteVertexArray(const GLuint& vertex_array) = 0;
+
+            // Vertex attributes read from a buffer, and draws
+            virtual void SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type) = 0;
+            virtual void EnableAttributes  (const GLuint& count, const bool& enabled) = 0;
+            virtual void DrawArrays        (const GLenum& mode, const int& first, const int& count) = 0;
+            virtual void DrawElements      (const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type) = 0;
+
+            // Reads the screen as RGB bytes, from its bottom row
+            virtual void ReadScreen(const int& width, const int& height, unsigned char* pixels) = 0;
+
+            static RenderDevice& Get()
+            {
+                return *current;
+            }
+
+            // Every draw goes to the given device from now on (NULL for the GL one)
+            static void SetCurrent(RenderDevice* device);
+
+            // Bytes of the values of a uniform
+            static size_t GetUniformSize(const UniformType& type, const int& count);
+        };
+    }
+
+#endif
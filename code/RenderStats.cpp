@@ -0,0 +1,256 @@
+/* ---------------------------------------------------------------------------
+** RenderStats.cpp
+** The counts of the frames and how they are written.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "RenderStats.hpp"
+
+#include <cstring>
+
+namespace flygl
+{
+    static RenderStats renderStats;
+
+    // The columns of the CSV and the keys of the JSON, in the order of the counters
+    static const char* COUNTER_NAMES[] =
+    {
+        "draws", "triangles", "vertices", "state_changes", "uniforms",
+        "texture_binds", "buffer_bytes", "target_switches", "drawn_objects", "culled_objects"
+    };
+    static const int COUNTER_COUNT = sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]);
+
+    // The counters as an array, in the order of their names
+    static void GetValues(const RenderCounters& counters, unsigned long* values)
+    {
+        values[0] = counters.drawCalls;
+        values[1] = counters.triangles;
+        values[2] = counters.vertices;
+        values[3] = counters.stateChanges;
+        values[4] = counters.uniformUploads;
+        values[5] = counters.textureBinds;
+        values[6] = counters.bufferBytes;
+        values[7] = counters.targetSwitches;
+        values[8] = counters.drawnObjects;
+        values[9] = counters.culledObjects;
+    }
+
+    void RenderCounters::Reset()
+    {
+        drawCalls      = 0;
+        triangles      = 0;
+        vertices       = 0;
+        stateChanges   = 0;
+        uniformUploads = 0;
+        textureBinds   = 0;
+        bufferBytes    = 0;
+        targetSwitches = 0;
+        drawnObjects   = 0;
+        culledObjects  = 0;
+    }
+
+    RenderCounters& RenderCounters::operator+=(const RenderCounters& other)
+    {
+        drawCalls      += other.drawCalls;
+        triangles      += other.triangles;
+        vertices       += other.vertices;
+        stateChanges   += other.stateChanges;
+        uniformUploads += other.uniformUploads;
+        textureBinds   += other.textureBinds;
+        bufferBytes    += other.bufferBytes;
+        targetSwitches += other.targetSwitches;
+        drawnObjects   += other.drawnObjects;
+        culledObjects  += other.culledObjects;
+
+        return *this;
+    }
+
+    RenderStats& RenderStats::Get()
+    {
+        return renderStats;
+    }
+
+    void RenderStats::BeginFrame()
+    {
+        frame.Reset();
+        passes    .clear();
+        openPasses.clear();
+
+        isInFrame = true;
+    }
+
+    // Keeps the counts of the frame, and writes them on the stream
+    void RenderStats::EndFrame()
+    {
+        if(!isInFrame)
+        {
+            return;
+        }
+
+        isInFrame = false;
+        openPasses.clear();
+
+        lastFrame  = frame;
+        lastPasses = passes;
+        frameCount++;
+
+        if(stream != NULL)
+        {
+            WriteFrame();
+        }
+    }
+
+    // The passes with the same name on a frame are added
+    //
+    // name     A literal, only the pointer is kept
+    void RenderStats::BeginPass(const char* name)
+    {
+        if(!isInFrame)
+        {
+            return;
+        }
+
+        size_t pass = 0;
+        while(pass < passes.size() && strcmp(passes[pass].name, name) != 0)
+        {
+            pass++;
+        }
+
+        if(pass == passes.size())
+        {
+            RenderPassStats new_pass;
+            new_pass.name = name;
+
+            passes.push_back(new_pass);
+        }
+
+        openPasses.push_back(pass);
+    }
+
+    void RenderStats::EndPass()
+    {
+        if(!openPasses.empty())
+        {
+            openPasses.pop_back();
+        }
+    }
+
+    // A draw call
+    //
+    // mode         GL_TRIANGLES or GL_TRIANGLE_STRIP (other modes draw no triangles)
+    // vertices     Vertices (or indices) drawn
+    void RenderStats::AddDraw(const GLenum& mode, const int& vertices)
+    {
+        int triangles = 0;
+        if(mode == GL_TRIANGLES)
+        {
+            triangles = vertices / 3;
+        }
+        else if(mode == GL_TRIANGLE_STRIP && vertices > 2)
+        {
+            triangles = vertices - 2;
+        }
+
+        Add(&RenderCounters::drawCalls, 1);
+        Add(&RenderCounters::triangles, triangles);
+        Add(&RenderCounters::vertices,  vertices);
+    }
+
+    std::string RenderStats::GetSummary() const
+    {
+        char summary[256];
+        sprintf(summary, "%lu draws, %lu triangles, %lu states, %lu uniforms, %lu binds, %lu targets, %lu/%lu objects",
+                lastFrame.drawCalls, lastFrame.triangles, lastFrame.stateChanges, lastFrame.uniformUploads,
+                lastFrame.textureBinds, lastFrame.targetSwitches, lastFrame.drawnObjects,
+                lastFrame.drawnObjects + lastFrame.culledObjects);
+
+        return summary;
+    }
+
+    // path     The file, overwritten
+    bool RenderStats::OpenStream(const std::string& path)
+    {
+        CloseStream();
+
+        stream = fopen(path.c_str(), "w");
+        if(stream == NULL)
+        {
+            return false;
+        }
+
+        isJson = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+
+        if(!isJson)
+        {
+            fprintf(stream, "frame,pass");
+            for(int i = 0; i < COUNTER_COUNT; ++i)
+            {
+                fprintf(stream, ",%s", COUNTER_NAMES[i]);
+            }
+            fprintf(stream, "\n");
+        }
+
+        return true;
+    }
+
+    void RenderStats::CloseStream()
+    {
+        if(stream != NULL)
+        {
+            fclose(stream);
+            stream = NULL;
+        }
+    }
+
+    // The last frame, a line of JSON or a row for the frame and one for
+    // every pass of CSV. It is flushed, so a long run that is killed keeps
+    // its frames.
+    void RenderStats::WriteFrame() const
+    {
+        unsigned long values[COUNTER_COUNT];
+
+        if(isJson)
+        {
+            GetValues(lastFrame, values);
+
+            fprintf(stream, "{ \"frame\": %lu", frameCount);
+            for(int i = 0; i < COUNTER_COUNT; ++i)
+            {
+                fprintf(stream, ", \"%s\": %lu", COUNTER_NAMES[i], values[i]);
+            }
+
+            fprintf(stream, ", \"passes\": [");
+            for(size_t i = 0; i < lastPasses.size(); ++i)
+            {
+                GetValues(lastPasses[i].counters, values);
+
+                fprintf(stream, "%s{ \"name\": \"%s\"", i == 0 ? " " : ", ", lastPasses[i].name);
+                for(int j = 0; j < COUNTER_COUNT; ++j)
+                {
+                    fprintf(stream, ", \"%s\": %lu", COUNTER_NAMES[j], values[j]);
+                }
+                fprintf(stream, " }");
+            }
+            fprintf(stream, " ] }\n");
+        }
+        else
+        {
+            for(size_t i = 0; i <= lastPasses.size(); ++i)
+            {
+                const bool is_frame = i == 0;
+
+                GetValues(is_frame ? lastFrame : lastPasses[i - 1].counters, values);
+
+                fprintf(stream, "%lu,%s", frameCount, is_frame ? "frame" : lastPasses[i - 1].name);
+                for(int j = 0; j < COUNTER_COUNT; ++j)
+                {
+                    fprintf(stream, ",%lu", values[j]);
+                }
+                fprintf(stream, "\n");
+            }
+        }
+
+        fflush(stream);
+    }
+}
@@ -0,0 +1,187 @@
+/* ---------------------------------------------------------------------------
+** RenderStats.hpp
+** Counts what every frame asks the render device to do: draw calls,
+** triangles and vertices, state changes, uniform uploads, texture binds,
+** bytes uploaded to buffers and render target switches, and the objects
+** drawn and culled. The device calls are counted by the StatsRenderDevice
+** (every device is behind it), the objects by the meshes and the culling.
+** The counts of a frame go to its total and to every pass open at that
+** moment (the passes are named scopes, like the ones of the GpuProfiler),
+** and when the frame ends they can be read and are written to the stream,
+** if there is one: a CSV (a row for the frame and one for every pass) or
+** JSON lines (an object per frame), chosen by the extension of the file.
+** It is only used from the thread that draws.
+**
+**   RenderStats::Get().BeginFrame();
+**   {
+**       RenderStatsPass pass("Scene");
+**       ...
+**   }
+**   RenderStats::Get().EndFrame();
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef RENDERSTATS_HEADER
+#define RENDERSTATS_HEADER
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+    namespace flygl
+    {
+        struct RenderCounters
+        {
+        public:
+
+            unsigned long drawCalls;
+            unsigned long triangles;
+            unsigned long vertices;
+            unsigned long stateChanges;     // Programs, fixed function states, viewports and vertex attributes
+            unsigned long uniformUploads;
+            unsigned long textureBinds;
+            unsigned long bufferBytes;      // Uploaded to buffers (created or updated)
+            unsigned long targetSwitches;   // Frame buffers bound
+            unsigned long drawnObjects;
+            unsigned long culledObjects;
+
+            // Constructor
+            RenderCounters()
+            {
+                Reset();
+            }
+
+            void Reset();
+
+            RenderCounters& operator+=(const RenderCounters& other);
+        };
+
+        // The counts of a pass on a frame
+        struct RenderPassStats
+        {
+        public:
+
+            const char*    name;
+            RenderCounters counters;
+        };
+
+        class RenderStats
+        {
+        private:
+
+            // The frame being counted
+            RenderCounters               frame;
+            std::vector<RenderPassStats> passes;
+            std::vector<size_t>          openPasses;
+            bool                         isInFrame;
+
+            // The last frame that ended
+            RenderCounters               lastFrame;
+            std::vector<RenderPassStats> lastPasses;
+            unsigned long                frameCount;
+
+            // Where every frame is written, if there is a stream
+            FILE* stream;
+            bool  isJson;
+
+        public:
+
+            // Constructor
+            RenderStats(): isInFrame(false), frameCount(0), stream(NULL), isJson(false)
+            {}
+
+            // Destructor
+            ~RenderStats()
+            {
+                CloseStream();
+            }
+
+            // The counts of the frames (there is only one)
+            static RenderStats& Get();
+
+            // What is counted before BeginFrame (loading) goes to no frame
+            void BeginFrame();
+            void EndFrame  ();
+
+            // name     A literal, only the pointer is kept
+            void BeginPass(const char* name);
+            void EndPass  ();
+
+            void AddDraw         (const GLenum& mode, const int& vertices);
+            void AddStateChange  ()                     { Add(&RenderCounters::stateChanges,   1);    }
+            void AddUniformUpload()                     { Add(&RenderCounters::uniformUploads, 1);    }
+            void AddTextureBind  ()                     { Add(&RenderCounters::textureBinds,   1);    }
+            void AddBufferBytes  (const size_t& bytes)  { Add(&RenderCounters::bufferBytes,    bytes); }
+            void AddTargetSwitch ()                     { Add(&RenderCounters::targetSwitches, 1);    }
+            void AddDrawnObject  ()                     { Add(&RenderCounters::drawnObjects,   1);    }
+            void AddCulledObjects(const size_t& count)  { Add(&RenderCounters::culledObjects,  count); }
+
+            // The counts of the last frame that ended
+            const RenderCounters& GetFrame() const
+            {
+                return lastFrame;
+            }
+
+            const std::vector<RenderPassStats>& GetPasses() const
+            {
+                return lastPasses;
+            }
+
+            unsigned long GetFrameCount() const
+            {
+                return frameCount;
+            }
+
+            // A line with the main counts of the last frame (for a title bar)
+            std::string GetSummary() const;
+
+            // Writes every frame that ends from now on. A path ending with
+            // .json writes JSON lines, any other a CSV.
+            bool OpenStream (const std::string& path);
+            void CloseStream();
+
+        private:
+
+            // Counts on the frame and on every open pass
+            void Add(unsigned long RenderCounters::* counter, const unsigned long& amount)
+            {
+                if(!isInFrame)
+                {
+                    return;
+                }
+
+                frame.*counter += amount;
+
+                for(size_t i = 0; i < openPasses.size(); ++i)
+                {
+                    passes[openPasses[i]].counters.*counter += amount;
+                }
+            }
+
+            void WriteFrame() const;
+        };
+
+        // Counts its scope as a pass
+        class RenderStatsPass
+        {
+        public:
+
+            // Constructor
+            RenderStatsPass(const char* name)
+            {
+                RenderStats::Get().BeginPass(name);
+            }
+
+            // Destructor
+            ~RenderStatsPass()
+            {
+                RenderStats::Get().EndPass();
+            }
+        };
+    }
+
+#endif
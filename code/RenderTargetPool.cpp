@@ -0,0 +1,292 @@
+/* ---------------------------------------------------------------------------
+** RenderTargetPool.cpp
+** The textures the scene and the post processes draw on. They are not owned
+** by the effects: an effect acquires the targets it needs for the frame (by
+** size and format) and releases them when it is done, so the next one can
+** use them again. The video memory used is the maximum number of targets
+** alive at the same time, not one full set per effect.
+** There is a single depth buffer (a texture, so it can be read), shared by
+** every pass that draws meshes. The frame buffers are cached by the
+** textures attached to them.
+** The scene can be drawn smaller than the screen (render scale): the depth
+** and the targets of the scene size follow the scale, and the last pass of
+** the chain draws them on the screen.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "RenderTargetPool.hpp"
+#include "RenderDevice.hpp"
+#include "MemoryTracker.hpp"
+
+namespace flygl
+{
+    // Deletes every target, frame buffer and the depth
+    RenderTargetPool::~RenderTargetPool()
+    {
+        while(!targets.empty())
+        {
+            DeleteTarget(targets.size() - 1);
+        }
+
+        RenderDevice::Get().DeleteTexture(depthTexture);
+    }
+
+    // The screen changed its size. The depth is created again, and the free
+    // targets are deleted (the effects will acquire them with the new size)
+    //
+    // screen_width     The width size of the viewport
+    // screen_height    The height size of the viewport
+    void RenderTargetPool::Resize(const int& screen_width, const int& screen_height)
+    {
+        screenWidth  = screen_width;
+        screenHeight = screen_height;
+        width        = std::max(1, (int)(screenWidth  * renderScale + 0.5f));
+        height       = std::max(1, (int)(screenHeight * renderScale + 0.5f));
+
+        for(size_t i = targets.size(); i > 0; --i)
+        {
+            if(!targets[i - 1]->isUsed)
+            {
+                DeleteTarget(i - 1);
+            }
+        }
+
+        CreateDepth();
+    }
+
+    // The scene is drawn at this fraction of the screen size. The depth is
+    // created again if the size changes, the targets of the old size are
+    // deleted when they are not used for a while
+    //
+    // scale    From 0 to 1
+    void RenderTargetPool::SetRenderScale(const float& scale)
+    {
+        renderScale = scale;
+
+        const int scaled_width  = std::max(1, (int)(screenWidth  * renderScale + 0.5f));
+        const int scaled_height = std::max(1, (int)(screenHeight * renderScale + 0.5f));
+
+        if(scaled_width != width || scaled_height != height)
+        {
+            width  = scaled_width;
+            height = scaled_height;
+            CreateDepth();
+        }
+    }
+
+    // Called at the end of every frame. The targets that nobody has used for
+    // a while are deleted (for example the ones of an effect that was removed)
+    void RenderTargetPool::EndFrame()
+    {
+        frame++;
+
+        for(size_t i = targets.size(); i > 0; --i)
+        {
+            const RenderTarget& target = *targets[i - 1];
+
+            if(!target.isUsed && frame - target.lastUsedFrame > UNUSED_FRAMES_LIMIT)
+            {
+                DeleteTarget(i - 1);
+            }
+        }
+    }
+
+    // Returns a free target with the given size and format, it is created if
+    // there isn't one. It must be released when it is not needed anymore.
+    //
+    // target_width     Width of the texture
+    // target_height    Height of the texture
+    // internal_format  Sized format (GL_RGB8, GL_RG16F...)
+    RenderTarget* RenderTargetPool::Acquire(const int& target_width, const int& target_height, const GLenum& internal_format)
+    {
+        MemoryScope memory_scope(MEMORY_POSTPROCESS);
+
+        for(size_t i = 0; i < targets.size(); ++i)
+        {
+            RenderTarget* target = targets[i];
+
+            if(!target->isUsed && target->internalFormat == internal_format &&
+               target->width == target_width && target->height == target_height)
+            {
+                target->isUsed        = true;
+                target->lastUsedFrame = frame;
+                return target;
+            }
+        }
+
+        RenderTarget* target = new RenderTarget();
+        target->internalFormat = internal_format;
+        target->width          = target_width;
+        target->height         = target_height;
+        target->isUsed         = true;
+        target->lastUsedFrame  = frame;
+
+        target->texture = RenderDevice::Get().CreateTexture2D(internal_format, target_width, target_height, GL_LINEAR);
+
+        AddSize(target_width * target_height * GetBytesPerPixel(internal_format));
+
+        targets.push_back(target);
+        return target;
+    }
+
+    // The target can be used by somebody else
+    void RenderTargetPool::Release(RenderTarget* target)
+    {
+        if(target != NULL)
+        {
+            target->isUsed        = false;
+            target->lastUsedFrame = frame;
+        }
+    }
+
+    // Binds a frame buffer with the given targets (on GL_COLOR_ATTACHMENT0,
+    // 1...) and sets the viewport to their size
+    //
+    // color_targets    The targets, all with the same size
+    // count            Number of targets
+    // with_depth       If the shared depth is attached (only for scene sized targets)
+    void RenderTargetPool::Bind(RenderTarget* const* color_targets, const int& count, const bool& with_depth)
+    {
+        // The depth is only as big as the scene
+        const bool has_depth = with_depth && color_targets[0]->width == width && color_targets[0]->height == height;
+
+        BindFrameBuffer(color_targets, count, has_depth ? depthTexture : 0);
+    }
+
+    // Binds a frame buffer with the given targets and a depth of their own,
+    // instead of the shared one (for targets that are not of the scene size)
+    //
+    // color_targets    The targets, all with the same size
+    // count            Number of targets
+    // depth_target     A GL_DEPTH24_STENCIL8 target of their size
+    void RenderTargetPool::Bind(RenderTarget* const* color_targets, const int& count, const RenderTarget* depth_target)
+    {
+        BindFrameBuffer(color_targets, count, depth_target->texture);
+    }
+
+    // Binds the screen (frame buffer 0)
+    void RenderTargetPool::BindScreen()
+    {
+        RenderDevice& device = RenderDevice::Get();
+
+        device.BindFramebuffer(0, 0);
+        device.SetViewport    (0, 0, screenWidth, screenHeight);
+    }
+
+    // Binds the frame buffer of these textures, on every draw buffer, and
+    // sets the viewport to their size
+    void RenderTargetPool::BindFrameBuffer(RenderTarget* const* color_targets, const int& count, const GLuint& depth)
+    {
+        MemoryScope memory_scope(MEMORY_POSTPROCESS);
+
+        RenderDevice& device = RenderDevice::Get();
+
+        device.BindFramebuffer(GetFrameBuffer(color_targets, count, depth), count);
+        device.SetViewport    (0, 0, color_targets[0]->width, color_targets[0]->height);
+    }
+
+    // Returns the frame buffer that has these textures attached, creating it
+    // if it is the first time they are drawn together
+    GLuint RenderTargetPool::GetFrameBuffer(RenderTarget* const* color_targets, const int& count, const GLuint& depth)
+    {
+        for(size_t i = 0; i < frameBuffers.size(); ++i)
+        {
+            const FrameBuffer& cached = frameBuffers[i];
+
+            bool same = cached.textureCount == count && cached.depth == depth;
+            for(int j = 0; j < count && same; ++j)
+            {
+                same = cached.textures[j] == color_targets[j]->texture;
+            }
+
+            if(same)
+            {
+                return cached.frameBuffer;
+            }
+        }
+
+        FrameBuffer created;
+        created.textureCount = count;
+        created.depth        = depth;
+
+        for(int i = 0; i < count; ++i)
+        {
+            created.textures[i] = color_targets[i]->texture;
+        }
+
+        created.frameBuffer = RenderDevice::Get().CreateFramebuffer(created.textures, count, depth);
+
+        frameBuffers.push_back(created);
+        return created.frameBuffer;
+    }
+
+    // Deletes the target on the given position, and its frame buffers
+    void RenderTargetPool::DeleteTarget(const size_t& index)
+    {
+        RenderTarget* target = targets[index];
+
+        DeleteFrameBuffers(target->texture);
+        RenderDevice::Get().DeleteTexture(target->texture);
+
+        sizeInBytes -= target->width * target->height * GetBytesPerPixel(target->internalFormat);
+
+        delete target;
+        targets.erase(targets.begin() + index);
+    }
+
+    // Deletes the frame buffers that have the given texture attached (as a
+    // color or as the depth)
+    void RenderTargetPool::DeleteFrameBuffers(const GLuint& texture)
+    {
+        for(size_t i = frameBuffers.size(); i > 0; --i)
+        {
+            const FrameBuffer& cached = frameBuffers[i - 1];
+
+            bool uses_texture = cached.depth == texture;
+            for(int j = 0; j < cached.textureCount && !uses_texture; ++j)
+            {
+                uses_texture = cached.textures[j] == texture;
+            }
+
+            if(uses_texture)
+            {
+                RenderDevice::Get().DeleteFramebuffer(cached.frameBuffer);
+                frameBuffers.erase(frameBuffers.begin() + (i - 1));
+            }
+        }
+    }
+
+    // Creates the shared depth with the scene size (deleting the old one)
+    void RenderTargetPool::CreateDepth()
+    {
+        if(depthTexture != 0)
+        {
+            DeleteFrameBuffers(depthTexture);
+            RenderDevice::Get().DeleteTexture(depthTexture);
+            sizeInBytes -= GetBytesPerPixel(GL_DEPTH24_STENCIL8) * depthWidth * depthHeight;
+        }
+
+        depthTexture = RenderDevice::Get().CreateTexture2D(GL_DEPTH24_STENCIL8, width, height, GL_NEAREST);
+
+        depthWidth  = width;
+        depthHeight = height;
+        AddSize(GetBytesPerPixel(GL_DEPTH24_STENCIL8) * width * height);
+    }
+
+    // Estimated bytes of a pixel in the given format (3 channels of 8 bits
+    // are stored as 4 by most GPUs)
+    size_t RenderTargetPool::GetBytesPerPixel(const GLenum& internal_format)
+    {
+        switch(internal_format)
+        {
+            case GL_R8:                 return 1;
+            case GL_RG8:
+            case GL_R16F:               return 2;
+            case GL_RG32F:
+            case GL_RGBA16F:            return 8;
+            case GL_RGBA32F:            return 16;
+            default:                    return 4;   // RGB8, RGBA8, RG16F, R32F, R11F_G11F_B10F, DEPTH24_STENCIL8
+        }
+    }
+}
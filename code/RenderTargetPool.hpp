@@ -0,0 +1,193 @@
+/* ---------------------------------------------------------------------------
+** RenderTargetPool.hpp
+** The textures the scene and the post processes draw on. They are not owned
+** by the effects: an effect acquires the targets it needs for the frame (by
+** size and format) and releases them when it is done, so the next one can
+** use them again. The video memory used is the maximum number of targets
+** alive at the same time, not one full set per effect.
+** There is a single depth buffer (a texture, so it can be read), shared by
+** every pass that draws meshes. The frame buffers are cached by the
+** textures attached to them.
+** The scene can be drawn smaller than the screen (render scale): the depth
+** and the targets of the scene size follow the scale, and the last pass of
+** the chain draws them on the screen.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef RENDERTARGETPOOL_HEADER
+#define RENDERTARGETPOOL_HEADER
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// glew
+#include <GL/glew.h>
+
+    namespace flygl
+    {
+        // A texture that can be drawn on
+        struct RenderTarget
+        {
+        public:
+
+            GLuint       texture;
+            GLenum       internalFormat;
+            int          width;
+            int          height;
+            bool         isUsed;
+            unsigned int lastUsedFrame;
+        };
+
+        class RenderTargetPool
+        {
+        public:
+
+            // Color textures that can be drawn at the same time
+            static const int MAX_ATTACHMENTS = 4;
+
+            // Free targets that are not used for this many frames are deleted
+            static const unsigned int UNUSED_FRAMES_LIMIT = 60;
+
+        private:
+
+            // A frame buffer with some textures attached
+            struct FrameBuffer
+            {
+                GLuint frameBuffer;
+                GLuint textures[MAX_ATTACHMENTS];
+                int    textureCount;
+                GLuint depth;           // 0 if it has no depth
+            };
+
+            std::vector<RenderTarget*> targets;
+            std::vector<FrameBuffer>   frameBuffers;
+
+            // The shared depth, of the scene size
+            GLuint depthTexture;
+            int    depthWidth;
+            int    depthHeight;
+
+            // Scene size (the screen size times the render scale)
+            int width;
+            int height;
+
+            int   screenWidth;
+            int   screenHeight;
+            float renderScale;
+
+            unsigned int frame;
+
+            // Estimated video memory of every target (and the depth)
+            size_t sizeInBytes;
+            size_t peakSizeInBytes;
+
+        public:
+
+            // Constructor
+            RenderTargetPool(): depthTexture(0), depthWidth(0), depthHeight(0), width(0), height(0),
+                screenWidth(0), screenHeight(0), renderScale(1.0f), frame(0), sizeInBytes(0), peakSizeInBytes(0)
+            {}
+
+            ~RenderTargetPool();
+
+            void Resize        (const int& screen_width, const int& screen_height);
+            void SetRenderScale(const float& scale);
+            void EndFrame      ();
+
+            RenderTarget* Acquire(const int& target_width, const int& target_height, const GLenum& internal_format);
+            void          Release(RenderTarget* target);
+
+            void Bind      (RenderTarget* const* color_targets, const int& count, const bool& with_depth);
+            void Bind      (RenderTarget* const* color_targets, const int& count, const RenderTarget* depth_target);
+            void BindScreen();
+
+            // Acquires a target of the scene size
+            RenderTarget* Acquire(const GLenum& internal_format)
+            {
+                return Acquire(width, height, internal_format);
+            }
+
+            // Binds a single target, without depth
+            void Bind(RenderTarget* color_target)
+            {
+                Bind(&color_target, 1, false);
+            }
+
+            // The shared depth (DEPTH24_STENCIL8)
+            GLuint GetDepthTexture() const
+            {
+                return depthTexture;
+            }
+
+            // The size the scene is drawn at
+            int GetWidth() const
+            {
+                return width;
+            }
+
+            int GetHeight() const
+            {
+                return height;
+            }
+
+            int GetScreenWidth() const
+            {
+                return screenWidth;
+            }
+
+            int GetScreenHeight() const
+            {
+                return screenHeight;
+            }
+
+            float GetRenderScale() const
+            {
+                return renderScale;
+            }
+
+            // If the scene is drawn smaller than the screen
+            bool IsScaled() const
+            {
+                return width != screenWidth || height != screenHeight;
+            }
+
+            // Number of targets, used or not
+            size_t GetTargetCount() const
+            {
+                return targets.size();
+            }
+
+            // Estimated video memory used now
+            size_t GetSize() const
+            {
+                return sizeInBytes;
+            }
+
+            // Estimated video memory used at the worst moment
+            size_t GetPeakSize() const
+            {
+                return peakSizeInBytes;
+            }
+
+            static size_t GetBytesPerPixel(const GLenum& internal_format);
+
+        private:
+
+            void DeleteTarget      (const size_t& index);
+            void DeleteFrameBuffers(const GLuint& texture);
+            void CreateDepth       ();
+
+            void   BindFrameBuffer(RenderTarget* const* color_targets, const int& count, const GLuint& depth);
+            GLuint GetFrameBuffer (RenderTarget* const* color_targets, const int& count, const GLuint& depth);
+
+            void AddSize(const size_t& size)
+            {
+                sizeInBytes    += size;
+                peakSizeInBytes = std::max(peakSizeInBytes, sizeInBytes);
+            }
+        };
+    }
+
+#endif
@@ -0,0 +1,95 @@
+/* ---------------------------------------------------------------------------
+** ResolutionController.cpp
+** Chooses the fraction of the screen size the scene is drawn at, so the
+** frame fits in a time budget. It is given the CPU and GPU time of every
+** frame: when the average is over the budget for a few frames the scale goes
+** down (as much as the pixels that have to be saved), and when it is well
+** under the budget for a long while it goes up a single step. Between both
+** limits nothing changes, so the scale doesn't jump back and forth. It only
+** goes down if the GPU is the slow one (or its time is not known).
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "ResolutionController.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace flygl
+{
+    // How fast the average follows the last frames
+    static const float AVERAGE_WEIGHT = 0.1f;
+
+    // The scale goes up when the frames take less than this part of the budget
+    static const float UPSCALE_RATIO = 0.75f;
+
+    // When it goes down, it aims at this part of the budget
+    static const float DOWNSCALE_TARGET = 0.85f;
+
+    // Adds the times of a frame, and returns the scale for the next one
+    //
+    // cpu_ms   Milliseconds the CPU worked on the frame (without waiting for the screen)
+    // gpu_ms   Milliseconds the GPU worked on it, 0 if it is not known
+    float ResolutionController::Update(const float& cpu_ms, const float& gpu_ms)
+    {
+        // Whatever is slower limits the frame, but the scale only saves GPU time
+        const float frame_time = std::max(cpu_ms, gpu_ms);
+        const bool  gpu_bound  = gpu_ms <= 0.0f || gpu_ms >= cpu_ms;
+
+        averageTime = averageCount == 0 ? frame_time : averageTime + (frame_time - averageTime) * AVERAGE_WEIGHT;
+        averageCount++;
+
+        if(averageTime > budget)
+        {
+            overBudgetFrames++;
+            underBudgetFrames = 0;
+        }
+        else if(averageTime < budget * UPSCALE_RATIO)
+        {
+            underBudgetFrames++;
+            overBudgetFrames = 0;
+        }
+        else
+        {
+            overBudgetFrames  = 0;
+            underBudgetFrames = 0;
+        }
+
+        if(overBudgetFrames >= DOWNSCALE_FRAMES && gpu_bound && scale > minScale)
+        {
+            // The time of the GPU is about the number of pixels, the square of the scale
+            const float wanted = scale * std::sqrt(budget * DOWNSCALE_TARGET / averageTime);
+
+            SetScale(std::min(wanted, scale - step));
+        }
+        else if(underBudgetFrames >= UPSCALE_FRAMES && scale < maxScale)
+        {
+            SetScale(scale + step);
+        }
+
+        return scale;
+    }
+
+    // Back to the highest scale, forgetting every frame
+    void ResolutionController::Reset()
+    {
+        scale             = maxScale;
+        averageTime       = 0.0f;
+        averageCount      = 0;
+        overBudgetFrames  = 0;
+        underBudgetFrames = 0;
+    }
+
+    // Changes the scale (rounded down to a step, between the limits). The
+    // frames before were drawn with the old one, so they are forgotten.
+    void ResolutionController::SetScale(const float& new_scale)
+    {
+        const float steps = std::floor(new_scale / step + 0.001f);
+
+        scale             = std::max(minScale, std::min(maxScale, steps * step));
+        averageCount      = 0;
+        overBudgetFrames  = 0;
+        underBudgetFrames = 0;
+    }
+}
@@ -0,0 +1,88 @@
+/* ---------------------------------------------------------------------------
+** ResolutionController.hpp
+** Chooses the fraction of the screen size the scene is drawn at, so the
+** frame fits in a time budget. It is given the CPU and GPU time of every
+** frame: when the average is over the budget for a few frames the scale goes
+** down (as much as the pixels that have to be saved), and when it is well
+** under the budget for a long while it goes up a single step. Between both
+** limits nothing changes, so the scale doesn't jump back and forth. It only
+** goes down if the GPU is the slow one (or its time is not known).
+** It doesn't touch GL, it can be fed any times to see what it does.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef RESOLUTIONCONTROLLER_HEADER
+#define RESOLUTIONCONTROLLER_HEADER
+
+    namespace flygl
+    {
+        class ResolutionController
+        {
+        public:
+
+            // Frames over the budget before the scale goes down
+            static const int DOWNSCALE_FRAMES = 5;
+
+            // Frames well under the budget before the scale goes up
+            static const int UPSCALE_FRAMES = 60;
+
+        private:
+
+            // Milliseconds a frame can take
+            float budget;
+
+            float minScale;
+            float maxScale;
+            float step;         // The scale is always a multiple of this
+            float scale;
+
+            // Average time of the frames since the last change
+            float averageTime;
+            int   averageCount;
+
+            int overBudgetFrames;
+            int underBudgetFrames;
+
+        public:
+
+            // Constructor
+            //
+            // budget_ms    Milliseconds a frame can take (16.6 for 60 fps)
+            // min_scale    The lowest scale
+            // max_scale    The highest scale (the screen size)
+            ResolutionController(const float& budget_ms = 16.6f, const float& min_scale = 0.5f, const float& max_scale = 1.0f):
+                budget(budget_ms), minScale(min_scale), maxScale(max_scale), step(0.05f), scale(max_scale),
+                averageTime(0.0f), averageCount(0), overBudgetFrames(0), underBudgetFrames(0)
+            {}
+
+            float Update(const float& cpu_ms, const float& gpu_ms);
+            void  Reset ();
+
+            float GetScale() const
+            {
+                return scale;
+            }
+
+            float GetAverageTime() const
+            {
+                return averageTime;
+            }
+
+            void SetBudget(const float& budget_ms)
+            {
+                budget = budget_ms;
+            }
+
+            float GetBudget() const
+            {
+                return budget;
+            }
+
+        private:
+
+            void SetScale(const float& new_scale);
+        };
+    }
+
+#endif
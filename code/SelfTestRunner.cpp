@@ -0,0 +1,368 @@
+/* ---------------------------------------------------------------------------
+** SelfTestRunner.cpp
+** The checks of the self test, and how they are run.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "SelfTestRunner.hpp"
+#include "ResolutionController.hpp"
+#include "View.hpp"
+#include "NullRenderDevice.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace flygl
+{
+    // The budget of the controllers of the checks (60 fps), and the time
+    // of the CPU they are given (always the faster one)
+    static const float BUDGET   = 16.6f;
+    static const float CPU_TIME = 4.0f;
+
+    static bool IsSameScale(const float& a, const float& b)
+    {
+        return std::fabs(a - b) < 0.001f;
+    }
+
+    static std::string Format(const char* format, const int& frame, const float& scale, const float& expected)
+    {
+        char text[256];
+        sprintf(text, format, frame, scale, expected);
+        return text;
+    }
+
+    // Frames over the budget lower the scale only after DOWNSCALE_FRAMES of them
+    class ResolutionDownscaleCase: public SelfTestCase
+    {
+    public:
+
+        std::string GetName() const { return "ResolutionController/downscale after a few frames"; }
+
+        bool Run(std::string& failure)
+        {
+            ResolutionController controller(BUDGET);
+            const float max_scale = controller.GetScale();
+
+            for(int frame = 1; frame <= ResolutionController::DOWNSCALE_FRAMES; ++frame)
+            {
+                const float scale = controller.Update(CPU_TIME, BUDGET * 1.5f);
+
+                if(frame < ResolutionController::DOWNSCALE_FRAMES && !IsSameScale(scale, max_scale))
+                {
+                    failure = Format("frame %d over the budget changed the scale to %.3f (it was %.3f)", frame, scale, max_scale);
+                    return false;
+                }
+
+                if(frame == ResolutionController::DOWNSCALE_FRAMES && scale >= max_scale)
+                {
+                    failure = Format("frame %d over the budget kept the scale at %.3f (it was %.3f)", frame, scale, max_scale);
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // Frames well under the budget raise the scale a single step, after
+    // UPSCALE_FRAMES of them
+    class ResolutionUpscaleCase: public SelfTestCase
+    {
+    public:
+
+        std::string GetName() const { return "ResolutionController/upscale a single step"; }
+
+        bool Run(std::string& failure)
+        {
+            static const float STEP = 0.05f;
+
+            ResolutionController controller(BUDGET);
+
+            // Down first, with the frames of a slow GPU
+            for(int frame = 0; frame < ResolutionController::DOWNSCALE_FRAMES; ++frame)
+            {
+                controller.Update(CPU_TIME, BUDGET * 1.5f);
+            }
+
+            const float low_scale = controller.GetScale();
+            const float up_scale  = low_scale + STEP;
+
+            // Up once, and not again until as many frames have passed
+            for(int frame = 1; frame < 2 * ResolutionController::UPSCALE_FRAMES; ++frame)
+            {
+                const float scale    = controller.Update(CPU_TIME, BUDGET * 0.4f);
+                const float expected = frame < ResolutionController::UPSCALE_FRAMES ? low_scale : up_scale;
+
+                if(!IsSameScale(scale, expected))
+                {
+                    failure = Format("frame %d under the budget has the scale at %.3f (it should be %.3f)", frame, scale, expected);
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // Frames just under the budget, with some noise, never change the scale
+    // (from the highest one or from a lower one)
+    class ResolutionStableCase: public SelfTestCase
+    {
+    public:
+
+        std::string GetName() const { return "ResolutionController/no oscillation under the budget"; }
+
+        bool Run(std::string& failure)
+        {
+            static const int FRAMES = 1000;
+
+            for(int lowered = 0; lowered < 2; ++lowered)
+            {
+                ResolutionController controller(BUDGET);
+
+                for(int frame = 0; lowered && frame < ResolutionController::DOWNSCALE_FRAMES; ++frame)
+                {
+                    controller.Update(CPU_TIME, BUDGET * 1.5f);
+                }
+
+                const float start_scale = controller.GetScale();
+
+                for(int frame = 1; frame <= FRAMES; ++frame)
+                {
+                    const float gpu_time = frame % 2 == 0 ? BUDGET - 0.1f : BUDGET - 0.6f;
+                    const float scale    = controller.Update(CPU_TIME, gpu_time);
+
+                    if(!IsSameScale(scale, start_scale))
+                    {
+                        failure = Format("frame %d just under the budget changed the scale to %.3f (it was %.3f)", frame, scale, start_scale);
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    };
+
+    // The View draws the same frame twice on the NullRenderDevice (nothing
+    // moves, the time doesn't pass), and both must make the same calls with
+    // the same values. Anything the frame keeps changing (a uniform of the
+    // time, a target taken from the pool in another order) is found here.
+    class SameFrameCase: public SelfTestCase
+    {
+    private:
+
+        static const int WIDTH  = 320;
+        static const int HEIGHT = 200;
+
+        std::string effects;
+        bool        isDeferred;
+
+    public:
+
+        // Constructor
+        //
+        // enabled_effects  The keys of the effects, as --effects of the headless run
+        // deferred         If the deferred renderer draws the scene
+        SameFrameCase(const std::string& enabled_effects, const bool& deferred):
+            effects(enabled_effects), isDeferred(deferred)
+        {}
+
+        std::string GetName() const
+        {
+            return std::string("CommandList/the same frame twice, ") + (isDeferred ? "deferred" : "forward") +
+                   (effects.empty() ? "" : ", effects " + effects);
+        }
+
+        bool CanRun() const
+        {
+            FILE* file = fopen("../../assets/models/troll.obj", "r");
+            if(file != NULL)
+            {
+                fclose(file);
+            }
+            return file != NULL;
+        }
+
+        bool Run(std::string& failure)
+        {
+            NullRenderDevice device;
+            RenderDevice::SetCurrent(&device);
+
+            CommandList first, second;
+            size_t      draws;
+            {
+                View view(WIDTH, HEIGHT);
+                view.SetInputsEnabled    (false);
+                view.SetDynamicResolution(false);
+                view.SetWaitForTextures  (true);
+                view.SetDeferred         (isDeferred);
+
+                for(size_t i = 0; i < effects.size(); ++i)
+                {
+                    view.SwitchEffect(effects[i] - '0');
+                }
+
+                // Some frames that move, and one still so the last matrices are the ones of now
+                for(int i = 0; i < 3; ++i)
+                {
+                    view.Update(1.0f / 60.0f);
+                    view.Draw();
+                }
+                view.Update(0.0f);
+                view.Draw();
+
+                device.Reset();
+                view.Update(0.0f);
+                view.Draw();
+                first = device.GetCommands();
+
+                device.Reset();
+                view.Update(0.0f);
+                view.Draw();
+                second = device.GetCommands();
+                draws  = device.GetDrawCount();
+            }
+
+            RenderDevice::SetCurrent(NULL);
+
+            if(draws == 0)
+            {
+                failure = "the frame has no draws";
+                return false;
+            }
+
+            return Compare(first, second, failure);
+        }
+
+    private:
+
+        // The first command that differs, printed
+        static bool Compare(const CommandList& first, const CommandList& second, std::string& failure)
+        {
+            if(first == second)
+            {
+                return true;
+            }
+
+            std::ostringstream first_text, second_text;
+            first .Print(first_text );
+            second.Print(second_text);
+
+            std::istringstream first_lines(first_text.str()), second_lines(second_text.str());
+            std::string        first_line, second_line;
+
+            for(int command = 0; ; ++command)
+            {
+                const bool has_first  = !std::getline(first_lines,  first_line ).fail();
+                const bool has_second = !std::getline(second_lines, second_line).fail();
+
+                if(!has_first)  { first_line  = "nothing"; }
+                if(!has_second) { second_line = "nothing"; }
+
+                if(first_line != second_line || (!has_first && !has_second))
+                {
+                    std::ostringstream text;
+                    text << "command " << command << " is \"" << first_line << "\" and then \"" << second_line << "\"";
+                    failure = text.str();
+                    return false;
+                }
+            }
+        }
+    };
+
+    const int SameFrameCase::WIDTH;
+    const int SameFrameCase::HEIGHT;
+
+    // Destructor
+    SelfTestRunner::~SelfTestRunner()
+    {
+        for(size_t i = 0; i < cases.size(); ++i)
+        {
+            delete cases[i];
+        }
+    }
+
+    // Reads the options. Returns false if there is no --self-test.
+    //
+    // argc     The arguments of main
+    // argv
+    bool SelfTestRunner::ParseArguments(const int& argc, char* argv[])
+    {
+        bool is_self_test = false;
+
+        for(int i = 1; i < argc; ++i)
+        {
+            const std::string option = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if(option == "--self-test")
+            {
+                is_self_test = true;
+            }
+            else if(has_value && option == "--filter") { filter = argv[++i]; }
+            else
+            {
+                error = "Unknown option (or without value): " + option;
+            }
+        }
+
+        return is_self_test;
+    }
+
+    // Runs every case. Returns the exit code of the program.
+    int SelfTestRunner::Run()
+    {
+        if(!error.empty())
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+
+        CreateCases();
+
+        int failed = 0;
+
+        for(size_t i = 0; i < cases.size(); ++i)
+        {
+            const std::string name = cases[i]->GetName();
+
+            if(!filter.empty() && name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            if(!cases[i]->CanRun())
+            {
+                fprintf(stdout, "%-60s skipped\n", name.c_str());
+                continue;
+            }
+
+            std::string failure;
+            if(cases[i]->Run(failure))
+            {
+                fprintf(stdout, "%-60s passed\n", name.c_str());
+            }
+            else
+            {
+                fprintf(stdout, "%-60s FAILED: %s\n", name.c_str(), failure.c_str());
+                failed++;
+            }
+        }
+
+        fprintf(stdout, "%d failed\n", failed);
+
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    void SelfTestRunner::CreateCases()
+    {
+        cases.push_back(new ResolutionDownscaleCase());
+        cases.push_back(new ResolutionUpscaleCase  ());
+        cases.push_back(new ResolutionStableCase   ());
+
+        cases.push_back(new SameFrameCase("",      false));
+        cases.push_back(new SameFrameCase("",      true ));
+        cases.push_back(new SameFrameCase("12356", false));
+    }
+}
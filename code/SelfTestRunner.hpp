@@ -0,0 +1,69 @@
+/* ---------------------------------------------------------------------------
+** SelfTestRunner.hpp
+** Checks of the parts of the engine that can run without a window or a GL
+** context, fed with scripted inputs: the hysteresis of the
+** ResolutionController with made up frame times, and the View drawing the
+** same frame twice on the NullRenderDevice, whose two CommandLists must be
+** equal. Every check prints if it passed (or why it failed, or that it was
+** skipped), and the program fails if any of them fails, so the build
+** machines can run it.
+**
+**   FlyEngine --self-test [--filter ResolutionController]
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef SELFTESTRUNNER_HEADER
+#define SELFTESTRUNNER_HEADER
+
+#include <string>
+#include <vector>
+
+    namespace flygl
+    {
+        // Something to check
+        class SelfTestCase
+        {
+        public:
+
+            // Destructor
+            virtual ~SelfTestCase()
+            {}
+
+            virtual std::string GetName() const = 0;
+
+            // Returns false if the case can't be run (a missing file), it is skipped
+            virtual bool CanRun() const
+            {
+                return true;
+            }
+
+            // Returns false, and what went wrong, if it fails
+            virtual bool Run(std::string& failure) = 0;
+        };
+
+        class SelfTestRunner
+        {
+        private:
+
+            std::string filter;     // Only the cases whose name has it
+
+            std::string error;
+
+            std::vector<SelfTestCase*> cases;
+
+        public:
+
+            // Destructor
+            ~SelfTestRunner();
+
+            bool ParseArguments(const int& argc, char* argv[]);
+            int  Run();
+
+        private:
+
+            void CreateCases();
+        };
+    }
+
+#endif
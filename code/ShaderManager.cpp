@@ -7,6 +7,8 @@
 ** -------------------------------------------------------------------------*/
 
 #include "ShaderManager.hpp"
+#include "Profiler.hpp"
+#include "MemoryTracker.hpp"
 
 #include <string>            //String
 #include <cassert>           //Assert
@@ -27,6 +29,8 @@ namespace flygl
     // path     The Path route of the vertex shader file
 	void ShaderManager::LoadVertexShader(std::string path)
 	{
+        MemoryScope memory_scope(MEMORY_SHADERS);
+
 		vertex_shader_code = "";
 
 		std::ifstream infile;
@@ -47,6 +51,8 @@ namespace flygl
     // path     The Path route of the fragment shader file
 	void ShaderManager::LoadFragmentShader(std::string path)
 	{
+        MemoryScope memory_scope(MEMORY_SHADERS);
+
 		fragment_shader_code = "";
 
 		std::ifstream infile;
@@ -62,111 +68,20 @@ namespace flygl
 		}
 	}
 
-    //Compiles the previously loaded shaders, checking for errors
+    //Compiles the previously loaded shaders, checking for errors (the
+    //render device shows them)
 	void ShaderManager::CompileShaders ()
 	{
-		GLint succeeded = GL_FALSE;
-
-		// Creates shader objects
-
-		GLuint   vertex_shader_id = glCreateShader (GL_VERTEX_SHADER  );
-		GLuint fragment_shader_id = glCreateShader (GL_FRAGMENT_SHADER);
-
-		// Load shaders code
-
-		const char *   vertex_shaders_code[] = {   vertex_shader_code.c_str () };
-		const char * fragment_shaders_code[] = { fragment_shader_code.c_str () };
-		const GLint    vertex_shaders_size[] = {   vertex_shader_code.size  () };
-		const GLint  fragment_shaders_size[] = { fragment_shader_code.size  () };
+        FLYGL_PROFILE_ZONE("ShaderManager::CompileShaders");
+        MemoryScope memory_scope(MEMORY_SHADERS);
 
-		glShaderSource  (  vertex_shader_id, 1,   vertex_shaders_code,   vertex_shaders_size);
-		glShaderSource  (fragment_shader_id, 1, fragment_shaders_code, fragment_shaders_size);
+        RenderDevice& device = RenderDevice::Get();
 
-		// Compile shaders
-
-		glCompileShader (  vertex_shader_id);
-		glCompileShader (fragment_shader_id);
-
-		// Check if the compilation was a success
-
-		glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &succeeded);
-		if (!succeeded)
+        if(program_id != 0)
         {
-            ShowCompilationError (  vertex_shader_id);
+            device.DeleteProgram(program_id);
         }
 
-		glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &succeeded);
-		if (!succeeded) 
-        {
-            ShowCompilationError (fragment_shader_id);
-        }
-
-		// Create the program ID
-
-		program_id = glCreateProgram ();
-
-		// Load the shaders into the program
-
-		glAttachShader  (program_id,   vertex_shader_id);
-		glAttachShader  (program_id, fragment_shader_id);
-
-		// Link the shaders
-
-		glLinkProgram   (program_id);
-
-		// Check if the link was successful
-
-		glGetProgramiv  (program_id, GL_LINK_STATUS, &succeeded);
-		if (!succeeded)
-        {
-            ShowLinkageError (program_id);
-        }
-
-		// Free the shaders
-
-		glDeleteShader (  vertex_shader_id);
-		glDeleteShader (fragment_shader_id);
-	}
-
-    //Shows an error log
-    void ShaderManager::ShowCompilationError (GLuint shader_id)
-	{
-		std::string info_log;
-		GLint  info_log_length;
-
-		glGetShaderiv (shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
-
-		info_log.resize (info_log_length);
-
-		glGetShaderInfoLog (shader_id, info_log_length, NULL, &info_log.front ());
-
-		std::cerr << info_log.c_str () << std::endl;
-
-		#ifdef _MSC_VER
-			OutputDebugStringA (info_log.c_str ());
-		#endif
-
-		assert(false);
-	}
-
-    //Shows an error log
-	void ShaderManager::ShowLinkageError (GLuint program_id)
-	{
-		std::string info_log;
-		GLint  info_log_length;
-
-		glGetProgramiv (program_id, GL_INFO_LOG_LENGTH, &info_log_length);
-
-		info_log.resize (info_log_length);
-
-		glGetProgramInfoLog (program_id, info_log_length, NULL, &info_log.front ());
-
-		std::cerr << info_log.c_str () << std::endl;
-
-		#ifdef _MSC_VER
-			OutputDebugStringA (info_log.c_str ());
-		#endif
-
-		assert(false);
+		program_id = device.CreateProgram(vertex_shader_code, fragment_shader_code);
 	}
-}
+}
\ No newline at end of file
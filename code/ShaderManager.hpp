@@ -20,6 +20,8 @@
 #include <GL/glew.h>
 #include <SFML/OpenGL.hpp>
 
+#include "RenderDevice.hpp"
+
 namespace flygl
 {
 
@@ -37,34 +39,43 @@ namespace flygl
 
         // Constructor
 		ShaderManager(const std::string vertex_shader, const std::string fragment_shader):
-		  vertex_shader_code(vertex_shader), fragment_shader_code(fragment_shader)
+		  program_id(0), vertex_shader_code(vertex_shader), fragment_shader_code(fragment_shader)
 		{}
 
         // Constructor
-		ShaderManager()
+		ShaderManager(): program_id(0)
 		{}
 
         // Destructor
 		~ShaderManager()
 		{
-			glDeleteProgram (program_id);
+            if(program_id != 0)
+            {
+			    RenderDevice::Get().DeleteProgram(program_id);
+            }
 		}
 
     	void LoadVertexShader  (std::string path);
 		void LoadFragmentShader(std::string path);
         void CompileShaders();
 
+        // Uses the given code as the fragment shader (for generated shaders)
+        void SetFragmentShaderCode(const std::string& code)
+        {
+            fragment_shader_code = code;
+        }
+
         //Use this program (after loading and compiling)
         inline void UseThisShader()
         {
-            glUseProgram (program_id);
+            RenderDevice::Get().UseProgram(program_id);
         }
 
         // Sets a uniform with the given name.
         //Returns the ID of the Uniform.
         GLuint SetUniform(const std::string &u_name) const
         {
-            return glGetUniformLocation(program_id, u_name.c_str());
+            return RenderDevice::Get().GetUniformLocation(program_id, u_name);
         }
 
         // Returns the Shader Program
@@ -72,11 +83,6 @@ namespace flygl
         {
             return program_id;
         }
-
-    private:
-
-        void ShowCompilationError (GLuint shader_id );
-		void ShowLinkageError     (GLuint program_id);
     };
 
 }
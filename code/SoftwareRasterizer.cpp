@@ -0,0 +1,978 @@
+/* ---------------------------------------------------------------------------
+** SoftwareRasterizer.cpp
+** Draws triangles on the CPU, in tiles, with every core.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "SoftwareRasterizer.hpp"
+#include "Profiler.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define FLYGL_RASTERIZER_SSE
+#endif
+
+namespace flygl
+{
+    const int SoftwareRasterizer::TILE_SIZE;
+
+    // Bits of the fixed point coordinates under the pixel
+    static const int SUBPIXEL_BITS  = 4;
+    static const int SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;
+    static const int SUBPIXEL_HALF  = SUBPIXEL_SCALE / 2;
+
+    // Pixels a triangle can go out of the viewport before it is clipped. It
+    // keeps the edges inside a block in 32 bits
+    static const float GUARD_BAND = 8192.0f;
+
+    // The smallest depth difference of a 24 bits depth (the polygon offset units)
+    static const float DEPTH_UNIT = 1.0f / 16777216.0f;
+
+    static const int BLOCK_SIZE     = SoftwareTexture::DEPTH_BLOCK_SIZE;
+    static const int SUB_BLOCK_SIZE = BLOCK_SIZE / 2;
+
+    // Rounds the division down, for negative numbers too
+    static long long FloorDivide(const long long& value, const long long& divisor)
+    {
+        const long long quotient = value / divisor;
+        return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+    }
+
+    // The value of a plane (value at the origin, per pixel on X and Y)
+    static float GetPlane(const float* plane, const float& dx, const float& dy)
+    {
+        return plane[0] + plane[1] * dx + plane[2] * dy;
+    }
+
+    // A plane through the values at the 3 vertices
+    //
+    // plane    Where it is written
+    // values   The values at the vertices
+    // x, y     The vertices, in pixels
+    // area     Twice the area of the triangle, in pixels
+    static void SetPlane(float* plane, const float* values, const float* x, const float* y, const float& area)
+    {
+        const float delta1 = values[1] - values[0];
+        const float delta2 = values[2] - values[0];
+
+        plane[0] = values[0];
+        plane[1] = (delta1 * (y[2] - y[0]) - delta2 * (y[1] - y[0])) / area;
+        plane[2] = (delta2 * (x[1] - x[0]) - delta1 * (x[2] - x[0])) / area;
+    }
+
+    // The blend factor of the source or the destination
+    static glm::vec4 GetBlendFactor(const GLenum& factor, const glm::vec4& source, const glm::vec4& destination)
+    {
+        switch(factor)
+        {
+            case GL_ZERO:                return glm::vec4(0.0f);
+            case GL_SRC_COLOR:           return source;
+            case GL_ONE_MINUS_SRC_COLOR: return 1.0f - source;
+            case GL_DST_COLOR:           return destination;
+            case GL_ONE_MINUS_DST_COLOR: return 1.0f - destination;
+            case GL_SRC_ALPHA:           return glm::vec4(source.a);
+            case GL_ONE_MINUS_SRC_ALPHA: return glm::vec4(1.0f - source.a);
+            case GL_DST_ALPHA:           return glm::vec4(destination.a);
+            case GL_ONE_MINUS_DST_ALPHA: return glm::vec4(1.0f - destination.a);
+            default:                     return glm::vec4(1.0f);
+        }
+    }
+
+    // Where an edge is over a block: -1 out, 1 fully in, 0 crossing it
+    //
+    // value    The edge at the first pixel of the block
+    // a, b     The edge steps per sub pixel on X and Y
+    // span     Sub pixels between the first and the last pixel of the block
+    static int ClassifyEdge(const long long& value, const long long& a, const long long& b, const long long& span)
+    {
+        const long long smallest = value + std::min(a, 0LL) * span + std::min(b, 0LL) * span;
+        const long long biggest  = value + std::max(a, 0LL) * span + std::max(b, 0LL) * span;
+
+        return biggest < 0 ? -1 : (smallest >= 0 ? 1 : 0);
+    }
+
+    // ----------------------------------------------------------------------
+    // The jobs of a draw
+    // ----------------------------------------------------------------------
+
+    // Shades a part of the vertices on every thread
+    struct SoftwareRasterizer::VertexJob: public WorkerJob
+    {
+    public:
+
+        SoftwareRasterizer* rasterizer;
+
+        // Constructor
+        VertexJob(SoftwareRasterizer* owner): rasterizer(owner)
+        {}
+
+        void Run(const int& worker)
+        {
+            const int count   = rasterizer->vertices.size();
+            const int threads = rasterizer->GetThreadCount();
+
+            rasterizer->ShadeVertices((int)((long long)count * worker / threads), (int)((long long)count * (worker + 1) / threads));
+        }
+    };
+
+    // Sets up a part of the triangles on every thread, each one on its chunk
+    struct SoftwareRasterizer::SetupJob: public WorkerJob
+    {
+    public:
+
+        SoftwareRasterizer* rasterizer;
+
+        // Constructor
+        SetupJob(SoftwareRasterizer* owner): rasterizer(owner)
+        {}
+
+        void Run(const int& worker)
+        {
+            const size_t count   = rasterizer->triangleIndices.size() / 3;
+            const size_t threads = rasterizer->GetThreadCount();
+
+            rasterizer->SetupTriangles(worker, count * worker / threads, count * (worker + 1) / threads);
+        }
+    };
+
+    // Every thread draws tiles until there are none left
+    struct SoftwareRasterizer::TileJob: public WorkerJob
+    {
+    public:
+
+        SoftwareRasterizer* rasterizer;
+
+        // Constructor
+        TileJob(SoftwareRasterizer* owner): rasterizer(owner)
+        {}
+
+        void Run(const int&)
+        {
+            rasterizer->DrawTiles();
+        }
+    };
+
+    // ----------------------------------------------------------------------
+    // Draws
+    // ----------------------------------------------------------------------
+
+    // Draws triangles. The shaders must have been prepared with their uniforms
+    //
+    // draw_state       The targets and the fixed function state
+    // vertex_shader    The shaders
+    // fragment_shader
+    // draw_attributes  One for every attribute of the vertex shader (MAX_ATTRIBUTES)
+    // mode             GL_TRIANGLES or GL_TRIANGLE_STRIP
+    // indices          The vertices, in order
+    void SoftwareRasterizer::Draw(const SoftwareDrawState& draw_state, const SoftwareVertexShader& vertex_shader, const SoftwareFragmentShader& fragment_shader,
+                                  const SoftwareAttribute* draw_attributes, const GLenum& mode, const std::vector<GLuint>& indices)
+    {
+        FLYGL_PROFILE_ZONE("SoftwareRasterizer::Draw");
+
+        state           = &draw_state;
+        vertexShader    = &vertex_shader;
+        fragmentShader  = &fragment_shader;
+        attributes      = draw_attributes;
+        varyingCount    = std::min(vertex_shader.GetVaryingCount(), (int)SoftwareVertex::MAX_VARYINGS);
+        texcoordVarying = vertex_shader.GetTexcoordVarying();
+
+        // The viewport, inside every target
+        scissorMinX = std::max(0, state->viewportX);
+        scissorMinY = std::max(0, state->viewportY);
+        scissorMaxX = state->viewportX + state->viewportWidth  - 1;
+        scissorMaxY = state->viewportY + state->viewportHeight - 1;
+
+        for(int i = 0; i < state->colorCount; ++i)
+        {
+            if(state->colors[i] != NULL)
+            {
+                scissorMaxX = std::min(scissorMaxX, state->colors[i]->width  - 1);
+                scissorMaxY = std::min(scissorMaxY, state->colors[i]->height - 1);
+            }
+        }
+
+        if(state->depth != NULL)
+        {
+            scissorMaxX = std::min(scissorMaxX, state->depth->width  - 1);
+            scissorMaxY = std::min(scissorMaxY, state->depth->height - 1);
+        }
+
+        if(scissorMinX > scissorMaxX || scissorMinY > scissorMaxY)
+        {
+            return;
+        }
+
+        // The vertices of every triangle (the odd ones of a strip are turned, to keep the winding)
+        triangleIndices.clear();
+
+        if(mode == GL_TRIANGLES)
+        {
+            triangleIndices.assign(indices.begin(), indices.begin() + (indices.size() / 3) * 3);
+        }
+        else if(mode == GL_TRIANGLE_STRIP)
+        {
+            for(size_t i = 0; i + 2 < indices.size(); ++i)
+            {
+                triangleIndices.push_back(indices[i % 2 == 0 ? i     : i + 1]);
+                triangleIndices.push_back(indices[i % 2 == 0 ? i + 1 : i    ]);
+                triangleIndices.push_back(indices[i + 2]);
+            }
+        }
+
+        if(triangleIndices.empty())
+        {
+            return;
+        }
+
+        // Every vertex up to the last one used is shaded
+        vertices.resize(*std::max_element(triangleIndices.begin(), triangleIndices.end()) + 1);
+
+        VertexJob vertex_job(this);
+        pool.Run(vertex_job);
+
+        // Set up and binning, a chunk for every thread
+        tileColumns = scissorMaxX / TILE_SIZE + 1;
+        tileRows    = scissorMaxY / TILE_SIZE + 1;
+
+        chunks.resize(GetThreadCount());
+        for(size_t i = 0; i < chunks.size(); ++i)
+        {
+            Chunk& chunk = chunks[i];
+            chunk.triangles      .clear();
+            chunk.clippedVertices.clear();
+            chunk.bins.resize(tileColumns * tileRows);
+
+            for(size_t j = 0; j < chunk.bins.size(); ++j)
+            {
+                chunk.bins[j].clear();
+            }
+        }
+
+        SetupJob setup_job(this);
+        pool.Run(setup_job);
+
+        // The tiles
+        nextTile = 0;
+
+        TileJob tile_job(this);
+        pool.Run(tile_job);
+    }
+
+    // Runs the vertex shader on some vertices
+    void SoftwareRasterizer::ShadeVertices(const int& first, const int& last)
+    {
+        // The attributes are copied, with the values GL gives the components not set
+        float        values  [SoftwareVertexShader::MAX_ATTRIBUTES][4];
+        const float* pointers[SoftwareVertexShader::MAX_ATTRIBUTES];
+
+        for(int i = 0; i < SoftwareVertexShader::MAX_ATTRIBUTES; ++i)
+        {
+            pointers[i] = values[i];
+        }
+
+        for(int vertex = first; vertex < last; ++vertex)
+        {
+            for(int i = 0; i < SoftwareVertexShader::MAX_ATTRIBUTES; ++i)
+            {
+                const SoftwareAttribute& attribute = attributes[i];
+
+                values[i][0] = values[i][1] = values[i][2] = 0.0f;
+                values[i][3] = 1.0f;
+
+                if(attribute.data != NULL && (size_t)vertex < attribute.vertexCount)
+                {
+                    memcpy(values[i], attribute.data + vertex * attribute.components, std::min(attribute.components, 4) * sizeof(float));
+                }
+            }
+
+            vertexShader->Shade(pointers, vertices[vertex]);
+        }
+    }
+
+    // Clips, culls, sets up and bins some triangles on a chunk
+    void SoftwareRasterizer::SetupTriangles(const int& chunk_index, const size_t& first, const size_t& last)
+    {
+        Chunk& chunk = chunks[chunk_index];
+
+        for(size_t i = first; i < last; ++i)
+        {
+            const int triangle[3] = { (int)triangleIndices[i * 3], (int)triangleIndices[i * 3 + 1], (int)triangleIndices[i * 3 + 2] };
+            ClipTriangle(chunk, triangle);
+        }
+    }
+
+    // Clips the triangle in clip space against the near and far planes, and
+    // the guard band. Most of them are inside and go on as they are
+    void SoftwareRasterizer::ClipTriangle(Chunk& chunk, const int* triangle)
+    {
+        static const int PLANE_COUNT  = 6;
+        static const int MAX_VERTICES = 3 + PLANE_COUNT;
+
+        const float guard_x = 1.0f + 2.0f * GUARD_BAND / state->viewportWidth;
+        const float guard_y = 1.0f + 2.0f * GUARD_BAND / state->viewportHeight;
+
+        // Inside when the position on them is positive
+        const glm::vec4 planes[PLANE_COUNT] =
+        {
+            glm::vec4( 0.0f,  0.0f,  1.0f, 1.0f   ),    // Near
+            glm::vec4( 0.0f,  0.0f, -1.0f, 1.0f   ),    // Far
+            glm::vec4( 1.0f,  0.0f,  0.0f, guard_x),
+            glm::vec4(-1.0f,  0.0f,  0.0f, guard_x),
+            glm::vec4( 0.0f,  1.0f,  0.0f, guard_y),
+            glm::vec4( 0.0f, -1.0f,  0.0f, guard_y)
+        };
+
+        int outside_all = ~0;
+        int outside_any = 0;
+
+        for(int i = 0; i < 3; ++i)
+        {
+            const glm::vec4& position = vertices[triangle[i]].position;
+
+            int outside = 0;
+            for(int j = 0; j < PLANE_COUNT; ++j)
+            {
+                if(glm::dot(planes[j], position) < 0.0f)
+                {
+                    outside |= 1 << j;
+                }
+            }
+
+            outside_all &= outside;
+            outside_any |= outside;
+        }
+
+        // Out of a plane
+        if(outside_all != 0)
+        {
+            return;
+        }
+
+        if(outside_any == 0)
+        {
+            AddTriangle(chunk, triangle);
+            return;
+        }
+
+        SoftwareVertex polygons[2][MAX_VERTICES];
+        int            count   = 3;
+        int            current = 0;
+
+        for(int i = 0; i < 3; ++i)
+        {
+            polygons[0][i] = vertices[triangle[i]];
+        }
+
+        for(int j = 0; j < PLANE_COUNT && count >= 3; ++j)
+        {
+            if((outside_any & (1 << j)) == 0)
+            {
+                continue;
+            }
+
+            const SoftwareVertex* input  = polygons[current];
+            SoftwareVertex*       output = polygons[1 - current];
+            int                   output_count = 0;
+
+            for(int i = 0; i < count; ++i)
+            {
+                const SoftwareVertex& vertex = input[i];
+                const SoftwareVertex& next   = input[(i + 1) % count];
+
+                const float distance      = glm::dot(planes[j], vertex.position);
+                const float next_distance = glm::dot(planes[j], next  .position);
+
+                if(distance >= 0.0f)
+                {
+                    output[output_count++] = vertex;
+                }
+
+                // The edge crosses the plane
+                if((distance >= 0.0f) != (next_distance >= 0.0f))
+                {
+                    const float     t       = distance / (distance - next_distance);
+                    SoftwareVertex& crossed = output[output_count++];
+
+                    crossed.position = glm::mix(vertex.position, next.position, t);
+                    for(int k = 0; k < varyingCount; ++k)
+                    {
+                        crossed.varyings[k] = vertex.varyings[k] + (next.varyings[k] - vertex.varyings[k]) * t;
+                    }
+                }
+            }
+
+            count   = output_count;
+            current = 1 - current;
+        }
+
+        // A fan of triangles with the new vertices
+        const int first_vertex = chunk.clippedVertices.size();
+
+        for(int i = 0; i < count; ++i)
+        {
+            chunk.clippedVertices.push_back(polygons[current][i]);
+        }
+
+        for(int i = 1; i + 1 < count; ++i)
+        {
+            const int fan[3] = { -1 - first_vertex, -1 - (first_vertex + i), -1 - (first_vertex + i + 1) };
+            AddTriangle(chunk, fan);
+        }
+    }
+
+    // Projects, culls and sets up a triangle that is inside the guard band, and bins it
+    void SoftwareRasterizer::AddTriangle(Chunk& chunk, const int* triangle)
+    {
+        float     inverse_w[3], window_z[3];
+        long long fixed_x[3], fixed_y[3];
+
+        for(int i = 0; i < 3; ++i)
+        {
+            const glm::vec4& position = GetVertex(chunk, triangle[i]).position;
+
+            // Only a guard, the clipping keeps it positive
+            if(position.w <= 0.0f)
+            {
+                return;
+            }
+
+            inverse_w[i] = 1.0f / position.w;
+            window_z [i] = position.z * inverse_w[i] * 0.5f + 0.5f;
+
+            const float window_x = state->viewportX + (position.x * inverse_w[i] * 0.5f + 0.5f) * state->viewportWidth;
+            const float window_y = state->viewportY + (position.y * inverse_w[i] * 0.5f + 0.5f) * state->viewportHeight;
+
+            fixed_x[i] = (long long)std::floor(window_x * SUBPIXEL_SCALE + 0.5f);
+            fixed_y[i] = (long long)std::floor(window_y * SUBPIXEL_SCALE + 0.5f);
+        }
+
+        // Twice the area: positive for counter clockwise (Y goes up)
+        long long area = (fixed_x[1] - fixed_x[0]) * (fixed_y[2] - fixed_y[0]) - (fixed_x[2] - fixed_x[0]) * (fixed_y[1] - fixed_y[0]);
+
+        if(area == 0)
+        {
+            return;
+        }
+
+        const bool is_front = (area > 0) == (state->frontFace != GL_CW);
+
+        if(state->cullFace && !is_front)
+        {
+            return;
+        }
+
+        // The back faces that are drawn are turned, every triangle is counter clockwise here
+        int order[3] = { 0, 1, 2 };
+        if(area < 0)
+        {
+            std::swap(order[1], order[2]);
+            area = -area;
+        }
+
+        Triangle result;
+        float    x[3], y[3], z[3], w[3];
+
+        for(int i = 0; i < 3; ++i)
+        {
+            result.vertices[i] = triangle[order[i]];
+
+            x[i] = (float)fixed_x[order[i]] / SUBPIXEL_SCALE;
+            y[i] = (float)fixed_y[order[i]] / SUBPIXEL_SCALE;
+            z[i] = window_z [order[i]];
+            w[i] = inverse_w[order[i]];
+        }
+
+        // The pixels whose center may be inside
+        const long long min_fixed_x = std::min(fixed_x[0], std::min(fixed_x[1], fixed_x[2]));
+        const long long max_fixed_x = std::max(fixed_x[0], std::max(fixed_x[1], fixed_x[2]));
+        const long long min_fixed_y = std::min(fixed_y[0], std::min(fixed_y[1], fixed_y[2]));
+        const long long max_fixed_y = std::max(fixed_y[0], std::max(fixed_y[1], fixed_y[2]));
+
+        result.minX = std::max((long long)scissorMinX, -FloorDivide(SUBPIXEL_HALF - min_fixed_x, SUBPIXEL_SCALE));
+        result.minY = std::max((long long)scissorMinY, -FloorDivide(SUBPIXEL_HALF - min_fixed_y, SUBPIXEL_SCALE));
+        result.maxX = std::min((long long)scissorMaxX, FloorDivide(max_fixed_x - SUBPIXEL_HALF, SUBPIXEL_SCALE));
+        result.maxY = std::min((long long)scissorMaxY, FloorDivide(max_fixed_y - SUBPIXEL_HALF, SUBPIXEL_SCALE));
+
+        if(result.minX > result.maxX || result.minY > result.maxY)
+        {
+            return;
+        }
+
+        // Edges from every vertex to the next one, the inside on their left
+        for(int i = 0; i < 3; ++i)
+        {
+            const int       from = order[i];
+            const int       to   = order[(i + 1) % 3];
+            const long long dx   = fixed_x[to] - fixed_x[from];
+            const long long dy   = fixed_y[to] - fixed_y[from];
+
+            result.edgeA[i] = -dy;
+            result.edgeB[i] =  dx;
+            result.edgeC[i] = dy * fixed_x[from] - dx * fixed_y[from];
+
+            // Top-left rule: the pixels on the other edges belong to the next triangle
+            const bool is_top_left = dy < 0 || (dy == 0 && dx < 0);
+            if(!is_top_left)
+            {
+                result.edgeC[i] -= 1;
+            }
+        }
+
+        // Planes from the first vertex
+        const float pixel_area = (float)area / (SUBPIXEL_SCALE * SUBPIXEL_SCALE);
+
+        const float lambda1[3] = { 0.0f, w[1], 0.0f };
+        const float lambda2[3] = { 0.0f, 0.0f, w[2] };
+
+        SetPlane(result.depth,    z,       x, y, pixel_area);
+        SetPlane(result.inverseW, w,       x, y, pixel_area);
+        SetPlane(result.lambda1,  lambda1, x, y, pixel_area);
+        SetPlane(result.lambda2,  lambda2, x, y, pixel_area);
+
+        result.originX  = x[0];
+        result.originY  = y[0];
+        result.minDepth = std::min(z[0], std::min(z[1], z[2]));
+
+        if(state->polygonOffset)
+        {
+            const float offset = state->offsetFactor * std::max(std::fabs(result.depth[1]), std::fabs(result.depth[2])) +
+                                 state->offsetUnits  * DEPTH_UNIT;
+
+            result.depth[0] += offset;
+            result.minDepth += offset;
+        }
+
+        // Binning
+        const int triangle_index = chunk.triangles.size();
+        chunk.triangles.push_back(result);
+
+        for(int tile_y = result.minY / TILE_SIZE; tile_y <= result.maxY / TILE_SIZE; ++tile_y)
+        {
+            for(int tile_x = result.minX / TILE_SIZE; tile_x <= result.maxX / TILE_SIZE; ++tile_x)
+            {
+                chunk.bins[tile_y * tileColumns + tile_x].push_back(triangle_index);
+            }
+        }
+    }
+
+    // Takes tiles and draws their triangles, in the order of the draw
+    void SoftwareRasterizer::DrawTiles()
+    {
+        const long tile_count = tileColumns * tileRows;
+
+        while(true)
+        {
+            const long tile = WorkerPool::AtomicAdd(nextTile, 1) - 1;
+
+            if(tile >= tile_count)
+            {
+                return;
+            }
+
+            for(size_t i = 0; i < chunks.size(); ++i)
+            {
+                const Chunk&            chunk = chunks[i];
+                const std::vector<int>& bin   = chunk.bins[tile];
+
+                for(size_t j = 0; j < bin.size(); ++j)
+                {
+                    DrawTriangle(chunk, chunk.triangles[bin[j]], tile % tileColumns, tile / tileColumns);
+                }
+            }
+        }
+    }
+
+    // Draws the part of a triangle inside a tile, block by block
+    void SoftwareRasterizer::DrawTriangle(const Chunk& chunk, const Triangle& triangle, const int& tile_x, const int& tile_y)
+    {
+        const int min_x = std::max(triangle.minX, tile_x * TILE_SIZE);
+        const int min_y = std::max(triangle.minY, tile_y * TILE_SIZE);
+        const int max_x = std::min(triangle.maxX, tile_x * TILE_SIZE + TILE_SIZE - 1);
+        const int max_y = std::min(triangle.maxY, tile_y * TILE_SIZE + TILE_SIZE - 1);
+
+        if(min_x > max_x || min_y > max_y)
+        {
+            return;
+        }
+
+        SoftwareTexture* depth = state->depthTest ? state->depth : NULL;
+
+        // Blocks behind the depth can be skipped when the nearer ones pass
+        const bool use_block_depth = depth != NULL && (state->depthFunction == GL_LESS || state->depthFunction == GL_LEQUAL);
+
+        const long long block_span = (BLOCK_SIZE     - 1) * SUBPIXEL_SCALE;
+        const long long sub_span   = (SUB_BLOCK_SIZE - 1) * SUBPIXEL_SCALE;
+
+        for(int block_y = min_y & ~(BLOCK_SIZE - 1); block_y <= max_y; block_y += BLOCK_SIZE)
+        {
+            for(int block_x = min_x & ~(BLOCK_SIZE - 1); block_x <= max_x; block_x += BLOCK_SIZE)
+            {
+                const long long sample_x = (long long)block_x * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+                const long long sample_y = (long long)block_y * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+
+                // The edges over the block
+                bool is_outside = false;
+                bool is_covered = true;
+
+                for(int i = 0; i < 3 && !is_outside; ++i)
+                {
+                    const long long value    = triangle.edgeA[i] * sample_x + triangle.edgeB[i] * sample_y + triangle.edgeC[i];
+                    const int       coverage = ClassifyEdge(value, triangle.edgeA[i], triangle.edgeB[i], block_span);
+
+                    is_outside = coverage < 0;
+                    is_covered = is_covered && coverage > 0;
+                }
+
+                if(is_outside)
+                {
+                    continue;
+                }
+
+                // The nearest depth the triangle can have on the block
+                if(use_block_depth)
+                {
+                    const float dx = block_x + 0.5f - triangle.originX;
+                    const float dy = block_y + 0.5f - triangle.originY;
+                    const float s  = BLOCK_SIZE - 1.0f;
+
+                    const float nearest = std::max(triangle.minDepth, GetPlane(triangle.depth, dx, dy) +
+                                                   std::min(triangle.depth[1] * s, 0.0f) + std::min(triangle.depth[2] * s, 0.0f));
+                    const float block_depth = depth->blockMaxDepth[(block_y / BLOCK_SIZE) * depth->blockColumns + block_x / BLOCK_SIZE];
+
+                    if(state->depthFunction == GL_LESS ? nearest >= block_depth : nearest > block_depth)
+                    {
+                        continue;
+                    }
+                }
+
+                bool is_written = false;
+
+                if(is_covered)
+                {
+                    is_written = DrawBlock(chunk, triangle, block_x, block_y, BLOCK_SIZE, true, min_x, min_y, max_x, max_y);
+                }
+                else
+                {
+                    // The 4x4 blocks
+                    for(int sub_y = block_y; sub_y < block_y + BLOCK_SIZE; sub_y += SUB_BLOCK_SIZE)
+                    {
+                        for(int sub_x = block_x; sub_x < block_x + BLOCK_SIZE; sub_x += SUB_BLOCK_SIZE)
+                        {
+                            const long long sub_sample_x = (long long)sub_x * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+                            const long long sub_sample_y = (long long)sub_y * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+
+                            bool is_sub_outside = false;
+                            bool is_sub_covered = true;
+
+                            for(int i = 0; i < 3 && !is_sub_outside; ++i)
+                            {
+                                const long long value    = triangle.edgeA[i] * sub_sample_x + triangle.edgeB[i] * sub_sample_y + triangle.edgeC[i];
+                                const int       coverage = ClassifyEdge(value, triangle.edgeA[i], triangle.edgeB[i], sub_span);
+
+                                is_sub_outside = coverage < 0;
+                                is_sub_covered = is_sub_covered && coverage > 0;
+                            }
+
+                            if(!is_sub_outside &&
+                               DrawBlock(chunk, triangle, sub_x, sub_y, SUB_BLOCK_SIZE, is_sub_covered, min_x, min_y, max_x, max_y))
+                            {
+                                is_written = true;
+                            }
+                        }
+                    }
+                }
+
+                if(is_written)
+                {
+                    depth->UpdateBlockDepth(block_x / BLOCK_SIZE, block_y / BLOCK_SIZE);
+                }
+            }
+        }
+    }
+
+    // Draws the pixels of a block (rows of 4) inside the triangle and the
+    // depth. Returns true if it wrote on the depth
+    //
+    // x, y         First pixel of the block
+    // size         Pixels of a side (4 or 8)
+    // covered      If the triangle covers the whole block, the edges are not tested
+    // min_x...     The pixels that can be drawn (the triangle inside the tile)
+    bool SoftwareRasterizer::DrawBlock(const Chunk& chunk, const Triangle& triangle, const int& x, const int& y, const int& size,
+                                       const bool& covered, const int& min_x, const int& min_y, const int& max_x, const int& max_y)
+    {
+        SoftwareTexture* depth       = state->depthTest ? state->depth : NULL;
+        const bool       write_depth = depth != NULL && state->depthWrite;
+        bool             is_written  = false;
+
+        // The edges the block crosses, relative to its first pixel. They fit
+        // in 32 bits there (the other ones are inside everywhere)
+        int edge_count = 0;
+        int edge_values[3], edge_steps_x[3], edge_steps_y[3];
+
+        if(!covered)
+        {
+            const long long sample_x = (long long)x * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+            const long long sample_y = (long long)y * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+            const long long span     = (size - 1) * SUBPIXEL_SCALE;
+
+            for(int i = 0; i < 3; ++i)
+            {
+                const long long value = triangle.edgeA[i] * sample_x + triangle.edgeB[i] * sample_y + triangle.edgeC[i];
+
+                if(ClassifyEdge(value, triangle.edgeA[i], triangle.edgeB[i], span) == 0)
+                {
+                    edge_values [edge_count] = (int)value;
+                    edge_steps_x[edge_count] = (int)(triangle.edgeA[i] * SUBPIXEL_SCALE);
+                    edge_steps_y[edge_count] = (int)(triangle.edgeB[i] * SUBPIXEL_SCALE);
+                    edge_count++;
+                }
+            }
+        }
+
+        const float depth_step_x = triangle.depth[1];
+
+        for(int row = 0; row < size; ++row)
+        {
+            const int pixel_y = y + row;
+
+            if(pixel_y < min_y || pixel_y > max_y)
+            {
+                continue;
+            }
+
+            float* depth_row = depth != NULL ? &depth->depth[pixel_y * depth->depthStride] : NULL;
+
+            for(int column = 0; column < size; column += 4)
+            {
+                const int pixel_x = x + column;
+
+                // The pixels inside the bounding box
+                int mask = 0;
+                for(int i = 0; i < 4; ++i)
+                {
+                    if(pixel_x + i >= min_x && pixel_x + i <= max_x)
+                    {
+                        mask |= 1 << i;
+                    }
+                }
+
+                if(mask == 0)
+                {
+                    continue;
+                }
+
+                // The edges
+                #ifdef FLYGL_RASTERIZER_SSE
+
+                    __m128i outside = _mm_setzero_si128();
+
+                    for(int i = 0; i < edge_count; ++i)
+                    {
+                        const int     start  = edge_values[i] + edge_steps_x[i] * column + edge_steps_y[i] * row;
+                        const __m128i values = _mm_add_epi32(_mm_set1_epi32(start),
+                                                             _mm_setr_epi32(0, edge_steps_x[i], edge_steps_x[i] * 2, edge_steps_x[i] * 3));
+                        outside = _mm_or_si128(outside, values);
+                    }
+
+                    mask &= ~_mm_movemask_ps(_mm_castsi128_ps(outside));
+
+                #else
+
+                    for(int i = 0; i < edge_count; ++i)
+                    {
+                        const int start = edge_values[i] + edge_steps_x[i] * column + edge_steps_y[i] * row;
+
+                        for(int j = 0; j < 4; ++j)
+                        {
+                            if(start + edge_steps_x[i] * j < 0)
+                            {
+                                mask &= ~(1 << j);
+                            }
+                        }
+                    }
+
+                #endif
+
+                if(mask == 0)
+                {
+                    continue;
+                }
+
+                // The depth of the 4 pixels
+                float depths[4];
+
+                const float start_depth = GetPlane(triangle.depth, pixel_x + 0.5f - triangle.originX, pixel_y + 0.5f - triangle.originY);
+
+                #ifdef FLYGL_RASTERIZER_SSE
+
+                    __m128 fragment_depth = _mm_add_ps(_mm_set1_ps(start_depth),
+                                                       _mm_mul_ps(_mm_set1_ps(depth_step_x), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+                    fragment_depth = _mm_min_ps(_mm_max_ps(fragment_depth, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+                    _mm_storeu_ps(depths, fragment_depth);
+
+                    if(depth != NULL)
+                    {
+                        const __m128 stored = _mm_loadu_ps(depth_row + pixel_x);
+                        __m128       passed;
+
+                        switch(state->depthFunction)
+                        {
+                            case GL_NEVER:    passed = _mm_setzero_ps();                    break;
+                            case GL_LESS:     passed = _mm_cmplt_ps (fragment_depth, stored); break;
+                            case GL_LEQUAL:   passed = _mm_cmple_ps (fragment_depth, stored); break;
+                            case GL_GREATER:  passed = _mm_cmpgt_ps (fragment_depth, stored); break;
+                            case GL_GEQUAL:   passed = _mm_cmpge_ps (fragment_depth, stored); break;
+                            case GL_EQUAL:    passed = _mm_cmpeq_ps (fragment_depth, stored); break;
+                            case GL_NOTEQUAL: passed = _mm_cmpneq_ps(fragment_depth, stored); break;
+                            default:          passed = _mm_cmpeq_ps (stored, stored);        break;
+                        }
+
+                        mask &= _mm_movemask_ps(passed);
+                    }
+
+                #else
+
+                    for(int i = 0; i < 4; ++i)
+                    {
+                        depths[i] = std::min(1.0f, std::max(0.0f, start_depth + depth_step_x * i));
+
+                        if(depth == NULL || (mask & (1 << i)) == 0)
+                        {
+                            continue;
+                        }
+
+                        const float stored = depth_row[pixel_x + i];
+                        bool        passed;
+
+                        switch(state->depthFunction)
+                        {
+                            case GL_NEVER:    passed = false;                break;
+                            case GL_LESS:     passed = depths[i] <  stored; break;
+                            case GL_LEQUAL:   passed = depths[i] <= stored; break;
+                            case GL_GREATER:  passed = depths[i] >  stored; break;
+                            case GL_GEQUAL:   passed = depths[i] >= stored; break;
+                            case GL_EQUAL:    passed = depths[i] == stored; break;
+                            case GL_NOTEQUAL: passed = depths[i] != stored; break;
+                            default:          passed = true;                break;
+                        }
+
+                        if(!passed)
+                        {
+                            mask &= ~(1 << i);
+                        }
+                    }
+
+                #endif
+
+                for(int i = 0; i < 4; ++i)
+                {
+                    if((mask & (1 << i)) == 0)
+                    {
+                        continue;
+                    }
+
+                    ShadePixel(chunk, triangle, pixel_x + i, pixel_y, depths[i]);
+
+                    if(write_depth)
+                    {
+                        depth_row[pixel_x + i] = depths[i];
+                        is_written = true;
+                    }
+                }
+            }
+        }
+
+        return is_written;
+    }
+
+    // Runs the fragment shader on a pixel, and writes its colors
+    void SoftwareRasterizer::ShadePixel(const Chunk& chunk, const Triangle& triangle, const int& x, const int& y, const float& depth)
+    {
+        const SoftwareVertex& vertex0 = GetVertex(chunk, triangle.vertices[0]);
+        const SoftwareVertex& vertex1 = GetVertex(chunk, triangle.vertices[1]);
+        const SoftwareVertex& vertex2 = GetVertex(chunk, triangle.vertices[2]);
+
+        const float center_x = x + 0.5f;
+        const float center_y = y + 0.5f;
+
+        float lambda1, lambda2;
+        GetBarycentrics(triangle, center_x, center_y, lambda1, lambda2);
+
+        float varyings[SoftwareVertex::MAX_VARYINGS];
+        for(int i = 0; i < varyingCount; ++i)
+        {
+            varyings[i] = vertex0.varyings[i] + lambda1 * (vertex1.varyings[i] - vertex0.varyings[i]) +
+                                                lambda2 * (vertex2.varyings[i] - vertex0.varyings[i]);
+        }
+
+        SoftwareFragment fragment;
+        fragment.fragCoord  = glm::vec4(center_x, center_y, depth,
+                                        GetPlane(triangle.inverseW, center_x - triangle.originX, center_y - triangle.originY));
+        fragment.varyings   = varyings;
+        fragment.texcoordDx = glm::vec2(0.0f);
+        fragment.texcoordDy = glm::vec2(0.0f);
+
+        // The texture coordinates on the next pixels, for the mipmaps
+        if(texcoordVarying >= 0)
+        {
+            const int   t  = texcoordVarying;
+            const float u0 = vertex0.varyings[t],     u1 = vertex1.varyings[t],     u2 = vertex2.varyings[t];
+            const float v0 = vertex0.varyings[t + 1], v1 = vertex1.varyings[t + 1], v2 = vertex2.varyings[t + 1];
+
+            float lambda1_x, lambda2_x, lambda1_y, lambda2_y;
+            GetBarycentrics(triangle, center_x + 1.0f, center_y, lambda1_x, lambda2_x);
+            GetBarycentrics(triangle, center_x, center_y + 1.0f, lambda1_y, lambda2_y);
+
+            fragment.texcoordDx = glm::vec2((lambda1_x - lambda1) * (u1 - u0) + (lambda2_x - lambda2) * (u2 - u0),
+                                            (lambda1_x - lambda1) * (v1 - v0) + (lambda2_x - lambda2) * (v2 - v0));
+            fragment.texcoordDy = glm::vec2((lambda1_y - lambda1) * (u1 - u0) + (lambda2_y - lambda2) * (u2 - u0),
+                                            (lambda1_y - lambda1) * (v1 - v0) + (lambda2_y - lambda2) * (v2 - v0));
+        }
+
+        glm::vec4 outputs[SoftwareFragmentShader::MAX_OUTPUTS];
+        for(int i = 0; i < SoftwareFragmentShader::MAX_OUTPUTS; ++i)
+        {
+            outputs[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        fragmentShader->Shade(fragment, outputs);
+
+        for(int i = 0; i < state->colorCount; ++i)
+        {
+            SoftwareTexture* target = state->colors[i];
+
+            if(target == NULL || !state->colorWrites[i])
+            {
+                continue;
+            }
+
+            glm::vec4 color = outputs[i];
+
+            if(state->blend)
+            {
+                const glm::vec4& destination = target->Read(x, y);
+
+                color = color       * GetBlendFactor(state->blendSource,      outputs[i], destination) +
+                        destination * GetBlendFactor(state->blendDestination, outputs[i], destination);
+            }
+
+            target->Write(x, y, color);
+        }
+    }
+
+    // The barycentrics of the second and the third vertex at a point, with perspective
+    void SoftwareRasterizer::GetBarycentrics(const Triangle& triangle, const float& x, const float& y, float& lambda1, float& lambda2) const
+    {
+        const float dx        = x - triangle.originX;
+        const float dy        = y - triangle.originY;
+        const float inverse_w = GetPlane(triangle.inverseW, dx, dy);
+
+        lambda1 = GetPlane(triangle.lambda1, dx, dy) / inverse_w;
+        lambda2 = GetPlane(triangle.lambda2, dx, dy) / inverse_w;
+    }
+}
@@ -0,0 +1,195 @@
+/* ---------------------------------------------------------------------------
+** SoftwareRasterizer.hpp
+** Draws triangles on the CPU for the SoftwareRenderDevice, with every core:
+**  - The vertices are shaded in parallel.
+**  - The triangles are clipped (near, far and a guard band), culled and
+**    set up with fixed point edges (4 bits under the pixel, top-left rule),
+**    then binned into tiles of 64x64 pixels.
+**  - Every thread takes tiles and draws their triangles in order, in blocks
+**    of 8x8 pixels: whole blocks behind the depth are rejected with the
+**    biggest depth of the block, the ones fully inside the triangle skip
+**    the edges, and the rest are split in 4x4 blocks. The edges and the
+**    depth are tested 4 pixels at a time with SSE2.
+**  - The covered pixels are shaded (with perspective) one by one, blended
+**    and written.
+** As the tiles don't share pixels, the threads never wait for each other
+** until the draw ends.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef SOFTWARERASTERIZER_HEADER
+#define SOFTWARERASTERIZER_HEADER
+
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+#include "SoftwareShaders.hpp"
+#include "SoftwareTexture.hpp"
+#include "WorkerPool.hpp"
+
+    namespace flygl
+    {
+        // Everything a draw needs besides the shaders and the vertices
+        struct SoftwareDrawState
+        {
+        public:
+
+            // Pixels drawn
+            int viewportX;
+            int viewportY;
+            int viewportWidth;
+            int viewportHeight;
+
+            // Targets: one for every output of the fragment shader, and the depth
+            SoftwareTexture* colors[SoftwareFragmentShader::MAX_OUTPUTS];
+            bool             colorWrites[SoftwareFragmentShader::MAX_OUTPUTS];
+            int              colorCount;
+            SoftwareTexture* depth;
+
+            bool   depthTest;
+            bool   depthWrite;
+            GLenum depthFunction;
+
+            bool   cullFace;        // Back faces
+            GLenum frontFace;       // GL_CCW or GL_CW
+
+            bool   blend;
+            GLenum blendSource;
+            GLenum blendDestination;
+
+            bool  polygonOffset;
+            float offsetFactor;
+            float offsetUnits;
+        };
+
+        // A vertex attribute, read from a buffer
+        struct SoftwareAttribute
+        {
+        public:
+
+            const float* data;          // NULL if it is not enabled
+            int          components;
+            size_t       vertexCount;   // Vertices the buffer has
+        };
+
+        class SoftwareRasterizer
+        {
+        public:
+
+            // Pixels of a side of a tile
+            static const int TILE_SIZE = 64;
+
+        private:
+
+            // A triangle ready to be drawn
+            struct Triangle
+            {
+            public:
+
+                int vertices[3];    // Shaded vertices, or clipped ones if they are negative (-1 - index)
+
+                // Edges in fixed point: A * x + B * y + C >= 0 inside (C includes the top-left bias)
+                long long edgeA[3];
+                long long edgeB[3];
+                long long edgeC[3];
+
+                // Planes (value at the origin, per pixel on X and Y): window depth,
+                // 1 / w and the 2 barycentrics over w, for the perspective
+                float depth[3];
+                float inverseW[3];
+                float lambda1[3];
+                float lambda2[3];
+
+                float originX;      // The first vertex, where the planes start
+                float originY;
+                float minDepth;
+
+                // Bounding box, in pixels (last ones included)
+                int minX, minY, maxX, maxY;
+            };
+
+            // What a thread sets up: its triangles, the vertices clipping
+            // created, and the triangles of every tile
+            struct Chunk
+            {
+            public:
+
+                std::vector<Triangle>             triangles;
+                std::vector<SoftwareVertex>       clippedVertices;
+                std::vector<std::vector<int> >    bins;
+            };
+
+            struct VertexJob;
+            struct SetupJob;
+            struct TileJob;
+
+            WorkerPool pool;
+
+            std::vector<SoftwareVertex> vertices;
+            std::vector<Chunk>          chunks;
+
+            // The draw being done
+            const SoftwareDrawState*      state;
+            const SoftwareVertexShader*   vertexShader;
+            const SoftwareFragmentShader* fragmentShader;
+            const SoftwareAttribute*      attributes;
+            std::vector<GLuint>           triangleIndices;   // 3 vertices per triangle
+
+            int varyingCount;
+            int texcoordVarying;
+
+            // Pixels that can be drawn: the viewport inside the targets
+            int scissorMinX, scissorMinY, scissorMaxX, scissorMaxY;
+            int tileColumns, tileRows;
+
+            volatile long nextTile;
+
+        public:
+
+            // Constructor
+            SoftwareRasterizer(): state(NULL), vertexShader(NULL), fragmentShader(NULL), attributes(NULL),
+                varyingCount(0), texcoordVarying(-1), nextTile(0)
+            {}
+
+            // Threads that draw, counting the caller (0 for one per core)
+            void SetThreadCount(const int& thread_count)
+            {
+                pool.Start(thread_count);
+            }
+
+            int GetThreadCount() const
+            {
+                return pool.GetThreadCount();
+            }
+
+            // Draws the triangles of a GL_TRIANGLES or GL_TRIANGLE_STRIP list of vertices
+            void Draw(const SoftwareDrawState& draw_state, const SoftwareVertexShader& vertex_shader, const SoftwareFragmentShader& fragment_shader,
+                      const SoftwareAttribute* draw_attributes, const GLenum& mode, const std::vector<GLuint>& indices);
+
+        private:
+
+            void ShadeVertices  (const int& first, const int& last);
+            void SetupTriangles (const int& chunk_index, const size_t& first, const size_t& last);
+            void DrawTiles      ();
+
+            void ClipTriangle   (Chunk& chunk, const int* triangle);
+            void AddTriangle    (Chunk& chunk, const int* triangle);
+            void DrawTriangle   (const Chunk& chunk, const Triangle& triangle, const int& tile_x, const int& tile_y);
+            bool DrawBlock      (const Chunk& chunk, const Triangle& triangle, const int& x, const int& y, const int& size,
+                                 const bool& covered, const int& min_x, const int& min_y, const int& max_x, const int& max_y);
+            void ShadePixel     (const Chunk& chunk, const Triangle& triangle, const int& x, const int& y, const float& depth);
+
+            const SoftwareVertex& GetVertex(const Chunk& chunk, const int& vertex) const
+            {
+                return vertex >= 0 ? vertices[vertex] : chunk.clippedVertices[-1 - vertex];
+            }
+
+            // The perspective barycentrics of a pixel center
+            void GetBarycentrics(const Triangle& triangle, const float& x, const float& y, float& lambda1, float& lambda2) const;
+        };
+    }
+
+#endif
@@ -0,0 +1,642 @@
+/* ---------------------------------------------------------------------------
+** SoftwareRenderDevice.cpp
+** The render device that draws on the CPU.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "SoftwareRenderDevice.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace flygl
+{
+    const int SoftwareRenderDevice::MAX_TEXTURE_UNITS;
+    const int SoftwareRenderDevice::MAX_DRAW_BUFFERS;
+
+    // What a uniform that was never set reads (a mat4 of them)
+    static const GLfloat ZERO_FLOATS[16] = { 0.0f };
+    static const GLint   ZERO_INTS  [16] = { 0 };
+
+    // ----------------------------------------------------------------------
+    // Programs
+    // ----------------------------------------------------------------------
+
+    // Constructor
+    //
+    // owner            The device, for the textures of the samplers
+    // vertex_code      The GLSL of the shaders, their C++ version is found by their name
+    // fragment_code
+    SoftwareRenderDevice::Program::Program(const SoftwareRenderDevice* owner, const std::string& vertex_code, const std::string& fragment_code):
+        device(owner), vertexShader(SoftwareShaders::CreateVertexShader(vertex_code)), fragmentShader(SoftwareShaders::CreateFragmentShader(fragment_code))
+    {
+        if(vertexShader == NULL || fragmentShader == NULL)
+        {
+            const std::string name = SoftwareShaders::GetName(vertexShader == NULL ? vertex_code : fragment_code);
+            fprintf(stderr, "Software device: no C++ version of the shader '%s', its draws are skipped\n", name.c_str());
+        }
+    }
+
+    // Destructor
+    SoftwareRenderDevice::Program::~Program()
+    {
+        delete vertexShader;
+        delete fragmentShader;
+    }
+
+    const GLfloat* SoftwareRenderDevice::Program::GetFloats(const std::string& name) const
+    {
+        const Uniform* uniform = Find(name);
+        return uniform != NULL ? &uniform->floats[0] : ZERO_FLOATS;
+    }
+
+    const GLint* SoftwareRenderDevice::Program::GetInts(const std::string& name) const
+    {
+        const Uniform* uniform = Find(name);
+        return uniform != NULL ? &uniform->ints[0] : ZERO_INTS;
+    }
+
+    // The texture bound to the target on the unit the sampler has
+    const SoftwareTexture* SoftwareRenderDevice::Program::GetSampler(const std::string& name, const GLenum& target) const
+    {
+        const GLint unit = GetInts(name)[0];
+
+        if(unit < 0 || unit >= MAX_TEXTURE_UNITS)
+        {
+            return NULL;
+        }
+
+        return device->GetTexture(device->boundTextures[unit][GetSlot(target)]);
+    }
+
+    const SoftwareRenderDevice::Uniform* SoftwareRenderDevice::Program::Find(const std::string& name) const
+    {
+        std::map<std::string, GLint>::const_iterator location = locations.find(name);
+        return location != locations.end() ? &uniforms[location->second] : NULL;
+    }
+
+    // ----------------------------------------------------------------------
+    // Device
+    // ----------------------------------------------------------------------
+
+    // Constructor
+    SoftwareRenderDevice::SoftwareRenderDevice(const int& screen_width, const int& screen_height, const int& thread_count):
+        nextName(1), screenWidth(screen_width), screenHeight(screen_height),
+        currentProgram(0), currentFramebuffer(0), drawBuffers(1), clearColor(0.0f)
+    {
+        rasterizer.SetThreadCount(thread_count);
+
+        memset(boundTextures, 0, sizeof(boundTextures));
+
+        for(int i = 0; i < MAX_DRAW_BUFFERS; ++i)
+        {
+            colorWrites[i] = true;
+        }
+
+        for(int i = 0; i < SoftwareVertexShader::MAX_ATTRIBUTES; ++i)
+        {
+            attributeBindings[i].buffer     = 0;
+            attributeBindings[i].components = 4;
+            attributeBindings[i].type       = GL_FLOAT;
+            attributeBindings[i].isEnabled  = false;
+        }
+
+        // The GL defaults
+        drawState.viewportX        = 0;
+        drawState.viewportY        = 0;
+        drawState.viewportWidth    = screen_width;
+        drawState.viewportHeight   = screen_height;
+        drawState.colorCount       = 0;
+        drawState.depth            = NULL;
+        drawState.depthTest        = false;
+        drawState.depthWrite       = true;
+        drawState.depthFunction    = GL_LESS;
+        drawState.cullFace         = false;
+        drawState.frontFace        = GL_CCW;
+        drawState.blend            = false;
+        drawState.blendSource      = GL_ONE;
+        drawState.blendDestination = GL_ZERO;
+        drawState.polygonOffset    = false;
+        drawState.offsetFactor     = 0.0f;
+        drawState.offsetUnits      = 0.0f;
+
+        // The screen: 8 bits colors and a depth
+        Framebuffer& screen = framebuffers[0];
+        screen.colors.push_back(CreateTexture2D(GL_RGBA8, screen_width, screen_height, GL_NEAREST));
+        screen.depth = CreateTexture2D(GL_DEPTH24_STENCIL8, screen_width, screen_height, GL_NEAREST);
+    }
+
+    // Destructor
+    SoftwareRenderDevice::~SoftwareRenderDevice()
+    {
+        for(std::map<GLuint, SoftwareTexture*>::iterator i = textures.begin(); i != textures.end(); ++i)
+        {
+            delete i->second;
+        }
+
+        for(std::map<GLuint, Program*>::iterator i = programs.begin(); i != programs.end(); ++i)
+        {
+            delete i->second;
+        }
+    }
+
+    GLuint SoftwareRenderDevice::CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        const GLuint buffer = nextName++;
+        SetBufferData(buffer, target, data, size, usage);
+
+        return buffer;
+    }
+
+    // Deletes the buffer, the buffer textures that read it are left empty
+    void SoftwareRenderDevice::DeleteBuffer(const GLuint& buffer)
+    {
+        std::map<GLuint, std::vector<unsigned char> >::iterator found = buffers.find(buffer);
+        if(found == buffers.end())
+        {
+            return;
+        }
+
+        for(std::map<GLuint, SoftwareTexture*>::iterator i = textures.begin(); i != textures.end(); ++i)
+        {
+            if(i->second->buffer == &found->second)
+            {
+                i->second->buffer = NULL;
+            }
+        }
+
+        buffers.erase(found);
+    }
+
+    void SoftwareRenderDevice::SetBufferData(const GLuint& buffer, const GLenum&, const void* data, const size_t& size, const GLenum&)
+    {
+        std::vector<unsigned char>& bytes = buffers[buffer];
+
+        if(data != NULL)
+        {
+            bytes.assign((const unsigned char*)data, (const unsigned char*)data + size);
+        }
+        else
+        {
+            bytes.assign(size, 0);
+        }
+    }
+
+    void SoftwareRenderDevice::UpdateBuffer(const GLuint& buffer, const GLenum&, const size_t& offset, const void* data, const size_t& size)
+    {
+        std::map<GLuint, std::vector<unsigned char> >::iterator found = buffers.find(buffer);
+
+        if(found != buffers.end() && data != NULL && offset + size <= found->second.size())
+        {
+            memcpy(&found->second[offset], data, size);
+        }
+    }
+
+    GLuint SoftwareRenderDevice::CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter)
+    {
+        SoftwareTexture* texture = new SoftwareTexture(GL_TEXTURE_2D);
+        texture->Create(internal_format, width, height, filter);
+
+        const GLuint name = nextName++;
+        textures[name] = texture;
+
+        return name;
+    }
+
+    void SoftwareRenderDevice::BindTexture(const GLuint& unit, const GLenum& target, const GLuint& texture)
+    {
+        if(unit < (GLuint)MAX_TEXTURE_UNITS)
+        {
+            boundTextures[unit][GetSlot(target)] = texture;
+        }
+    }
+
+    // Deletes the texture, and unbinds it from every unit
+    void SoftwareRenderDevice::DeleteTexture(const GLuint& texture)
+    {
+        std::map<GLuint, SoftwareTexture*>::iterator found = textures.find(texture);
+        if(found == textures.end())
+        {
+            return;
+        }
+
+        delete found->second;
+        textures.erase(found);
+
+        for(int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+        {
+            for(int j = 0; j < SLOT_COUNT; ++j)
+            {
+                if(boundTextures[i][j] == texture)
+                {
+                    boundTextures[i][j] = 0;
+                }
+            }
+        }
+    }
+
+    GLuint SoftwareRenderDevice::CreateTextureArray()
+    {
+        const GLuint name = nextName++;
+        textures[name] = new SoftwareTexture(GL_TEXTURE_2D_ARRAY);
+
+        return name;
+    }
+
+    // Decodes a block compressed level of a texture array
+    void SoftwareRenderDevice::SetCompressedLevel(const GLuint& texture, const int& level, const GLenum& internal_format,
+                                                  const int& width, const int& height, const int& layers,
+                                                  const void* data, const size_t& size)
+    {
+        SoftwareTexture* array = GetTexture(texture);
+
+        if(array != NULL)
+        {
+            array->SetCompressedLevel(level, internal_format, width, height, layers, data, size);
+        }
+    }
+
+    GLuint SoftwareRenderDevice::CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format)
+    {
+        SoftwareTexture* texture = new SoftwareTexture(GL_TEXTURE_BUFFER);
+        texture->internalFormat = internal_format;
+
+        std::map<GLuint, std::vector<unsigned char> >::iterator found = buffers.find(buffer);
+        texture->buffer = found != buffers.end() ? &found->second : NULL;
+
+        const GLuint name = nextName++;
+        textures[name] = texture;
+
+        return name;
+    }
+
+    GLuint SoftwareRenderDevice::CreateProgram(const std::string& vertex_code, const std::string& fragment_code)
+    {
+        const GLuint name = nextName++;
+        programs[name] = new Program(this, vertex_code, fragment_code);
+
+        return name;
+    }
+
+    void SoftwareRenderDevice::DeleteProgram(const GLuint& program)
+    {
+        std::map<GLuint, Program*>::iterator found = programs.find(program);
+        if(found == programs.end())
+        {
+            return;
+        }
+
+        delete found->second;
+        programs.erase(found);
+
+        if(currentProgram == program)
+        {
+            currentProgram = 0;
+        }
+    }
+
+    void SoftwareRenderDevice::UseProgram(const GLuint& program)
+    {
+        currentProgram = program;
+    }
+
+    // Every name gets a location the first time it is asked for
+    GLint SoftwareRenderDevice::GetUniformLocation(const GLuint& program, const std::string& name)
+    {
+        std::map<GLuint, Program*>::iterator found = programs.find(program);
+        if(found == programs.end())
+        {
+            return -1;
+        }
+
+        Program& owner = *found->second;
+
+        std::map<std::string, GLint>::iterator location = owner.locations.find(name);
+        if(location != owner.locations.end())
+        {
+            return location->second;
+        }
+
+        Uniform uniform;
+        uniform.name = name;
+        uniform.floats.assign(16, 0.0f);
+        uniform.ints  .assign(16, 0);
+
+        owner.uniforms.push_back(uniform);
+        owner.locations[name] = owner.uniforms.size() - 1;
+
+        return owner.uniforms.size() - 1;
+    }
+
+    // Stores the values on the program in use
+    void SoftwareRenderDevice::SetUniform(const GLint& location, const UniformType& type, const int& count, const void* values)
+    {
+        std::map<GLuint, Program*>::iterator found = programs.find(currentProgram);
+
+        if(found == programs.end() || location < 0 || location >= (GLint)found->second->uniforms.size() || count <= 0)
+        {
+            return;
+        }
+
+        Uniform& uniform = found->second->uniforms[location];
+
+        const size_t value_count = GetUniformSize(type, count) / sizeof(GLfloat);
+
+        if(type == UNIFORM_INT || type == UNIFORM_IVEC3)
+        {
+            uniform.ints.resize(std::max(uniform.ints.size(), value_count));
+            memcpy(&uniform.ints[0], values, value_count * sizeof(GLint));
+        }
+        else
+        {
+            uniform.floats.resize(std::max(uniform.floats.size(), value_count));
+            memcpy(&uniform.floats[0], values, value_count * sizeof(GLfloat));
+        }
+    }
+
+    GLuint SoftwareRenderDevice::CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture)
+    {
+        const GLuint name = nextName++;
+
+        Framebuffer& framebuffer = framebuffers[name];
+        framebuffer.colors.assign(color_textures, color_textures + count);
+        framebuffer.depth = depth_texture;
+
+        return name;
+    }
+
+    void SoftwareRenderDevice::DeleteFramebuffer(const GLuint& framebuffer)
+    {
+        if(framebuffer != 0)
+        {
+            framebuffers.erase(framebuffer);
+        }
+    }
+
+    void SoftwareRenderDevice::BindFramebuffer(const GLuint& framebuffer, const int& draw_buffers)
+    {
+        currentFramebuffer = framebuffer;
+        drawBuffers        = framebuffer != 0 ? draw_buffers : 1;
+    }
+
+    void SoftwareRenderDevice::SetViewport(const int& x, const int& y, const int& width, const int& height)
+    {
+        drawState.viewportX      = x;
+        drawState.viewportY      = y;
+        drawState.viewportWidth  = width;
+        drawState.viewportHeight = height;
+    }
+
+    // Clears the drawn attachments of the bound frame buffer (the masks are kept, as in GL)
+    void SoftwareRenderDevice::Clear(const GLbitfield& mask)
+    {
+        std::map<GLuint, Framebuffer>::iterator found = framebuffers.find(currentFramebuffer);
+        if(found == framebuffers.end())
+        {
+            return;
+        }
+
+        const Framebuffer& framebuffer = found->second;
+
+        if(mask & GL_COLOR_BUFFER_BIT)
+        {
+            for(int i = 0; i < drawBuffers && i < (int)framebuffer.colors.size() && i < MAX_DRAW_BUFFERS; ++i)
+            {
+                SoftwareTexture* target = GetTexture(framebuffer.colors[i]);
+
+                if(target != NULL && colorWrites[i])
+                {
+                    target->Clear(clearColor);
+                }
+            }
+        }
+
+        SoftwareTexture* depth = GetTexture(framebuffer.depth);
+
+        if((mask & GL_DEPTH_BUFFER_BIT) && depth != NULL && drawState.depthWrite)
+        {
+            depth->ClearDepth(1.0f);
+        }
+    }
+
+    void SoftwareRenderDevice::SetClearColor(const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha)
+    {
+        clearColor = glm::vec4(red, green, blue, alpha);
+    }
+
+    void SoftwareRenderDevice::SetCapability(const GLenum& capability, const bool& enabled)
+    {
+        switch(capability)
+        {
+            case GL_DEPTH_TEST:          drawState.depthTest     = enabled; break;
+            case GL_CULL_FACE:           drawState.cullFace      = enabled; break;
+            case GL_BLEND:               drawState.blend         = enabled; break;
+            case GL_POLYGON_OFFSET_FILL: drawState.polygonOffset = enabled; break;
+        }
+    }
+
+    void SoftwareRenderDevice::SetDepthFunction(const GLenum& function)
+    {
+        drawState.depthFunction = function;
+    }
+
+    void SoftwareRenderDevice::SetDepthMask(const bool& write)
+    {
+        drawState.depthWrite = write;
+    }
+
+    void SoftwareRenderDevice::SetFrontFace(const GLenum& mode)
+    {
+        drawState.frontFace = mode;
+    }
+
+    void SoftwareRenderDevice::SetBlendFunction(const GLenum& source, const GLenum& destination)
+    {
+        drawState.blendSource      = source;
+        drawState.blendDestination = destination;
+    }
+
+    void SoftwareRenderDevice::SetPolygonOffset(const GLfloat& factor, const GLfloat& units)
+    {
+        drawState.offsetFactor = factor;
+        drawState.offsetUnits  = units;
+    }
+
+    void SoftwareRenderDevice::SetColorMask(const GLuint& attachment, const bool& write)
+    {
+        if(attachment < (GLuint)MAX_DRAW_BUFFERS)
+        {
+            colorWrites[attachment] = write;
+        }
+    }
+
+    // There is a single set of attributes, every draw sets the ones it reads
+    GLuint SoftwareRenderDevice::CreateVertexArray()
+    {
+        return nextName++;
+    }
+
+    void SoftwareRenderDevice::BindVertexArray(const GLuint&)
+    {}
+
+    void SoftwareRenderDevice::DeleteVertexArray(const GLuint&)
+    {}
+
+    void SoftwareRenderDevice::SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type)
+    {
+        if(index < (GLuint)SoftwareVertexShader::MAX_ATTRIBUTES)
+        {
+            attributeBindings[index].buffer     = buffer;
+            attributeBindings[index].components = components;
+            attributeBindings[index].type       = type;
+        }
+    }
+
+    void SoftwareRenderDevice::EnableAttributes(const GLuint& count, const bool& enabled)
+    {
+        for(GLuint i = 0; i < count && i < (GLuint)SoftwareVertexShader::MAX_ATTRIBUTES; ++i)
+        {
+            attributeBindings[i].isEnabled = enabled;
+        }
+    }
+
+    void SoftwareRenderDevice::DrawArrays(const GLenum& mode, const int& first, const int& count)
+    {
+        drawIndices.resize(std::max(count, 0));
+
+        for(int i = 0; i < count; ++i)
+        {
+            drawIndices[i] = first + i;
+        }
+
+        Draw(mode);
+    }
+
+    // Draws with the indices of a buffer (the ones past its end are ignored)
+    void SoftwareRenderDevice::DrawElements(const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type)
+    {
+        std::map<GLuint, std::vector<unsigned char> >::const_iterator found = buffers.find(index_buffer);
+        if(found == buffers.end() || found->second.empty())
+        {
+            return;
+        }
+
+        const std::vector<unsigned char>& bytes = found->second;
+
+        const size_t index_size = type == GL_UNSIGNED_INT ? 4 : (type == GL_UNSIGNED_SHORT ? 2 : 1);
+        const size_t index_count = std::min((size_t)std::max(count, 0), bytes.size() / index_size);
+
+        drawIndices.resize(index_count);
+
+        for(size_t i = 0; i < index_count; ++i)
+        {
+            switch(index_size)
+            {
+                case 4:  drawIndices[i] = ((const GLuint*  )&bytes[0])[i]; break;
+                case 2:  drawIndices[i] = ((const GLushort*)&bytes[0])[i]; break;
+                default: drawIndices[i] = bytes[i];                        break;
+            }
+        }
+
+        Draw(mode);
+    }
+
+    // The screen as RGB bytes, from its bottom row
+    void SoftwareRenderDevice::ReadScreen(const int& width, const int& height, unsigned char* pixels)
+    {
+        const SoftwareTexture* screen = GetTexture(framebuffers[0].colors[0]);
+
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                unsigned char* pixel = &pixels[(y * width + x) * 3];
+
+                if(x >= screen->width || y >= screen->height)
+                {
+                    pixel[0] = pixel[1] = pixel[2] = 0;
+                    continue;
+                }
+
+                const glm::vec4& color = screen->Read(x, y);
+
+                for(int i = 0; i < 3; ++i)
+                {
+                    pixel[i] = (unsigned char)(std::min(1.0f, std::max(0.0f, color[i])) * 255.0f + 0.5f);
+                }
+            }
+        }
+    }
+
+    // Draws the vertices of drawIndices with the program in use, on the bound frame buffer
+    void SoftwareRenderDevice::Draw(const GLenum& mode)
+    {
+        std::map<GLuint, Program*>::iterator program = programs.find(currentProgram);
+        std::map<GLuint, Framebuffer>::iterator framebuffer = framebuffers.find(currentFramebuffer);
+
+        if(program == programs.end() || framebuffer == framebuffers.end() ||
+           program->second->vertexShader == NULL || program->second->fragmentShader == NULL)
+        {
+            return;
+        }
+
+        // The targets
+        const Framebuffer& targets = framebuffer->second;
+
+        drawState.colorCount = std::min(std::min(drawBuffers, (int)targets.colors.size()), (int)SoftwareFragmentShader::MAX_OUTPUTS);
+
+        for(int i = 0; i < drawState.colorCount; ++i)
+        {
+            drawState.colors     [i] = GetTexture(targets.colors[i]);
+            drawState.colorWrites[i] = colorWrites[i];
+        }
+
+        drawState.depth = GetTexture(targets.depth);
+
+        // The attributes (only floats)
+        SoftwareAttribute attributes[SoftwareVertexShader::MAX_ATTRIBUTES];
+
+        for(int i = 0; i < SoftwareVertexShader::MAX_ATTRIBUTES; ++i)
+        {
+            const AttributeBinding& binding = attributeBindings[i];
+
+            attributes[i].data        = NULL;
+            attributes[i].components  = binding.components;
+            attributes[i].vertexCount = 0;
+
+            std::map<GLuint, std::vector<unsigned char> >::const_iterator buffer = buffers.find(binding.buffer);
+
+            if(binding.isEnabled && binding.type == GL_FLOAT && binding.components > 0 && buffer != buffers.end() && !buffer->second.empty())
+            {
+                attributes[i].data        = (const float*)&buffer->second[0];
+                attributes[i].vertexCount = buffer->second.size() / (binding.components * sizeof(float));
+            }
+        }
+
+        SoftwareVertexShader&   vertex_shader   = *program->second->vertexShader;
+        SoftwareFragmentShader& fragment_shader = *program->second->fragmentShader;
+
+        vertex_shader  .Prepare(*program->second);
+        fragment_shader.Prepare(*program->second);
+
+        rasterizer.Draw(drawState, vertex_shader, fragment_shader, attributes, mode, drawIndices);
+    }
+
+    SoftwareTexture* SoftwareRenderDevice::GetTexture(const GLuint& texture) const
+    {
+        std::map<GLuint, SoftwareTexture*>::const_iterator found = textures.find(texture);
+        return found != textures.end() ? found->second : NULL;
+    }
+
+    SoftwareRenderDevice::TextureSlot SoftwareRenderDevice::GetSlot(const GLenum& target)
+    {
+        switch(target)
+        {
+            case GL_TEXTURE_2D_ARRAY: return SLOT_ARRAY;
+            case GL_TEXTURE_BUFFER:   return SLOT_BUFFER;
+            default:                  return SLOT_2D;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+/* ---------------------------------------------------------------------------
+** SoftwareRenderDevice.hpp
+** A render device that draws on the CPU, with the SoftwareRasterizer and the
+** C++ version of every shader (SoftwareShaders). It keeps its own buffers,
+** textures and frame buffers, and the screen is a texture of the size given,
+** so it needs no GPU to draw: it is the reference the images of the GPU are
+** compared with, and what draws on machines without one. The shaders are
+** found by their name, a program without a C++ version draws nothing.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef SOFTWARERENDERDEVICE_HEADER
+#define SOFTWARERENDERDEVICE_HEADER
+
+#include <map>
+#include <string>
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "RenderDevice.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "SoftwareShaders.hpp"
+#include "SoftwareTexture.hpp"
+
+    namespace flygl
+    {
+        class SoftwareRenderDevice: public RenderDevice
+        {
+        public:
+
+            static const int MAX_TEXTURE_UNITS = 32;
+            static const int MAX_DRAW_BUFFERS  = 8;
+
+        private:
+
+            // The targets a texture can be bound to, every unit has one of each
+            enum TextureSlot
+            {
+                SLOT_2D,
+                SLOT_ARRAY,
+                SLOT_BUFFER,
+                SLOT_COUNT
+            };
+
+            struct Framebuffer
+            {
+            public:
+
+                std::vector<GLuint> colors;
+                GLuint              depth;
+            };
+
+            struct Uniform
+            {
+            public:
+
+                std::string          name;
+                std::vector<GLfloat> floats;
+                std::vector<GLint>   ints;
+            };
+
+            // A program, and the uniforms its shaders read
+            struct Program: public SoftwareUniforms
+            {
+            public:
+
+                const SoftwareRenderDevice* device;
+                SoftwareVertexShader*       vertexShader;    // NULL if there is no C++ version
+                SoftwareFragmentShader*     fragmentShader;
+
+                std::vector<Uniform>         uniforms;      // The location is the index
+                std::map<std::string, GLint> locations;
+
+                // Constructor
+                Program(const SoftwareRenderDevice* owner, const std::string& vertex_code, const std::string& fragment_code);
+
+                // Destructor
+                ~Program();
+
+                const GLfloat*         GetFloats (const std::string& name) const;
+                const GLint*           GetInts   (const std::string& name) const;
+                const SoftwareTexture* GetSampler(const std::string& name, const GLenum& target) const;
+
+            private:
+
+                const Uniform* Find(const std::string& name) const;
+
+                // Not copied, it owns the shaders
+                Program(const Program& other);
+                Program& operator=(const Program& other);
+            };
+
+            // A vertex attribute: the buffer it is read from
+            struct AttributeBinding
+            {
+            public:
+
+                GLuint buffer;
+                int    components;
+                GLenum type;
+                bool   isEnabled;
+            };
+
+            SoftwareRasterizer rasterizer;
+
+            GLuint nextName;
+            int    screenWidth;
+            int    screenHeight;
+
+            std::map<GLuint, std::vector<unsigned char> > buffers;
+            std::map<GLuint, SoftwareTexture*>            textures;
+            std::map<GLuint, Framebuffer>                 framebuffers;     // 0 is the screen
+            std::map<GLuint, Program*>                    programs;
+
+            // State
+            GLuint           boundTextures[MAX_TEXTURE_UNITS][SLOT_COUNT];
+            GLuint           currentProgram;
+            GLuint           currentFramebuffer;
+            int              drawBuffers;
+            glm::vec4        clearColor;
+            bool             colorWrites[MAX_DRAW_BUFFERS];
+            AttributeBinding attributeBindings[SoftwareVertexShader::MAX_ATTRIBUTES];
+
+            // The fixed function state, the targets are set on every draw
+            SoftwareDrawState drawState;
+
+            // The vertices of the draw being done
+            std::vector<GLuint> drawIndices;
+
+        public:
+
+            // screen_width     Size of the screen in pixels
+            // screen_height
+            // thread_count     Threads that draw, counting the caller (0 for one per core)
+            SoftwareRenderDevice(const int& screen_width, const int& screen_height, const int& thread_count);
+
+            // Destructor
+            ~SoftwareRenderDevice();
+
+            GLuint CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   DeleteBuffer(const GLuint& buffer);
+            void   SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   UpdateBuffer (const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size);
+
+            GLuint CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter);
+            void   BindTexture    (const GLuint& unit, const GLenum& target, const GLuint& texture);
+            void   DeleteTexture  (const GLuint& texture);
+
+            GLuint CreateTextureArray ();
+            void   SetCompressedLevel (const GLuint& texture, const int& level, const GLenum& internal_format,
+                                       const int& width, const int& height, const int& layers,
+                                       const void* data, const size_t& size);
+            GLuint CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format);
+
+            GLuint CreateProgram     (const std::string& vertex_code, const std::string& fragment_code);
+            void   DeleteProgram     (const GLuint& program);
+            void   UseProgram        (const GLuint& program);
+            GLint  GetUniformLocation(const GLuint& program, const std::string& name);
+            void   SetUniform        (const GLint& location, const UniformType& type, const int& count, const void* values);
+
+            GLuint CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture);
+            void   DeleteFramebuffer(const GLuint& framebuffer);
+            void   BindFramebuffer  (const GLuint& framebuffer, const int& draw_buffers);
+            void   SetViewport      (const int& x, const int& y, const int& width, const int& height);
+            void   Clear            (const GLbitfield& mask);
+            void   SetClearColor    (const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha);
+
+            void SetCapability    (const GLenum& capability, const bool& enabled);
+            void SetDepthFunction (const GLenum& function);
+            void SetDepthMask     (const bool& write);
+            void SetFrontFace     (const GLenum& mode);
+            void SetBlendFunction (const GLenum& source, const GLenum& destination);
+            void SetPolygonOffset (const GLfloat& factor, const GLfloat& units);
+            void SetColorMask     (const GLuint& attachment, const bool& write);
+
+            GLuint CreateVertexArray();
+            void   BindVertexArray  (const GLuint& vertex_array);
+            void   DeleteVertexArray(const GLuint& vertex_array);
+
+            void SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type);
+            void EnableAttributes  (const GLuint& count, const bool& enabled);
+            void DrawArrays        (const GLenum& mode, const int& first, const int& count);
+            void DrawElements      (const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type);
+
+            void ReadScreen(const int& width, const int& height, unsigned char* pixels);
+
+            int GetThreadCount() const
+            {
+                return rasterizer.GetThreadCount();
+            }
+
+        private:
+
+            void Draw(const GLenum& mode);
+
+            SoftwareTexture* GetTexture(const GLuint& texture) const;
+
+            static TextureSlot GetSlot(const GLenum& target);
+        };
+    }
+
+#endif
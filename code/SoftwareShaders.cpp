@@ -0,0 +1,1132 @@
+/* ---------------------------------------------------------------------------
+** SoftwareShaders.cpp
+** The shaders of the engine written in C++. Every class says which GLSL
+** file it is, and they are written as close to it as C++ lets us, so a
+** change on a shader is easy to bring here.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "SoftwareShaders.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+namespace flygl
+{
+    const int SoftwareVertex::MAX_VARYINGS;
+    const int SoftwareVertexShader::MAX_ATTRIBUTES;
+    const int SoftwareFragmentShader::MAX_OUTPUTS;
+
+    // ----------------------------------------------------------------------
+    // What the GLSL has and C++ doesn't
+    // ----------------------------------------------------------------------
+
+    static glm::mat4 GetMat4(const SoftwareUniforms& uniforms, const std::string& name)
+    {
+        glm::mat4 matrix;
+        memcpy(&matrix[0][0], uniforms.GetFloats(name), sizeof(matrix));
+        return matrix;
+    }
+
+    static glm::mat3 GetMat3(const SoftwareUniforms& uniforms, const std::string& name)
+    {
+        glm::mat3 matrix;
+        memcpy(&matrix[0][0], uniforms.GetFloats(name), sizeof(matrix));
+        return matrix;
+    }
+
+    static glm::vec2 GetVec2(const SoftwareUniforms& uniforms, const std::string& name)
+    {
+        const GLfloat* values = uniforms.GetFloats(name);
+        return glm::vec2(values[0], values[1]);
+    }
+
+    static glm::vec3 GetVec3(const SoftwareUniforms& uniforms, const std::string& name)
+    {
+        const GLfloat* values = uniforms.GetFloats(name);
+        return glm::vec3(values[0], values[1], values[2]);
+    }
+
+    static float GetFloat(const SoftwareUniforms& uniforms, const std::string& name)
+    {
+        return uniforms.GetFloats(name)[0];
+    }
+
+    static int GetInt(const SoftwareUniforms& uniforms, const std::string& name)
+    {
+        return uniforms.GetInts(name)[0];
+    }
+
+    static glm::vec2 ReadVec2(const float* values)
+    {
+        return glm::vec2(values[0], values[1]);
+    }
+
+    static glm::vec3 ReadVec3(const float* values)
+    {
+        return glm::vec3(values[0], values[1], values[2]);
+    }
+
+    static glm::vec4 ReadVec4(const float* values)
+    {
+        return glm::vec4(values[0], values[1], values[2], values[3]);
+    }
+
+    static void WriteVec(float* values, const float* vector, const int& count)
+    {
+        memcpy(values, vector, count * sizeof(float));
+    }
+
+    // texture(), texelFetch() and textureSize() on a sampler that may have nothing bound
+    static glm::vec4 Texture(const SoftwareTexture* texture, const glm::vec2& uv)
+    {
+        return texture != NULL ? texture->Sample(uv) : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    static glm::vec4 TexelFetch(const SoftwareTexture* texture, const glm::ivec2& texel)
+    {
+        return texture != NULL ? texture->Fetch(texel.x, texel.y) : glm::vec4(0.0f);
+    }
+
+    static glm::ivec2 TextureSize(const SoftwareTexture* texture)
+    {
+        return texture != NULL ? texture->GetSize() : glm::ivec2(0);
+    }
+
+    static glm::vec4 TextureLayer(const SoftwareTexture* texture, const glm::vec2& uv, const int& layer, const SoftwareFragment& fragment)
+    {
+        return texture != NULL ? texture->SampleLayer(uv, layer, fragment.texcoordDx, fragment.texcoordDy) : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    // GLSL int(): towards 0, and NaN is kept out of the conversion
+    static int ToInt(const float& value)
+    {
+        return value == value ? (int)std::max(-2147483520.0f, std::min(2147483520.0f, value)) : 0;
+    }
+
+    static glm::vec3 Reflect(const glm::vec3& incident, const glm::vec3& normal)
+    {
+        return incident - 2.0f * glm::dot(normal, incident) * normal;
+    }
+
+    static float SmoothStep(const float& edge0, const float& edge1, const float& x)
+    {
+        const float t = glm::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    // ----------------------------------------------------------------------
+    // Lighting shared by the mesh and the deferred shaders
+    // ----------------------------------------------------------------------
+
+    // The clustered lights (see LightManager and LightClusters)
+    struct ClusteredLights
+    {
+    public:
+
+        const SoftwareTexture* lightData;
+        const SoftwareTexture* lightIndices;
+        const SoftwareTexture* lightClusters;
+
+        glm::ivec3 clusterGrid;
+        glm::vec2  clusterScale;
+        glm::vec2  clusterDepth;
+        glm::mat4  viewMatrix;
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            lightData     = uniforms.GetSampler("lightData",     GL_TEXTURE_BUFFER);
+            lightIndices  = uniforms.GetSampler("lightIndices",  GL_TEXTURE_BUFFER);
+            lightClusters = uniforms.GetSampler("lightClusters", GL_TEXTURE_BUFFER);
+
+            const GLint* grid = uniforms.GetInts("clusterGrid");
+            clusterGrid  = glm::ivec3(grid[0], grid[1], grid[2]);
+            clusterScale = GetVec2(uniforms, "clusterScale");
+            clusterDepth = GetVec2(uniforms, "clusterDepth");
+            viewMatrix   = GetMat4(uniforms, "viewMatrix"  );
+        }
+
+        // The lighting loop of fragment.glsl and deferredLightingFragment.glsl
+        glm::vec3 Shade(const glm::vec4& frag_coord, const glm::vec3& fragPositionCam, const glm::vec3& normal,
+                        const glm::vec3& materialDiffuseColor, const float& shininess) const
+        {
+            const glm::vec3 materialAmbientColor  = glm::vec3(0.1f, 0.1f, 0.1f) * materialDiffuseColor;
+            const glm::vec3 materialSpecularColor = glm::vec3(0.3f, 0.3f, 0.3f);
+
+            const glm::vec3 normalizedEyeDir = glm::normalize(-fragPositionCam);
+
+            glm::vec3 totalLighting = materialAmbientColor;
+
+            if(lightData == NULL || lightIndices == NULL || lightClusters == NULL ||
+               clusterGrid.x <= 0 || clusterGrid.y <= 0 || clusterGrid.z <= 0)
+            {
+                return totalLighting;
+            }
+
+            // Our froxel
+            glm::ivec3 cell = glm::ivec3(ToInt(frag_coord.x * clusterScale.x), ToInt(frag_coord.y * clusterScale.y),
+                                         ToInt(std::log(-fragPositionCam.z) * clusterDepth.x + clusterDepth.y));
+            cell = glm::clamp(cell, glm::ivec3(0), clusterGrid - 1);
+
+            const int    cluster = (cell.z * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+            const GLuint first   = lightClusters->FetchUint(cluster, 0);
+            const GLuint count   = lightClusters->FetchUint(cluster, 1);
+
+            for(GLuint i = 0; i < count; ++i)
+            {
+                const int       light      = lightIndices->FetchUint(first + i, 0);
+                const glm::vec4 lightPos   = lightData->FetchFloat(light * 2    );
+                const glm::vec4 lightColor = lightData->FetchFloat(light * 2 + 1);
+
+                // Lights
+                const glm::vec3 lightPosCam     = glm::vec3(viewMatrix * glm::vec4(glm::vec3(lightPos), 1.0f));
+                const glm::vec3 lightVector     = lightPosCam - fragPositionCam;
+                const float     distancePowered = glm::dot(lightVector, lightVector);
+                const glm::vec3 light_direction = lightVector / std::sqrt(distancePowered);
+
+                // The light fades to 0 at its radius, so cutting it at the froxels doesn't show
+                const float ratio       = distancePowered / (lightPos.w * lightPos.w);
+                const float falloff     = glm::clamp(1.0f - ratio * ratio, 0.0f, 1.0f);
+                const float attenuation = falloff * falloff / distancePowered;
+
+                //Diffuse
+                const float diffPower = glm::clamp(glm::dot(normal, light_direction), 0.0f, 1.0f);
+
+                //Specular
+                const glm::vec3 reflectDirection = Reflect(-light_direction, normal);
+                const float     basicSpecPower   = std::max(glm::dot(normalizedEyeDir, reflectDirection), 0.0f);
+                const float     specPower        = std::pow(basicSpecPower, shininess);
+
+                // Apply Lighting
+                const glm::vec3 color     = glm::vec3(lightColor);
+                const glm::vec3 specTotal = materialSpecularColor * color * (lightColor.w / 100.0f) * specPower * attenuation;
+                const glm::vec3 diffTotal = materialDiffuseColor  * color *  lightColor.w          * diffPower * attenuation;
+
+                totalLighting += diffTotal + specTotal;
+            }
+
+            return totalLighting;
+        }
+    };
+
+    // The textures of a mesh (texture arrays and their layers)
+    struct MeshTextures
+    {
+    public:
+
+        const SoftwareTexture* diffuseSampler;
+        const SoftwareTexture* specularSampler;
+        const SoftwareTexture* normalSampler;
+        GLint                  textureLayers[3];
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            diffuseSampler  = uniforms.GetSampler("diffuseSampler",  GL_TEXTURE_2D_ARRAY);
+            specularSampler = uniforms.GetSampler("specularSampler", GL_TEXTURE_2D_ARRAY);
+            normalSampler   = uniforms.GetSampler("normalSampler",   GL_TEXTURE_2D_ARRAY);
+            memcpy(textureLayers, uniforms.GetInts("textureLayers"), sizeof(textureLayers));
+        }
+
+        // The normal map only stores X and Y (BC5), Z is rebuilt from them
+        glm::vec3 GetNormal(const SoftwareFragment& fragment, const glm::vec2& uv,
+                            const glm::vec3& tangentCam, const glm::vec3& bitangentCam, const glm::vec3& normalCam) const
+        {
+            glm::vec3 normalTan;
+            const glm::vec2 xy = glm::vec2(TextureLayer(normalSampler, uv, textureLayers[2], fragment)) * 2.0f - 1.0f;
+            normalTan.x = xy.x;
+            normalTan.y = xy.y;
+            normalTan.z = std::sqrt(glm::clamp(1.0f - glm::dot(xy, xy), 0.0f, 1.0f));
+
+            return glm::normalize(glm::mat3(glm::normalize(tangentCam), glm::normalize(bitangentCam), glm::normalize(normalCam)) * normalTan);
+        }
+    };
+
+    // ----------------------------------------------------------------------
+    // Vertex shaders
+    // ----------------------------------------------------------------------
+
+    // The varyings of vertex.glsl (fragColor is not read by any fragment shader)
+    enum MeshVarying
+    {
+        MESH_UV           = 0,
+        MESH_POSITION     = 2,
+        MESH_TANGENT      = 5,
+        MESH_BITANGENT    = 8,
+        MESH_NORMAL       = 11,
+        MESH_OLD_POSITION = 14,
+        MESH_NEW_POSITION = 18,
+        MESH_VARYINGS     = 22
+    };
+
+    // vertex.glsl
+    class MeshVertexShader: public SoftwareVertexShader
+    {
+    private:
+
+        glm::mat4 MVP;
+        glm::mat4 modelView;
+        glm::mat3 modelView3x3;
+        glm::mat4 oldMVP;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            MVP          = GetMat4(uniforms, "MVP");
+            modelView    = GetMat4(uniforms, "viewMatrix") * GetMat4(uniforms, "modelMatrix");
+            modelView3x3 = GetMat3(uniforms, "modelView3x3");
+            oldMVP       = GetMat4(uniforms, "oldMVP");
+        }
+
+        void Shade(const float* const* attributes, SoftwareVertex& vertex) const
+        {
+            const glm::vec4 pos = glm::vec4(ReadVec3(attributes[0]), 1.0f);
+
+            vertex.position = MVP * pos;
+
+            const glm::vec3 fragPositionCam = glm::vec3(modelView * pos);
+
+            // For normal mapping
+            const glm::vec3 tangentCam   = modelView3x3 * SafeNormalize(ReadVec3(attributes[4]));
+            const glm::vec3 bitangentCam = modelView3x3 * SafeNormalize(ReadVec3(attributes[5]));
+            const glm::vec3 normalCam    = modelView3x3 * SafeNormalize(ReadVec3(attributes[3]));
+
+            // For Motion Blur
+            const glm::vec4 oldScreenCoord = oldMVP * pos;
+
+            WriteVec(&vertex.varyings[MESH_UV          ], attributes[2],      2);
+            WriteVec(&vertex.varyings[MESH_POSITION    ], &fragPositionCam[0], 3);
+            WriteVec(&vertex.varyings[MESH_TANGENT     ], &tangentCam[0],      3);
+            WriteVec(&vertex.varyings[MESH_BITANGENT   ], &bitangentCam[0],    3);
+            WriteVec(&vertex.varyings[MESH_NORMAL      ], &normalCam[0],       3);
+            WriteVec(&vertex.varyings[MESH_OLD_POSITION], &oldScreenCoord[0],  4);
+            WriteVec(&vertex.varyings[MESH_NEW_POSITION], &vertex.position[0], 4);
+        }
+
+        int GetVaryingCount() const
+        {
+            return MESH_VARYINGS;
+        }
+
+        int GetTexcoordVarying() const
+        {
+            return MESH_UV;
+        }
+
+    private:
+
+        // The attributes that were not set are 0, GLSL would give NaN
+        static glm::vec3 SafeNormalize(const glm::vec3& vector)
+        {
+            const float length = glm::length(vector);
+            return length > 0.0f ? vector / length : vector;
+        }
+    };
+
+    // planarReflectionVertex.glsl
+    class ReflectionVertexShader: public SoftwareVertexShader
+    {
+    private:
+
+        glm::mat4 MVP;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            MVP = GetMat4(uniforms, "MVP");
+        }
+
+        void Shade(const float* const* attributes, SoftwareVertex& vertex) const
+        {
+            vertex.position = MVP * glm::vec4(ReadVec3(attributes[0]), 1.0f);
+        }
+
+        int GetVaryingCount() const
+        {
+            return 0;
+        }
+    };
+
+    // The screen quad: basicPostProcessVertex.glsl, blurVertex.glsl and
+    // motionBlurVertex.glsl (with the Texcoord), deferredLightingVertex.glsl
+    class QuadVertexShader: public SoftwareVertexShader
+    {
+    private:
+
+        bool hasTexcoord;
+
+    public:
+
+        // Constructor
+        QuadVertexShader(const bool& with_texcoord): hasTexcoord(with_texcoord)
+        {}
+
+        void Prepare(const SoftwareUniforms&)
+        {}
+
+        void Shade(const float* const* attributes, SoftwareVertex& vertex) const
+        {
+            const glm::vec2 position = ReadVec2(attributes[0]);
+
+            vertex.position = glm::vec4(position, 0.0f, 1.0f);
+
+            if(hasTexcoord)
+            {
+                const glm::vec2 Texcoord = (position / 2.0f) + 0.5f;
+                WriteVec(vertex.varyings, &Texcoord[0], 2);
+            }
+        }
+
+        int GetVaryingCount() const
+        {
+            return hasTexcoord ? 2 : 0;
+        }
+
+        int GetTexcoordVarying() const
+        {
+            return hasTexcoord ? 0 : -1;
+        }
+    };
+
+    // ----------------------------------------------------------------------
+    // Mesh fragment shaders
+    // ----------------------------------------------------------------------
+
+    // fragment.glsl
+    class MeshFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        MeshTextures    textures;
+        ClusteredLights lights;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            textures.Prepare(uniforms);
+            lights  .Prepare(uniforms);
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const float*    v               = fragment.varyings;
+            const glm::vec2 uv              = ReadVec2(&v[MESH_UV]);
+            const glm::vec3 fragPositionCam = ReadVec3(&v[MESH_POSITION]);
+
+            //Material Colors
+            const glm::vec3 materialDiffuseColor = glm::vec3(TextureLayer(textures.diffuseSampler, uv, textures.textureLayers[0], fragment));
+
+            const glm::vec3 normal = textures.GetNormal(fragment, uv, ReadVec3(&v[MESH_TANGENT]), ReadVec3(&v[MESH_BITANGENT]), ReadVec3(&v[MESH_NORMAL]));
+
+            //Specular Init
+            const float shininess = TextureLayer(textures.specularSampler, uv, textures.textureLayers[1], fragment).r * 255.0f;
+
+            const glm::vec3 totalLighting = lights.Shade(fragment.fragCoord, fragPositionCam, normal, materialDiffuseColor, shininess);
+
+            outputs[0] = glm::vec4(totalLighting, 0.3f);
+
+            // Motion Blur
+            outputs[1] = glm::vec4(GetSpeed(v), 0.0f, 1.0f);
+        }
+
+        // Screen movement since the last frame
+        static glm::vec2 GetSpeed(const float* v)
+        {
+            const glm::vec4 oldScreenCoord = ReadVec4(&v[MESH_OLD_POSITION]);
+            const glm::vec4 newScreenCoord = ReadVec4(&v[MESH_NEW_POSITION]);
+
+            return glm::vec2(newScreenCoord) / newScreenCoord.w - glm::vec2(oldScreenCoord) / oldScreenCoord.w;
+        }
+    };
+
+    // gbufferFragment.glsl
+    class GeometryFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        MeshTextures textures;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            textures.Prepare(uniforms);
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const float*    v  = fragment.varyings;
+            const glm::vec2 uv = ReadVec2(&v[MESH_UV]);
+
+            const glm::vec3 normal = textures.GetNormal(fragment, uv, ReadVec3(&v[MESH_TANGENT]), ReadVec3(&v[MESH_BITANGENT]), ReadVec3(&v[MESH_NORMAL]));
+
+            outputs[0] = glm::vec4(glm::vec3(TextureLayer(textures.diffuseSampler,  uv, textures.textureLayers[0], fragment)),
+                                             TextureLayer(textures.specularSampler, uv, textures.textureLayers[1], fragment).r);
+            outputs[1] = glm::vec4(EncodeNormal(normal), 0.0f, 1.0f);
+
+            // Motion Blur
+            outputs[2] = glm::vec4(MeshFragmentShader::GetSpeed(v), 0.0f, 1.0f);
+        }
+
+    private:
+
+        // A unit vector to the 2 coordinates of the octahedron
+        static glm::vec2 EncodeNormal(glm::vec3 n)
+        {
+            n /= std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+            const glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+            return n.z >= 0.0f ? glm::vec2(n) : folded;
+        }
+    };
+
+    // deferredLightingFragment.glsl
+    class DeferredLightingFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* albedoTexture;
+        const SoftwareTexture* normalTexture;
+        const SoftwareTexture* velocityTexture;
+        const SoftwareTexture* depthTexture;
+
+        glm::mat4       inverseProjection;
+        ClusteredLights lights;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            albedoTexture     = uniforms.GetSampler("albedoTexture"  );
+            normalTexture     = uniforms.GetSampler("normalTexture"  );
+            velocityTexture   = uniforms.GetSampler("velocityTexture");
+            depthTexture      = uniforms.GetSampler("depthTexture"   );
+            inverseProjection = GetMat4(uniforms, "inverseProjection");
+
+            lights.Prepare(uniforms);
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const glm::ivec2 pixel = glm::ivec2((int)fragment.fragCoord.x, (int)fragment.fragCoord.y);
+            const float      depth = TexelFetch(depthTexture, pixel).r;
+
+            // Nothing was drawn here
+            if(depth == 1.0f)
+            {
+                outputs[0] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+                outputs[1] = glm::vec4(0.0f);
+                return;
+            }
+
+            // Position from the depth
+            const glm::vec2 ndc_xy          = glm::vec2(fragment.fragCoord) / glm::vec2(TextureSize(depthTexture)) * 2.0f - 1.0f;
+            const glm::vec4 position        = inverseProjection * glm::vec4(ndc_xy, depth * 2.0f - 1.0f, 1.0f);
+            const glm::vec3 fragPositionCam = glm::vec3(position) / position.w;
+
+            //Material Colors
+            const glm::vec4 albedo = TexelFetch(albedoTexture, pixel);
+            const glm::vec3 normal = DecodeNormal(glm::vec2(TexelFetch(normalTexture, pixel)));
+
+            //Specular Init
+            const float shininess = albedo.a * 255.0f;
+
+            outputs[0] = glm::vec4(lights.Shade(fragment.fragCoord, fragPositionCam, normal, glm::vec3(albedo), shininess), 0.3f);
+
+            // Motion Blur
+            outputs[1] = TexelFetch(velocityTexture, pixel);
+        }
+
+    private:
+
+        // The 2 coordinates of the octahedron to a unit vector
+        static glm::vec3 DecodeNormal(const glm::vec2& e)
+        {
+            glm::vec3 n = glm::vec3(e, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+            if(n.z < 0.0f)
+            {
+                const glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+                n.x = folded.x;
+                n.y = folded.y;
+            }
+            return glm::normalize(n);
+        }
+    };
+
+    // planarReflectionFragment.glsl
+    class ReflectionFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* reflectionTexture;
+        float                  reflectivity;
+        glm::vec2              invSceneSize;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            reflectionTexture = uniforms.GetSampler("reflectionTexture");
+            reflectivity      = GetFloat(uniforms, "reflectivity");
+            invSceneSize      = GetVec2 (uniforms, "invSceneSize");
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const glm::vec2 texcoord = glm::vec2(fragment.fragCoord) * invSceneSize;
+
+            outputs[0] = glm::vec4(glm::vec3(Texture(reflectionTexture, texcoord)), reflectivity);
+        }
+    };
+
+    // ----------------------------------------------------------------------
+    // Post process fragment shaders
+    // ----------------------------------------------------------------------
+
+    // basicPostProcessFragment.glsl
+    class CopyFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* colorTexture;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            colorTexture = uniforms.GetSampler("colorTexture");
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            outputs[0] = Texture(colorTexture, ReadVec2(fragment.varyings));
+        }
+    };
+
+    // blurGaussianFragment.glsl
+    class GaussianFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* colorTexture;
+
+        glm::vec2 direction;
+        int       tapCount;
+        float     tapOffsets[8];
+        float     tapWeights[8];
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            colorTexture = uniforms.GetSampler("colorTexture");
+            direction    = GetVec2(uniforms, "direction");
+            tapCount     = std::min(8, GetInt(uniforms, "tapCount"));
+
+            memcpy(tapOffsets, uniforms.GetFloats("tapOffsets"), sizeof(tapOffsets));
+            memcpy(tapWeights, uniforms.GetFloats("tapWeights"), sizeof(tapWeights));
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const glm::vec2 Texcoord = ReadVec2(fragment.varyings);
+
+            glm::vec3 color = glm::vec3(Texture(colorTexture, Texcoord)) * tapWeights[0];
+
+            for(int i = 1; i < tapCount; i++)
+            {
+                const glm::vec2 offset = direction * tapOffsets[i];
+                color += (glm::vec3(Texture(colorTexture, Texcoord + offset)) + glm::vec3(Texture(colorTexture, Texcoord - offset))) * tapWeights[i];
+            }
+
+            outputs[0] = glm::vec4(color, 1.0f);
+        }
+    };
+
+    // blurDownsampleFragment.glsl and blurUpsampleFragment.glsl
+    class ResampleFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* colorTexture;
+        glm::vec2              halfTexel;
+        bool                   isUpsample;
+
+    public:
+
+        // Constructor
+        ResampleFragmentShader(const bool& upsample): isUpsample(upsample)
+        {}
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            colorTexture = uniforms.GetSampler("colorTexture");
+            halfTexel    = GetVec2(uniforms, "halfTexel");
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const glm::vec2 Texcoord = ReadVec2(fragment.varyings);
+
+            if(!isUpsample)
+            {
+                glm::vec3 color = glm::vec3(Texture(colorTexture, Texcoord)) * 4.0f;
+
+                color += glm::vec3(Texture(colorTexture, Texcoord - halfTexel));
+                color += glm::vec3(Texture(colorTexture, Texcoord + halfTexel));
+                color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2(halfTexel.x, -halfTexel.y)));
+                color += glm::vec3(Texture(colorTexture, Texcoord - glm::vec2(halfTexel.x, -halfTexel.y)));
+
+                outputs[0] = glm::vec4(color / 8.0f, 1.0f);
+                return;
+            }
+
+            glm::vec3 color = glm::vec3(0.0f);
+
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2(-halfTexel.x * 2.0f, 0.0f)));
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2( halfTexel.x * 2.0f, 0.0f)));
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2(0.0f, -halfTexel.y * 2.0f)));
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2(0.0f,  halfTexel.y * 2.0f)));
+
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2(-halfTexel.x,  halfTexel.y))) * 2.0f;
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2( halfTexel.x,  halfTexel.y))) * 2.0f;
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2( halfTexel.x, -halfTexel.y))) * 2.0f;
+            color += glm::vec3(Texture(colorTexture, Texcoord + glm::vec2(-halfTexel.x, -halfTexel.y))) * 2.0f;
+
+            outputs[0] = glm::vec4(color / 12.0f, 1.0f);
+        }
+    };
+
+    // bilateralUpsampleFragment.glsl
+    class BilateralUpsampleFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* colorTexture;
+        const SoftwareTexture* depthTexture;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            colorTexture = uniforms.GetSampler("colorTexture");
+            depthTexture = uniforms.GetSampler("depthTexture");
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            // Keeps the weights finite where the depth is the same
+            static const float DEPTH_EPSILON = 0.0001f;
+
+            const glm::vec2 Texcoord   = ReadVec2(fragment.varyings);
+            const glm::vec2 smallSize  = glm::vec2(TextureSize(colorTexture));
+            const glm::vec2 depthSize  = glm::vec2(TextureSize(depthTexture));
+            const glm::vec2 depthScale = depthSize / smallSize;
+            const float     depth      = TexelFetch(depthTexture, glm::ivec2(Texcoord * depthSize)).r;
+
+            const glm::vec2 position = Texcoord * smallSize - 0.5f;
+            const glm::vec2 first    = glm::floor(position);
+            const glm::vec2 fraction = position - first;
+
+            glm::vec3 total       = glm::vec3(0.0f);
+            float     totalWeight = 0.0f;
+
+            for(int y = 0; y < 2; y++)
+            {
+                for(int x = 0; x < 2; x++)
+                {
+                    const glm::vec2 texel      = glm::clamp(first + glm::vec2(x, y), glm::vec2(0.0f), smallSize - 1.0f);
+                    const float     linear     = (x == 0 ? 1.0f - fraction.x : fraction.x) * (y == 0 ? 1.0f - fraction.y : fraction.y);
+                    const float     texelDepth = TexelFetch(depthTexture, glm::ivec2((texel + 0.5f) * depthScale)).r;
+                    const float     weight     = linear / (DEPTH_EPSILON + std::fabs(texelDepth - depth));
+
+                    total       += glm::vec3(TexelFetch(colorTexture, glm::ivec2(texel))) * weight;
+                    totalWeight += weight;
+                }
+            }
+
+            outputs[0] = glm::vec4(total / totalWeight, 1.0f);
+        }
+    };
+
+    // motionBlurTileMaxFragment.glsl and motionBlurNeighbourMaxFragment.glsl
+    class VelocityMaxFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* velocityTexture;
+        const SoftwareTexture* speedTexture;    // Only the neighbour max has it
+        int                    tileSize;
+        bool                   isNeighbourMax;
+
+    public:
+
+        // Constructor
+        VelocityMaxFragmentShader(const bool& neighbour_max): speedTexture(NULL), isNeighbourMax(neighbour_max)
+        {}
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            velocityTexture = uniforms.GetSampler("velocityTexture");
+            speedTexture    = isNeighbourMax ? uniforms.GetSampler("speedTexture") : NULL;
+            tileSize        = GetInt(uniforms, "tileSize");
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const glm::ivec2 size  = TextureSize(velocityTexture);
+            const glm::ivec2 pixel = glm::ivec2((int)fragment.fragCoord.x, (int)fragment.fragCoord.y);
+
+            glm::vec2 maxVelocity = glm::vec2(0.0f);
+            float     maxLength   = 0.0f;
+
+            if(isNeighbourMax)
+            {
+                // The lengths are compared in pixels of the scene, as the tile max does
+                const glm::vec2 pixels = glm::vec2(TextureSize(speedTexture));
+
+                for(int y = -1; y <= 1; y++)
+                {
+                    for(int x = -1; x <= 1; x++)
+                    {
+                        const glm::ivec2 neighbour = glm::clamp(pixel + glm::ivec2(x, y), glm::ivec2(0), size - 1);
+                        const glm::vec2  velocity  = glm::vec2(TexelFetch(velocityTexture, neighbour));
+                        const glm::vec2  blur      = velocity * pixels;
+                        const float      len       = glm::dot(blur, blur);
+
+                        if(len > maxLength)
+                        {
+                            maxLength   = len;
+                            maxVelocity = velocity;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                const glm::ivec2 first = pixel * tileSize;
+                const glm::ivec2 last  = glm::min(first + tileSize, size);
+
+                // The lengths are compared in pixels, the screen is not square
+                const glm::vec2 pixels = glm::vec2(size);
+
+                for(int y = first.y; y < last.y; y++)
+                {
+                    for(int x = first.x; x < last.x; x++)
+                    {
+                        const glm::vec2 velocity = glm::vec2(TexelFetch(velocityTexture, glm::ivec2(x, y)));
+                        const glm::vec2 blur     = velocity * pixels;
+                        const float     len      = glm::dot(blur, blur);
+
+                        if(len > maxLength)
+                        {
+                            maxLength   = len;
+                            maxVelocity = velocity;
+                        }
+                    }
+                }
+            }
+
+            outputs[0] = glm::vec4(maxVelocity, 0.0f, 1.0f);
+        }
+    };
+
+    // motionBlurFragment.glsl
+    class MotionBlurFragmentShader: public SoftwareFragmentShader
+    {
+    private:
+
+        const SoftwareTexture* colorTexture;
+        const SoftwareTexture* speedTexture;
+        const SoftwareTexture* neighbourMaxTexture;
+
+        float intensity;
+        int   maxSamples;
+        float velocityThreshold;
+        int   tileSize;
+
+    public:
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            colorTexture        = uniforms.GetSampler("colorTexture"       );
+            speedTexture        = uniforms.GetSampler("speedTexture"       );
+            neighbourMaxTexture = uniforms.GetSampler("neighbourMaxTexture");
+
+            intensity         = GetFloat(uniforms, "intensity"        );
+            maxSamples        = GetInt  (uniforms, "maxSamples"       );
+            velocityThreshold = GetFloat(uniforms, "velocityThreshold");
+            tileSize          = std::max(1, GetInt(uniforms, "tileSize"));
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            // One sample every this many pixels of blur
+            static const float PIXELS_PER_SAMPLE = 2.0f;
+
+            const glm::vec2  Texcoord = ReadVec2(fragment.varyings);
+            const glm::vec2  pixels   = glm::vec2(TextureSize(colorTexture));
+            const glm::ivec2 speed    = glm::ivec2(Texcoord * glm::vec2(TextureSize(speedTexture)));
+            const glm::ivec2 tile     = speed / tileSize;
+            const glm::vec3  color    = glm::vec3(Texture(colorTexture, Texcoord));
+
+            const glm::vec2 maxBlur   = intensity * glm::vec2(TexelFetch(neighbourMaxTexture, tile));
+            const float     maxLength = glm::length(maxBlur * pixels);
+
+            // Nothing moves around here
+            if(maxLength < velocityThreshold)
+            {
+                outputs[0] = glm::vec4(color, 1.0f);
+                return;
+            }
+
+            const float centerLength = glm::length(intensity * glm::vec2(Texture(speedTexture, Texcoord)) * pixels);
+            const int   samples      = glm::clamp((int)std::ceil(maxLength / PIXELS_PER_SAMPLE), 2, maxSamples);
+
+            glm::vec3 total       = color;
+            float     totalWeight = 1.0f;
+
+            for(int i = 0; i < samples; i++)
+            {
+                const float     t        = float(i) / float(samples - 1) - 0.5f;
+                const glm::vec2 position = Texcoord + maxBlur * t;
+                const float     distance = std::fabs(t) * maxLength;
+
+                const float sampleLength = glm::length(intensity * glm::vec2(Texture(speedTexture, position)) * pixels);
+                const float weight       = std::max(Cover(distance, sampleLength), Cover(distance, centerLength));
+
+                total       += glm::vec3(Texture(colorTexture, position)) * weight;
+                totalWeight += weight;
+            }
+
+            outputs[0] = glm::vec4(total / totalWeight, 1.0f);
+        }
+
+    private:
+
+        // How much a blur of this length covers a pixel at this distance (both in pixels)
+        static float Cover(const float& distance, const float& blurLength)
+        {
+            return glm::clamp(1.0f - distance / std::max(0.5f * blurLength, 1.0f), 0.0f, 1.0f);
+        }
+    };
+
+    // The generated shader of a FusedPass: dizzyEffect.glsl,
+    // colorGradeEffect.glsl and vignetteEffect.glsl, in the order its main calls them
+    class FusedFragmentShader: public SoftwareFragmentShader
+    {
+    public:
+
+        enum Effect
+        {
+            DIZZY_EFFECT,
+            COLOR_GRADE_EFFECT,
+            VIGNETTE_EFFECT,
+            EFFECT_COUNT
+        };
+
+        static const char* GetFunctionName(const Effect& effect)
+        {
+            static const char* NAMES[EFFECT_COUNT] = { "Dizzy", "ColorGrade", "Vignette" };
+            return NAMES[effect];
+        }
+
+    private:
+
+        std::vector<Effect> effects;
+
+        const SoftwareTexture* colorTexture;
+
+        float dizzyTime;
+        float dizzyRadius;
+        int   dizzyViewHeight;
+
+        float     gradeExposure;
+        float     gradeContrast;
+        float     gradeSaturation;
+        glm::vec3 gradeTint;
+
+        float vignetteStrength;
+        float vignetteRadius;
+
+    public:
+
+        // Constructor
+        FusedFragmentShader(const std::vector<Effect>& fused_effects): effects(fused_effects)
+        {}
+
+        void Prepare(const SoftwareUniforms& uniforms)
+        {
+            colorTexture = uniforms.GetSampler("colorTexture");
+
+            dizzyTime       = GetFloat(uniforms, "dizzyTime"      );
+            dizzyRadius     = GetFloat(uniforms, "dizzyRadius"    );
+            dizzyViewHeight = GetInt  (uniforms, "dizzyViewHeight");
+
+            gradeExposure   = GetFloat(uniforms, "gradeExposure"  );
+            gradeContrast   = GetFloat(uniforms, "gradeContrast"  );
+            gradeSaturation = GetFloat(uniforms, "gradeSaturation");
+            gradeTint       = GetVec3 (uniforms, "gradeTint"      );
+
+            vignetteStrength = GetFloat(uniforms, "vignetteStrength");
+            vignetteRadius   = GetFloat(uniforms, "vignetteRadius"  );
+        }
+
+        void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const
+        {
+            const glm::vec2 Texcoord = ReadVec2(fragment.varyings);
+
+            size_t    first_point = 0;
+            glm::vec3 color;
+
+            // Only the first one can read the image
+            if(!effects.empty() && effects[0] == DIZZY_EFFECT)
+            {
+                color       = Dizzy(Texcoord);
+                first_point = 1;
+            }
+            else
+            {
+                color = glm::vec3(Texture(colorTexture, Texcoord));
+            }
+
+            for(size_t i = first_point; i < effects.size(); ++i)
+            {
+                switch(effects[i])
+                {
+                    case COLOR_GRADE_EFFECT: color = ColorGrade(color, Texcoord); break;
+                    case VIGNETTE_EFFECT:    color = Vignette  (color, Texcoord); break;
+                    default:                                                      break;
+                }
+            }
+
+            outputs[0] = glm::vec4(color, 1.0f);
+        }
+
+    private:
+
+        glm::vec3 Dizzy(const glm::vec2& uv) const
+        {
+            const float invViewSize = 1.0f / dizzyViewHeight;
+
+            const glm::vec3 color1 = glm::vec3(Texture(colorTexture, uv + std::cos(dizzyTime * 10.0f) * dizzyRadius * invViewSize));
+            const glm::vec3 color2 = glm::vec3(Texture(colorTexture, uv + std::sin(dizzyTime * 10.0f) * dizzyRadius * invViewSize));
+
+            return glm::mix(color1, color2, 0.5f);
+        }
+
+        glm::vec3 ColorGrade(glm::vec3 color, const glm::vec2&) const
+        {
+            color *= gradeExposure * gradeTint;
+            color  = (color - 0.5f) * gradeContrast + 0.5f;
+
+            const float luminance = glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+            color = glm::mix(glm::vec3(luminance), color, gradeSaturation);
+
+            return glm::clamp(color, 0.0f, 1.0f);
+        }
+
+        glm::vec3 Vignette(const glm::vec3& color, const glm::vec2& uv) const
+        {
+            // 1.0 on the corners
+            const float distance = glm::length(uv - 0.5f) * 1.41421356f;
+
+            return color * (1.0f - vignetteStrength * SmoothStep(vignetteRadius, 1.0f, distance));
+        }
+    };
+
+    // ----------------------------------------------------------------------
+    // Factory
+    // ----------------------------------------------------------------------
+
+    // The name on the header of a shader file (its second line)
+    std::string SoftwareShaders::GetName(const std::string& code)
+    {
+        if(code.compare(0, 2, "/*") != 0)
+        {
+            return "";
+        }
+
+        const size_t line_start = code.find('\n');
+        if(line_start == std::string::npos)
+        {
+            return "";
+        }
+
+        const size_t line_end   = code.find('\n', line_start + 1);
+        const std::string line  = code.substr(line_start + 1, line_end == std::string::npos ? std::string::npos : line_end - line_start - 1);
+
+        const size_t first = line.find_first_not_of("* \t");
+        const size_t last  = line.find_last_not_of (" \t\r");
+
+        return first == std::string::npos ? "" : line.substr(first, last - first + 1);
+    }
+
+    SoftwareVertexShader* SoftwareShaders::CreateVertexShader(const std::string& code)
+    {
+        const std::string name = GetName(code);
+
+        if(name == "Vertex")                 return new MeshVertexShader();
+        if(name == "planarReflectionVertex") return new ReflectionVertexShader();
+        if(name == "deferredLightingVertex") return new QuadVertexShader(false);
+
+        if(name == "basicPostProcessVertex" || name == "blurVertex" || name == "motionBlurVertex")
+        {
+            return new QuadVertexShader(true);
+        }
+
+        return NULL;
+    }
+
+    SoftwareFragmentShader* SoftwareShaders::CreateFragmentShader(const std::string& code)
+    {
+        const std::string name = GetName(code);
+
+        if(name == "Fragment")                       return new MeshFragmentShader();
+        if(name == "gbufferFragment")                return new GeometryFragmentShader();
+        if(name == "deferredLightingFragment")       return new DeferredLightingFragmentShader();
+        if(name == "planarReflectionFragment")       return new ReflectionFragmentShader();
+        if(name == "basicPostProcessFragment")       return new CopyFragmentShader();
+        if(name == "blurGaussianFragment")           return new GaussianFragmentShader();
+        if(name == "blurDownsampleFragment")         return new ResampleFragmentShader(false);
+        if(name == "blurUpsampleFragment")           return new ResampleFragmentShader(true);
+        if(name == "bilateralUpsampleFragment")      return new BilateralUpsampleFragmentShader();
+        if(name == "motionBlurTileMaxFragment")      return new VelocityMaxFragmentShader(false);
+        if(name == "motionBlurNeighbourMaxFragment") return new VelocityMaxFragmentShader(true);
+        if(name == "motionBlurFragment")             return new MotionBlurFragmentShader();
+
+        // A fused pass has no header, its main calls the functions of the effects
+        const size_t main = code.find("void main()");
+        if(!name.empty() || main == std::string::npos)
+        {
+            return NULL;
+        }
+
+        std::vector<std::pair<size_t, FusedFragmentShader::Effect> > calls;
+
+        for(int i = 0; i < FusedFragmentShader::EFFECT_COUNT; ++i)
+        {
+            const FusedFragmentShader::Effect effect = (FusedFragmentShader::Effect)i;
+            const size_t call = code.find(std::string(FusedFragmentShader::GetFunctionName(effect)) + "(", main);
+
+            if(call != std::string::npos)
+            {
+                calls.push_back(std::make_pair(call, effect));
+            }
+        }
+
+        std::sort(calls.begin(), calls.end());
+
+        std::vector<FusedFragmentShader::Effect> effects;
+        for(size_t i = 0; i < calls.size(); ++i)
+        {
+            effects.push_back(calls[i].second);
+        }
+
+        return new FusedFragmentShader(effects);
+    }
+}
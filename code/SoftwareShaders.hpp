@@ -0,0 +1,127 @@
+/* ---------------------------------------------------------------------------
+** SoftwareShaders.hpp
+** The shaders of the engine written in C++, for the SoftwareRenderDevice.
+** Every GLSL file has its C++ version here, found by the name on the header
+** of the file (or, for the fused passes of the PostprocessChain, by the
+** functions their main calls): the mesh shaders with their normal mapped,
+** specular and clustered lighting, the G-buffer and the deferred lighting,
+** the planar reflections and every post process. They do what the GLSL does,
+** so the images can be compared with the ones of the GPU.
+** A vertex shader writes the clip space position and an array of floats
+** (the varyings); the rasterizer interpolates them with perspective and
+** gives them to the fragment shader, that writes one color per attachment.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef SOFTWARESHADERS_HEADER
+#define SOFTWARESHADERS_HEADER
+
+#include <string>
+
+// glew
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "SoftwareTexture.hpp"
+
+    namespace flygl
+    {
+        // The uniforms of a program, as its shaders read them
+        class SoftwareUniforms
+        {
+        public:
+
+            // Destructor
+            virtual ~SoftwareUniforms()
+            {}
+
+            // The values of a uniform, 0 if it was never set (there are always 16 of them)
+            virtual const GLfloat* GetFloats(const std::string& name) const = 0;
+            virtual const GLint*   GetInts  (const std::string& name) const = 0;
+
+            // The texture bound to the target on the unit of a sampler, NULL for none
+            virtual const SoftwareTexture* GetSampler(const std::string& name, const GLenum& target = GL_TEXTURE_2D) const = 0;
+        };
+
+        // What a vertex shader writes
+        struct SoftwareVertex
+        {
+        public:
+
+            static const int MAX_VARYINGS = 24;
+
+            glm::vec4 position;     // Clip space
+            float     varyings[MAX_VARYINGS];
+        };
+
+        // What a fragment shader reads
+        struct SoftwareFragment
+        {
+        public:
+
+            glm::vec4    fragCoord;     // Pixel center and depth, as gl_FragCoord
+            const float* varyings;
+
+            // How much the texture coordinates change to the next pixel (the mipmap)
+            glm::vec2 texcoordDx;
+            glm::vec2 texcoordDy;
+        };
+
+        class SoftwareVertexShader
+        {
+        public:
+
+            static const int MAX_ATTRIBUTES = 8;
+
+            // Destructor
+            virtual ~SoftwareVertexShader()
+            {}
+
+            // Reads the uniforms, before a draw
+            virtual void Prepare(const SoftwareUniforms& uniforms) = 0;
+
+            // attributes   The values of every attribute of the vertex (zeros for the ones not set)
+            virtual void Shade(const float* const* attributes, SoftwareVertex& vertex) const = 0;
+
+            virtual int GetVaryingCount() const = 0;
+
+            // The varying with the texture coordinates, -1 if there are none
+            virtual int GetTexcoordVarying() const
+            {
+                return -1;
+            }
+        };
+
+        class SoftwareFragmentShader
+        {
+        public:
+
+            static const int MAX_OUTPUTS = 4;
+
+            // Destructor
+            virtual ~SoftwareFragmentShader()
+            {}
+
+            // Reads the uniforms, before a draw
+            virtual void Prepare(const SoftwareUniforms& uniforms) = 0;
+
+            // outputs  One color for every attachment
+            virtual void Shade(const SoftwareFragment& fragment, glm::vec4* outputs) const = 0;
+        };
+
+        class SoftwareShaders
+        {
+        public:
+
+            // The C++ version of a shader, NULL if there is none
+            static SoftwareVertexShader*   CreateVertexShader  (const std::string& code);
+            static SoftwareFragmentShader* CreateFragmentShader(const std::string& code);
+
+            static std::string GetName(const std::string& code);
+        };
+    }
+
+#endif
@@ -0,0 +1,325 @@
+/* ---------------------------------------------------------------------------
+** SoftwareTexture.cpp
+** A texture of the SoftwareRenderDevice, and its sampling.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "SoftwareTexture.hpp"
+#include "TextureCompressor.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace flygl
+{
+    const int SoftwareTexture::DEPTH_BLOCK_SIZE;
+
+    // Wraps a texel coordinate (GL_REPEAT)
+    static int Repeat(const int& coordinate, const int& size)
+    {
+        const int wrapped = coordinate % size;
+        return wrapped < 0 ? wrapped + size : wrapped;
+    }
+
+    // Makes it a render target (a depth one for the depth formats)
+    //
+    // internal_format  GL_RGB8, GL_RG16F, GL_DEPTH24_STENCIL8...
+    // texture_width    Size in pixels
+    // texture_height
+    // texture_filter   GL_LINEAR or GL_NEAREST
+    void SoftwareTexture::Create(const GLenum& internal_format, const int& texture_width, const int& texture_height, const GLenum& texture_filter)
+    {
+        internalFormat = internal_format;
+        filter         = texture_filter;
+        width          = texture_width;
+        height         = texture_height;
+        layers         = 1;
+
+        texels.clear();
+        depth .clear();
+        blockMaxDepth.clear();
+
+        if(IsDepth())
+        {
+            // Whole blocks, so their rows can be read 4 pixels at a time
+            blockColumns = (width + DEPTH_BLOCK_SIZE - 1) / DEPTH_BLOCK_SIZE;
+            depthStride  = blockColumns * DEPTH_BLOCK_SIZE;
+
+            const int block_rows = (height + DEPTH_BLOCK_SIZE - 1) / DEPTH_BLOCK_SIZE;
+
+            depth        .assign(depthStride * block_rows * DEPTH_BLOCK_SIZE, 1.0f);
+            blockMaxDepth.assign(blockColumns * block_rows, 1.0f);
+        }
+        else
+        {
+            texels.assign(width * height, glm::vec4(0.0f));
+        }
+    }
+
+    // Decodes a level of a texture array. The levels after it are dropped,
+    // it is the smallest one until another is given.
+    //
+    // level            The level (0 is the biggest one)
+    // internal_format  A block compressed format
+    // level_width      Size of the level in pixels
+    // level_height
+    // level_layers     Number of layers
+    // data             Every layer of the level, one after another
+    // size             Bytes of the data
+    void SoftwareTexture::SetCompressedLevel(const int& level, const GLenum& internal_format,
+                                             const int& level_width, const int& level_height, const int& level_layers,
+                                             const void* data, const size_t& size)
+    {
+        const size_t layer_size = TextureCompressor::GetLevelSize(internal_format, level_width, level_height);
+
+        if(level < 0 || level > (int)levels.size() || layer_size * level_layers > size)
+        {
+            return;
+        }
+
+        if(level == 0)
+        {
+            internalFormat = internal_format;
+            width          = level_width;
+            height         = level_height;
+            layers         = level_layers;
+        }
+
+        levels.resize(level + 1);
+
+        Level& decoded = levels[level];
+        decoded.width  = level_width;
+        decoded.height = level_height;
+        decoded.texels.resize(level_width * level_height * 4 * level_layers);
+
+        for(int layer = 0; layer < level_layers; ++layer)
+        {
+            TextureCompressor::Decompress(internal_format, (const unsigned char*)data + layer * layer_size,
+                                          level_width, level_height, &decoded.texels[layer * level_width * level_height * 4]);
+        }
+    }
+
+    // Fills a color target
+    void SoftwareTexture::Clear(const glm::vec4& color)
+    {
+        if(texels.empty())
+        {
+            return;
+        }
+
+        Write(0, 0, color);
+        std::fill(texels.begin() + 1, texels.end(), texels[0]);
+    }
+
+    // Fills a depth target, and its blocks
+    void SoftwareTexture::ClearDepth(const float& value)
+    {
+        std::fill(depth        .begin(), depth        .end(), value);
+        std::fill(blockMaxDepth.begin(), blockMaxDepth.end(), value);
+    }
+
+    // Stores a color as the format would: without the channels it doesn't
+    // have, and rounded to 8 bits for the normalized ones
+    void SoftwareTexture::Write(const int& x, const int& y, const glm::vec4& color)
+    {
+        glm::vec4 stored = color;
+
+        switch(internalFormat)
+        {
+            case GL_R8:
+            case GL_R16F:
+            case GL_R32F:
+                stored = glm::vec4(color.r, 0.0f, 0.0f, 1.0f);
+                break;
+
+            case GL_RG8:
+            case GL_RG16F:
+            case GL_RG32F:
+                stored = glm::vec4(color.r, color.g, 0.0f, 1.0f);
+                break;
+
+            case GL_RGB8:
+            case GL_RGB16F:
+                stored = glm::vec4(color.r, color.g, color.b, 1.0f);
+                break;
+
+            case GL_R11F_G11F_B10F:
+                stored = glm::vec4(glm::max(glm::vec3(color), glm::vec3(0.0f)), 1.0f);
+                break;
+        }
+
+        switch(internalFormat)
+        {
+            case GL_R8:
+            case GL_RG8:
+            case GL_RGB8:
+            case GL_RGBA8:
+                stored = glm::floor(glm::clamp(stored, 0.0f, 1.0f) * 255.0f + 0.5f) / 255.0f;
+                break;
+        }
+
+        texels[y * width + x] = stored;
+    }
+
+    // Finds the biggest depth of a block again, after drawing on it
+    void SoftwareTexture::UpdateBlockDepth(const int& block_x, const int& block_y)
+    {
+        const float* row = &depth[block_y * DEPTH_BLOCK_SIZE * depthStride + block_x * DEPTH_BLOCK_SIZE];
+
+        float biggest = row[0];
+        for(int y = 0; y < DEPTH_BLOCK_SIZE; ++y, row += depthStride)
+        {
+            for(int x = 0; x < DEPTH_BLOCK_SIZE; ++x)
+            {
+                biggest = std::max(biggest, row[x]);
+            }
+        }
+
+        blockMaxDepth[block_y * blockColumns + block_x] = biggest;
+    }
+
+    // texelFetch: the texel as it is, the depth on the red channel
+    glm::vec4 SoftwareTexture::Fetch(const int& x, const int& y) const
+    {
+        if(x < 0 || y < 0 || x >= width || y >= height)
+        {
+            return glm::vec4(0.0f);
+        }
+
+        if(IsDepth())
+        {
+            return glm::vec4(depth[y * depthStride + x], 0.0f, 0.0f, 1.0f);
+        }
+
+        return texels[y * width + x];
+    }
+
+    // texture: bilinear (nearest for the depth), clamped to the edges
+    glm::vec4 SoftwareTexture::Sample(const glm::vec2& uv) const
+    {
+        if(width == 0 || height == 0)
+        {
+            return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        if(filter == GL_NEAREST || IsDepth())
+        {
+            const int x = std::min(width  - 1, std::max(0, (int)std::floor(uv.x * width )));
+            const int y = std::min(height - 1, std::max(0, (int)std::floor(uv.y * height)));
+            return Fetch(x, y);
+        }
+
+        const float px = uv.x * width  - 0.5f;
+        const float py = uv.y * height - 0.5f;
+        const float fx = std::floor(px);
+        const float fy = std::floor(py);
+        const float tx = px - fx;
+        const float ty = py - fy;
+
+        const int x0 = std::min(width  - 1, std::max(0, (int)fx    ));
+        const int x1 = std::min(width  - 1, std::max(0, (int)fx + 1));
+        const int y0 = std::min(height - 1, std::max(0, (int)fy    ));
+        const int y1 = std::min(height - 1, std::max(0, (int)fy + 1));
+
+        const glm::vec4 bottom = glm::mix(texels[y0 * width + x0], texels[y0 * width + x1], tx);
+        const glm::vec4 top    = glm::mix(texels[y1 * width + x0], texels[y1 * width + x1], tx);
+
+        return glm::mix(bottom, top, ty);
+    }
+
+    // texture on an array: trilinear and repeated. The level comes from the
+    // derivatives of the coordinates, as the GPU finds them on a quad.
+    //
+    // uv       The coordinates
+    // layer    The layer read
+    // uv_dx    How much the coordinates change to the next pixel on X
+    // uv_dy    And on Y
+    glm::vec4 SoftwareTexture::SampleLayer(const glm::vec2& uv, const int& layer, const glm::vec2& uv_dx, const glm::vec2& uv_dy) const
+    {
+        // Incomplete textures are black
+        if(levels.empty())
+        {
+            return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        const int       clamped_layer = std::min(layers - 1, std::max(0, layer));
+        const glm::vec2 size          = glm::vec2(levels[0].width, levels[0].height);
+
+        const float footprint = std::max(glm::dot(uv_dx * size, uv_dx * size), glm::dot(uv_dy * size, uv_dy * size));
+        const float lod       = std::min(0.5f * std::log(std::max(footprint, 1e-12f)) / std::log(2.0f), (float)(levels.size() - 1));
+
+        if(lod <= 0.0f)
+        {
+            return SampleLevel(levels[0], clamped_layer, uv);
+        }
+
+        const int   first    = (int)lod;
+        const float fraction = lod - first;
+
+        const glm::vec4 color = SampleLevel(levels[first], clamped_layer, uv);
+
+        if(fraction <= 0.0f || first + 1 >= (int)levels.size())
+        {
+            return color;
+        }
+
+        return glm::mix(color, SampleLevel(levels[first + 1], clamped_layer, uv), fraction);
+    }
+
+    // texelFetch on an RGBA32F buffer
+    glm::vec4 SoftwareTexture::FetchFloat(const int& index) const
+    {
+        glm::vec4 value(0.0f);
+
+        if(buffer != NULL && index >= 0 && (index + 1) * sizeof(glm::vec4) <= buffer->size())
+        {
+            memcpy(&value[0], &(*buffer)[index * sizeof(glm::vec4)], sizeof(glm::vec4));
+        }
+        return value;
+    }
+
+    // texelFetch on an R32UI or RG32UI buffer
+    GLuint SoftwareTexture::FetchUint(const int& index, const int& component) const
+    {
+        const size_t components = internalFormat == GL_RG32UI ? 2 : 1;
+        const size_t offset     = (index * components + component) * sizeof(GLuint);
+
+        GLuint value = 0;
+
+        if(buffer != NULL && index >= 0 && offset + sizeof(GLuint) <= buffer->size())
+        {
+            memcpy(&value, &(*buffer)[offset], sizeof(GLuint));
+        }
+        return value;
+    }
+
+    // Bilinear and repeated on a level of an array
+    glm::vec4 SoftwareTexture::SampleLevel(const Level& level, const int& layer, const glm::vec2& uv) const
+    {
+        const float px = uv.x * level.width  - 0.5f;
+        const float py = uv.y * level.height - 0.5f;
+        const float fx = std::floor(px);
+        const float fy = std::floor(py);
+        const float tx = px - fx;
+        const float ty = py - fy;
+
+        const int x0 = Repeat((int)fx,     level.width );
+        const int x1 = Repeat((int)fx + 1, level.width );
+        const int y0 = Repeat((int)fy,     level.height);
+        const int y1 = Repeat((int)fy + 1, level.height);
+
+        const glm::vec4 bottom = glm::mix(GetLevelTexel(level, layer, x0, y0), GetLevelTexel(level, layer, x1, y0), tx);
+        const glm::vec4 top    = glm::mix(GetLevelTexel(level, layer, x0, y1), GetLevelTexel(level, layer, x1, y1), tx);
+
+        return glm::mix(bottom, top, ty);
+    }
+
+    glm::vec4 SoftwareTexture::GetLevelTexel(const Level& level, const int& layer, const int& x, const int& y) const
+    {
+        const unsigned char* texel = &level.texels[((layer * level.height + y) * level.width + x) * 4];
+
+        return glm::vec4(texel[0], texel[1], texel[2], texel[3]) * (1.0f / 255.0f);
+    }
+}
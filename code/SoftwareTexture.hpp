@@ -0,0 +1,110 @@
+/* ---------------------------------------------------------------------------
+** SoftwareTexture.hpp
+** A texture of the SoftwareRenderDevice, and the sampling the shaders do on
+** it. Render targets keep float texels (rounded to what their format can
+** store) or, for the depth, floats with the biggest depth of every block of
+** 8x8 pixels, so whole blocks can be rejected without reading them. Texture
+** arrays keep their block compressed levels decoded to RGBA8, and buffer
+** textures read the bytes of their buffer.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef SOFTWARETEXTURE_HEADER
+#define SOFTWARETEXTURE_HEADER
+
+#include <vector>
+
+// glew
+#include <GL/glew.h>
+
+// GLM
+#include <glm/glm.hpp>
+
+    namespace flygl
+    {
+        class SoftwareTexture
+        {
+        public:
+
+            // Pixels of a side of the hierarchical depth blocks
+            static const int DEPTH_BLOCK_SIZE = 8;
+
+            // A level of a texture array, every layer after another
+            struct Level
+            {
+            public:
+
+                int width;
+                int height;
+                std::vector<unsigned char> texels;
+            };
+
+            GLenum target;          // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY or GL_TEXTURE_BUFFER
+            GLenum internalFormat;
+            GLenum filter;
+            int    width;
+            int    height;
+            int    layers;
+
+            // Render targets: the rows start from the bottom, as in GL
+            std::vector<glm::vec4> texels;
+            std::vector<float>     depth;           // Rows of depthStride values (a whole number of blocks)
+            std::vector<float>     blockMaxDepth;   // The biggest depth of every block
+            int                    depthStride;
+            int                    blockColumns;
+
+            // Texture arrays
+            std::vector<Level> levels;
+
+            // Buffer textures (the buffer belongs to the device)
+            const std::vector<unsigned char>* buffer;
+
+            // Constructor
+            SoftwareTexture(const GLenum& texture_target): target(texture_target), internalFormat(GL_RGBA8), filter(GL_LINEAR),
+                width(0), height(0), layers(0), depthStride(0), blockColumns(0), buffer(NULL)
+            {}
+
+            void Create            (const GLenum& internal_format, const int& texture_width, const int& texture_height, const GLenum& texture_filter);
+            void SetCompressedLevel(const int& level, const GLenum& internal_format,
+                                    const int& level_width, const int& level_height, const int& level_layers,
+                                    const void* data, const size_t& size);
+
+            bool IsDepth() const
+            {
+                return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH_COMPONENT24 ||
+                       internalFormat == GL_DEPTH_COMPONENT32F;
+            }
+
+            // Drawing on render targets
+            void Clear          (const glm::vec4& color);
+            void ClearDepth     (const float& value);
+            void Write          (const int& x, const int& y, const glm::vec4& color);
+            void UpdateBlockDepth(const int& block_x, const int& block_y);
+
+            // The texel as it is stored (blending reads it)
+            const glm::vec4& Read(const int& x, const int& y) const
+            {
+                return texels[y * width + x];
+            }
+
+            // What the shaders do: texelFetch, texture and textureSize
+            glm::vec4 Fetch      (const int& x, const int& y) const;
+            glm::vec4 Sample     (const glm::vec2& uv) const;
+            glm::vec4 SampleLayer(const glm::vec2& uv, const int& layer, const glm::vec2& uv_dx, const glm::vec2& uv_dy) const;
+            glm::vec4 FetchFloat (const int& index) const;
+            GLuint    FetchUint  (const int& index, const int& component) const;
+
+            glm::ivec2 GetSize() const
+            {
+                return glm::ivec2(width, height);
+            }
+
+        private:
+
+            glm::vec4 SampleLevel(const Level& level, const int& layer, const glm::vec2& uv) const;
+            glm::vec4 GetLevelTexel(const Level& level, const int& layer, const int& x, const int& y) const;
+        };
+    }
+
+#endif
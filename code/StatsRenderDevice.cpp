@@ -0,0 +1,319 @@
+/* ---------------------------------------------------------------------------
+** StatsRenderDevice.cpp
+** Every call is counted and passed to the device, and the size of what is
+** created is kept.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "StatsRenderDevice.hpp"
+#include "RenderStats.hpp"
+#include "RenderTargetPool.hpp"
+
+namespace flygl
+{
+    // The names of the new device are not the ones kept, so the video
+    // memory starts again from 0
+    void StatsRenderDevice::SetDevice(RenderDevice* counted_device)
+    {
+        if(counted_device == device)
+        {
+            return;
+        }
+
+        device = counted_device;
+
+        buffers .clear();
+        textures.clear();
+        programs.clear();
+        MemoryTracker::ResetGpu();
+    }
+
+    GLuint StatsRenderDevice::CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        if(data != NULL)
+        {
+            RenderStats::Get().AddBufferBytes(size);
+        }
+
+        const GLuint buffer = device->CreateBuffer(target, data, size, usage);
+
+        buffers[buffer] = size;
+        MemoryTracker::AddGpuResource(GPU_BUFFERS, size);
+
+        return buffer;
+    }
+
+    void StatsRenderDevice::DeleteBuffer(const GLuint& buffer)
+    {
+        std::map<GLuint, size_t>::iterator it = buffers.find(buffer);
+        if(it != buffers.end())
+        {
+            MemoryTracker::RemoveGpuResource(GPU_BUFFERS, it->second);
+            buffers.erase(it);
+        }
+
+        device->DeleteBuffer(buffer);
+    }
+
+    void StatsRenderDevice::SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage)
+    {
+        if(data != NULL)
+        {
+            RenderStats::Get().AddBufferBytes(size);
+        }
+
+        std::map<GLuint, size_t>::iterator it = buffers.find(buffer);
+        if(it != buffers.end())
+        {
+            MemoryTracker::ResizeGpuResource(GPU_BUFFERS, it->second, size);
+            it->second = size;
+        }
+
+        device->SetBufferData(buffer, target, data, size, usage);
+    }
+
+    void StatsRenderDevice::UpdateBuffer(const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size)
+    {
+        RenderStats::Get().AddBufferBytes(size);
+        device->UpdateBuffer(buffer, target, offset, data, size);
+    }
+
+    GLuint StatsRenderDevice::CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter)
+    {
+        const GLuint texture = device->CreateTexture2D(internal_format, width, height, filter);
+
+        TextureMemory& memory = textures[texture];
+        memory.resource = GPU_RENDER_TARGETS;
+        memory.levels.assign(1, width * height * RenderTargetPool::GetBytesPerPixel(internal_format));
+
+        MemoryTracker::AddGpuResource(GPU_RENDER_TARGETS, memory.levels[0]);
+
+        return texture;
+    }
+
+    void StatsRenderDevice::BindTexture(const GLuint& unit, const GLenum& target, const GLuint& texture)
+    {
+        RenderStats::Get().AddTextureBind();
+        device->BindTexture(unit, target, texture);
+    }
+
+    // Buffer textures were not kept, their memory is the one of the buffer
+    void StatsRenderDevice::DeleteTexture(const GLuint& texture)
+    {
+        std::map<GLuint, TextureMemory>::iterator it = textures.find(texture);
+        if(it != textures.end())
+        {
+            size_t bytes = 0;
+            for(size_t i = 0; i < it->second.levels.size(); ++i)
+            {
+                bytes += it->second.levels[i];
+            }
+
+            MemoryTracker::RemoveGpuResource(it->second.resource, bytes);
+            textures.erase(it);
+        }
+
+        device->DeleteTexture(texture);
+    }
+
+    // Empty until its levels are set
+    GLuint StatsRenderDevice::CreateTextureArray()
+    {
+        const GLuint texture = device->CreateTextureArray();
+
+        textures[texture].resource = GPU_TEXTURES;
+        MemoryTracker::AddGpuResource(GPU_TEXTURES, 0);
+
+        return texture;
+    }
+
+    void StatsRenderDevice::SetCompressedLevel(const GLuint& texture, const int& level, const GLenum& internal_format,
+                                               const int& width, const int& height, const int& layers,
+                                               const void* data, const size_t& size)
+    {
+        // A level set again (the streamer changes the resident ones) replaces the old one
+        std::map<GLuint, TextureMemory>::iterator it = textures.find(texture);
+        if(it != textures.end() && level >= 0)
+        {
+            std::vector<size_t>& levels = it->second.levels;
+            if((size_t)level >= levels.size())
+            {
+                levels.resize(level + 1, 0);
+            }
+
+            MemoryTracker::ResizeGpuResource(it->second.resource, levels[level], size);
+            levels[level] = size;
+        }
+
+        device->SetCompressedLevel(texture, level, internal_format, width, height, layers, data, size);
+    }
+
+    GLuint StatsRenderDevice::CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format)
+    {
+        return device->CreateBufferTexture(buffer, internal_format);
+    }
+
+    GLuint StatsRenderDevice::CreateProgram(const std::string& vertex_code, const std::string& fragment_code)
+    {
+        const GLuint program = device->CreateProgram(vertex_code, fragment_code);
+
+        // Only the code is known, not what the driver compiles it to
+        if(program != 0)
+        {
+            programs[program] = vertex_code.size() + fragment_code.size();
+            MemoryTracker::AddGpuResource(GPU_PROGRAMS, programs[program]);
+        }
+
+        return program;
+    }
+
+    void StatsRenderDevice::DeleteProgram(const GLuint& program)
+    {
+        std::map<GLuint, size_t>::iterator it = programs.find(program);
+        if(it != programs.end())
+        {
+            MemoryTracker::RemoveGpuResource(GPU_PROGRAMS, it->second);
+            programs.erase(it);
+        }
+
+        device->DeleteProgram(program);
+    }
+
+    void StatsRenderDevice::UseProgram(const GLuint& program)
+    {
+        RenderStats::Get().AddStateChange();
+        device->UseProgram(program);
+    }
+
+    GLint StatsRenderDevice::GetUniformLocation(const GLuint& program, const std::string& name)
+    {
+        return device->GetUniformLocation(program, name);
+    }
+
+    void StatsRenderDevice::SetUniform(const GLint& location, const UniformType& type, const int& count, const void* values)
+    {
+        RenderStats::Get().AddUniformUpload();
+        device->SetUniform(location, type, count, values);
+    }
+
+    GLuint StatsRenderDevice::CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture)
+    {
+        return device->CreateFramebuffer(color_textures, count, depth_texture);
+    }
+
+    void StatsRenderDevice::DeleteFramebuffer(const GLuint& framebuffer)
+    {
+        device->DeleteFramebuffer(framebuffer);
+    }
+
+    void StatsRenderDevice::BindFramebuffer(const GLuint& framebuffer, const int& draw_buffers)
+    {
+        RenderStats::Get().AddTargetSwitch();
+        device->BindFramebuffer(framebuffer, draw_buffers);
+    }
+
+    void StatsRenderDevice::SetViewport(const int& x, const int& y, const int& width, const int& height)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetViewport(x, y, width, height);
+    }
+
+    void StatsRenderDevice::Clear(const GLbitfield& mask)
+    {
+        device->Clear(mask);
+    }
+
+    void StatsRenderDevice::SetClearColor(const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetClearColor(red, green, blue, alpha);
+    }
+
+    void StatsRenderDevice::SetCapability(const GLenum& capability, const bool& enabled)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetCapability(capability, enabled);
+    }
+
+    void StatsRenderDevice::SetDepthFunction(const GLenum& function)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetDepthFunction(function);
+    }
+
+    void StatsRenderDevice::SetDepthMask(const bool& write)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetDepthMask(write);
+    }
+
+    void StatsRenderDevice::SetFrontFace(const GLenum& mode)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetFrontFace(mode);
+    }
+
+    void StatsRenderDevice::SetBlendFunction(const GLenum& source, const GLenum& destination)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetBlendFunction(source, destination);
+    }
+
+    void StatsRenderDevice::SetPolygonOffset(const GLfloat& factor, const GLfloat& units)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetPolygonOffset(factor, units);
+    }
+
+    void StatsRenderDevice::SetColorMask(const GLuint& attachment, const bool& write)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetColorMask(attachment, write);
+    }
+
+    GLuint StatsRenderDevice::CreateVertexArray()
+    {
+        return device->CreateVertexArray();
+    }
+
+    void StatsRenderDevice::BindVertexArray(const GLuint& vertex_array)
+    {
+        RenderStats::Get().AddStateChange();
+        device->BindVertexArray(vertex_array);
+    }
+
+    void StatsRenderDevice::DeleteVertexArray(const GLuint& vertex_array)
+    {
+        device->DeleteVertexArray(vertex_array);
+    }
+
+    void StatsRenderDevice::SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type)
+    {
+        RenderStats::Get().AddStateChange();
+        device->SetVertexAttribute(index, buffer, components, type);
+    }
+
+    void StatsRenderDevice::EnableAttributes(const GLuint& count, const bool& enabled)
+    {
+        RenderStats::Get().AddStateChange();
+        device->EnableAttributes(count, enabled);
+    }
+
+    void StatsRenderDevice::DrawArrays(const GLenum& mode, const int& first, const int& count)
+    {
+        RenderStats::Get().AddDraw(mode, count);
+        device->DrawArrays(mode, first, count);
+    }
+
+    void StatsRenderDevice::DrawElements(const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type)
+    {
+        RenderStats::Get().AddDraw(mode, count);
+        device->DrawElements(mode, index_buffer, count, type);
+    }
+
+    void StatsRenderDevice::ReadScreen(const int& width, const int& height, unsigned char* pixels)
+    {
+        device->ReadScreen(width, height, pixels);
+    }
+}
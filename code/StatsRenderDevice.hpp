@@ -0,0 +1,108 @@
+/* ---------------------------------------------------------------------------
+** StatsRenderDevice.hpp
+** The device that is always current: it counts every call on the
+** RenderStats and passes it to the device chosen with SetCurrent (the GL
+** one, the null one or the software one), so the counts are the same
+** whatever draws the frames.
+** It also estimates the video memory of what is created on the device
+** (see MemoryTracker): the size of every buffer, texture and program is
+** kept by name, and taken out when it is deleted.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef STATSRENDERDEVICE_HEADER
+#define STATSRENDERDEVICE_HEADER
+
+#include <map>
+#include <vector>
+
+#include "RenderDevice.hpp"
+#include "MemoryTracker.hpp"
+
+    namespace flygl
+    {
+        class StatsRenderDevice: public RenderDevice
+        {
+        private:
+
+            // The bytes of a texture, by level (render targets only have one)
+            struct TextureMemory
+            {
+            public:
+
+                GpuResource         resource;
+                std::vector<size_t> levels;
+            };
+
+            RenderDevice* device;
+
+            // The resources alive on the device, and their bytes
+            std::map<GLuint, size_t>        buffers;
+            std::map<GLuint, TextureMemory> textures;
+            std::map<GLuint, size_t>        programs;
+
+        public:
+
+            // Constructor
+            StatsRenderDevice(RenderDevice* counted_device): device(counted_device)
+            {}
+
+            // The video memory of the previous device is forgotten
+            void SetDevice(RenderDevice* counted_device);
+
+            RenderDevice* GetDevice() const
+            {
+                return device;
+            }
+
+            GLuint CreateBuffer(const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   DeleteBuffer(const GLuint& buffer);
+            void   SetBufferData(const GLuint& buffer, const GLenum& target, const void* data, const size_t& size, const GLenum& usage);
+            void   UpdateBuffer (const GLuint& buffer, const GLenum& target, const size_t& offset, const void* data, const size_t& size);
+
+            GLuint CreateTexture2D(const GLenum& internal_format, const int& width, const int& height, const GLenum& filter);
+            void   BindTexture    (const GLuint& unit, const GLenum& target, const GLuint& texture);
+            void   DeleteTexture  (const GLuint& texture);
+
+            GLuint CreateTextureArray ();
+            void   SetCompressedLevel (const GLuint& texture, const int& level, const GLenum& internal_format,
+                                       const int& width, const int& height, const int& layers,
+                                       const void* data, const size_t& size);
+            GLuint CreateBufferTexture(const GLuint& buffer, const GLenum& internal_format);
+
+            GLuint CreateProgram     (const std::string& vertex_code, const std::string& fragment_code);
+            void   DeleteProgram     (const GLuint& program);
+            void   UseProgram        (const GLuint& program);
+            GLint  GetUniformLocation(const GLuint& program, const std::string& name);
+            void   SetUniform        (const GLint& location, const UniformType& type, const int& count, const void* values);
+
+            GLuint CreateFramebuffer(const GLuint* color_textures, const int& count, const GLuint& depth_texture);
+            void   DeleteFramebuffer(const GLuint& framebuffer);
+            void   BindFramebuffer  (const GLuint& framebuffer, const int& draw_buffers);
+            void   SetViewport      (const int& x, const int& y, const int& width, const int& height);
+            void   Clear            (const GLbitfield& mask);
+            void   SetClearColor    (const GLfloat& red, const GLfloat& green, const GLfloat& blue, const GLfloat& alpha);
+
+            void SetCapability    (const GLenum& capability, const bool& enabled);
+            void SetDepthFunction (const GLenum& function);
+            void SetDepthMask     (const bool& write);
+            void SetFrontFace     (const GLenum& mode);
+            void SetBlendFunction (const GLenum& source, const GLenum& destination);
+            void SetPolygonOffset (const GLfloat& factor, const GLfloat& units);
+            void SetColorMask     (const GLuint& attachment, const bool& write);
+
+            GLuint CreateVertexArray();
+            void   BindVertexArray  (const GLuint& vertex_array);
+            void   DeleteVertexArray(const GLuint& vertex_array);
+
+            void SetVertexAttribute(const GLuint& index, const GLuint& buffer, const int& components, const GLenum& type);
+            void EnableAttributes  (const GLuint& count, const bool& enabled);
+            void DrawArrays        (const GLenum& mode, const int& first, const int& count);
+            void DrawElements      (const GLenum& mode, const GLuint& index_buffer, const int& count, const GLenum& type);
+
+            void ReadScreen(const int& width, const int& height, unsigned char* pixels);
+        };
+    }
+
+#endif
@@ -0,0 +1,427 @@
+/* ---------------------------------------------------------------------------
+** TGADecoder.cpp
+** A fast decoder for the .tga textures of the scene. The RLE expansion, the
+** BGR to RGB swizzle and the vertical flip are done in a single pass (with
+** SSSE3 when the CPU has it), straight into the buffer of the caller, that
+** can be a mapped PBO. The input is usually a MappedFile.
+** The output is the same as stb_image gives: the top row first and rows
+** without padding.
+** Only true color (24/32 bits) and grey (8 bits) images are supported, the
+** rest (color mapped, 16 bits...) should be loaded with stb_image.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "TGADecoder.hpp"
+#include "MappedFile.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// SSSE3 (pshufb) for the swizzles. VS can always build it and checks the CPU
+// when running, gcc/clang only when they are allowed to use it.
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    #include <intrin.h>
+    #define FLYGL_TGA_SSSE3
+#elif defined(__SSSE3__)
+    #define FLYGL_TGA_SSSE3
+#endif
+
+#ifdef FLYGL_TGA_SSSE3
+    #include <tmmintrin.h>
+#endif
+
+namespace flygl
+{
+    // Header fields
+    static const size_t TGA_HEADER_SIZE       = 18;
+    static const int    TGA_TRUE_COLOR        = 2;
+    static const int    TGA_GREY              = 3;
+    static const int    TGA_TRUE_COLOR_RLE    = 10;
+    static const int    TGA_GREY_RLE          = 11;
+    static const int    TGA_RIGHT_TO_LEFT_BIT = 0x10;
+    static const int    TGA_TOP_DOWN_BIT      = 0x20;
+
+    // If the file has the .tga extension
+    bool TGADecoder::IsTGA(const std::string& path)
+    {
+        if(path.size() < 4)
+        {
+            return false;
+        }
+
+        std::string extension = path.substr(path.size() - 4);
+        for(size_t i = 0; i < extension.size(); ++i)
+        {
+            extension[i] = (char)tolower(extension[i]);
+        }
+        return extension == ".tga";
+    }
+
+    // Reads the header, and checks we know how to decode the image
+    //
+    // file     The whole file
+    // size     Bytes of the file
+    // info     What we need of the header
+    bool TGADecoder::ReadHeader(const unsigned char* file, const size_t& size, TGAInfo& info)
+    {
+        if(file == NULL || size < TGA_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        const int id_length       = file[0];
+        const int color_map_type  = file[1];
+        const int image_type      = file[2];
+        const int color_map_size  = file[5] | (file[6] << 8);
+        const int color_map_bits  = file[7];
+        const int bits_per_pixel  = file[16];
+        const int descriptor      = file[17];
+
+        info.width     = file[12] | (file[13] << 8);
+        info.height    = file[14] | (file[15] << 8);
+        info.isRLE     = image_type == TGA_TRUE_COLOR_RLE || image_type == TGA_GREY_RLE;
+        info.isTopDown = (descriptor & TGA_TOP_DOWN_BIT) != 0;
+
+        // A true color image may still have a color map, we just skip it
+        info.dataOffset = TGA_HEADER_SIZE + id_length;
+        if(color_map_type == 1)
+        {
+            info.dataOffset += color_map_size * ((color_map_bits + 7) / 8);
+        }
+        else if(color_map_type != 0)
+        {
+            return false;
+        }
+
+        if(image_type == TGA_TRUE_COLOR || image_type == TGA_TRUE_COLOR_RLE)
+        {
+            if(bits_per_pixel != 24 && bits_per_pixel != 32)
+            {
+                return false;
+            }
+            info.channels = bits_per_pixel / 8;
+        }
+        else if(image_type == TGA_GREY || image_type == TGA_GREY_RLE)
+        {
+            if(bits_per_pixel != 8)
+            {
+                return false;
+            }
+            info.channels = 1;
+        }
+        else
+        {
+            return false;
+        }
+
+        // Nobody uses mirrored images, leave them to stb_image
+        if((descriptor & TGA_RIGHT_TO_LEFT_BIT) != 0)
+        {
+            return false;
+        }
+
+        return info.width > 0 && info.height > 0 && info.dataOffset <= size;
+    }
+
+    // Decodes the image in a single pass. Runs can cross rows, so they are
+    // split where the rows end (and the rows are written flipped if needed).
+    //
+    // file     The whole file
+    // size     Bytes of the file
+    // info     What ReadHeader returned
+    // output   width * height * channels bytes, top row first
+    // channels Channels wanted in the output (1 to 4)
+    bool TGADecoder::Decode(
+        const unsigned char* file, const size_t& size, const TGAInfo& info,
+        unsigned char* output, const int& channels)
+    {
+        const unsigned char* source     = file + info.dataOffset;
+        const unsigned char* source_end = file + size;
+
+        const int    source_channels = info.channels;
+        const int    width           = info.width;
+        const int    height          = info.height;
+        const size_t row_size        = (size_t)width * channels;
+        const int    total_pixels    = width * height;
+
+        unsigned char value[4];
+        int           pixel = 0;
+
+        while(pixel < total_pixels)
+        {
+            int  count;
+            bool is_raw;
+
+            if(info.isRLE)
+            {
+                if(source >= source_end)
+                {
+                    return false;
+                }
+                const unsigned char packet = *source++;
+                count  = std::min((packet & 0x7F) + 1, total_pixels - pixel);
+                is_raw = (packet & 0x80) == 0;
+            }
+            else
+            {
+                count  = total_pixels - pixel;
+                is_raw = true;
+            }
+
+            const size_t needed = (size_t)(is_raw ? count : 1) * source_channels;
+            if((size_t)(source_end - source) < needed)
+            {
+                return false;
+            }
+
+            // The repeated pixel is converted only once
+            if(!is_raw)
+            {
+                ConvertPixel(source, source_channels, value, channels);
+                source += source_channels;
+            }
+
+            while(count > 0)
+            {
+                const int row    = pixel / width;
+                const int column = pixel % width;
+                const int span   = std::min(count, width - column);
+
+                const int output_row = info.isTopDown ? row : height - 1 - row;
+                unsigned char* destination = output + output_row * row_size + column * channels;
+
+                if(is_raw)
+                {
+                    ConvertPixels(source, source_channels, destination, channels, span);
+                    source += span * source_channels;
+                }
+                else
+                {
+                    FillPixels(value, destination, channels, span);
+                }
+
+                pixel += span;
+                count -= span;
+            }
+        }
+
+        return true;
+    }
+
+    // Maps the file and decodes it in a new buffer (like stb_image, free it
+    // with free or stbi_image_free)
+    //
+    // path             The path route of the .tga
+    // width            Width of the image
+    // height           Height of the image
+    // file_channels    Channels of the file
+    // desired_channels Channels of the output, 0 to keep the ones of the file
+    //
+    // Returns NULL if the file can't be read or decoded.
+    unsigned char* TGADecoder::Load(
+        const std::string& path, int& width, int& height,
+        int& file_channels, const int& desired_channels)
+    {
+        MappedFile file;
+        TGAInfo    info;
+
+        if(!file.Open(path) || !ReadHeader(file.GetData(), file.GetSize(), info))
+        {
+            return NULL;
+        }
+
+        const int channels = desired_channels != 0 ? desired_channels : info.channels;
+        unsigned char* output = (unsigned char*)malloc((size_t)info.width * info.height * channels);
+
+        if(output == NULL)
+        {
+            return NULL;
+        }
+
+        if(!Decode(file.GetData(), file.GetSize(), info, output, channels))
+        {
+            free(output);
+            return NULL;
+        }
+
+        width         = info.width;
+        height        = info.height;
+        file_channels = info.channels;
+
+        return output;
+    }
+
+    // Converts a run of BGR(A) or grey pixels to RGB(A)/grey. The common
+    // cases are done 4 or 5 pixels at a time with a byte shuffle.
+    void TGADecoder::ConvertPixels(const unsigned char* source, const int& source_channels,
+                                   unsigned char* destination, const int& channels, int count)
+    {
+        if(source_channels == channels && channels == 1)
+        {
+            memcpy(destination, source, count);
+            return;
+        }
+
+#ifdef FLYGL_TGA_SSSE3
+        static const bool has_ssse3 = HasSSSE3();
+
+        if(has_ssse3)
+        {
+            // 16 bytes are read and written every time, so we stop while the
+            // run has some bytes left (the tail goes through the scalar path)
+            if(source_channels == 3 && channels == 3)
+            {
+                const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+                for(; count >= 6; count -= 5, source += 15, destination += 15)
+                {
+                    const __m128i pixels = _mm_loadu_si128((const __m128i*)source);
+                    _mm_storeu_si128((__m128i*)destination, _mm_shuffle_epi8(pixels, shuffle));
+                }
+            }
+            else if(source_channels == 3 && channels == 4)
+            {
+                const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+                const __m128i alpha   = _mm_set1_epi32(0xFF000000);
+                for(; count >= 6; count -= 4, source += 12, destination += 16)
+                {
+                    const __m128i pixels = _mm_loadu_si128((const __m128i*)source);
+                    _mm_storeu_si128((__m128i*)destination, _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+                }
+            }
+            else if(source_channels == 4 && channels == 4)
+            {
+                const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+                for(; count >= 4; count -= 4, source += 16, destination += 16)
+                {
+                    const __m128i pixels = _mm_loadu_si128((const __m128i*)source);
+                    _mm_storeu_si128((__m128i*)destination, _mm_shuffle_epi8(pixels, shuffle));
+                }
+            }
+            else if(source_channels == 4 && channels == 3)
+            {
+                const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+                for(; count >= 6; count -= 4, source += 16, destination += 12)
+                {
+                    const __m128i pixels = _mm_loadu_si128((const __m128i*)source);
+                    _mm_storeu_si128((__m128i*)destination, _mm_shuffle_epi8(pixels, shuffle));
+                }
+            }
+        }
+#endif
+
+        for(; count > 0; --count, source += source_channels, destination += channels)
+        {
+            ConvertPixel(source, source_channels, destination, channels);
+        }
+    }
+
+    // Converts a single pixel. Grey is computed as stb_image does.
+    void TGADecoder::ConvertPixel(const unsigned char* source, const int& source_channels,
+                                  unsigned char* destination, const int& channels)
+    {
+        unsigned char red, green, blue, alpha;
+
+        if(source_channels == 1)
+        {
+            red = green = blue = source[0];
+        }
+        else
+        {
+            blue  = source[0];
+            green = source[1];
+            red   = source[2];
+        }
+        alpha = source_channels == 4 ? source[3] : 255;
+
+        switch(channels)
+        {
+            case 1:
+            case 2:
+            {
+                destination[0] = (unsigned char)((red * 77 + green * 150 + blue * 29) >> 8);
+                if(channels == 2)
+                {
+                    destination[1] = alpha;
+                }
+                break;
+            }
+            default:
+            {
+                destination[0] = red;
+                destination[1] = green;
+                destination[2] = blue;
+                if(channels == 4)
+                {
+                    destination[3] = alpha;
+                }
+                break;
+            }
+        }
+    }
+
+    // Writes the same (already converted) pixel count times
+    void TGADecoder::FillPixels(const unsigned char* pixel, unsigned char* destination,
+                                const int& channels, int count)
+    {
+        if(channels == 1)
+        {
+            memset(destination, pixel[0], count);
+            return;
+        }
+
+#ifdef FLYGL_TGA_SSSE3
+        if(channels == 4)
+        {
+            int value;
+            memcpy(&value, pixel, 4);
+
+            const __m128i pattern = _mm_set1_epi32(value);
+            for(; count >= 4; count -= 4, destination += 16)
+            {
+                _mm_storeu_si128((__m128i*)destination, pattern);
+            }
+        }
+        else if(channels == 3 && count >= 16)
+        {
+            // 16 pixels are 48 bytes, 3 registers with the pattern
+            unsigned char bytes[48];
+            for(int i = 0; i < 16; ++i)
+            {
+                memcpy(&bytes[i * 3], pixel, 3);
+            }
+
+            const __m128i pattern0 = _mm_loadu_si128((const __m128i*)&bytes[0] );
+            const __m128i pattern1 = _mm_loadu_si128((const __m128i*)&bytes[16]);
+            const __m128i pattern2 = _mm_loadu_si128((const __m128i*)&bytes[32]);
+            for(; count >= 16; count -= 16, destination += 48)
+            {
+                _mm_storeu_si128((__m128i*)&destination[0],  pattern0);
+                _mm_storeu_si128((__m128i*)&destination[16], pattern1);
+                _mm_storeu_si128((__m128i*)&destination[32], pattern2);
+            }
+        }
+#endif
+
+        for(; count > 0; --count, destination += channels)
+        {
+            memcpy(destination, pixel, channels);
+        }
+    }
+
+    // If the CPU can run the SSSE3 paths
+    bool TGADecoder::HasSSSE3()
+    {
+#if defined(_MSC_VER) && defined(FLYGL_TGA_SSSE3)
+        int cpu_info[4];
+        __cpuid(cpu_info, 1);
+        return (cpu_info[2] & (1 << 9)) != 0;
+#elif defined(FLYGL_TGA_SSSE3)
+        return true;
+#else
+        return false;
+#endif
+    }
+}
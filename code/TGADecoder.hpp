@@ -0,0 +1,67 @@
+/* ---------------------------------------------------------------------------
+** TGADecoder.hpp
+** A fast decoder for the .tga textures of the scene. The RLE expansion, the
+** BGR to RGB swizzle and the vertical flip are done in a single pass (with
+** SSSE3 when the CPU has it), straight into the buffer of the caller, that
+** can be a mapped PBO. The input is usually a MappedFile.
+** The output is the same as stb_image gives: the top row first and rows
+** without padding.
+** Only true color (24/32 bits) and grey (8 bits) images are supported, the
+** rest (color mapped, 16 bits...) should be loaded with stb_image.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef TGADECODER_HEADER
+#define TGADECODER_HEADER
+
+#include <string>
+#include <cstddef>
+
+    namespace flygl
+    {
+        // What the header of a .tga tells us
+        struct TGAInfo
+        {
+        public:
+
+            int    width;
+            int    height;
+            int    channels;        // 1 (grey), 3 (BGR) or 4 (BGRA)
+            bool   isRLE;
+            bool   isTopDown;       // If not, the bottom row is the first one
+            size_t dataOffset;      // Where the pixels start
+        };
+
+        class TGADecoder
+        {
+        public:
+
+            static bool IsTGA(const std::string& path);
+
+            static bool ReadHeader(const unsigned char* file, const size_t& size, TGAInfo& info);
+
+            static bool Decode(
+                const unsigned char* file, const size_t& size, const TGAInfo& info,
+                unsigned char* output, const int& channels);
+
+            static unsigned char* Load(
+                const std::string& path, int& width, int& height,
+                int& file_channels, const int& desired_channels);
+
+        private:
+
+            static void ConvertPixels(const unsigned char* source, const int& source_channels,
+                                      unsigned char* destination, const int& channels, int count);
+
+            static void ConvertPixel (const unsigned char* source, const int& source_channels,
+                                      unsigned char* destination, const int& channels);
+
+            static void FillPixels   (const unsigned char* pixel, unsigned char* destination,
+                                      const int& channels, int count);
+
+            static bool HasSSSE3();
+        };
+    }
+
+#endif
@@ -0,0 +1,309 @@
+/* ---------------------------------------------------------------------------
+** Texture.cpp
+** A texture used by the meshes. It loads the image, compresses it with the
+** format that fits its usage (see TextureCompressor) and keeps the result in
+** a .dds file next to the original one (named with the usage, as every usage
+** has its own format), so the next time it is just read and uploaded. The
+** file is made again if the original image is newer.
+** Compressed textures start with their smallest mips only, the rest of them
+** are brought (and dropped) by the TextureStreamer.
+** Every texture is a GL_TEXTURE_2D_ARRAY: a single texture is an array with
+** one layer, and textures with the same size and format can be packed in the
+** layers of the same one (see TextureArrayBuilder), so meshes that share it
+** don't have to bind anything between draws.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "Texture.hpp"
+#include "DDSFile.hpp"
+#include "TextureImporter.hpp"
+
+#include <sys/stat.h>
+
+namespace flygl
+{
+    GLuint Texture::boundTextures[Texture::MAX_TEXTURE_UNITS] = { 0 };
+
+    // The names of the usages in the cached files, in the order of TextureUsage
+    static const char* USAGE_NAMES[] = { "diffuse", "specular", "normal" };
+
+    // If the file has been modified after the other one (false if one of
+    // them doesn't exist)
+    static bool IsNewer(const std::string& path, const std::string& other_path)
+    {
+        #if defined(_MSC_VER)
+            struct _stat file, other;
+            const bool exist = _stat(path.c_str(), &file) == 0 && _stat(other_path.c_str(), &other) == 0;
+        #else
+            struct stat file, other;
+            const bool exist = stat(path.c_str(), &file) == 0 && stat(other_path.c_str(), &other) == 0;
+        #endif
+
+        return exist && file.st_mtime > other.st_mtime;
+    }
+
+    // Loads the texture. If the GPU supports it, the texture will be block
+    // compressed and only its smallest levels uploaded (the streamer will
+    // bring the rest). If not it is uploaded as it is.
+    //
+    // path             The path route of the texture (.dds files are not compressed again)
+    // texture_usage    Diffuse, specular or normal
+    void Texture::Load(const std::string& path, const TextureUsage& texture_usage)
+    {
+        usage = texture_usage;
+
+        CompressedImage image;
+        int             first_level;
+
+        if(IsCompressionSupported() && LoadCompressedImage(path, image, first_level))
+        {
+            SetResidentLevels(std::vector<CompressedImage>(1, image), first_level);
+        }
+        else
+        {
+            CreateTexture();
+
+            int img_width, img_height, comp_num;
+            unsigned char *data = TextureImporter::Load(path, usage, img_width, img_height, comp_num);
+
+            if(data != NULL)
+            {
+                UploadUncompressed(data, img_width, img_height, comp_num);
+            }
+
+            // Free the data, we already have it stored
+            TextureImporter::Free(data);
+        }
+    }
+
+    // Gets the compressed version of the image. It is read from the .dds
+    // cache of its usage if it exists and the image has not changed since
+    // it was saved, if not the image is compressed and the cache saved.
+    //
+    // path         The path route of the original texture
+    // image        Where the compressed levels are stored
+    // first_level  The level of the full texture where image starts
+    bool Texture::LoadCompressedImage(const std::string& path, CompressedImage& image, int& first_level)
+    {
+        static const std::string DDS_EXTENSION = ".dds";
+
+        // It may be already compressed
+        const bool is_dds = path.size() > DDS_EXTENSION.size() &&
+            path.compare(path.size() - DDS_EXTENSION.size(), DDS_EXTENSION.size(), DDS_EXTENSION) == 0;
+
+        const std::string cache_path = is_dds ? path : path + "." + USAGE_NAMES[usage] + DDS_EXTENSION;
+
+        const bool is_cached = (is_dds || !IsNewer(path, cache_path)) &&
+            DDSFile::ReadHeader(cache_path, internalFormat, width, height, levels);
+
+        if(!is_cached)
+        {
+            if(is_dds)
+            {
+                return false;
+            }
+
+            int img_width, img_height, comp_num;
+            unsigned char *data = TextureImporter::LoadPixels(path, img_width, img_height, comp_num, 4);
+
+            if(data == NULL)
+            {
+                return false;
+            }
+
+            // Only keep the alpha if somebody is really using it
+            bool has_alpha = false;
+            if(comp_num == 2 || comp_num == 4)
+            {
+                for(int i = 0; i < img_width * img_height && !has_alpha; ++i)
+                {
+                    has_alpha = data[i * 4 + 3] != 255;
+                }
+            }
+
+            TextureCompressor::Compress(data, img_width, img_height, usage, has_alpha, image);
+            TextureImporter::Free(data);
+
+            internalFormat = image.format;
+            width          = img_width;
+            height         = img_height;
+            levels         = image.levels.size();
+
+            // If it can't be saved we can't stream it, so it will be fully resident
+            first_level = 0;
+
+            if(DDSFile::Save(cache_path, image))
+            {
+                streamingPaths.assign(1, cache_path);
+                first_level   = GetStartLevel();
+            }
+
+            return true;
+        }
+
+        // Start with the small levels only
+        first_level = GetStartLevel();
+
+        if(!DDSFile::Load(cache_path, image, first_level))
+        {
+            return false;
+        }
+
+        streamingPaths.assign(1, cache_path);
+        return true;
+    }
+
+    // Packs some compressed textures (they must have the same format, size
+    // and levels) in the layers of this one. As any other compressed texture
+    // it starts with the smallest levels.
+    //
+    // dds_paths        The .dds files, one per layer
+    // texture_usage    Diffuse, specular or normal
+    bool Texture::LoadLayers(const std::vector<std::string>& dds_paths, const TextureUsage& texture_usage)
+    {
+        usage = texture_usage;
+
+        if(dds_paths.empty() || !DDSFile::ReadHeader(dds_paths[0], internalFormat, width, height, levels))
+        {
+            return false;
+        }
+
+        layers = dds_paths.size();
+
+        const int first_level = GetStartLevel();
+        std::vector<CompressedImage> images(layers);
+
+        for(int i = 0; i < layers; ++i)
+        {
+            if(!DDSFile::Load(dds_paths[i], images[i], first_level) ||
+               images[i].format != internalFormat ||
+               images[i].levels.size() != (size_t)(levels - first_level))
+            {
+                return false;
+            }
+        }
+
+        streamingPaths = dds_paths;
+        SetResidentLevels(images, first_level);
+
+        return true;
+    }
+
+    // Replaces the levels in the GPU with the given ones. The old texture is
+    // deleted and a new one created, so we only pay for the levels we have.
+    //
+    // images       One image per layer, with the levels from first_level to the smallest one
+    // first_level  The level of the full texture where the images start
+    void Texture::SetResidentLevels(const std::vector<CompressedImage>& images, const int& first_level)
+    {
+        // The whole image may have been compressed right now, just skip the big levels
+        const int    skip  = std::max(0, (int)images[0].levels.size() - (levels - first_level));
+        const GLenum format = images[0].format;
+
+        CreateTexture();
+
+        sizeInBytes = 0;
+
+        std::vector<unsigned char> level_data;
+
+        for(size_t i = skip; i < images[0].levels.size(); ++i)
+        {
+            const CompressedImage::Level& level = images[0].levels[i];
+
+            // Every layer of the level, one after another
+            level_data.clear();
+            for(size_t layer = 0; layer < images.size(); ++layer)
+            {
+                const std::vector<unsigned char>& data = images[layer].levels[i].data;
+                level_data.insert(level_data.end(), data.begin(), data.end());
+            }
+
+            RenderDevice::Get().SetCompressedLevel(textureID, i - skip, format,
+                                                   level.width, level.height, images.size(),
+                                                   &level_data[0], level_data.size());
+
+            sizeInBytes += level_data.size();
+        }
+
+        residentLevel = first_level;
+    }
+
+    // The first level that is not bigger than STREAMING_START_SIZE
+    int Texture::GetStartLevel() const
+    {
+        int level = 0;
+        while(level < levels - 1 && std::max(width >> level, height >> level) > STREAMING_START_SIZE)
+        {
+            level++;
+        }
+        return level;
+    }
+
+    // Video memory needed to have every level from the given one
+    size_t Texture::GetSizeFrom(const int& level) const
+    {
+        if(!IsStreamed())
+        {
+            return sizeInBytes;
+        }
+
+        size_t size = 0;
+        for(int i = level; i < levels; ++i)
+        {
+            size += TextureCompressor::GetLevelSize(internalFormat, std::max(1, width >> i), std::max(1, height >> i));
+        }
+        return size * layers;
+    }
+
+    // Uploads the image with the smallest format that fits its channels, and
+    // let the GPU build the mipmaps
+    void Texture::UploadUncompressed(const unsigned char* data, const int& img_width, const int& img_height, const int& comp_num)
+    {
+        internalFormat = TextureImporter::GetInternalFormat(comp_num, false);
+        width          = img_width;
+        height         = img_height;
+        levels         = TextureImporter::GetLevelCount(img_width, img_height);
+        sizeInBytes    = 0;
+
+        for(int i = 0; i < levels; ++i)
+        {
+            // RGB8 is stored as RGBA8 by most GPUs
+            sizeInBytes += std::max(1, width >> i) * std::max(1, height >> i) * (comp_num == 3 ? 4 : comp_num);
+        }
+
+        TextureImporter::Upload(GL_TEXTURE_2D_ARRAY, data, img_width, img_height, comp_num, usage, levels);
+    }
+
+    // Creates a new texture (deleting the old one), repeated and with
+    // trilinear filtering. The GL one is left bound, for the uncompressed upload
+    void Texture::CreateTexture()
+    {
+        DeleteTexture();
+
+        textureID = RenderDevice::Get().CreateTextureArray();
+
+        // We don't know on which unit it has been bound
+        ResetBindings();
+    }
+
+    // Deletes the texture. The device unbinds it from every unit
+    void Texture::DeleteTexture()
+    {
+        if(textureID == 0)
+        {
+            return;
+        }
+
+        for(GLuint i = 0; i < MAX_TEXTURE_UNITS; ++i)
+        {
+            if(boundTextures[i] == textureID)
+            {
+                boundTextures[i] = 0;
+            }
+        }
+
+        RenderDevice::Get().DeleteTexture(textureID);
+        textureID = 0;
+    }
+}
@@ -0,0 +1,255 @@
+/* ---------------------------------------------------------------------------
+** Texture.hpp
+** A texture used by the meshes. It loads the image, compresses it with the
+** format that fits its usage (see TextureCompressor) and keeps the result in
+** a .dds file next to the original one (named with the usage, as every usage
+** has its own format), so the next time it is just read and uploaded. The
+** file is made again if the original image is newer.
+** Compressed textures start with their smallest mips only, the rest of them
+** are brought (and dropped) by the TextureStreamer.
+** Every texture is a GL_TEXTURE_2D_ARRAY: a single texture is an array with
+** one layer, and textures with the same size and format can be packed in the
+** layers of the same one (see TextureArrayBuilder), so meshes that share it
+** don't have to bind anything between draws.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef TEXTURE_HEADER
+#define TEXTURE_HEADER
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// glew
+#include <GL/glew.h>
+
+#include "TextureCompressor.hpp"
+#include "RenderDevice.hpp"
+
+    namespace flygl
+    {
+        class Texture
+        {
+        public:
+
+            // Compressed textures start with the levels up to this size
+            static const int STREAMING_START_SIZE = 64;
+
+            // Texture units whose bindings are remembered
+            static const GLuint MAX_TEXTURE_UNITS = 16;
+
+        protected:
+
+            GLuint       textureID;
+            GLenum       internalFormat;
+            TextureUsage usage;
+
+            // Size of the full texture (level 0), even if it is not in the GPU
+            int width;
+            int height;
+            int levels;
+            int layers;
+
+            // Estimated video memory used by the resident levels
+            size_t sizeInBytes;
+
+            // Streaming data. The .dds files (one per layer) have every level,
+            // and only the ones from residentLevel to the smallest are in the GPU.
+            std::vector<std::string> streamingPaths;
+            int                      residentLevel;
+            int                      requestedLevel;
+            unsigned int             lastNeededFrame;
+            bool                     isLoading;
+
+            // Meshes using this texture
+            int references;
+
+            // What is bound on every unit, to skip binding it again
+            static GLuint boundTextures[MAX_TEXTURE_UNITS];
+
+        public:
+
+            // Constructor
+            Texture(): textureID(0), internalFormat(GL_NONE), usage(DIFFUSE_TEXTURE),
+                width(0), height(0), levels(0), layers(1), sizeInBytes(0),
+                residentLevel(0), requestedLevel(0), lastNeededFrame(0), isLoading(false),
+                references(1)
+            {}
+
+            // Destructor
+            ~Texture()
+            {
+                DeleteTexture();
+            }
+
+            void Load      (const std::string& path, const TextureUsage& texture_usage);
+            bool LoadLayers(const std::vector<std::string>& dds_paths, const TextureUsage& texture_usage);
+
+            void   SetResidentLevels(const std::vector<CompressedImage>& images, const int& first_level);
+            size_t GetSizeFrom      (const int& level) const;
+
+            // Binds the texture to the given unit (0, 1, 2...), if it is not already there
+            void Bind(const GLuint& unit) const
+            {
+                if(unit >= MAX_TEXTURE_UNITS || boundTextures[unit] != textureID)
+                {
+                    RenderDevice::Get().BindTexture(unit, GL_TEXTURE_2D_ARRAY, textureID);
+
+                    if(unit < MAX_TEXTURE_UNITS)
+                    {
+                        boundTextures[unit] = textureID;
+                    }
+                }
+            }
+
+            // Forget what is bound, call it if somebody else binds texture arrays
+            static void ResetBindings()
+            {
+                for(GLuint i = 0; i < MAX_TEXTURE_UNITS; ++i)
+                {
+                    boundTextures[i] = 0;
+                }
+            }
+
+            // Another mesh is using this texture
+            void AddReference()
+            {
+                references++;
+            }
+
+            // A mesh stops using this texture. When nobody uses it, it is deleted
+            void Release()
+            {
+                if(--references == 0)
+                {
+                    delete this;
+                }
+            }
+
+            // Returns the GL texture
+            GLuint GetID() const
+            {
+                return textureID;
+            }
+
+            // Returns the estimated memory used by the texture
+            size_t GetSize() const
+            {
+                return sizeInBytes;
+            }
+
+            // Returns the block format (or the sized format if it is not compressed)
+            GLenum GetFormat() const
+            {
+                return internalFormat;
+            }
+
+            // Returns what the texture is used for
+            TextureUsage GetUsage() const
+            {
+                return usage;
+            }
+
+            // Returns the width of the full texture (level 0)
+            int GetWidth() const
+            {
+                return width;
+            }
+
+            // Returns the height of the full texture (level 0)
+            int GetHeight() const
+            {
+                return height;
+            }
+
+            // Returns the number of levels of the full texture
+            int GetLevelCount() const
+            {
+                return levels;
+            }
+
+            // Returns the number of layers of the array
+            int GetLayerCount() const
+            {
+                return layers;
+            }
+
+            // If the levels of this texture can be streamed
+            bool IsStreamed() const
+            {
+                return !streamingPaths.empty();
+            }
+
+            // The .dds files that have every level (one per layer)
+            const std::vector<std::string>& GetStreamingPaths() const
+            {
+                return streamingPaths;
+            }
+
+            // The biggest level that is in the GPU
+            int GetResidentLevel() const
+            {
+                return residentLevel;
+            }
+
+            // Forget what was needed on the last frame
+            void ResetRequest()
+            {
+                requestedLevel = levels - 1;
+            }
+
+            // Somebody needs this level (or a smaller one) on this frame
+            void Require(const int& level, const unsigned int& frame)
+            {
+                requestedLevel  = std::min(requestedLevel, std::max(0, level));
+                lastNeededFrame = frame;
+            }
+
+            // The biggest level that has been required
+            int GetRequestedLevel() const
+            {
+                return requestedLevel;
+            }
+
+            // Changes the required level (for example if we are out of memory)
+            void SetRequestedLevel(const int& level)
+            {
+                requestedLevel = std::min(levels - 1, std::max(0, level));
+            }
+
+            // The last frame when it was needed
+            unsigned int GetLastNeededFrame() const
+            {
+                return lastNeededFrame;
+            }
+
+            // If some levels are being loaded
+            bool IsLoading() const
+            {
+                return isLoading;
+            }
+
+            void SetLoading(const bool& loading)
+            {
+                isLoading = loading;
+            }
+
+            // Returns if the compressed formats can be used in this GPU
+            static bool IsCompressionSupported()
+            {
+                return GLEW_EXT_texture_compression_s3tc && (GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc);
+            }
+
+        private:
+
+            bool LoadCompressedImage(const std::string& path, CompressedImage& image, int& first_level);
+            void UploadUncompressed (const unsigned char* data, const int& img_width, const int& img_height, const int& comp_num);
+            void CreateTexture      ();
+            void DeleteTexture      ();
+            int  GetStartLevel      () const;
+        };
+    }
+
+#endif
@@ -0,0 +1,102 @@
+/* ---------------------------------------------------------------------------
+** TextureArrayBuilder.cpp
+** Packs the textures of the meshes that have the same usage, format, size
+** and levels into the layers of a single GL_TEXTURE_2D_ARRAY. Each mesh
+** keeps the layer it uses, and passes it to the shader on every draw, so the
+** meshes that share a material class don't bind anything between draws.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "TextureArrayBuilder.hpp"
+
+namespace flygl
+{
+    // Groups the textures of the given meshes, and packs every group with
+    // more than one texture. Call it after loading the meshes, and before
+    // giving them to the TextureStreamer.
+    void TextureArrayBuilder::Pack(const std::vector<Mesh*>& meshes)
+    {
+        std::vector<Group> groups;
+
+        for(size_t m = 0; m < meshes.size(); ++m)
+        {
+            const std::vector<Texture*>& textures = meshes[m]->GetTextures();
+
+            for(size_t t = 0; t < textures.size(); ++t)
+            {
+                const Texture* texture = textures[t];
+
+                // Only compressed textures have their levels in a file we can pack
+                if(!texture->IsStreamed() || texture->GetLayerCount() != 1)
+                {
+                    continue;
+                }
+
+                Slot slot;
+                slot.mesh  = meshes[m];
+                slot.index = t;
+
+                size_t g = 0;
+                while(g < groups.size() &&
+                     (groups[g].usage  != texture->GetUsage()  || groups[g].format != texture->GetFormat() ||
+                      groups[g].width  != texture->GetWidth()  || groups[g].height != texture->GetHeight() ||
+                      groups[g].levels != texture->GetLevelCount()))
+                {
+                    g++;
+                }
+
+                if(g == groups.size())
+                {
+                    Group group;
+                    group.usage  = texture->GetUsage();
+                    group.format = texture->GetFormat();
+                    group.width  = texture->GetWidth();
+                    group.height = texture->GetHeight();
+                    group.levels = texture->GetLevelCount();
+                    groups.push_back(group);
+                }
+
+                groups[g].slots.push_back(slot);
+            }
+        }
+
+        for(size_t g = 0; g < groups.size(); ++g)
+        {
+            if(groups[g].slots.size() > 1)
+            {
+                PackGroup(groups[g]);
+            }
+        }
+    }
+
+    // Creates the array of a group and gives every mesh its layer
+    void TextureArrayBuilder::PackGroup(const Group& group)
+    {
+        std::vector<std::string> paths;
+        std::vector<Texture*>    sources;
+
+        for(size_t i = 0; i < group.slots.size(); ++i)
+        {
+            sources.push_back(group.slots[i].mesh->GetTextures()[group.slots[i].index]);
+            paths  .push_back(sources.back()->GetStreamingPaths()[0]);
+        }
+
+        Texture* array = new Texture();
+
+        // If something fails, the meshes keep their own textures
+        if(!array->LoadLayers(paths, group.usage))
+        {
+            array->Release();
+            return;
+        }
+
+        for(size_t i = 0; i < group.slots.size(); ++i)
+        {
+            group.slots[i].mesh->SetTextureLayer(group.slots[i].index, array, i);
+        }
+
+        // The meshes have their own references now
+        array->Release();
+    }
+}
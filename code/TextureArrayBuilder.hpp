@@ -0,0 +1,53 @@
+/* ---------------------------------------------------------------------------
+** TextureArrayBuilder.hpp
+** Packs the textures of the meshes that have the same usage, format, size
+** and levels into the layers of a single GL_TEXTURE_2D_ARRAY. Each mesh
+** keeps the layer it uses, and passes it to the shader on every draw, so the
+** meshes that share a material class don't bind anything between draws.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef TEXTUREARRAYBUILDER_HEADER
+#define TEXTUREARRAYBUILDER_HEADER
+
+#include <vector>
+
+#include "Mesh.hpp"
+#include "Texture.hpp"
+
+    namespace flygl
+    {
+        class TextureArrayBuilder
+        {
+        protected:
+
+            // A texture of a mesh
+            struct Slot
+            {
+                Mesh*  mesh;
+                size_t index;
+            };
+
+            // Textures that can share an array
+            struct Group
+            {
+                TextureUsage      usage;
+                GLenum            format;
+                int               width;
+                int               height;
+                int               levels;
+                std::vector<Slot> slots;
+            };
+
+        public:
+
+            static void Pack(const std::vector<Mesh*>& meshes);
+
+        private:
+
+            static void PackGroup(const Group& group);
+        };
+    }
+
+#endif
@@ -0,0 +1,557 @@
+/* ---------------------------------------------------------------------------
+** TextureCompressor.cpp
+** CPU block compression for the mesh textures. Diffuse maps go to BC1 (BC3 if
+** they have alpha), specular maps to BC4 (one channel) and tangent space
+** normal maps to BC5 (only X and Y, the shader rebuilds Z). The whole mip
+** chain is built here too, so the GPU never has to generate mipmaps.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "TextureCompressor.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace flygl
+{
+    // Returns the block format that fits the given usage
+    GLenum TextureCompressor::GetFormat(const TextureUsage& usage, const bool& has_alpha)
+    {
+        switch(usage)
+        {
+            case SPECULAR_TEXTURE: return GL_COMPRESSED_RED_RGTC1;
+            case NORMAL_TEXTURE:   return GL_COMPRESSED_RG_RGTC2;
+            default:               return has_alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        }
+    }
+
+    // Compresses an image and its whole mip chain
+    //
+    // rgba         The source texels, 4 bytes each, as they come from stbi_load
+    // width        Width of the source image
+    // height       Height of the source image
+    // usage        Diffuse, specular or normal. Decides the block format
+    // has_alpha    If a diffuse texture has to keep its alpha channel (BC3)
+    // image        Where the compressed levels are stored
+    void TextureCompressor::Compress(
+        const unsigned char* rgba, const int& width, const int& height,
+        const TextureUsage& usage, const bool& has_alpha, CompressedImage& image)
+    {
+        image.format = GetFormat(usage, has_alpha);
+        image.levels.clear();
+
+        std::vector<unsigned char> level(rgba, rgba + width * height * 4);
+        std::vector<unsigned char> next;
+
+        int level_width  = width;
+        int level_height = height;
+
+        while(true)
+        {
+            CompressedImage::Level compressed;
+            compressed.width  = level_width;
+            compressed.height = level_height;
+            CompressLevel(level, level_width, level_height, image.format, compressed.data);
+
+            image.levels.push_back(compressed);
+
+            if(level_width == 1 && level_height == 1)
+            {
+                break;
+            }
+
+            Downsample(level, level_width, level_height, next, usage == NORMAL_TEXTURE);
+            level.swap(next);
+
+            level_width  = std::max(1, level_width  / 2);
+            level_height = std::max(1, level_height / 2);
+        }
+    }
+
+    // Compresses one level, block by block. Borders that are not a multiple
+    // of 4 repeat the last row/column.
+    void TextureCompressor::CompressLevel(
+        const std::vector<unsigned char>& rgba, const int& width, const int& height,
+        const GLenum& format, std::vector<unsigned char>& output)
+    {
+        const size_t block_size = GetBlockSize(format);
+        const int    blocks_x   = (width  + 3) / 4;
+        const int    blocks_y   = (height + 3) / 4;
+
+        output.resize(blocks_x * blocks_y * block_size);
+
+        unsigned char block[64];
+        unsigned char* destination = &output[0];
+
+        for(int by = 0; by < blocks_y; ++by)
+        {
+            for(int bx = 0; bx < blocks_x; ++bx)
+            {
+                // Gather the 4x4 texels
+                for(int y = 0; y < 4; ++y)
+                {
+                    const int source_y = std::min(by * 4 + y, height - 1);
+
+                    for(int x = 0; x < 4; ++x)
+                    {
+                        const int source_x = std::min(bx * 4 + x, width - 1);
+                        memcpy(&block[(y * 4 + x) * 4], &rgba[(source_y * width + source_x) * 4], 4);
+                    }
+                }
+
+                switch(format)
+                {
+                    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:  CompressBC1Block(block, destination); break;
+                    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: CompressBC3Block(block, destination); break;
+                    case GL_COMPRESSED_RG_RGTC2:           CompressBC5Block(block, destination); break;
+                    default:
+                    {
+                        unsigned char red[16];
+                        for(int i = 0; i < 16; ++i)
+                        {
+                            red[i] = block[i * 4];
+                        }
+                        CompressBC4Block(red, destination);
+                        break;
+                    }
+                }
+
+                destination += block_size;
+            }
+        }
+    }
+
+    // BC1 (DXT1): two 565 endpoints and 2 bits per texel
+    void TextureCompressor::CompressBC1Block(const unsigned char* block_rgba, unsigned char* output)
+    {
+        CompressColorBlock(block_rgba, output);
+    }
+
+    // BC3 (DXT5): a BC4 block for the alpha followed by a BC1 color block
+    void TextureCompressor::CompressBC3Block(const unsigned char* block_rgba, unsigned char* output)
+    {
+        unsigned char alpha[16];
+        for(int i = 0; i < 16; ++i)
+        {
+            alpha[i] = block_rgba[i * 4 + 3];
+        }
+
+        CompressBC4Block  (alpha,      output    );
+        CompressColorBlock(block_rgba, output + 8);
+    }
+
+    // BC5 (RGTC2): two BC4 blocks, one for X (red) and one for Y (green)
+    void TextureCompressor::CompressBC5Block(const unsigned char* block_rgba, unsigned char* output)
+    {
+        unsigned char red  [16];
+        unsigned char green[16];
+        for(int i = 0; i < 16; ++i)
+        {
+            red  [i] = block_rgba[i * 4 + 0];
+            green[i] = block_rgba[i * 4 + 1];
+        }
+
+        CompressBC4Block(red,   output    );
+        CompressBC4Block(green, output + 8);
+    }
+
+    // BC4 (RGTC1): two 8 bit endpoints and 3 bits per texel. We always use
+    // the 8 values mode (first endpoint greater than the second one).
+    void TextureCompressor::CompressBC4Block(const unsigned char* values, unsigned char* output)
+    {
+        unsigned char max_value = values[0];
+        unsigned char min_value = values[0];
+        for(int i = 1; i < 16; ++i)
+        {
+            max_value = std::max(max_value, values[i]);
+            min_value = std::min(min_value, values[i]);
+        }
+
+        output[0] = max_value;
+        output[1] = min_value;
+        memset(output + 2, 0, 6);
+
+        if(max_value == min_value)
+        {
+            return;
+        }
+
+        // Position of the value between max (0) and min (7), and the index
+        // the palette gives to that position
+        static const unsigned char PALETTE_INDEX[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+
+        const int range = max_value - min_value;
+        unsigned long long bits = 0;
+
+        for(int i = 0; i < 16; ++i)
+        {
+            const int step = ((max_value - values[i]) * 7 + range / 2) / range;
+            bits |= (unsigned long long)PALETTE_INDEX[step] << (3 * i);
+        }
+
+        for(int i = 0; i < 6; ++i)
+        {
+            output[2 + i] = (unsigned char)(bits >> (8 * i));
+        }
+    }
+
+    // Compresses the color of a block. The endpoints are found on the
+    // principal axis of the colors (a few power iterations of the covariance
+    // matrix), and slightly inset so the palette covers the block better.
+    void TextureCompressor::CompressColorBlock(const unsigned char* block_rgba, unsigned char* output)
+    {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for(int i = 0; i < 16; ++i)
+        {
+            mean[0] += block_rgba[i * 4 + 0];
+            mean[1] += block_rgba[i * 4 + 1];
+            mean[2] += block_rgba[i * 4 + 2];
+        }
+        mean[0] /= 16.0f;
+        mean[1] /= 16.0f;
+        mean[2] /= 16.0f;
+
+        // Covariance: xx, xy, xz, yy, yz, zz
+        float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for(int i = 0; i < 16; ++i)
+        {
+            const float r = block_rgba[i * 4 + 0] - mean[0];
+            const float g = block_rgba[i * 4 + 1] - mean[1];
+            const float b = block_rgba[i * 4 + 2] - mean[2];
+
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for(int iteration = 0; iteration < 4; ++iteration)
+        {
+            const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+            const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+            const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+
+            const float biggest = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+            if(biggest < 1e-6f)
+            {
+                break;
+            }
+
+            axis[0] = x / biggest;
+            axis[1] = y / biggest;
+            axis[2] = z / biggest;
+        }
+
+        // Project every texel and keep the extremes
+        float min_projection =  1e30f;
+        float max_projection = -1e30f;
+        int   min_texel = 0;
+        int   max_texel = 0;
+
+        for(int i = 0; i < 16; ++i)
+        {
+            const float projection = block_rgba[i * 4 + 0] * axis[0] + block_rgba[i * 4 + 1] * axis[1] + block_rgba[i * 4 + 2] * axis[2];
+            if(projection < min_projection) { min_projection = projection; min_texel = i; }
+            if(projection > max_projection) { max_projection = projection; max_texel = i; }
+        }
+
+        // Inset the endpoints 1/16 of the range and quantize them to 565
+        int endpoint[2][3];
+        for(int c = 0; c < 3; ++c)
+        {
+            const int high  = block_rgba[max_texel * 4 + c];
+            const int low   = block_rgba[min_texel * 4 + c];
+            const int inset = (high - low) / 16;
+
+            endpoint[0][c] = std::min(255, std::max(0, high - inset));
+            endpoint[1][c] = std::min(255, std::max(0, low  + inset));
+        }
+
+        unsigned short color[2];
+        for(int e = 0; e < 2; ++e)
+        {
+            color[e] = (unsigned short)(
+                ((endpoint[e][0] * 31 + 127) / 255) << 11 |
+                ((endpoint[e][1] * 63 + 127) / 255) <<  5 |
+                ((endpoint[e][2] * 31 + 127) / 255));
+        }
+
+        // Four colors mode needs the first endpoint to be the greater one
+        if(color[0] < color[1])
+        {
+            std::swap(color[0], color[1]);
+        }
+
+        output[0] = (unsigned char)(color[0] & 0xFF);
+        output[1] = (unsigned char)(color[0] >> 8  );
+        output[2] = (unsigned char)(color[1] & 0xFF);
+        output[3] = (unsigned char)(color[1] >> 8  );
+        memset(output + 4, 0, 4);
+
+        if(color[0] == color[1])
+        {
+            return;
+        }
+
+        // Build the palette with the quantized endpoints, as the GPU will do
+        int palette[4][3];
+        for(int e = 0; e < 2; ++e)
+        {
+            const int r = (color[e] >> 11) & 31;
+            const int g = (color[e] >>  5) & 63;
+            const int b =  color[e]        & 31;
+
+            palette[e][0] = (r << 3) | (r >> 2);
+            palette[e][1] = (g << 2) | (g >> 4);
+            palette[e][2] = (b << 3) | (b >> 2);
+        }
+        for(int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] +     palette[1][c]) / 3;
+            palette[3][c] = (    palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        unsigned int indices = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            int best_index    = 0;
+            int best_distance = 0x7FFFFFFF;
+
+            for(int p = 0; p < 4; ++p)
+            {
+                const int dr = block_rgba[i * 4 + 0] - palette[p][0];
+                const int dg = block_rgba[i * 4 + 1] - palette[p][1];
+                const int db = block_rgba[i * 4 + 2] - palette[p][2];
+                const int distance = dr * dr + dg * dg + db * db;
+
+                if(distance < best_distance)
+                {
+                    best_distance = distance;
+                    best_index    = p;
+                }
+            }
+
+            indices |= best_index << (2 * i);
+        }
+
+        output[4] = (unsigned char)(indices      );
+        output[5] = (unsigned char)(indices >>  8);
+        output[6] = (unsigned char)(indices >> 16);
+        output[7] = (unsigned char)(indices >> 24);
+    }
+
+    // Halves an RGBA image with a box filter. Normal maps are renormalized,
+    // averaging normals makes them shorter.
+    void TextureCompressor::Downsample(
+        const std::vector<unsigned char>& source, const int& width, const int& height,
+              std::vector<unsigned char>& destination, const bool& is_normal_map)
+    {
+        const int new_width  = std::max(1, width  / 2);
+        const int new_height = std::max(1, height / 2);
+
+        destination.resize(new_width * new_height * 4);
+
+        for(int y = 0; y < new_height; ++y)
+        {
+            const int y0 = std::min(y * 2,     height - 1);
+            const int y1 = std::min(y * 2 + 1, height - 1);
+
+            for(int x = 0; x < new_width; ++x)
+            {
+                const int x0 = std::min(x * 2,     width - 1);
+                const int x1 = std::min(x * 2 + 1, width - 1);
+
+                const unsigned char* t00 = &source[(y0 * width + x0) * 4];
+                const unsigned char* t01 = &source[(y0 * width + x1) * 4];
+                const unsigned char* t10 = &source[(y1 * width + x0) * 4];
+                const unsigned char* t11 = &source[(y1 * width + x1) * 4];
+
+                unsigned char* texel = &destination[(y * new_width + x) * 4];
+
+                for(int c = 0; c < 4; ++c)
+                {
+                    texel[c] = (unsigned char)((t00[c] + t01[c] + t10[c] + t11[c] + 2) / 4);
+                }
+
+                if(is_normal_map)
+                {
+                    float normal[3];
+                    for(int c = 0; c < 3; ++c)
+                    {
+                        normal[c] = (t00[c] + t01[c] + t10[c] + t11[c]) / (4.0f * 127.5f) - 1.0f;
+                    }
+
+                    const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if(length > 1e-6f)
+                    {
+                        for(int c = 0; c < 3; ++c)
+                        {
+                            texel[c] = (unsigned char)std::min(255.0f, std::max(0.0f, (normal[c] / length + 1.0f) * 127.5f + 0.5f));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Decodes a level (what the GPU does when it samples it). The channels
+    // the format doesn't have are 0, and the alpha 255.
+    //
+    // format   GL_COMPRESSED_RGB_S3TC_DXT1_EXT, ..._DXT5_EXT, GL_COMPRESSED_RED_RGTC1 or GL_COMPRESSED_RG_RGTC2
+    // data     The blocks of the level
+    // width    Size of the level in texels
+    // height
+    // rgba     Where the texels are written, 4 bytes each
+    void TextureCompressor::Decompress(
+        const GLenum& format, const unsigned char* data, const int& width, const int& height,
+        unsigned char* rgba)
+    {
+        const int blocks_wide = (width + 3) / 4;
+        const int blocks_high = (height + 3) / 4;
+        const size_t block_size = GetBlockSize(format);
+
+        unsigned char block_rgba[16 * 4];
+
+        for(int block_y = 0; block_y < blocks_high; ++block_y)
+        {
+            for(int block_x = 0; block_x < blocks_wide; ++block_x)
+            {
+                const unsigned char* block = data + (block_y * blocks_wide + block_x) * block_size;
+
+                for(int i = 0; i < 16; ++i)
+                {
+                    block_rgba[i * 4 + 0] = 0;
+                    block_rgba[i * 4 + 1] = 0;
+                    block_rgba[i * 4 + 2] = 0;
+                    block_rgba[i * 4 + 3] = 255;
+                }
+
+                switch(format)
+                {
+                    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                        DecompressColorBlock(block, block_rgba, 3);
+                        break;
+
+                    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                        DecompressBC4Block  (block,     block_rgba, 3);
+                        DecompressColorBlock(block + 8, block_rgba, 3);
+                        break;
+
+                    case GL_COMPRESSED_RED_RGTC1:
+                        DecompressBC4Block(block, block_rgba, 0);
+                        break;
+
+                    case GL_COMPRESSED_RG_RGTC2:
+                        DecompressBC4Block(block,     block_rgba, 0);
+                        DecompressBC4Block(block + 8, block_rgba, 1);
+                        break;
+                }
+
+                // The blocks on the borders may be bigger than the level
+                for(int y = 0; y < 4 && block_y * 4 + y < height; ++y)
+                {
+                    for(int x = 0; x < 4 && block_x * 4 + x < width; ++x)
+                    {
+                        const unsigned char* texel  = &block_rgba[(y * 4 + x) * 4];
+                        unsigned char*       output = &rgba[((block_y * 4 + y) * width + block_x * 4 + x) * 4];
+
+                        output[0] = texel[0];
+                        output[1] = texel[1];
+                        output[2] = texel[2];
+                        output[3] = texel[3];
+                    }
+                }
+            }
+        }
+    }
+
+    // Decodes the color of a BC1 block: the two 565 endpoints and their
+    // interpolations (black for the 4th one if the first is not the biggest)
+    //
+    // channel_count    The RGB channels written
+    void TextureCompressor::DecompressColorBlock(const unsigned char* block, unsigned char* block_rgba, const int& channel_count)
+    {
+        const unsigned int endpoints[2] = { (unsigned int)(block[0] | (block[1] << 8)), (unsigned int)(block[2] | (block[3] << 8)) };
+
+        int palette[4][3];
+        for(int i = 0; i < 2; ++i)
+        {
+            const unsigned int r = (endpoints[i] >> 11) & 31;
+            const unsigned int g = (endpoints[i] >>  5) & 63;
+            const unsigned int b =  endpoints[i]        & 31;
+
+            palette[i][0] = (r << 3) | (r >> 2);
+            palette[i][1] = (g << 2) | (g >> 4);
+            palette[i][2] = (b << 3) | (b >> 2);
+        }
+
+        for(int c = 0; c < 3; ++c)
+        {
+            if(endpoints[0] > endpoints[1])
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        const unsigned int indices = block[4] | (block[5] << 8u) | (block[6] << 16u) | ((unsigned int)block[7] << 24u);
+
+        for(int i = 0; i < 16; ++i)
+        {
+            const int index = (indices >> (i * 2)) & 3;
+
+            for(int c = 0; c < channel_count; ++c)
+            {
+                block_rgba[i * 4 + c] = (unsigned char)palette[index][c];
+            }
+        }
+    }
+
+    // Decodes a BC4 block on one channel: two endpoints and 6 values
+    // between them, or 4 values and 0 and 255
+    void TextureCompressor::DecompressBC4Block(const unsigned char* block, unsigned char* block_rgba, const int& channel)
+    {
+        int palette[8];
+        palette[0] = block[0];
+        palette[1] = block[1];
+
+        if(palette[0] > palette[1])
+        {
+            for(int i = 1; i < 7; ++i)
+            {
+                palette[i + 1] = ((7 - i) * palette[0] + i * palette[1] + 3) / 7;
+            }
+        }
+        else
+        {
+            for(int i = 1; i < 5; ++i)
+            {
+                palette[i + 1] = ((5 - i) * palette[0] + i * palette[1] + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        // 48 bits of indices, 3 per texel
+        unsigned long long indices = 0;
+        for(int i = 0; i < 6; ++i)
+        {
+            indices |= (unsigned long long)block[2 + i] << (8 * i);
+        }
+
+        for(int i = 0; i < 16; ++i)
+        {
+            block_rgba[i * 4 + channel] = (unsigned char)palette[(indices >> (i * 3)) & 7];
+        }
+    }
+}
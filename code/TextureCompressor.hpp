@@ -0,0 +1,106 @@
+/* ---------------------------------------------------------------------------
+** TextureCompressor.hpp
+** CPU block compression for the mesh textures. Diffuse maps go to BC1 (BC3 if
+** they have alpha), specular maps to BC4 (one channel) and tangent space
+** normal maps to BC5 (only X and Y, the shader rebuilds Z). The whole mip
+** chain is built here too, so the GPU never has to generate mipmaps.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef TEXTURECOMPRESSOR_HEADER
+#define TEXTURECOMPRESSOR_HEADER
+
+#include <vector>
+#include <cstddef>
+
+// glew
+#include <GL/glew.h>
+
+    namespace flygl
+    {
+        // What the texture is used for. It decides the block format.
+        enum TextureUsage
+        {
+            DIFFUSE_TEXTURE  = 0,
+            SPECULAR_TEXTURE = 1,
+            NORMAL_TEXTURE   = 2
+        };
+
+        // A compressed image with its whole mip chain, ready to be
+        // uploaded with glCompressedTexImage2D
+        struct CompressedImage
+        {
+        public:
+
+            struct Level
+            {
+                int width;
+                int height;
+                std::vector<unsigned char> data;
+            };
+
+            GLenum             format;
+            std::vector<Level> levels;
+
+            // Bytes of every level together
+            size_t GetSize() const
+            {
+                size_t size = 0;
+                for(size_t i = 0; i < levels.size(); ++i)
+                {
+                    size += levels[i].data.size();
+                }
+                return size;
+            }
+        };
+
+        class TextureCompressor
+        {
+        public:
+
+            static void Compress(
+                const unsigned char* rgba, const int& width, const int& height,
+                const TextureUsage& usage, const bool& has_alpha, CompressedImage& image);
+
+            static GLenum GetFormat(const TextureUsage& usage, const bool& has_alpha);
+
+            // Bytes used by a block of 4x4 texels in the given format
+            static size_t GetBlockSize(const GLenum& format)
+            {
+                return (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RED_RGTC1) ? 8 : 16;
+            }
+
+            // Bytes used by a whole level in the given format
+            static size_t GetLevelSize(const GLenum& format, const int& width, const int& height)
+            {
+                return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+            }
+
+            static void CompressBC1Block(const unsigned char* block_rgba, unsigned char* output);
+            static void CompressBC3Block(const unsigned char* block_rgba, unsigned char* output);
+            static void CompressBC4Block(const unsigned char* values,     unsigned char* output);
+            static void CompressBC5Block(const unsigned char* block_rgba, unsigned char* output);
+
+            static void Downsample(
+                const std::vector<unsigned char>& source, const int& width, const int& height,
+                      std::vector<unsigned char>& destination, const bool& is_normal_map);
+
+            static void Decompress(
+                const GLenum& format, const unsigned char* data, const int& width, const int& height,
+                unsigned char* rgba);
+
+        private:
+
+            static void CompressLevel(
+                const std::vector<unsigned char>& rgba, const int& width, const int& height,
+                const GLenum& format, std::vector<unsigned char>& output);
+
+            static void CompressColorBlock(const unsigned char* block_rgba, unsigned char* output);
+
+            static void DecompressColorBlock(const unsigned char* block, unsigned char* block_rgba, const int& channel_count);
+            static void DecompressBC4Block  (const unsigned char* block, unsigned char* block_rgba, const int& channel);
+        };
+    }
+
+#endif
@@ -0,0 +1,235 @@
+/* ---------------------------------------------------------------------------
+** TextureImporter.cpp
+** Loads an image and uploads it without compression, with the smallest sized
+** format that fits it: specular maps only keep one channel (GL_R8), normal
+** maps two (GL_RG8, the shader rebuilds Z), grey images one... The storage is
+** allocated with glTexStorage (immutable) when the GPU supports it, and the
+** unpack alignment is set for the real row size of the image.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "TextureImporter.hpp"
+#include "TGADecoder.hpp"
+
+// STB Image, for image loading
+#include "stb_image\stb_image.h"
+
+namespace flygl
+{
+    // Loads an image, keeping only the channels it really needs
+    //
+    // path     The path route of the image
+    // usage    Diffuse, specular or normal
+    // width    Width of the loaded image
+    // height   Height of the loaded image
+    // channels Channels per texel of the returned data (1 to 4)
+    //
+    // Returns the texels (free them with Free), or NULL if it could not be loaded.
+    unsigned char* TextureImporter::Load(
+        const std::string& path, const TextureUsage& usage,
+        int& width, int& height, int& channels)
+    {
+        unsigned char* data = LoadPixels(path, width, height, channels, 0);
+
+        if(data == NULL)
+        {
+            return NULL;
+        }
+
+        const int texels = width * height;
+
+        if(usage == SPECULAR_TEXTURE && channels > 1)
+        {
+            // The shader only reads the red channel
+            KeepChannels(data, texels, channels, 1);
+            channels = 1;
+        }
+        else if(usage == NORMAL_TEXTURE && channels > 2)
+        {
+            // X and Y, the shader rebuilds Z
+            KeepChannels(data, texels, channels, 2);
+            channels = 2;
+        }
+        else if(usage == DIFFUSE_TEXTURE && channels == 3 && IsGrey(data, texels, channels))
+        {
+            KeepChannels(data, texels, channels, 1);
+            channels = 1;
+        }
+
+        return data;
+    }
+
+    // Loads the pixels of an image as stb_image does. The .tga files go
+    // through the TGADecoder, and only fall back to stb_image if it can't
+    // decode them.
+    //
+    // path             The path route of the image
+    // width            Width of the image
+    // height           Height of the image
+    // file_channels    Channels of the file
+    // desired_channels Channels of the output, 0 to keep the ones of the file
+    unsigned char* TextureImporter::LoadPixels(
+        const std::string& path, int& width, int& height,
+        int& file_channels, const int& desired_channels)
+    {
+        if(TGADecoder::IsTGA(path))
+        {
+            unsigned char* data = TGADecoder::Load(path, width, height, file_channels, desired_channels);
+            if(data != NULL)
+            {
+                return data;
+            }
+        }
+
+        return stbi_load(path.c_str(), &width, &height, &file_channels, desired_channels);
+    }
+
+    // Frees what Load or LoadPixels returned (both stb_image and the
+    // TGADecoder allocate with malloc)
+    void TextureImporter::Free(unsigned char* data)
+    {
+        stbi_image_free(data);
+    }
+
+    // Uploads an image to the texture bound to the given target
+    //
+    // target   GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY (with a single layer)
+    // data     The texels, as Load returns them
+    // width    Width of the image
+    // height   Height of the image
+    // channels Channels per texel
+    // usage    Diffuse, specular or normal. Grey diffuse textures are read as RGB
+    // levels   Levels of the texture. If more than one, mipmaps are generated
+    // is_srgb  If the colors are in sRGB space
+    void TextureImporter::Upload(
+        const GLenum& target, const unsigned char* data,
+        const int& width, const int& height, const int& channels,
+        const TextureUsage& usage, const int& levels, const bool& is_srgb)
+    {
+        const GLenum internal_format = GetInternalFormat(channels, is_srgb);
+        const GLenum format          = GetFormat(channels);
+
+        AllocateLevels(target, internal_format, width, height, levels);
+
+        // Rows of the image are not always aligned to 4 bytes (RGB or R images)
+        const int row_size = width * channels;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, (row_size % 4 == 0) ? 4 : (row_size % 2 == 0) ? 2 : 1);
+
+        if(target == GL_TEXTURE_2D_ARRAY)
+        {
+            glTexSubImage3D(target, 0, 0, 0, 0, width, height, 1, format, GL_UNSIGNED_BYTE, data);
+        }
+        else
+        {
+            glTexSubImage2D(target, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        // A grey diffuse texture has to look grey, not red
+        if(usage == DIFFUSE_TEXTURE && channels <= 2)
+        {
+            glTexParameteri(target, GL_TEXTURE_SWIZZLE_R, GL_RED);
+            glTexParameteri(target, GL_TEXTURE_SWIZZLE_G, GL_RED);
+            glTexParameteri(target, GL_TEXTURE_SWIZZLE_B, GL_RED);
+            glTexParameteri(target, GL_TEXTURE_SWIZZLE_A, channels == 2 ? GL_GREEN : GL_ONE);
+        }
+
+        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0         );
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,  levels - 1);
+
+        if(levels > 1)
+        {
+            glGenerateMipmap(target);
+        }
+    }
+
+    // The smallest sized format for the given channels
+    GLenum TextureImporter::GetInternalFormat(const int& channels, const bool& is_srgb)
+    {
+        switch(channels)
+        {
+            case 1:  return GL_R8;
+            case 2:  return GL_RG8;
+            case 3:  return is_srgb ? GL_SRGB8        : GL_RGB8;
+            default: return is_srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        }
+    }
+
+    // The format of the data we pass for the given channels
+    GLenum TextureImporter::GetFormat(const int& channels)
+    {
+        switch(channels)
+        {
+            case 1:  return GL_RED;
+            case 2:  return GL_RG;
+            case 3:  return GL_RGB;
+            default: return GL_RGBA;
+        }
+    }
+
+    // Packs the texels keeping only the first new_channels channels
+    void TextureImporter::KeepChannels(unsigned char* data, const int& texels, const int& channels, const int& new_channels)
+    {
+        for(int i = 0; i < texels; ++i)
+        {
+            for(int c = 0; c < new_channels; ++c)
+            {
+                data[i * new_channels + c] = data[i * channels + c];
+            }
+        }
+    }
+
+    // If every texel has the same red, green and blue
+    bool TextureImporter::IsGrey(const unsigned char* data, const int& texels, const int& channels)
+    {
+        for(int i = 0; i < texels; ++i)
+        {
+            const unsigned char* texel = &data[i * channels];
+            if(texel[0] != texel[1] || texel[0] != texel[2])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Allocates every level of the bound texture. Immutable if we can
+    void TextureImporter::AllocateLevels(const GLenum& target, const GLenum& internal_format, const int& width, const int& height, const int& levels)
+    {
+        const bool is_array = target == GL_TEXTURE_2D_ARRAY;
+
+        if(GLEW_VERSION_4_2 || GLEW_ARB_texture_storage)
+        {
+            if(is_array)
+            {
+                glTexStorage3D(target, levels, internal_format, width, height, 1);
+            }
+            else
+            {
+                glTexStorage2D(target, levels, internal_format, width, height);
+            }
+            return;
+        }
+
+        // Old GPUs: allocate the levels one by one
+        int level_width  = width;
+        int level_height = height;
+
+        for(int i = 0; i < levels; ++i)
+        {
+            if(is_array)
+            {
+                glTexImage3D(target, i, internal_format, level_width, level_height, 1, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+            }
+            else
+            {
+                glTexImage2D(target, i, internal_format, level_width, level_height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+            }
+
+            level_width  = level_width  > 1 ? level_width  / 2 : 1;
+            level_height = level_height > 1 ? level_height / 2 : 1;
+        }
+    }
+}
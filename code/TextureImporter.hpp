@@ -0,0 +1,65 @@
+/* ---------------------------------------------------------------------------
+** TextureImporter.hpp
+** Loads an image and uploads it without compression, with the smallest sized
+** format that fits it: specular maps only keep one channel (GL_R8), normal
+** maps two (GL_RG8, the shader rebuilds Z), grey images one... The storage is
+** allocated with glTexStorage (immutable) when the GPU supports it, and the
+** unpack alignment is set for the real row size of the image.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef TEXTUREIMPORTER_HEADER
+#define TEXTUREIMPORTER_HEADER
+
+#include <string>
+
+// glew
+#include <GL/glew.h>
+
+#include "TextureCompressor.hpp"
+
+    namespace flygl
+    {
+        class TextureImporter
+        {
+        public:
+
+            static unsigned char* Load(
+                const std::string& path, const TextureUsage& usage,
+                int& width, int& height, int& channels);
+
+            static unsigned char* LoadPixels(
+                const std::string& path, int& width, int& height,
+                int& file_channels, const int& desired_channels);
+
+            static void Free(unsigned char* data);
+
+            static void Upload(
+                const GLenum& target, const unsigned char* data,
+                const int& width, const int& height, const int& channels,
+                const TextureUsage& usage, const int& levels, const bool& is_srgb = false);
+
+            static GLenum GetInternalFormat(const int& channels, const bool& is_srgb);
+            static GLenum GetFormat        (const int& channels);
+
+            // Number of levels of a full mip chain
+            static int GetLevelCount(const int& width, const int& height)
+            {
+                int levels = 1;
+                for(int size = (width > height ? width : height); size > 1; size /= 2)
+                {
+                    levels++;
+                }
+                return levels;
+            }
+
+        private:
+
+            static void KeepChannels  (unsigned char* data, const int& texels, const int& channels, const int& new_channels);
+            static bool IsGrey        (const unsigned char* data, const int& texels, const int& channels);
+            static void AllocateLevels(const GLenum& target, const GLenum& internal_format, const int& width, const int& height, const int& levels);
+        };
+    }
+
+#endif
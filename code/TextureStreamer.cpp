@@ -0,0 +1,317 @@
+/* ---------------------------------------------------------------------------
+** TextureStreamer.cpp
+** Brings the mip levels of the textures to the GPU when they are needed, and
+** drops them when we run out of memory. Every frame it checks how big the
+** textures of every mesh are on screen (texture coordinates per world unit
+** and distance to the camera), and asks a loader thread for the levels that
+** are missing. If the resident textures go over the budget, the levels that
+** have not been needed for longer are dropped first.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "TextureStreamer.hpp"
+#include "Profiler.hpp"
+#include "MemoryTracker.hpp"
+#include "DDSFile.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace flygl
+{
+    // Constructor, starts the loader thread
+    TextureStreamer::TextureStreamer():
+        budget(DEFAULT_BUDGET), frame(0),
+        loaderThread(&TextureStreamer::LoaderLoop, this), isRunning(true)
+    {
+        loaderThread.launch();
+    }
+
+    // Destructor, stops the loader thread and throws away what it was doing
+    TextureStreamer::~TextureStreamer()
+    {
+        {
+            sf::Lock lock(loaderMutex);
+            isRunning = false;
+        }
+        loaderThread.wait();
+
+        for(size_t i = 0; i < pendingLoads.size(); ++i)
+        {
+            delete pendingLoads[i];
+        }
+        for(size_t i = 0; i < finishedLoads.size(); ++i)
+        {
+            delete finishedLoads[i];
+        }
+    }
+
+    // Adds a mesh whose textures will be streamed
+    void TextureStreamer::AddMesh(Mesh* mesh)
+    {
+        meshes.push_back(mesh);
+
+        // Some textures may be shared with other meshes
+        const std::vector<Texture*>& mesh_textures = mesh->GetTextures();
+        for(size_t i = 0; i < mesh_textures.size(); ++i)
+        {
+            if(std::find(textures.begin(), textures.end(), mesh_textures[i]) == textures.end())
+            {
+                textures.push_back(mesh_textures[i]);
+            }
+        }
+    }
+
+    // Called every frame, after the meshes and the camera have been updated
+    //
+    // camera       The camera that is drawing the scene
+    // view_matrix  The view matrix of that camera
+    void TextureStreamer::Update(const Camera& camera, const glm::mat4& view_matrix)
+    {
+        FLYGL_PROFILE_ZONE("TextureStreamer::Update");
+        MemoryScope memory_scope(MEMORY_TEXTURES);
+
+        frame++;
+
+        RequestLevels (camera, view_matrix);
+        ApplyBudget   ();
+        QueueLoads    ();
+        UploadFinished();
+    }
+
+    // Video memory used right now by the textures
+    size_t TextureStreamer::GetResidentSize() const
+    {
+        size_t size = 0;
+        for(size_t i = 0; i < textures.size(); ++i)
+        {
+            size += textures[i]->GetSize();
+        }
+        return size;
+    }
+
+    // Used when the frames must not depend on how long the loads take (the
+    // golden images), the upload limit of a frame is ignored
+    void TextureStreamer::WaitForLoads()
+    {
+        FLYGL_PROFILE_ZONE("TextureStreamer::WaitForLoads");
+
+        for(;;)
+        {
+            UploadFinished();
+
+            bool is_loading = false;
+            for(size_t i = 0; i < textures.size() && !is_loading; ++i)
+            {
+                is_loading = textures[i]->IsLoading();
+            }
+
+            if(!is_loading)
+            {
+                return;
+            }
+
+            sf::sleep(sf::milliseconds(1));
+        }
+    }
+
+    // Finds the level each texture needs. A texel of that level should be
+    // as big as a pixel on the screen.
+    void TextureStreamer::RequestLevels(const Camera& camera, const glm::mat4& view_matrix)
+    {
+        for(size_t i = 0; i < textures.size(); ++i)
+        {
+            textures[i]->ResetRequest();
+        }
+
+        // Pixels that a world unit takes at distance 1
+        const float pixels_per_unit = camera.GetScreenHeight() /
+            (2.0f * std::tan(glm::radians(camera.GetFoV()) * 0.5f));
+
+        for(size_t i = 0; i < meshes.size(); ++i)
+        {
+            const Mesh* mesh   = meshes[i];
+            const float radius = mesh->GetBoundsRadius();
+
+            // The camera looks to -Z, if it is behind us we don't need it
+            const glm::vec3 center = glm::vec3(view_matrix * glm::vec4(mesh->GetBoundsCenter(), 1.0f));
+            if(center.z - radius > 0.0f)
+            {
+                continue;
+            }
+
+            const float distance  = glm::max(camera.GetNear(), glm::length(center) - radius);
+            const float uv_per_px = mesh->GetUVDensity() * distance / pixels_per_unit;
+
+            const std::vector<Texture*>& mesh_textures = mesh->GetTextures();
+
+            for(size_t t = 0; t < mesh_textures.size(); ++t)
+            {
+                const float texels_per_px = mesh_textures[t]->GetWidth() * uv_per_px;
+                const int   level = texels_per_px > 1.0f ? (int)std::floor(std::log(texels_per_px) / std::log(2.0f)) : 0;
+
+                mesh_textures[t]->Require(level, frame);
+            }
+        }
+    }
+
+    // If what has been requested does not fit in the budget, make the
+    // textures that have not been needed for longer (and then the biggest
+    // ones) use smaller levels.
+    void TextureStreamer::ApplyBudget()
+    {
+        size_t total = 0;
+        for(size_t i = 0; i < textures.size(); ++i)
+        {
+            total += textures[i]->GetSizeFrom(textures[i]->GetRequestedLevel());
+        }
+
+        while(total > budget)
+        {
+            Texture* victim = NULL;
+
+            for(size_t i = 0; i < textures.size(); ++i)
+            {
+                Texture* texture = textures[i];
+
+                if(!texture->IsStreamed() || texture->GetRequestedLevel() >= texture->GetLevelCount() - 1)
+                {
+                    continue;
+                }
+
+                if(victim == NULL ||
+                   texture->GetLastNeededFrame() <  victim->GetLastNeededFrame() ||
+                  (texture->GetLastNeededFrame() == victim->GetLastNeededFrame() &&
+                   texture->GetSizeFrom(texture->GetRequestedLevel()) > victim->GetSizeFrom(victim->GetRequestedLevel())))
+                {
+                    victim = texture;
+                }
+            }
+
+            // Nothing else can be dropped
+            if(victim == NULL)
+            {
+                break;
+            }
+
+            const int level = victim->GetRequestedLevel();
+            total -= victim->GetSizeFrom(level) - victim->GetSizeFrom(level + 1);
+            victim->SetRequestedLevel(level + 1);
+        }
+    }
+
+    // Asks the loader thread for the levels that are missing. Levels that
+    // are not needed any more are only dropped if we are over the budget.
+    void TextureStreamer::QueueLoads()
+    {
+        const bool over_budget = GetResidentSize() > budget;
+
+        sf::Lock lock(loaderMutex);
+
+        for(size_t i = 0; i < textures.size(); ++i)
+        {
+            Texture* texture = textures[i];
+
+            if(!texture->IsStreamed() || texture->IsLoading())
+            {
+                continue;
+            }
+
+            const int requested = texture->GetRequestedLevel();
+            const int resident  = texture->GetResidentLevel();
+
+            if(requested < resident || (requested > resident && over_budget))
+            {
+                LoadRequest* request = new LoadRequest();
+                request->texture    = texture;
+                request->paths      = texture->GetStreamingPaths();
+                request->firstLevel = requested;
+                request->success    = false;
+
+                texture->SetLoading(true);
+                pendingLoads.push_back(request);
+            }
+        }
+    }
+
+    // Uploads what the loader thread has already read
+    void TextureStreamer::UploadFinished()
+    {
+        size_t uploaded = 0;
+
+        while(uploaded < UPLOAD_BYTES_PER_FRAME)
+        {
+            LoadRequest* request = NULL;
+            {
+                sf::Lock lock(loaderMutex);
+                if(!finishedLoads.empty())
+                {
+                    request = finishedLoads.front();
+                    finishedLoads.pop_front();
+                }
+            }
+
+            if(request == NULL)
+            {
+                break;
+            }
+
+            if(request->success)
+            {
+                request->texture->SetResidentLevels(request->images, request->firstLevel);
+                uploaded += request->texture->GetSize();
+            }
+
+            request->texture->SetLoading(false);
+            delete request;
+        }
+    }
+
+    // The loader thread. It reads the requested levels from the .dds files
+    // (one per layer)
+    void TextureStreamer::LoaderLoop()
+    {
+        FLYGL_PROFILE_THREAD("Texture loader");
+
+        // Everything this thread allocates is the levels it reads
+        MemoryTracker::SetTag(MEMORY_TEXTURES);
+
+        for(;;)
+        {
+            LoadRequest* request = NULL;
+            {
+                sf::Lock lock(loaderMutex);
+                if(!isRunning)
+                {
+                    return;
+                }
+
+                if(!pendingLoads.empty())
+                {
+                    request = pendingLoads.front();
+                    pendingLoads.pop_front();
+                }
+            }
+
+            if(request == NULL)
+            {
+                sf::sleep(sf::milliseconds(5));
+                continue;
+            }
+
+            FLYGL_PROFILE_ZONE("DDSFile::Load");
+
+            request->images.resize(request->paths.size());
+            request->success = true;
+
+            for(size_t i = 0; i < request->paths.size() && request->success; ++i)
+            {
+                request->success = DDSFile::Load(request->paths[i], request->images[i], request->firstLevel);
+            }
+
+            sf::Lock lock(loaderMutex);
+            finishedLoads.push_back(request);
+        }
+    }
+}
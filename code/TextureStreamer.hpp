@@ -0,0 +1,102 @@
+/* ---------------------------------------------------------------------------
+** TextureStreamer.hpp
+** Brings the mip levels of the textures to the GPU when they are needed, and
+** drops them when we run out of memory. Every frame it checks how big the
+** textures of every mesh are on screen (texture coordinates per world unit
+** and distance to the camera), and asks a loader thread for the levels that
+** are missing. If the resident textures go over the budget, the levels that
+** have not been needed for longer are dropped first.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef TEXTURESTREAMER_HEADER
+#define TEXTURESTREAMER_HEADER
+
+#include <deque>
+#include <vector>
+
+// SFML, for the loader thread
+#include <SFML/System.hpp>
+
+// GLM
+#include <glm/glm.hpp>
+
+#include "Mesh.hpp"
+#include "Camera.hpp"
+#include "Texture.hpp"
+
+    namespace flygl
+    {
+        class TextureStreamer
+        {
+        public:
+
+            // Default amount of video memory for the textures
+            static const size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+            // Max bytes uploaded in a frame, to avoid hiccups
+            static const size_t UPLOAD_BYTES_PER_FRAME = 8 * 1024 * 1024;
+
+        protected:
+
+            // Some levels of a texture (every layer), read by the loader thread
+            struct LoadRequest
+            {
+                Texture*                     texture;
+                std::vector<std::string>     paths;
+                int                          firstLevel;
+                std::vector<CompressedImage> images;
+                bool                         success;
+            };
+
+            std::vector<Mesh*>    meshes;
+            std::vector<Texture*> textures;
+
+            size_t       budget;
+            unsigned int frame;
+
+            // Loader thread data
+            sf::Thread                loaderThread;
+            sf::Mutex                 loaderMutex;
+            std::deque<LoadRequest*>  pendingLoads;
+            std::deque<LoadRequest*>  finishedLoads;
+            bool                      isRunning;        // Read and written with the mutex
+
+        public:
+
+            TextureStreamer();
+            ~TextureStreamer();
+
+            void AddMesh(Mesh* mesh);
+            void Update (const Camera& camera, const glm::mat4& view_matrix);
+
+            size_t GetResidentSize() const;
+
+            // Waits until the loader thread has read every requested level,
+            // and uploads them
+            void WaitForLoads();
+
+            // Changes the amount of video memory the textures can use
+            void SetBudget(const size_t& bytes)
+            {
+                budget = bytes;
+            }
+
+            // Returns the amount of video memory the textures can use
+            size_t GetBudget() const
+            {
+                return budget;
+            }
+
+        private:
+
+            void RequestLevels (const Camera& camera, const glm::mat4& view_matrix);
+            void ApplyBudget   ();
+            void QueueLoads    ();
+            void UploadFinished();
+            void LoaderLoop    ();
+        };
+    }
+
+#endif
@@ -6,6 +6,12 @@
 ** -------------------------------------------------------------------------*/
 
 #include "View.hpp"
+#include "TextureArrayBuilder.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
 
 #include <SFML/Window.hpp>  //For SFML inputs
 
@@ -20,15 +26,35 @@ namespace flygl
     // Class Constructor, Initializes the values.
     View::View(const int& width, const int& height)
     {
+        FLYGL_PROFILE_ZONE("View::View");
+
+        // What is not a mesh, a texture, a shader or a post process (they
+        // have their own scopes) is counted as loading
+        MemoryScope memory_scope(MEMORY_LOADING);
+
         screenWidth  = width;
         screenHeight = height;
         totalTime = 0.0f;
+        useInputs = true;
+        waitForTextures = false;
         
-        glEnable   (GL_DEPTH_TEST);
-        glEnable   (GL_CULL_FACE ); // Backface Culling
-        glDepthFunc(GL_LESS      ); // Accept closer fragments
+        RenderDevice& device = RenderDevice::Get();
+
+        device.SetCapability   (GL_DEPTH_TEST, true);
+        device.SetCapability   (GL_CULL_FACE,  true); // Backface Culling
+        device.SetDepthFunction(GL_LESS);             // Accept closer fragments
+
+        device.SetClearColor(0.f, 0.f, 0.f, 1.f);
+
+        // Video memory the textures can use
+        textureStreamer.SetBudget(128 * 1024 * 1024);
+
+        // The scene is scaled to keep 60 fps
+        useDynamicResolution = true;
+        gpuProfiler.Initialize();
 
-        glClearColor (0.f, 0.f, 0.f, 1.f);
+        lightManager .Initialize();
+        lightClusters.Initialize();
 
         MeshInitialization  ();
         CameraInitialization();
@@ -42,10 +68,19 @@ namespace flygl
     // Called every frame, updates the data
     void View::Update (const float& deltaTime)
     {
+        FLYGL_PROFILE_ZONE("View::Update");
+
+        frameClock.restart();
+
         totalTime += deltaTime;
-        Inputs(deltaTime);
 
-        if(actualEffect == DIZZY)
+        // Without a window (headless) there is no keyboard to read
+        if(useInputs)
+        {
+            Inputs(deltaTime);
+        }
+
+        if(dizzy.IsEnabled())
         {
             dizzy.Update(deltaTime);
         }
@@ -54,92 +89,140 @@ namespace flygl
 
         redLight.SetIntensity((1 + glm::sin(totalTime)) * 100000.0f);
 
-        bat.       Update();
-        floor.     Update();
-        walls.     Update();
-        columns.   Update();
-        cam.       Update();
-        whiteLight.Update();
-        redLight.  Update();
+        {
+            FLYGL_PROFILE_ZONE("Actors");
+
+            bat.       Update();
+            floor.     Update();
+            walls.     Update();
+            columns.   Update();
+            cam.       Update();
+            whiteLight.Update();
+            redLight.  Update();
+        }
+
+        textureStreamer.Update(cam, cam.GetMatrix());
+
+        if(waitForTextures)
+        {
+            textureStreamer.WaitForLoads();
+        }
     }
 
     // Called every frame, draws on the screen
     void View::Draw ()
     {
-        //Post-Processing: Preprocess
-        if(actualEffect == MOTION_BLUR)
-        {
-            blur.PreProcess();
-        }
-        else if(actualEffect == BLUR)
-        {
-            normal_blur.PreProcess();
-        }
-        else if(actualEffect == DIZZY)
-        {
-            dizzy.PreProcess();
-        }
-        else
-        {
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            glEnable(GL_DEPTH_TEST);
-        }
+        FLYGL_PROFILE_ZONE("View::Draw");
 
+        // The scene is drawn at the scale chosen with the last frames
+        renderTargets.SetRenderScale(useDynamicResolution ? resolutionController.GetScale() : 1.0f);
 
-        glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gpuProfiler.BeginFrame();
+        RenderStats::Get().BeginFrame();
 
         glm::mat4  ProjectionMatrix = cam.GetProjectionMatrix();
         glm::mat4& viewMatrix       = cam.GetMatrix();
 
-        CalculateLightingBuffer();
-        
-        if(actualEffect == REFLECTION)
         {
-            ReflectionDraw(ProjectionMatrix, viewMatrix);
+            FLYGL_PROFILE_ZONE("Lights");
+            RenderStatsPass stats_pass("Lights");
+
+            // Only the lights that changed are uploaded again
+            lightManager.Update();
+            lightManager.Bind();
+
+            // Every fragment only looks at the lights of its cluster
+            lightClusters.Update(lightManager, viewMatrix, ProjectionMatrix, cam.GetNear(), cam.GetFar(),
+                                 renderTargets.GetWidth(), renderTargets.GetHeight());
+            lightClusters.Bind();
         }
-        else
+
+        // Somebody may have changed the texture units since the last frame
+        Texture::ResetBindings();
+
+        // The reflections go first, on their own targets and with their own lights
+        if(useReflection)
         {
-            NormalDraw(ProjectionMatrix, viewMatrix);
+            GpuZone         gpu_zone  (&gpuProfiler, "Reflections");
+            RenderStatsPass stats_pass("Reflections");
+
+            reflections.Draw(lightManager, cam, ProjectionMatrix, viewMatrix);
+            lightClusters.Bind();
         }
-        
-        //Post-Process
-        if(actualEffect == MOTION_BLUR)
+
+        // Deferred: the G-buffer goes first, it is lit below instead of drawing the meshes.
+        // The surfaces of the reflections need the depth of the scene, so they draw forward
+        const bool deferred_draw = useDeferred && !useReflection;
+
+        if(deferred_draw)
         {
-            blur.Draw();
+            GpuZone         gpu_zone  (&gpuProfiler, "Geometry");
+            RenderStatsPass stats_pass("Geometry");
+
+            deferredRenderer.DrawGeometry(sceneMeshes, ProjectionMatrix, viewMatrix);
         }
-        else if(actualEffect == BLUR)
+
+        //Post-Processing: the scene is drawn on the targets of the chain (the
+        //G-buffer is on the shared depth, so it is not attached)
+        postprocessChain.Begin(!deferred_draw);
+
         {
-            normal_blur.Draw();
+            GpuZone         gpu_zone  (&gpuProfiler, "Scene");
+            RenderStatsPass stats_pass("Scene");
+
+            RenderDevice::Get().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        
+            if(deferred_draw)
+            {
+                deferredRenderer.DrawLighting(ProjectionMatrix, viewMatrix, lightClusters);
+            }
+            else
+            {
+                NormalDraw(ProjectionMatrix, viewMatrix);
+            }
         }
-        else if(actualEffect == DIZZY)
+
+        if(useReflection)
         {
-            dizzy.Draw();
+            GpuZone         gpu_zone  (&gpuProfiler, "Reflection surfaces");
+            RenderStatsPass stats_pass("Reflection surfaces");
+
+            reflections.DrawSurfaces(ProjectionMatrix, viewMatrix);
         }
+        
+        //Post-Process: every enabled effect, the last one on the screen (and
+        //scaled up to it). Every pass is measured by the chain
+        postprocessChain.End();
+
+        // The targets nobody uses anymore are deleted
+        renderTargets.EndFrame();
+
+        gpuProfiler.EndFrame();
+        RenderStats::Get().EndFrame();
+        UpdateResolution();
     }
 
-    void View::NormalDraw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
+    // Gives the times of the frame to the resolution controller. The GPU time
+    // is the one of the last frame the profiler has read (this one is not
+    // finished)
+    void View::UpdateResolution()
     {
-        bat.    Draw(projection_matrix, view_matrix, lightBuffer);
-        floor.  Draw(projection_matrix, view_matrix, lightBuffer);
-        walls.  Draw(projection_matrix, view_matrix, lightBuffer);
-        columns.Draw(projection_matrix, view_matrix, lightBuffer);
+        const float cpu_time = frameClock.getElapsedTime().asMicroseconds() / 1000.0f;
+
+        if(useDynamicResolution)
+        {
+            resolutionController.Update(cpu_time, gpuProfiler.GetFrameTime());
+        }
     }
 
-    void View::ReflectionDraw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
+    void View::NormalDraw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
     {
-        //Normal Draws
-        bat.    Draw(projection_matrix, view_matrix, lightBuffer);
-        walls.  Draw(projection_matrix, view_matrix, lightBuffer);
-        columns.Draw(projection_matrix, view_matrix, lightBuffer);
-
-        //Draws elements that will have reflexion
-        PrepareReflectiveDraws();
-        floor.Draw(projection_matrix, view_matrix, lightBuffer);
-
-        //Redraw the elements that will be reflected
-        PrepareReflectionDraws();
-        DrawMeshReflection(bat,     projection_matrix, view_matrix);
-        EndReflection();
+        FLYGL_PROFILE_ZONE("View::NormalDraw");
+
+        for(size_t i = 0; i < sceneMeshes.size(); ++i)
+        {
+            sceneMeshes[i]->Draw(projection_matrix, view_matrix, lightClusters);
+        }
     }
 
     // Resizes the screen with the given values
@@ -149,75 +232,13 @@ namespace flygl
         screenHeight = height;
         cam.SetScreenSize (screenWidth, screenHeight);
 
-        glViewport (0, 0, width, height);
-        blur.       Resize(width, height);
-        normal_blur.Resize(width, height);
-        dizzy.      Resize(width, height);
-    }
-
-    
-
-    // Next draws will reflect meshes
-    void View::PrepareReflectiveDraws()
-    {
-        glEnable(GL_STENCIL_TEST);
-
-        //Stencil Buffer Operations
-        glStencilFunc(GL_ALWAYS, 1, 0xFF); // Set any stencil to 1
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-        glStencilMask(0xFF); // Write to stencil buffer
-        glDepthMask(GL_FALSE); // Don't write to depth buffer
-        glClear(GL_STENCIL_BUFFER_BIT); // Clear stencil buffer (0 by default)
-    }
-
-    // Next draws will be reflected
-    void View::PrepareReflectionDraws()
-    {
-        glStencilFunc(GL_EQUAL, 1, 0xFF); // Pass test if stencil value is 1
-        glStencilMask(0x00); // Don't write anything to stencil buffer
-        glDepthMask(GL_TRUE); // Write to depth buffer
-        
-        //Prepare Alpha
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    }
-
-    // Finish the reflection process
-    void View::EndReflection()
-    {
-        glDisable(GL_BLEND);
-        glDisable(GL_STENCIL_TEST);
-    }
+        RenderDevice::Get().SetViewport(0, 0, width, height);
 
-    // Draws a mesh as a reflection. This is an aditional draw call.
-    void View::DrawMeshReflection(Mesh& mesh, const glm::mat4& projection_matrix, const glm::mat4& view_matrix)
-    {
-        mesh.SetScale(bat.GetScale().x, -bat.GetScale().y, bat.GetScale().z);
-        mesh.Update();
-        mesh.Draw(projection_matrix, view_matrix, lightBuffer);
-        mesh.SetScale(bat.GetScale().x, -bat.GetScale().y, bat.GetScale().z);
+        // The effects take the targets with the new size on the next frame
+        renderTargets.Resize(width, height);
     }
 
-    // Calculates a buffer that contains all the lighting
-    void View::CalculateLightingBuffer()
-    {
-        lightBuffer.positionBuffer[0] =  whiteLight.GetPosition().x;
-        lightBuffer.positionBuffer[1] =  whiteLight.GetPosition().y;
-        lightBuffer.positionBuffer[2] =  whiteLight.GetPosition().z;
-        lightBuffer.positionBuffer[3] =    redLight.GetPosition().x;
-        lightBuffer.positionBuffer[4] =    redLight.GetPosition().y;
-        lightBuffer.positionBuffer[5] =    redLight.GetPosition().z;
-   
-        lightBuffer.colorBuffer[0] =  whiteLight.GetColor().x;
-        lightBuffer.colorBuffer[1] =  whiteLight.GetColor().y;
-        lightBuffer.colorBuffer[2] =  whiteLight.GetColor().z;
-        lightBuffer.colorBuffer[3] =    redLight.GetColor().x;
-        lightBuffer.colorBuffer[4] =    redLight.GetColor().y;
-        lightBuffer.colorBuffer[5] =    redLight.GetColor().z;
-
-        lightBuffer.intensityBuffer[0] =  whiteLight.GetIntensity();
-        lightBuffer.intensityBuffer[1] =    redLight.GetIntensity();
-    }
+    
 
     // Handle the user inputs
     void View::Inputs(const float& deltaTime)
@@ -290,50 +311,131 @@ namespace flygl
             whiteLight.Switch();
         }
 
-        // SWITCH EFFECT
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num0))
+        // SWITCH EFFECTS (they are added to the ones already enabled)
+        for (int number = 0; number <= 6; ++number)
+        {
+            if (sf::Keyboard::isKeyPressed((sf::Keyboard::Key)(sf::Keyboard::Num0 + number)))
+            {
+                SwitchEffect(number);
+            }
+        }
+
+        // SWITCH RENDERER
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::F5))
         {
-            actualEffect = NONE;
+            SetDeferred(false);
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num1))
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::F6))
         {
-            actualEffect = MOTION_BLUR;
+            SetDeferred(true);
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num2))
+
+        // DYNAMIC RESOLUTION
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::F7))
+        {
+            SetDynamicResolution(true);
+        }
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::F8))
         {
-            actualEffect = REFLECTION;
+            SetDynamicResolution(false);
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num3))
+    }
+
+    // Enables an effect, with the number of its key (0 disables every one)
+    void View::SwitchEffect(const int& number)
+    {
+        switch (number)
         {
-            actualEffect = BLUR;
+            case 0:
+            {
+                blur.       SetEnabled(false);
+                normal_blur.SetEnabled(false);
+                dizzy.      SetEnabled(false);
+                colorGrade. SetEnabled(false);
+                vignette.   SetEnabled(false);
+                useReflection = false;
+                break;
+            }
+            case 1: blur.       SetEnabled(true); break;
+            case 2: useReflection = true;         break;
+            case 3: normal_blur.SetEnabled(true); break;
+            case 4: dizzy.      SetEnabled(true); break;
+            case 5: colorGrade. SetEnabled(true); break;
+            case 6: vignette.   SetEnabled(true); break;
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Num4))
+    }
+
+    // Switches between the forward and the deferred renderer
+    void View::SetDeferred(const bool& deferred)
+    {
+        useDeferred = deferred;
+    }
+
+    // Enables or disables the dynamic resolution (disabled, the scene is drawn at the screen size)
+    void View::SetDynamicResolution(const bool& dynamic_resolution)
+    {
+        useDynamicResolution = dynamic_resolution;
+
+        if(!dynamic_resolution)
         {
-            actualEffect = DIZZY;
+            resolutionController.Reset();
         }
     }
 
     // Initialize Post-Processes data Here!
     void View::PostProcessInitialization()
     {
-        actualEffect = NONE;
+        FLYGL_PROFILE_ZONE("View::PostProcessInitialization");
+        MemoryScope memory_scope(MEMORY_POSTPROCESS);
+
+        useReflection = false;
 
         blur.Initialize("../../assets/shaders/motionBlurVertex.glsl", 
                         "../../assets/shaders/motionBlurFragment.glsl",
-                        screenWidth, screenHeight);
+                        "../../assets/shaders/motionBlurTileMaxFragment.glsl",
+                        "../../assets/shaders/motionBlurNeighbourMaxFragment.glsl",
+                        renderTargets);
         
         normal_blur.Initialize("../../assets/shaders/blurVertex.glsl", 
-                        "../../assets/shaders/blurFragment.glsl",
-                        screenWidth, screenHeight);
-
-        dizzy.Initialize("../../assets/shaders/dizzyVertex.glsl", 
-                        "../../assets/shaders/dizzyFragment.glsl",
-                        screenWidth, screenHeight);
+                        "../../assets/shaders/blurGaussianFragment.glsl",
+                        "../../assets/shaders/blurDownsampleFragment.glsl",
+                        "../../assets/shaders/blurUpsampleFragment.glsl",
+                        renderTargets);
+
+        // Only functions, they are drawn in a single generated pass
+        dizzy.     Initialize("../../assets/shaders/dizzyEffect.glsl",      renderTargets);
+        colorGrade.Initialize("../../assets/shaders/colorGradeEffect.glsl", renderTargets);
+        vignette.  Initialize("../../assets/shaders/vignetteEffect.glsl",   renderTargets);
+
+        // The blurs lose nothing at half the resolution
+        blur.       SetResolutionScale(0.5f);
+        normal_blur.SetResolutionScale(0.5f);
+
+        postprocessChain.Initialize(renderTargets,
+                        "../../assets/shaders/basicPostProcessVertex.glsl",
+                        "../../assets/shaders/basicPostProcessFragment.glsl",
+                        "../../assets/shaders/bilateralUpsampleFragment.glsl");
+        postprocessChain.Add(&blur       );
+        postprocessChain.Add(&normal_blur);
+        postprocessChain.Add(&dizzy      );
+        postprocessChain.Add(&colorGrade );
+        postprocessChain.Add(&vignette   );
+        postprocessChain.SetGpuProfiler(&gpuProfiler);
+
+        useDeferred = false;
+
+        deferredRenderer.Initialize("../../assets/shaders/deferredLightingVertex.glsl", 
+                        "../../assets/shaders/deferredLightingFragment.glsl",
+                        renderTargets);
+        deferredRenderer.InitializeGeometry("../../assets/shaders/vertex.glsl", 
+                        "../../assets/shaders/gbufferFragment.glsl");
     }
     
     // Initialize Camera data Here!
     void View::CameraInitialization()
     {
+        FLYGL_PROFILE_ZONE("View::CameraInitialization");
+
         cam.SetScreenSize (screenWidth, screenHeight);
         cam.SetPosition   ( -60.0f,  -160.0f, -230.0f);
         cam.SetRotation   ( 20.0f, -10.0f, 0.0f);
@@ -346,11 +448,10 @@ namespace flygl
     // Initialize Light data Here!
     void View::LightsInitialization()
     {
-        lightBuffer.numberOfLights = 3;
+        FLYGL_PROFILE_ZONE("View::LightsInitialization");
 
-        lightBuffer.positionBuffer .resize(lightBuffer.numberOfLights * 3);
-        lightBuffer.colorBuffer    .resize(lightBuffer.numberOfLights * 3);
-        lightBuffer.intensityBuffer.resize(lightBuffer.numberOfLights    );
+        lightManager.Register(&whiteLight);
+        lightManager.Register(&redLight  );
 
         whiteLight.SetPosition(300.0f, 200.0f, 50.0f);
         whiteLight.SetColor(1.0f, 1.0f, 1.0f);
@@ -364,32 +465,60 @@ namespace flygl
     // Initialize the mesh data here!
     void View::MeshInitialization()
     {
+        FLYGL_PROFILE_ZONE("View::MeshInitialization");
+
         bat.LoadMesh        ("../../assets/models/troll.obj");
         bat.LoadShaders     ("../../assets/shaders/vertex.glsl", "../../assets/shaders/fragment.glsl");
-        bat.SetTexture      ("../../assets/textures/colors.jpg",   "diffuseSampler" );
-        bat.SetTexture      ("../../assets/textures/specular.jpg", "specularSampler");
-        bat.SetTexture      ("../../assets/textures/normals.jpg",  "normalSampler"  );
+        bat.SetTexture      ("../../assets/textures/colors.jpg",      "diffuseSampler",  DIFFUSE_TEXTURE);
+        bat.SetTexture      ("../../assets/textures/specular.jpg",    "specularSampler", SPECULAR_TEXTURE);
+        bat.SetTexture      ("../../assets/textures/normals.jpg",     "normalSampler",   NORMAL_TEXTURE);
         bat.SetBasicUniforms();
         
         floor.LoadMesh        ("../../assets/models/suelo.obj");
         floor.LoadShaders     ("../../assets/shaders/vertex.glsl", "../../assets/shaders/fragment.glsl");
-        floor.SetTexture      ("../../assets/textures/Suelo_D.tga",  "diffuseSampler");
-        floor.SetTexture      ("../../assets/textures/Suelo_S.tga",  "specularSampler");
-        floor.SetTexture      ("../../assets/textures/Suelo_NM.tga", "normalSampler");
+        floor.SetTexture      ("../../assets/textures/Suelo_D.tga",     "diffuseSampler",  DIFFUSE_TEXTURE);
+        floor.SetTexture      ("../../assets/textures/Suelo_S.tga",     "specularSampler", SPECULAR_TEXTURE);
+        floor.SetTexture      ("../../assets/textures/Suelo_NM.tga",    "normalSampler",   NORMAL_TEXTURE);
         floor.SetBasicUniforms();
 
         walls.LoadMesh        ("../../assets/models/paredes.obj");
         walls.LoadShaders     ("../../assets/shaders/vertex.glsl", "../../assets/shaders/fragment.glsl");
-        walls.SetTexture      ("../../assets/textures/Pared_D.tga",  "diffuseSampler");
-        walls.SetTexture      ("../../assets/textures/Pared_S.tga",  "specularSampler");
-        walls.SetTexture      ("../../assets/textures/Pared_NM.tga", "normalSampler");
+        walls.SetTexture      ("../../assets/textures/Pared_D.tga",     "diffuseSampler",  DIFFUSE_TEXTURE);
+        walls.SetTexture      ("../../assets/textures/Pared_S.tga",     "specularSampler", SPECULAR_TEXTURE);
+        walls.SetTexture      ("../../assets/textures/Pared_NM.tga",    "normalSampler",   NORMAL_TEXTURE);
         walls.SetBasicUniforms();
 
         columns.LoadMesh        ("../../assets/models/columnas.obj");
         columns.LoadShaders     ("../../assets/shaders/vertex.glsl", "../../assets/shaders/fragment.glsl");
-        columns.SetTexture      ("../../assets/textures/Columna_D.tga",  "diffuseSampler");
-        columns.SetTexture      ("../../assets/textures/Columna_S.tga",  "specularSampler");
-        columns.SetTexture      ("../../assets/textures/Columna_NM.tga", "normalSampler");
+        columns.SetTexture      ("../../assets/textures/Columna_D.tga",   "diffuseSampler",  DIFFUSE_TEXTURE);
+        columns.SetTexture      ("../../assets/textures/Columna_S.tga",   "specularSampler", SPECULAR_TEXTURE);
+        columns.SetTexture      ("../../assets/textures/Columna_NM.tga",  "normalSampler",   NORMAL_TEXTURE);
         columns.SetBasicUniforms();
+
+        sceneMeshes.push_back(&bat    );
+        sceneMeshes.push_back(&floor  );
+        sceneMeshes.push_back(&walls  );
+        sceneMeshes.push_back(&columns);
+
+        // Textures with the same size and format share an array, and the
+        // meshes that share arrays are drawn one after another
+        TextureArrayBuilder::Pack(sceneMeshes);
+        std::sort(sceneMeshes.begin(), sceneMeshes.end(), Mesh::SortByMaterial);
+
+        for(size_t i = 0; i < sceneMeshes.size(); ++i)
+        {
+            textureStreamer.AddMesh(sceneMeshes[i]);
+        }
+
+        // The floor reflects everything over it
+        reflections.Initialize("../../assets/shaders/planarReflectionVertex.glsl",
+                        "../../assets/shaders/planarReflectionFragment.glsl",
+                        renderTargets);
+        reflections.SetGpuProfiler(&gpuProfiler);
+
+        const int floor_reflection = reflections.Add(floor.GetPosition(), glm::vec3(0.0f, 1.0f, 0.0f), &floor, 0.5f);
+        reflections.AddMesh(floor_reflection, &bat    );
+        reflections.AddMesh(floor_reflection, &walls  );
+        reflections.AddMesh(floor_reflection, &columns);
     }
 }
@@ -14,28 +14,30 @@
     // GLM
     #include <glm/glm.hpp>
 
+    // SFML
+    #include <SFML/System/Clock.hpp>
+
     #include "Mesh.hpp"
     #include "Camera.hpp"
     #include "PointLight.hpp"
     #include "Postprocess.hpp"
     #include "MotionBlur.hpp"
+    #include "BlurProcess.hpp"
     #include "DizzyProcess.hpp"
+    #include "ColorGrade.hpp"
+    #include "Vignette.hpp"
+    #include "PostprocessChain.hpp"
+    #include "DeferredRenderer.hpp"
+    #include "TextureStreamer.hpp"
+    #include "ResolutionController.hpp"
+    #include "GpuProfiler.hpp"
+    #include "PlanarReflections.hpp"
     
     namespace flygl
     {
 
         class View
         {
-            enum Effects
-            {
-                NONE        = 0,
-                REFLECTION  = 1,
-                MOTION_BLUR = 2,
-                BLUR        = 3,
-                DIZZY       = 4
-            }
-            actualEffect;
-
         private:
 
             // Scene Meshes
@@ -44,10 +46,14 @@
             Mesh   walls;
             Mesh   columns;
 
-            // Lights
-            LightingBuffer lightBuffer;
+            // Every mesh, sorted by material to bind less textures
+            std::vector<Mesh*> sceneMeshes;
+
+            // Lights (the manager is destroyed before them, it unregisters them)
             PointLight     whiteLight;
             PointLight     redLight;
+            LightManager   lightManager;
+            LightClusters  lightClusters;
 
             float totalTime;
 
@@ -60,10 +66,44 @@
             int screenWidth;
             int screenHeight;
 
-            //POST-PROCESSING IS SO COOL!!!
+            // The targets of the post processes, only the ones alive at the same time exist
+            RenderTargetPool renderTargets;
+
+            //POST-PROCESSING IS SO COOL!!! (they can be stacked, in this order)
             MotionBlur  blur;
-            Postprocess normal_blur;
+            BlurProcess normal_blur;
             DizzyProcess dizzy;
+            ColorGrade  colorGrade;
+            Vignette    vignette;
+            PostprocessChain postprocessChain;
+
+            // The scene is reflected on the floor
+            PlanarReflections reflections;
+            bool              useReflection;
+
+            // Deferred path, instead of drawing every mesh with its own shader
+            DeferredRenderer deferredRenderer;
+            bool             useDeferred;
+
+            // Brings the texture levels when they are needed
+            TextureStreamer textureStreamer;
+
+            // Dynamic resolution: the scene is drawn smaller when the frames
+            // take too long. The CPU time is measured from Update to the end
+            // of Draw, the GPU time by the profiler (of a frame some frames
+            // ago, so it never waits)
+            ResolutionController resolutionController;
+            bool                 useDynamicResolution;
+            sf::Clock            frameClock;
+
+            // The GPU time of the frame and of every pass
+            GpuProfiler gpuProfiler;
+
+            // The keyboard is read on Update (not without a window)
+            bool useInputs;
+
+            // Update waits for the textures being loaded
+            bool waitForTextures;
 
         public:
 
@@ -75,18 +115,53 @@
 
             void   ShowLoading();
 
+            // What the keys do, for whoever drives the view without a keyboard
+            void   SwitchEffect        (const int&  number);
+            void   SetDeferred         (const bool& deferred);
+            void   SetDynamicResolution(const bool& dynamic_resolution);
+
+            void SetInputsEnabled(const bool& enabled)
+            {
+                useInputs = enabled;
+            }
+
+            // Places the camera, for the paths the golden tests follow
+            void SetCamera(const glm::vec3& position, const glm::vec3& rotation)
+            {
+                cam.SetPosition(position);
+                cam.SetRotation(rotation);
+            }
+
+            // The frames don't depend on how long the textures take to load
+            void SetWaitForTextures(const bool& wait)
+            {
+                waitForTextures = wait;
+            }
+
+            // Milliseconds the GPU took on a recent frame (0 until it is known)
+            float GetGpuFrameTime() const
+            {
+                return gpuProfiler.GetFrameTime();
+            }
+
+            // The GPU times of the passes (the average of the last frames)
+            const GpuProfiler& GetGpuProfiler() const
+            {
+                return gpuProfiler;
+            }
+
+            float GetRenderScale() const
+            {
+                return renderTargets.GetRenderScale();
+            }
+
         private:
 
             void Inputs(const float& deltaTime);
-            void CalculateLightingBuffer();
 
-            void NormalDraw    (const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
-            void ReflectionDraw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
-            void PrepareReflectiveDraws();
-            void PrepareReflectionDraws();
-            void EndReflection();
+            void NormalDraw(const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
 
-            void DrawMeshReflection(Mesh& mesh, const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
+            void UpdateResolution();
 
             void PostProcessInitialization();
             void CameraInitialization();
@@ -0,0 +1,38 @@
+/* ---------------------------------------------------------------------------
+** Vignette.hpp
+** Darkens the corners of the screen. It is a point function
+** (vignetteEffect.glsl), fused with the effects next to it.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef VIGNETTE_HEADER
+#define VIGNETTE_HEADER
+
+#include "FusedPass.hpp"
+
+    namespace flygl
+    {
+        class Vignette : public FusableEffect
+        {
+        protected:
+            GLfloat strength;
+            GLfloat radius;
+
+        public:
+
+			//Constructor
+			Vignette(): FusableEffect("Vignette", POINT_OPERATION), strength(0.6f), radius(0.5f)
+			{
+			}
+
+            // Render the Uniforms
+            virtual void SetUniforms(FusedPass& pass)
+            {
+                RenderDevice::Get().SetUniform(pass.GetUniform("vignetteStrength"), UNIFORM_FLOAT, 1, &strength);
+                RenderDevice::Get().SetUniform(pass.GetUniform("vignetteRadius"  ), UNIFORM_FLOAT, 1, &radius  );
+            }
+        };
+    }
+
+#endif
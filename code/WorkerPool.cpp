@@ -0,0 +1,175 @@
+/* ---------------------------------------------------------------------------
+** WorkerPool.cpp
+** Threads that run a job together.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#include "WorkerPool.hpp"
+#include "Profiler.hpp"
+
+#if defined(_MSC_VER)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <intrin.h>
+#else
+    #include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define FLYGL_WORKERS_PAUSE
+#endif
+
+namespace flygl
+{
+    // Waits before a worker yields its core, and before it sleeps
+    static const int SPIN_WAITS  = 4000;
+    static const int YIELD_WAITS = 200;
+
+    // Creates the workers
+    //
+    // thread_count     Threads that run every job, counting the caller (0 for one per core)
+    void WorkerPool::Start(const int& thread_count)
+    {
+        Stop();
+
+        const int count = thread_count > 0 ? thread_count : GetHardwareThreads();
+
+        isRunning = true;
+
+        for(int i = 1; i < count; ++i)
+        {
+            workers.push_back(new Worker(this, i));
+            workers.back()->thread.launch();
+        }
+    }
+
+    // Waits for the workers to end, and deletes them
+    void WorkerPool::Stop()
+    {
+        if(workers.empty())
+        {
+            return;
+        }
+
+        isRunning = false;
+        Fence();
+        AtomicAdd(generation, 1);
+
+        for(size_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i]->thread.wait();
+            delete workers[i];
+        }
+        workers.clear();
+    }
+
+    // Runs the job on every thread, and returns when all of them have finished it
+    void WorkerPool::Run(WorkerJob& worker_job)
+    {
+        if(workers.empty())
+        {
+            worker_job.Run(0);
+            return;
+        }
+
+        job     = &worker_job;
+        pending = workers.size();
+        Fence();
+        AtomicAdd(generation, 1);
+
+        worker_job.Run(0);
+
+        while(pending != 0)
+        {
+            Pause();
+        }
+        Fence();
+    }
+
+    // Waits for a new generation, runs its job and tells the pool
+    void WorkerPool::Worker::Loop()
+    {
+        FLYGL_PROFILE_THREAD("Worker");
+
+        long seen = 0;
+        int  idle = 0;
+
+        while(true)
+        {
+            if(pool->generation == seen)
+            {
+                idle++;
+
+                if(idle < SPIN_WAITS)
+                {
+                    Pause();
+                }
+                else
+                {
+                    sf::sleep(sf::milliseconds(idle < SPIN_WAITS + YIELD_WAITS ? 0 : 1));
+                }
+                continue;
+            }
+
+            Fence();
+            seen = pool->generation;
+            idle = 0;
+
+            if(!pool->isRunning)
+            {
+                return;
+            }
+
+            {
+                FLYGL_PROFILE_ZONE("WorkerJob::Run");
+                pool->job->Run(index);
+            }
+            AtomicAdd(pool->pending, -1);
+        }
+    }
+
+    // Number of cores (logical) of the machine
+    int WorkerPool::GetHardwareThreads()
+    {
+        #if defined(_MSC_VER)
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            const int count = info.dwNumberOfProcessors;
+        #else
+            const int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        #endif
+
+        return count > 0 ? count : 1;
+    }
+
+    // Adds to the value, as a single operation, and returns the result
+    long WorkerPool::AtomicAdd(volatile long& value, const long& amount)
+    {
+        #if defined(_MSC_VER)
+            return _InterlockedExchangeAdd(&value, amount) + amount;
+        #else
+            return __sync_add_and_fetch(&value, amount);
+        #endif
+    }
+
+    // Every write before it is seen before every write after it
+    void WorkerPool::Fence()
+    {
+        #if defined(_MSC_VER)
+            MemoryBarrier();
+        #else
+            __sync_synchronize();
+        #endif
+    }
+
+    // Tells the core we are spinning
+    void WorkerPool::Pause()
+    {
+        #ifdef FLYGL_WORKERS_PAUSE
+            _mm_pause();
+        #endif
+    }
+}
@@ -0,0 +1,93 @@
+/* ---------------------------------------------------------------------------
+** WorkerPool.hpp
+** Threads that run a job together: every worker, and the thread that asks
+** for it, call the job with their index, and the job takes its work from an
+** atomic counter until there is nothing left. Between jobs the workers spin
+** for a while before sleeping, so the many small jobs of a frame don't pay
+** for waking them up every time.
+**
+** Author: Fly - Ruben Negredo
+** -------------------------------------------------------------------------*/
+
+#ifndef WORKERPOOL_HEADER
+#define WORKERPOOL_HEADER
+
+#include <vector>
+
+// SFML
+#include <SFML/System.hpp>
+
+    namespace flygl
+    {
+        // Something the pool runs in parallel
+        class WorkerJob
+        {
+        public:
+
+            // Destructor
+            virtual ~WorkerJob()
+            {}
+
+            // Called once by every thread (0 is the one that runs the job)
+            virtual void Run(const int& worker) = 0;
+        };
+
+        class WorkerPool
+        {
+        private:
+
+            // A thread of the pool
+            struct Worker
+            {
+            public:
+
+                WorkerPool* pool;
+                int         index;
+                sf::Thread  thread;
+
+                // Constructor
+                Worker(WorkerPool* worker_pool, const int& worker_index):
+                    pool(worker_pool), index(worker_index), thread(&Worker::Loop, this)
+                {}
+
+                void Loop();
+            };
+
+            std::vector<Worker*> workers;
+
+            // The job being run, it changes with the generation
+            WorkerJob*    job;
+            volatile long generation;
+            volatile long pending;      // Workers that haven't finished the job
+            volatile bool isRunning;
+
+        public:
+
+            // Constructor
+            WorkerPool(): job(NULL), generation(0), pending(0), isRunning(false)
+            {}
+
+            // Destructor
+            ~WorkerPool()
+            {
+                Stop();
+            }
+
+            void Start(const int& thread_count);
+            void Stop ();
+            void Run  (WorkerJob& worker_job);
+
+            // Threads that run every job (the caller too)
+            int GetThreadCount() const
+            {
+                return workers.size() + 1;
+            }
+
+            static int  GetHardwareThreads();
+            static long AtomicAdd(volatile long& value, const long& amount);
+            static void Fence    ();
+            static void Pause    ();
+        };
+    }
+
+#endif
@@ -26,14 +26,44 @@
 
 #include "View.hpp"
 #include "ShaderManager.hpp"
+#include "TextureImporter.hpp"
+#include "HeadlessRunner.hpp"
+#include "BenchmarkRunner.hpp"
+#include "SelfTestRunner.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "MemoryTracker.hpp"
 
 using namespace sf;
 
-void EventHandler(Window &window, flygl::View &view, bool &running);
+void EventHandler(Window &window, flygl::View &view, bool &running, bool &showStats, bool &showMemory);
 void ShowLoading();
 
-int main ()
+int main (int argc, char* argv[])
 {
+    FLYGL_PROFILE_THREAD("Main");
+
+    // Without a window, for the machines with no display (see HeadlessRunner)
+    flygl::HeadlessRunner headless;
+    if (headless.ParseArguments(argc, argv))
+    {
+        return headless.Run();
+    }
+
+    // The CPU benchmarks, no window either (see BenchmarkRunner)
+    flygl::BenchmarkRunner benchmarks;
+    if (benchmarks.ParseArguments(argc, argv))
+    {
+        return benchmarks.Run();
+    }
+
+    // The checks that need no window either (see SelfTestRunner)
+    flygl::SelfTestRunner self_tests;
+    if (self_tests.ParseArguments(argc, argv))
+    {
+        return self_tests.Run();
+    }
+
     static const sf::Uint32 INITIAL_WINDOW_WIDTH  = 640;
     static const sf::Uint32 INITIAL_WINDOW_HEIGHT = 400;
 
@@ -54,8 +84,19 @@ int main ()
 
     flygl::View view(INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT);
 
+    // Only the events of the frames are kept for the trace (see F9)
+    FLYGL_PROFILE_FRAME();
+
     bool running = true;
 
+    // The render stats of the last frame on the title (F10)
+    bool      showStats = false;
+    sf::Clock titleClock;
+
+    // The memory report on the console, every 5 seconds (F11)
+    bool      showMemory = false;
+    sf::Clock memoryClock;
+
     // Delta Time Initialization
     sf::Clock deltaClock;
     sf::Time deltaTime = deltaClock.restart();
@@ -68,7 +109,10 @@ int main ()
     // Core Loop
     do
     {
-        EventHandler(window, view, running);
+        {
+            FLYGL_PROFILE_ZONE("EventHandler");
+            EventHandler(window, view, running, showStats, showMemory);
+        }
         
         // Updates
         deltaTime = deltaClock.restart();
@@ -80,7 +124,25 @@ int main ()
         view.Draw();
 
         // Pass everything to the Window.
-        window.display ();
+        {
+            FLYGL_PROFILE_ZONE("window.display");
+            window.display ();
+        }
+
+        // Twice a second, the title is slow to change on some systems
+        if (showStats && titleClock.getElapsedTime().asSeconds() >= 0.5f)
+        {
+            window.setTitle ("FlyEngine - " + flygl::RenderStats::Get().GetSummary());
+            titleClock.restart();
+        }
+
+        if (showMemory && memoryClock.getElapsedTime().asSeconds() >= 5.0f)
+        {
+            flygl::MemoryTracker::WriteReport(stdout);
+            memoryClock.restart();
+        }
+
+        FLYGL_PROFILE_FRAME();
     }
     while (running);
 
@@ -90,10 +152,12 @@ int main ()
 
 // Takes care of all window events
 // 
-// window   The window, to know the inputs
-// view     If the window is resized, we must inform the view with the new parameters
-// running  A boolean to tell if the application is being closed
-void EventHandler(Window &window, flygl::View &view, bool &running)
+// window       The window, to know the inputs
+// view         If the window is resized, we must inform the view with the new parameters
+// running      A boolean to tell if the application is being closed
+// showStats    If the render stats are shown on the title (F10)
+// showMemory   If the memory report is printed (F11)
+void EventHandler(Window &window, flygl::View &view, bool &running, bool &showStats, bool &showMemory)
 {
     Event event;
 
@@ -117,6 +181,35 @@ void EventHandler(Window &window, flygl::View &view, bool &running)
 
                 break;
             }
+
+            case Event::KeyPressed:
+            {
+                // Saves the last frames of the profiler (if the build has it)
+                #ifdef FLYGL_PROFILING
+                if (event.key.code == Keyboard::F9)
+                {
+                    flygl::Profiler::WriteChromeTrace("trace.json", 300);
+                }
+                #endif
+
+                if (event.key.code == Keyboard::F10)
+                {
+                    showStats = !showStats;
+                    window.setTitle ("FlyEngine");
+                }
+
+                // The first report is printed at once
+                if (event.key.code == Keyboard::F11)
+                {
+                    showMemory = !showMemory;
+                    if (showMemory)
+                    {
+                        flygl::MemoryTracker::WriteReport(stdout);
+                    }
+                }
+
+                break;
+            }
         }
     }
 }
@@ -160,7 +253,7 @@ void ShowLoading()
     glVertexAttribPointer(attPosition, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
 
     int img_width, img_height, comp_num;
-    unsigned char *data = stbi_load("../../assets/textures/loading.png", &img_width, &img_height, &comp_num, 0);
+    unsigned char *data = flygl::TextureImporter::Load("../../assets/textures/loading.png", flygl::DIFFUSE_TEXTURE, img_width, img_height, comp_num);
 
     // Create one OpenGL texture
     GLuint texture_id = loadingshader.SetUniform("colorTexture");
@@ -170,13 +263,14 @@ void ShowLoading()
 	
 	glBindTexture(GL_TEXTURE_2D, loadingtextureID);
 
-    glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, 
-                    img_width, img_height, 
-                    0, GL_RGB, GL_UNSIGNED_BYTE, 
-                    data);
+    // Only one level, it is drawn at its size
+    if(data != NULL)
+    {
+        flygl::TextureImporter::Upload(GL_TEXTURE_2D, data, img_width, img_height, comp_num, flygl::DIFFUSE_TEXTURE, 1);
+    }
 
     // Free the data, we already have it stored
-    stbi_image_free(data);
+    flygl::TextureImporter::Free(data);
 
     // Set texture Parameters
     glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
@@ -67,6 +67,7 @@ bool loadOBJ(
 			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
 			if (matches != 9){
 				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
+				fclose(file);
 				return false;
 			}
 			vertexIndices.push_back(vertexIndex[0]);
@@ -86,6 +87,8 @@ bool loadOBJ(
 
 	}
 
+	fclose(file);
+
 	// For each vertex of each triangle
 	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
 